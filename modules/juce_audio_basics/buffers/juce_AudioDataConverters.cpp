@@ -431,34 +431,607 @@ void AudioDataConverters::convertFormatToFloat (DataFormat sourceFormat, const v
 //==============================================================================
 void AudioDataConverters::interleaveSamples (const float** source, float* dest, int numSamples, int numChannels)
 {
-    for (int chan = 0; chan < numChannels; ++chan)
+    interleaveFromInt32 (reinterpret_cast<const int32* const*> (source), 0, numChannels,
+                         ByteOrder::isBigEndian() ? float32BE : float32LE, dest, numChannels, numSamples);
+}
+
+void AudioDataConverters::deinterleaveSamples (const float* source, float** dest, int numSamples, int numChannels)
+{
+    deinterleaveToInt32 (ByteOrder::isBigEndian() ? float32BE : float32LE, source, numChannels,
+                         reinterpret_cast<int32* const*> (dest), 0, numChannels, numSamples);
+}
+
+//==============================================================================
+namespace BlockConversionHelpers
+{
+    using DataFormat = AudioDataConverters::DataFormat;
+
+    // Interleaved data is converted to (or from) native 32-bit values in blocks of at most
+    // this many values, so that the intermediate buffer stays in the cache.
+    enum { maxValuesPerBlock = 2048, maxChannelsPerBlock = 64 };
+
+    static bool isBigEndianFormat (DataFormat format) noexcept      { return (format & 1) != 0; }
+    static bool needsByteSwap (DataFormat format) noexcept          { return isBigEndianFormat (format) != ByteOrder::isBigEndian(); }
+
+    static int getBytesPerSample (DataFormat format) noexcept
+    {
+        return format < AudioDataConverters::int24LE ? 2 : (format < AudioDataConverters::int32LE ? 3 : 4);
+    }
+
+    // The 32-bit formats can be used without converting them if they're in the native byte order
+    static bool canUseDirectly (DataFormat format, const void* data) noexcept
+    {
+        return getBytesPerSample (format) == 4 && ! needsByteSwap (format)
+                 && (((pointer_sized_int) data) & 3) == 0;
+    }
+
+   #if JUCE_USE_SSE_INTRINSICS
+    static forcedinline __m128i swapBytes16 (__m128i v) noexcept
+    {
+        return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+    }
+
+    static forcedinline __m128i swapBytes32 (__m128i v) noexcept
+    {
+        v = swapBytes16 (v);
+        v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+        return _mm_shufflehi_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+    }
+   #endif
+
+    //==============================================================================
+    static void copy32 (const uint8* src, uint8* dest, int num, bool swap) noexcept
+    {
+        if (! swap)
+        {
+            memcpy (dest, src, sizeof (int32) * (size_t) num);
+            return;
+        }
+
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i <= num - 4; i += 4)
+            _mm_storeu_si128 ((__m128i*) (dest + 4 * i), swapBytes32 (_mm_loadu_si128 ((const __m128i*) (src + 4 * i))));
+       #elif JUCE_USE_ARM_NEON
+        for (; i <= num - 4; i += 4)
+            vst1q_u8 (dest + 4 * i, vrev32q_u8 (vld1q_u8 (src + 4 * i)));
+       #endif
+
+        for (; i < num; ++i)
+            writeUnaligned<uint32> (dest + 4 * i, ByteOrder::swap (readUnaligned<uint32> (src + 4 * i)));
+    }
+
+    static void readInt16 (const uint8* src, int32* dest, int num, bool swap) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        const auto zero = _mm_setzero_si128();
+
+        for (; i <= num - 8; i += 8)
+        {
+            auto v = _mm_loadu_si128 ((const __m128i*) (src + 2 * i));
+
+            if (swap)
+                v = swapBytes16 (v);
+
+            _mm_storeu_si128 ((__m128i*) (dest + i),     _mm_unpacklo_epi16 (zero, v));
+            _mm_storeu_si128 ((__m128i*) (dest + i + 4), _mm_unpackhi_epi16 (zero, v));
+        }
+       #elif JUCE_USE_ARM_NEON
+        for (; i <= num - 8; i += 8)
+        {
+            auto v = vld1q_u8 (src + 2 * i);
+
+            if (swap)
+                v = vrev16q_u8 (v);
+
+            auto s = vreinterpretq_s16_u8 (v);
+            vst1q_s32 (dest + i,     vshll_n_s16 (vget_low_s16 (s), 16));
+            vst1q_s32 (dest + i + 4, vshll_n_s16 (vget_high_s16 (s), 16));
+        }
+       #endif
+
+        for (; i < num; ++i)
+        {
+            auto v = readUnaligned<uint16> (src + 2 * i);
+            dest[i] = (int32) ((uint32) (swap ? ByteOrder::swap (v) : v) << 16);
+        }
+    }
+
+    static void writeInt16 (const int32* src, uint8* dest, int num, bool swap) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        for (; i <= num - 8; i += 8)
+        {
+            // (the values are already in range after the shift, so the saturation has no effect)
+            auto v = _mm_packs_epi32 (_mm_srai_epi32 (_mm_loadu_si128 ((const __m128i*) (src + i)), 16),
+                                      _mm_srai_epi32 (_mm_loadu_si128 ((const __m128i*) (src + i + 4)), 16));
+
+            if (swap)
+                v = swapBytes16 (v);
+
+            _mm_storeu_si128 ((__m128i*) (dest + 2 * i), v);
+        }
+       #elif JUCE_USE_ARM_NEON
+        for (; i <= num - 8; i += 8)
+        {
+            auto v = vreinterpretq_u8_s16 (vcombine_s16 (vshrn_n_s32 (vld1q_s32 (src + i), 16),
+                                                         vshrn_n_s32 (vld1q_s32 (src + i + 4), 16)));
+
+            if (swap)
+                v = vrev16q_u8 (v);
+
+            vst1q_u8 (dest + 2 * i, v);
+        }
+       #endif
+
+        for (; i < num; ++i)
+        {
+            auto v = (uint16) (src[i] >> 16);
+            writeUnaligned<uint16> (dest + 2 * i, swap ? ByteOrder::swap (v) : v);
+        }
+    }
+
+    static void readInt24 (const uint8* src, int32* dest, int num, bool bigEndian) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS && (defined (__SSSE3__) || defined (__AVX__))
+        {
+            // Each group of 4 samples is read with a 16-byte load, so stop before that runs off the end
+            const auto shuffle = bigEndian ? _mm_setr_epi8 (-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9)
+                                           : _mm_setr_epi8 (-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+            for (; 3 * i + 16 <= 3 * num; i += 4)
+                _mm_storeu_si128 ((__m128i*) (dest + i), _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*) (src + 3 * i)), shuffle));
+        }
+       #elif JUCE_USE_SSE_INTRINSICS
+        {
+            const auto mask = _mm_set1_epi32 ((int) 0xffffff00);
+
+            for (; 3 * i + 16 <= 3 * num; i += 4)
+            {
+                // shift each sample down to the bottom of a copy of the data, and gather the bottom values
+                auto v = _mm_loadu_si128 ((const __m128i*) (src + 3 * i));
+                auto values = _mm_unpacklo_epi64 (_mm_unpacklo_epi32 (v, _mm_srli_si128 (v, 3)),
+                                                  _mm_unpacklo_epi32 (_mm_srli_si128 (v, 6), _mm_srli_si128 (v, 9)));
+
+                _mm_storeu_si128 ((__m128i*) (dest + i), bigEndian ? _mm_and_si128 (swapBytes32 (values), mask)
+                                                                    : _mm_slli_epi32 (values, 8));
+            }
+        }
+       #elif JUCE_USE_ARM_NEON
+        for (; i <= num - 16; i += 16)
+        {
+            // split the bytes of 16 samples, then write them back with a zero byte at the bottom of each value
+            auto bytes = vld3q_u8 (src + 3 * i);
+
+            uint8x16x4_t values;
+            values.val[0] = vdupq_n_u8 (0);
+            values.val[1] = bytes.val[bigEndian ? 2 : 0];
+            values.val[2] = bytes.val[1];
+            values.val[3] = bytes.val[bigEndian ? 0 : 2];
+
+            vst4q_u8 ((uint8*) (dest + i), values);
+        }
+       #endif
+
+        // Each sample is read with a 4-byte load, so the last one has to be done separately
+        if (bigEndian)
+            for (; i < num - 1; ++i)
+                dest[i] = (int32) (ByteOrder::swapIfLittleEndian (readUnaligned<uint32> (src + 3 * i)) & 0xffffff00u);
+        else
+            for (; i < num - 1; ++i)
+                dest[i] = (int32) (ByteOrder::swapIfBigEndian (readUnaligned<uint32> (src + 3 * i)) << 8);
+
+        if (i < num)
+            dest[i] = (int32) ((uint32) (bigEndian ? ByteOrder::bigEndian24Bit (src + 3 * i)
+                                                   : ByteOrder::littleEndian24Bit (src + 3 * i)) << 8);
+    }
+
+    static void writeInt24 (const int32* src, uint8* dest, int num, bool bigEndian) noexcept
+    {
+        int i = 0;
+
+       #if JUCE_USE_SSE_INTRINSICS && (defined (__SSSE3__) || defined (__AVX__))
+        {
+            const auto shuffle = bigEndian ? _mm_setr_epi8 (3, 2, 1, 7, 6, 5, 11, 10, 9, 15, 14, 13, -1, -1, -1, -1)
+                                           : _mm_setr_epi8 (1, 2, 3, 5, 6, 7, 9, 10, 11, 13, 14, 15, -1, -1, -1, -1);
+
+            for (; 3 * i + 16 <= 3 * num; i += 4)
+                _mm_storeu_si128 ((__m128i*) (dest + 3 * i), _mm_shuffle_epi8 (_mm_loadu_si128 ((const __m128i*) (src + i)), shuffle));
+        }
+       #elif JUCE_USE_ARM_NEON
+        for (; i <= num - 16; i += 16)
+        {
+            // split the bytes of 16 values, then write back the top three bytes of each one
+            auto values = vld4q_u8 ((const uint8*) (src + i));
+
+            uint8x16x3_t bytes;
+            bytes.val[0] = values.val[bigEndian ? 3 : 1];
+            bytes.val[1] = values.val[2];
+            bytes.val[2] = values.val[bigEndian ? 1 : 3];
+
+            vst3q_u8 (dest + 3 * i, bytes);
+        }
+       #endif
+
+        // Each sample is written with a 4-byte store that overlaps the next one, so the last one
+        // has to be done separately
+        if (bigEndian)
+            for (; i < num - 1; ++i)
+                writeUnaligned<uint32> (dest + 3 * i, ByteOrder::swapIfLittleEndian ((uint32) src[i]));
+        else
+            for (; i < num - 1; ++i)
+                writeUnaligned<uint32> (dest + 3 * i, ByteOrder::swapIfBigEndian ((uint32) src[i] >> 8));
+
+        if (i < num)
+        {
+            if (bigEndian)
+                ByteOrder::bigEndian24BitToChars (src[i] >> 8, dest + 3 * i);
+            else
+                ByteOrder::littleEndian24BitToChars (src[i] >> 8, dest + 3 * i);
+        }
+    }
+
+    static void toInt32 (DataFormat format, const uint8* src, int32* dest, int num) noexcept
+    {
+        switch (getBytesPerSample (format))
+        {
+            case 2:   readInt16 (src, dest, num, needsByteSwap (format)); break;
+            case 3:   readInt24 (src, dest, num, isBigEndianFormat (format)); break;
+            default:  copy32 (src, (uint8*) dest, num, needsByteSwap (format)); break;
+        }
+    }
+
+    static void fromInt32 (DataFormat format, const int32* src, uint8* dest, int num) noexcept
     {
-        auto i = chan;
-        auto src = source [chan];
+        switch (getBytesPerSample (format))
+        {
+            case 2:   writeInt16 (src, dest, num, needsByteSwap (format)); break;
+            case 3:   writeInt24 (src, dest, num, isBigEndianFormat (format)); break;
+            default:  copy32 ((const uint8*) src, dest, num, needsByteSwap (format)); break;
+        }
+    }
+
+    //==============================================================================
+    template <int numChannels>
+    static void deinterleave (const int32* src, int32* const* dest, int start, int num) noexcept
+    {
+        for (int i = start; i < num; ++i)
+            for (int chan = 0; chan < numChannels; ++chan)
+                dest[chan][i] = src[i * numChannels + chan];
+    }
+
+    template <int numChannels>
+    static void interleave (const int32* const* src, int32* dest, int start, int num) noexcept
+    {
+        for (int i = start; i < num; ++i)
+            for (int chan = 0; chan < numChannels; ++chan)
+                dest[i * numChannels + chan] = src[chan][i];
+    }
 
-        for (int j = 0; j < numSamples; ++j)
+   #if JUCE_USE_SSE_INTRINSICS
+    // The values are moved around as floats, which doesn't change their bits
+    static forcedinline __m128 load (const int32* src) noexcept              { return _mm_loadu_ps ((const float*) src); }
+    static forcedinline void store (int32* dest, __m128 v) noexcept         { _mm_storeu_ps ((float*) dest, v); }
+
+    static void deinterleave2 (const int32* src, int32* const* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
         {
-            dest [i] = src [j];
-            i += numChannels;
+            auto a = load (src + 2 * i);
+            auto b = load (src + 2 * i + 4);
+            store (dest[0] + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (2, 0, 2, 0)));
+            store (dest[1] + i, _mm_shuffle_ps (a, b, _MM_SHUFFLE (3, 1, 3, 1)));
+        }
+
+        deinterleave<2> (src, dest, i, num);
+    }
+
+    static void interleave2 (const int32* const* src, int32* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            auto a = load (src[0] + i);
+            auto b = load (src[1] + i);
+            store (dest + 2 * i,     _mm_unpacklo_ps (a, b));
+            store (dest + 2 * i + 4, _mm_unpackhi_ps (a, b));
+        }
+
+        interleave<2> (src, dest, i, num);
+    }
+
+    // Transposes a 4x4 block of values, where the rows are 'stride' values apart in the
+    // interleaved data, and the columns are the channels.
+    static forcedinline void deinterleave4x4 (const int32* src, int stride, int32* const* dest, int i) noexcept
+    {
+        auto r0 = load (src), r1 = load (src + stride), r2 = load (src + 2 * stride), r3 = load (src + 3 * stride);
+        _MM_TRANSPOSE4_PS (r0, r1, r2, r3);
+        store (dest[0] + i, r0);  store (dest[1] + i, r1);  store (dest[2] + i, r2);  store (dest[3] + i, r3);
+    }
+
+    static forcedinline void interleave4x4 (const int32* const* src, int i, int32* dest, int stride) noexcept
+    {
+        auto r0 = load (src[0] + i), r1 = load (src[1] + i), r2 = load (src[2] + i), r3 = load (src[3] + i);
+        _MM_TRANSPOSE4_PS (r0, r1, r2, r3);
+        store (dest, r0);  store (dest + stride, r1);  store (dest + 2 * stride, r2);  store (dest + 3 * stride, r3);
+    }
+
+    static void deinterleave4 (const int32* src, int32* const* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+            deinterleave4x4 (src + 4 * i, 4, dest, i);
+
+        deinterleave<4> (src, dest, i, num);
+    }
+
+    static void interleave4 (const int32* const* src, int32* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+            interleave4x4 (src, i, dest + 4 * i, 4);
+
+        interleave<4> (src, dest, i, num);
+    }
+
+    static void deinterleave8 (const int32* src, int32* const* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            deinterleave4x4 (src + 8 * i,     8, dest,     i);
+            deinterleave4x4 (src + 8 * i + 4, 8, dest + 4, i);
+        }
+
+        deinterleave<8> (src, dest, i, num);
+    }
+
+    static void interleave8 (const int32* const* src, int32* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            interleave4x4 (src,     i, dest + 8 * i,     8);
+            interleave4x4 (src + 4, i, dest + 8 * i + 4, 8);
+        }
+
+        interleave<8> (src, dest, i, num);
+    }
+   #elif JUCE_USE_ARM_NEON
+    static void deinterleave2 (const int32* src, int32* const* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            auto v = vld2q_s32 (src + 2 * i);
+            vst1q_s32 (dest[0] + i, v.val[0]);
+            vst1q_s32 (dest[1] + i, v.val[1]);
+        }
+
+        deinterleave<2> (src, dest, i, num);
+    }
+
+    static void interleave2 (const int32* const* src, int32* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            int32x4x2_t v;
+            v.val[0] = vld1q_s32 (src[0] + i);
+            v.val[1] = vld1q_s32 (src[1] + i);
+            vst2q_s32 (dest + 2 * i, v);
+        }
+
+        interleave<2> (src, dest, i, num);
+    }
+
+    static void deinterleave4 (const int32* src, int32* const* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            auto v = vld4q_s32 (src + 4 * i);
+
+            for (int chan = 0; chan < 4; ++chan)
+                vst1q_s32 (dest[chan] + i, v.val[chan]);
+        }
+
+        deinterleave<4> (src, dest, i, num);
+    }
+
+    static void interleave4 (const int32* const* src, int32* dest, int num) noexcept
+    {
+        int i = 0;
+
+        for (; i <= num - 4; i += 4)
+        {
+            int32x4x4_t v;
+
+            for (int chan = 0; chan < 4; ++chan)
+                v.val[chan] = vld1q_s32 (src[chan] + i);
+
+            vst4q_s32 (dest + 4 * i, v);
+        }
+
+        interleave<4> (src, dest, i, num);
+    }
+
+    static void deinterleave8 (const int32* src, int32* const* dest, int num) noexcept      { deinterleave<8> (src, dest, 0, num); }
+    static void interleave8 (const int32* const* src, int32* dest, int num) noexcept        { interleave<8> (src, dest, 0, num); }
+   #else
+    static void deinterleave2 (const int32* src, int32* const* dest, int num) noexcept      { deinterleave<2> (src, dest, 0, num); }
+    static void interleave2 (const int32* const* src, int32* dest, int num) noexcept        { interleave<2> (src, dest, 0, num); }
+    static void deinterleave4 (const int32* src, int32* const* dest, int num) noexcept      { deinterleave<4> (src, dest, 0, num); }
+    static void interleave4 (const int32* const* src, int32* dest, int num) noexcept        { interleave<4> (src, dest, 0, num); }
+    static void deinterleave8 (const int32* src, int32* const* dest, int num) noexcept      { deinterleave<8> (src, dest, 0, num); }
+    static void interleave8 (const int32* const* src, int32* dest, int num) noexcept        { interleave<8> (src, dest, 0, num); }
+   #endif
+
+    static void deinterleave (const int32* src, int32* const* dest, int numChannels, int num) noexcept
+    {
+        switch (numChannels)
+        {
+            case 1:   memcpy (dest[0], src, sizeof (int32) * (size_t) num); break;
+            case 2:   deinterleave2 (src, dest, num); break;
+            case 3:   deinterleave<3> (src, dest, 0, num); break;
+            case 4:   deinterleave4 (src, dest, num); break;
+            case 5:   deinterleave<5> (src, dest, 0, num); break;
+            case 6:   deinterleave<6> (src, dest, 0, num); break;
+            case 7:   deinterleave<7> (src, dest, 0, num); break;
+            case 8:   deinterleave8 (src, dest, num); break;
+
+            default:
+                for (int chan = 0; chan < numChannels; ++chan)
+                    for (int i = 0; i < num; ++i)
+                        dest[chan][i] = src[i * numChannels + chan];
+
+                break;
+        }
+    }
+
+    static void interleave (const int32* const* src, int32* dest, int numChannels, int num) noexcept
+    {
+        switch (numChannels)
+        {
+            case 1:   memcpy (dest, src[0], sizeof (int32) * (size_t) num); break;
+            case 2:   interleave2 (src, dest, num); break;
+            case 3:   interleave<3> (src, dest, 0, num); break;
+            case 4:   interleave4 (src, dest, num); break;
+            case 5:   interleave<5> (src, dest, 0, num); break;
+            case 6:   interleave<6> (src, dest, 0, num); break;
+            case 7:   interleave<7> (src, dest, 0, num); break;
+            case 8:   interleave8 (src, dest, num); break;
+
+            default:
+                for (int chan = 0; chan < numChannels; ++chan)
+                    for (int i = 0; i < num; ++i)
+                        dest[i * numChannels + chan] = src[chan][i];
+
+                break;
         }
     }
 }
 
-void AudioDataConverters::deinterleaveSamples (const float* source, float** dest, int numSamples, int numChannels)
+void AudioDataConverters::deinterleaveToInt32 (DataFormat sourceFormat, const void* source, int numSourceChannels,
+                                               int32* const* dest, int destOffset, int numDestChannels,
+                                               int numSamples) noexcept
 {
-    for (int chan = 0; chan < numChannels; ++chan)
+    using namespace BlockConversionHelpers;
+    jassert (numSourceChannels > 0 && numSamples >= 0);
+
+    for (int chan = numSourceChannels; chan < numDestChannels; ++chan)
+        if (dest[chan] != nullptr)
+            zeromem (dest[chan] + destOffset, sizeof (int32) * (size_t) numSamples);
+
+    auto src = static_cast<const uint8*> (source);
+    auto bytesPerSample = getBytesPerSample (sourceFormat);
+
+    if (numSourceChannels > maxChannelsPerBlock)
     {
-        auto i = chan;
-        auto dst = dest [chan];
+        // (this is only for very unusual channel counts, so it isn't worth optimising)
+        for (int chan = 0; chan < jmin (numSourceChannels, numDestChannels); ++chan)
+            if (auto* d = dest[chan])
+                for (int i = 0; i < numSamples; ++i)
+                    toInt32 (sourceFormat, src + bytesPerSample * (i * numSourceChannels + chan), d + destOffset + i, 1);
+
+        return;
+    }
 
-        for (int j = 0; j < numSamples; ++j)
+    int32 block[maxValuesPerBlock], unused[maxValuesPerBlock];
+    int32* channels[maxChannelsPerBlock];
+    auto framesPerBlock = maxValuesPerBlock / numSourceChannels;
+    auto useSourceDirectly = canUseDirectly (sourceFormat, source);
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        auto num = jmin (framesPerBlock, numSamples - pos);
+
+        for (int chan = 0; chan < numSourceChannels; ++chan)
+            channels[chan] = (chan < numDestChannels && dest[chan] != nullptr) ? dest[chan] + destOffset + pos : unused;
+
+        if (useSourceDirectly)
+            deinterleave (reinterpret_cast<const int32*> (src), channels, numSourceChannels, num);
+        else if (numSourceChannels == 1)
+            toInt32 (sourceFormat, src, channels[0], num);
+        else
         {
-            dst [j] = source [i];
-            i += numChannels;
+            toInt32 (sourceFormat, src, block, num * numSourceChannels);
+            deinterleave (block, channels, numSourceChannels, num);
         }
+
+        src += bytesPerSample * numSourceChannels * num;
+        pos += num;
     }
 }
 
+void AudioDataConverters::interleaveFromInt32 (const int32* const* source, int sourceOffset, int numSourceChannels,
+                                               DataFormat destFormat, void* dest, int numDestChannels,
+                                               int numSamples) noexcept
+{
+    using namespace BlockConversionHelpers;
+    jassert (numDestChannels > 0 && numSamples >= 0);
+
+    auto dst = static_cast<uint8*> (dest);
+    auto bytesPerSample = getBytesPerSample (destFormat);
+    int32 block[maxValuesPerBlock], silence[maxValuesPerBlock];
+
+    if (numDestChannels > maxChannelsPerBlock)
+    {
+        zeromem (silence, sizeof (int32));
+
+        for (int chan = 0; chan < numDestChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                fromInt32 (destFormat, chan < numSourceChannels ? source[chan] + sourceOffset + i : silence,
+                           dst + bytesPerSample * (i * numDestChannels + chan), 1);
+
+        return;
+    }
+
+    const int32* channels[maxChannelsPerBlock];
+    auto framesPerBlock = maxValuesPerBlock / numDestChannels;
+    auto useDestDirectly = canUseDirectly (destFormat, dest);
+
+    if (numSourceChannels < numDestChannels)
+        zeromem (silence, sizeof (int32) * (size_t) framesPerBlock);
+
+    for (int pos = 0; pos < numSamples;)
+    {
+        auto num = jmin (framesPerBlock, numSamples - pos);
+
+        for (int chan = 0; chan < numDestChannels; ++chan)
+            channels[chan] = chan < numSourceChannels ? source[chan] + sourceOffset + pos : silence;
+
+        if (useDestDirectly)
+            interleave (channels, reinterpret_cast<int32*> (dst), numDestChannels, num);
+        else if (numDestChannels == 1)
+            fromInt32 (destFormat, channels[0], dst, num);
+        else
+        {
+            interleave (channels, block, numDestChannels, num);
+            fromInt32 (destFormat, block, dst, num * numDestChannels);
+        }
+
+        dst += bytesPerSample * numDestChannels * num;
+        pos += num;
+    }
+}
 
 //==============================================================================
 //==============================================================================
@@ -573,9 +1146,168 @@ public:
         }
     };
 
+    //==============================================================================
+    template <class SampleFormat, class Endianness>
+    struct BlockTest
+    {
+        // The float formats are converted as raw 32-bit values, so they're checked against Int32
+        using ReferenceFormat = typename std::conditional<SampleFormat::isFloat != 0, AudioData::Int32, SampleFormat>::type;
+        using SourcePointer   = AudioData::Pointer<ReferenceFormat, Endianness, AudioData::Interleaved, AudioData::Const>;
+        using DestPointer     = AudioData::Pointer<ReferenceFormat, Endianness, AudioData::Interleaved, AudioData::NonConst>;
+
+        static void test (UnitTest& unitTest, Random& r)
+        {
+            auto format = (AudioDataConverters::DataFormat) AudioDataConverters::getDataFormat<SampleFormat, Endianness>();
+            auto bytesPerSample = (int) SampleFormat::bytesPerSample;
+            const int destOffset = 3;
+
+            for (auto numChannels : { 1, 2, 3, 4, 6, 8, 11, 70 })
+            {
+                for (auto numSamples : { 0, 1, 7, 33, 3001 })
+                {
+                    // use a misaligned buffer every other time, to check the direct 32-bit paths
+                    auto misalignment = (numSamples & 1);
+                    auto numBytes = (size_t) (bytesPerSample * numChannels * numSamples);
+
+                    HeapBlock<uint8> source (numBytes + 1), dest (numBytes + 2), expected (numBytes + 2);
+                    auto* sourceData = source.get() + misalignment;
+
+                    for (size_t i = 0; i < numBytes; ++i)
+                        sourceData[i] = (uint8) r.nextInt (256);
+
+                    // one extra destination channel, which should be cleared, and one null channel
+                    std::vector<std::vector<int32>> channels ((size_t) numChannels + 1, std::vector<int32> ((size_t) (numSamples + destOffset), 0x12345678));
+                    std::vector<int32*> channelPointers;
+
+                    for (auto& c : channels)
+                        channelPointers.push_back (c.data());
+
+                    auto nullChannel = numChannels > 1 ? 1 : -1;
+
+                    if (nullChannel >= 0)
+                        channelPointers[(size_t) nullChannel] = nullptr;
+
+                    AudioDataConverters::deinterleaveToInt32 (format, sourceData, numChannels,
+                                                              channelPointers.data(), destOffset, numChannels + 1, numSamples);
+
+                    bool allMatched = true;
+
+                    for (int chan = 0; chan <= numChannels; ++chan)
+                    {
+                        auto& c = channels[(size_t) chan];
+
+                        for (int i = 0; i < destOffset; ++i)
+                            allMatched = allMatched && c[(size_t) i] == 0x12345678;
+
+                        SourcePointer reference (sourceData + chan * bytesPerSample, numChannels);
+
+                        for (int i = 0; i < numSamples; ++i)
+                        {
+                            auto value = c[(size_t) (i + destOffset)];
+
+                            if (chan == nullChannel)
+                                allMatched = allMatched && value == 0x12345678;
+                            else if (chan == numChannels)
+                                allMatched = allMatched && value == 0;
+                            else
+                                allMatched = allMatched && value == reference.getAsInt32();
+
+                            ++reference;
+                        }
+                    }
+
+                    unitTest.expect (allMatched);
+
+                    // ..and interleave the channels again, leaving out the last one so that it gets cleared
+                    channelPointers[(size_t) jmax (0, nullChannel)] = channels[(size_t) jmax (0, nullChannel)].data();
+                    auto numSourceChannels = numChannels - 1;
+
+                    for (int i = 0; i < numSamples; ++i)
+                        channels[(size_t) numChannels - 1][(size_t) (i + destOffset)] = 0;
+
+                    memset (dest, 0xcd, numBytes + 2);
+                    memset (expected, 0xcd, numBytes + 2);
+
+                    for (int chan = 0; chan < numChannels; ++chan)
+                    {
+                        DestPointer reference (expected + misalignment + chan * bytesPerSample, numChannels);
+
+                        for (int i = 0; i < numSamples; ++i)
+                        {
+                            reference.setAsInt32 (channels[(size_t) chan][(size_t) (i + destOffset)]);
+                            ++reference;
+                        }
+                    }
+
+                    AudioDataConverters::interleaveFromInt32 (channelPointers.data(), destOffset, numSourceChannels,
+                                                              format, dest + misalignment, numChannels, numSamples);
+
+                    unitTest.expect (memcmp (dest, expected, numBytes + 2) == 0);
+                }
+            }
+        }
+    };
+
+    template <class SampleFormat>
+    static void testBlockConversion (UnitTest& unitTest, Random& r)
+    {
+        BlockTest<SampleFormat, AudioData::LittleEndian>::test (unitTest, r);
+        BlockTest<SampleFormat, AudioData::BigEndian>::test (unitTest, r);
+    }
+
+    template <class SampleFormat, class Endianness>
+    void benchmarkReading (const String& description, int numChannels)
+    {
+        using SourcePointer = AudioData::Pointer<SampleFormat, Endianness, AudioData::Interleaved, AudioData::Const>;
+        using DestPointer   = AudioData::Pointer<AudioData::Int32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>;
+
+        const int numSamples = 48000 * 10;
+        HeapBlock<uint8> source ((size_t) (numSamples * numChannels * SampleFormat::bytesPerSample), true);
+        AudioBuffer<float> buffer (numChannels, numSamples);
+        auto channels = reinterpret_cast<int32* const*> (buffer.getArrayOfWritePointers());
+        auto format = (AudioDataConverters::DataFormat) AudioDataConverters::getDataFormat<SampleFormat, Endianness>();
+
+        double sampleBySample = 1.0e10, asBlocks = 1.0e10;
+
+        for (int i = 0; i < 5; ++i)
+        {
+            auto start = Time::getMillisecondCounterHiRes();
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                DestPointer (channels[chan]).convertSamples (SourcePointer (source + chan * SampleFormat::bytesPerSample, numChannels), numSamples);
+
+            auto middle = Time::getMillisecondCounterHiRes();
+
+            AudioDataConverters::deinterleaveToInt32 (format, source, numChannels, channels, 0, numChannels, numSamples);
+
+            auto end = Time::getMillisecondCounterHiRes();
+
+            sampleBySample = jmin (sampleBySample, middle - start);
+            asBlocks = jmin (asBlocks, end - middle);
+        }
+
+        logMessage (description + ", 10 seconds: " + String (sampleBySample, 2) + " ms sample-by-sample, "
+                      + String (asBlocks, 2) + " ms as blocks");
+    }
+
     void runTest() override
     {
         auto r = getRandom();
+
+        beginTest ("Block conversion");
+        expect (AudioDataConverters::getDataFormat<AudioData::Int8, AudioData::LittleEndian>() < 0);
+        testBlockConversion<AudioData::Int16> (*this, r);
+        testBlockConversion<AudioData::Int24> (*this, r);
+        testBlockConversion<AudioData::Int32> (*this, r);
+        testBlockConversion<AudioData::Float32> (*this, r);
+
+        beginTest ("Block conversion performance");
+        benchmarkReading<AudioData::Int16, AudioData::LittleEndian> ("Stereo 16-bit", 2);
+        benchmarkReading<AudioData::Int24, AudioData::LittleEndian> ("Stereo 24-bit", 2);
+        benchmarkReading<AudioData::Int24, AudioData::BigEndian>    ("Stereo 24-bit big-endian", 2);
+        benchmarkReading<AudioData::Int24, AudioData::LittleEndian> ("8 channel 24-bit", 8);
+        benchmarkReading<AudioData::Float32, AudioData::LittleEndian> ("6 channel float", 6);
+
         beginTest ("Round-trip conversion: Int8");
         Test1 <AudioData::Int8>::test (*this, r);
         beginTest ("Round-trip conversion: Int16");
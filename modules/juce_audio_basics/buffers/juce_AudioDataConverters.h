@@ -648,8 +648,10 @@ public:
     A set of routines to convert buffers of 32-bit floating point data to and from
     various integer formats.
 
-    Note that these functions are deprecated - the AudioData class provides a much more
-    flexible set of conversion classes now.
+    Note that the single-channel functions are deprecated - the AudioData class provides a
+    much more flexible set of conversion classes now. The block conversion functions,
+    deinterleaveToInt32() and interleaveFromInt32(), are what the AudioFormatReader and
+    AudioFormatWriter helper classes use for the common sample formats.
 
     @tags{Audio}
 */
@@ -708,6 +710,55 @@ public:
     static void deinterleaveSamples (const float* source, float** dest,
                                      int numSamples, int numChannels);
 
+    //==============================================================================
+    /** Splits a block of interleaved samples into separate channels of 32-bit values.
+
+        Integer formats are converted to left-justified 32-bit integers, in the same way as
+        AudioData::Pointer::getAsInt32(). The float formats are copied as raw 32-bit values,
+        so the destination channels will contain floats in the native byte order.
+
+        Null destination channels are skipped, and any destination channels beyond
+        numSourceChannels are cleared. Where possible this uses vectorised code, so it's
+        much quicker than converting the channels one at a time with AudioData::Pointer.
+    */
+    static void deinterleaveToInt32 (DataFormat sourceFormat, const void* source, int numSourceChannels,
+                                     int32* const* dest, int destOffset, int numDestChannels,
+                                     int numSamples) noexcept;
+
+    /** Interleaves some channels of 32-bit values into a block of samples.
+
+        This is the reverse of deinterleaveToInt32(): integer formats take the top bits of
+        each value (truncating it, like AudioData::Pointer::setAsInt32()), and the float
+        formats copy the raw 32-bit values. Any destination channels beyond numSourceChannels
+        are cleared.
+    */
+    static void interleaveFromInt32 (const int32* const* source, int sourceOffset, int numSourceChannels,
+                                     DataFormat destFormat, void* dest, int numDestChannels,
+                                     int numSamples) noexcept;
+
+    /** True if deinterleaveToInt32() and interleaveFromInt32() can use vector instructions
+        on this platform. Without them, they're only quicker than AudioData::Pointer for the
+        32-bit formats.
+    */
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    static constexpr bool usesVectorInstructions = true;
+   #else
+    static constexpr bool usesVectorInstructions = false;
+   #endif
+
+    /** Returns the DataFormat that matches an AudioData sample format and endianness, or -1
+        if there isn't one (e.g. for the 8-bit formats).
+    */
+    template <class SampleFormat, class Endianness>
+    static constexpr int getDataFormat() noexcept
+    {
+        return std::is_same<SampleFormat, AudioData::Int16>::value   ? (Endianness::isBigEndian ? int16BE   : int16LE)
+             : std::is_same<SampleFormat, AudioData::Int24>::value   ? (Endianness::isBigEndian ? int24BE   : int24LE)
+             : std::is_same<SampleFormat, AudioData::Int32>::value   ? (Endianness::isBigEndian ? int32BE   : int32LE)
+             : std::is_same<SampleFormat, AudioData::Float32>::value ? (Endianness::isBigEndian ? float32BE : float32LE)
+             : -1;
+    }
+
 private:
     AudioDataConverters();
     JUCE_DECLARE_NON_COPYABLE (AudioDataConverters)
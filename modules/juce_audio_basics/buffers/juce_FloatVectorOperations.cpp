@@ -352,6 +352,25 @@ namespace FloatVectorHelpers
     union signMask32 { float  f; uint32 i; };
     union signMask64 { double d; uint64 i; };
 
+    template <typename Type>
+    static Range<Type> findMinMaxAndSumOfSquares (const Type* src, int num, double& sumOfSquares) noexcept
+    {
+        if (num <= 0)
+            return {};
+
+        Range<Type> result (src[0], src[0]);
+        double total = 0;
+
+        for (int i = 0; i < num; ++i)
+        {
+            result = result.getUnionWith (src[i]);
+            total += (double) src[i] * src[i];
+        }
+
+        sumOfSquares += total;
+        return result;
+    }
+
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
     template<int typeSize> struct ModeType    { using Mode = BasicOps32; };
     template<>             struct ModeType<8> { using Mode = BasicOps64; };
@@ -483,6 +502,66 @@ namespace FloatVectorHelpers
 
             return Range<Type>::findMinAndMax (src, num);
         }
+
+        static Range<Type> findMinMaxAndSumOfSquares (const Type* src, int num, double& sumOfSquares) noexcept
+        {
+            int numLongOps = num / Mode::numParallel;
+
+            if (numLongOps > 1)
+            {
+                auto mn = Mode::loadU (src);
+                auto mx = mn;
+                auto squares = Mode::mul (mn, mn);
+                double total = 0;
+
+                for (int i = 1; i < numLongOps; ++i)
+                {
+                    src += Mode::numParallel;
+                    const ParallelType v = Mode::loadU (src);
+                    mn = Mode::min (mn, v);
+                    mx = Mode::max (mx, v);
+                    squares = Mode::add (squares, Mode::mul (v, v));
+
+                    // (the squares are moved into a double every so often, so that
+                    // long blocks don't lose precision)
+                    if ((i & 255) == 0)
+                    {
+                        total += sum (squares);
+                        squares = Mode::load1 (0);
+                    }
+                }
+
+                total += sum (squares);
+                Range<Type> result (Mode::min (mn),
+                                    Mode::max (mx));
+
+                num &= (Mode::numParallel - 1);
+                src += Mode::numParallel;
+
+                for (int i = 0; i < num; ++i)
+                {
+                    result = result.getUnionWith (src[i]);
+                    total += (double) src[i] * src[i];
+                }
+
+                sumOfSquares += total;
+                return result;
+            }
+
+            return FloatVectorHelpers::findMinMaxAndSumOfSquares (src, num, sumOfSquares);
+        }
+
+        static double sum (ParallelType v) noexcept
+        {
+            Type values[Mode::numParallel];
+            Mode::storeU (values, v);
+            double total = 0;
+
+            for (auto value : values)
+                total += value;
+
+            return total;
+        }
     };
    #endif
 }
@@ -625,6 +704,14 @@ void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const double* src,
    #endif
 }
 
+void JUCE_CALLTYPE FloatVectorOperations::add (double* dest, const float* src, int num) noexcept
+{
+    // the vector macros expect the source and destination to be the same type,
+    // so this simple loop is left for the compiler to vectorise
+    for (int i = 0; i < num; ++i)
+        dest[i] += (double) src[i];
+}
+
 void JUCE_CALLTYPE FloatVectorOperations::add (float* dest, const float* src1, const float* src2, int num) noexcept
 {
    #if JUCE_USE_VDSP_FRAMEWORK
@@ -992,6 +1079,24 @@ Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinAndMax (const double*
    #endif
 }
 
+Range<float> JUCE_CALLTYPE FloatVectorOperations::findMinMaxAndSumOfSquares (const float* src, int num, double& sumOfSquares) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps32>::findMinMaxAndSumOfSquares (src, num, sumOfSquares);
+   #else
+    return FloatVectorHelpers::findMinMaxAndSumOfSquares (src, num, sumOfSquares);
+   #endif
+}
+
+Range<double> JUCE_CALLTYPE FloatVectorOperations::findMinMaxAndSumOfSquares (const double* src, int num, double& sumOfSquares) noexcept
+{
+   #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
+    return FloatVectorHelpers::MinMax<FloatVectorHelpers::BasicOps64>::findMinMaxAndSumOfSquares (src, num, sumOfSquares);
+   #else
+    return FloatVectorHelpers::findMinMaxAndSumOfSquares (src, num, sumOfSquares);
+   #endif
+}
+
 float JUCE_CALLTYPE FloatVectorOperations::findMinimum (const float* src, int num) noexcept
 {
    #if JUCE_USE_SSE_INTRINSICS || JUCE_USE_ARM_NEON
@@ -1181,6 +1286,14 @@ public:
             Range<ValueType> minMax2 (Range<ValueType>::findMinAndMax (data1, num));
             u.expect (minMax1 == minMax2);
 
+            double squares1 = 0, squares2 = 0;
+            u.expect (FloatVectorOperations::findMinMaxAndSumOfSquares (data1, num, squares1) == minMax2);
+
+            for (int i = 0; i < num; ++i)
+                squares2 += (double) data1[i] * data1[i];
+
+            u.expect (std::abs (squares1 - squares2) <= squares2 * 1.0e-5);
+
             u.expect (valuesMatch (FloatVectorOperations::findMinimum (data1, num), juce::findMinimum (data1, num)));
             u.expect (valuesMatch (FloatVectorOperations::findMaximum (data1, num), juce::findMaximum (data1, num)));
 
@@ -1242,7 +1355,20 @@ public:
             u.expect (buffersMatch (data1, data2, num));
         }
 
-        static void doConversionTest (UnitTest&, double*, double*, int*, int) {}
+        static void doConversionTest (UnitTest& u, double* data1, double* data2, int* const int1, int num)
+        {
+            HeapBlock<float> floats ((size_t) num);
+            FloatVectorOperations::convertFixedToFloat (floats, int1, 1.0e-6f, num);
+
+            FloatVectorOperations::fill (data1, 1.0, num);
+            FloatVectorOperations::fill (data2, 1.0, num);
+            FloatVectorOperations::add (data1, floats, num);
+
+            for (int i = 0; i < num; ++i)
+                data2[i] += (double) floats[i];
+
+            u.expect (buffersMatch (data1, data2, num));
+        }
 
         static void fillRandomly (Random& random, ValueType* d, int num)
         {
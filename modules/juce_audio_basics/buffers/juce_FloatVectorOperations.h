@@ -85,6 +85,9 @@ public:
     /** Adds the source values to the destination values. */
     static void JUCE_CALLTYPE add (double* dest, const double* src, int numValues) noexcept;
 
+    /** Converts the single-precision source values to double precision and adds them to the destination values. */
+    static void JUCE_CALLTYPE add (double* dest, const float* src, int numValues) noexcept;
+
     /** Adds each source1 value to the corresponding source2 value and stores the result in the destination array. */
     static void JUCE_CALLTYPE add (float* dest, const float* src1, const float* src2, int num) noexcept;
 
@@ -202,6 +205,17 @@ public:
     /** Finds the minimum and maximum values in the given array. */
     static Range<double> JUCE_CALLTYPE findMinAndMax (const double* src, int numValues) noexcept;
 
+    /** Finds the minimum and maximum values in the given array, and adds the sum of the
+        squares of the values to sumOfSquares. This makes a single pass through the data,
+        so it's quicker than finding the range and the squares separately.
+    */
+    static Range<float> JUCE_CALLTYPE findMinMaxAndSumOfSquares (const float* src, int numValues, double& sumOfSquares) noexcept;
+
+    /** Finds the minimum and maximum values in the given array, and adds the sum of the
+        squares of the values to sumOfSquares.
+    */
+    static Range<double> JUCE_CALLTYPE findMinMaxAndSumOfSquares (const double* src, int numValues, double& sumOfSquares) noexcept;
+
     /** Finds the minimum value in the given array. */
     static float JUCE_CALLTYPE findMinimum (const float* src, int numValues) noexcept;
 
@@ -39,6 +39,10 @@
  #include <emmintrin.h>
 #endif
 
+#if JUCE_USE_SSE_INTRINSICS && (defined (__SSSE3__) || defined (__AVX__))
+ #include <tmmintrin.h>
+#endif
+
 #ifndef JUCE_USE_VDSP_FRAMEWORK
  #define JUCE_USE_VDSP_FRAMEWORK 1
 #endif
@@ -60,17 +64,21 @@
 #include "utilities/juce_IIRFilter.cpp"
 #include "utilities/juce_LagrangeInterpolator.cpp"
 #include "utilities/juce_CatmullRomInterpolator.cpp"
+#include "utilities/juce_WindowedSincKernel.cpp"
 #include "utilities/juce_SmoothedValue.cpp"
 #include "midi/juce_MidiBuffer.cpp"
+#include "midi/juce_MidiEventList.cpp"
 #include "midi/juce_MidiFile.cpp"
 #include "midi/juce_MidiKeyboardState.cpp"
 #include "midi/juce_MidiMessage.cpp"
 #include "midi/juce_MidiMessageSequence.cpp"
 #include "midi/juce_MidiRPN.cpp"
+#include "synthesisers/juce_SinglePrecisionVoiceRenderer.h"
 #include "mpe/juce_MPEValue.cpp"
 #include "mpe/juce_MPENote.cpp"
 #include "mpe/juce_MPEZoneLayout.cpp"
 #include "mpe/juce_MPEInstrument.cpp"
+#include "mpe/juce_RealtimeMPEInstrument.cpp"
 #include "mpe/juce_MPEMessages.cpp"
 #include "mpe/juce_MPESynthesiserBase.cpp"
 #include "mpe/juce_MPESynthesiserVoice.cpp"
@@ -89,11 +89,13 @@
 #include "utilities/juce_IIRFilter.h"
 #include "utilities/juce_LagrangeInterpolator.h"
 #include "utilities/juce_CatmullRomInterpolator.h"
+#include "utilities/juce_WindowedSincKernel.h"
 #include "utilities/juce_SmoothedValue.h"
 #include "utilities/juce_Reverb.h"
 #include "utilities/juce_ADSR.h"
 #include "midi/juce_MidiMessage.h"
 #include "midi/juce_MidiBuffer.h"
+#include "midi/juce_MidiEventList.h"
 #include "midi/juce_MidiMessageSequence.h"
 #include "midi/juce_MidiFile.h"
 #include "midi/juce_MidiKeyboardState.h"
@@ -102,6 +104,7 @@
 #include "mpe/juce_MPENote.h"
 #include "mpe/juce_MPEZoneLayout.h"
 #include "mpe/juce_MPEInstrument.h"
+#include "mpe/juce_RealtimeMPEInstrument.h"
 #include "mpe/juce_MPEMessages.h"
 #include "mpe/juce_MPESynthesiserBase.h"
 #include "mpe/juce_MPESynthesiserVoice.h"
@@ -0,0 +1,527 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+MidiEventList::MidiEventList (int maxNumEvents, int maxNumBytes)
+{
+    ensureCapacity (maxNumEvents, maxNumBytes);
+}
+
+MidiEventList::MidiEventList (const MidiBuffer& buffer)
+{
+    MidiBuffer::Iterator i (buffer);
+    const uint8* eventData;
+    int eventSize, position, numBufferEvents = 0, numBytes = 0;
+
+    while (i.getNextEvent (eventData, eventSize, position))
+    {
+        ++numBufferEvents;
+        numBytes += eventSize;
+    }
+
+    ensureCapacity (numBufferEvents, numBytes);
+    addEvents (buffer, 0, -1, 0);
+}
+
+MidiEventList::MidiEventList (const MidiEventList& other)
+{
+    *this = other;
+}
+
+MidiEventList& MidiEventList::operator= (const MidiEventList& other)
+{
+    if (this != &other)
+    {
+        clear();
+        ensureCapacity (other.eventCapacity, other.dataCapacity);
+
+        numEvents = other.numEvents;
+        dataUsed = other.dataUsed;
+        sorted = other.sorted;
+
+        std::copy (other.times.get(),   other.times   + numEvents, times.get());
+        std::copy (other.offsets.get(), other.offsets + numEvents, offsets.get());
+        std::copy (other.sizes.get(),   other.sizes   + numEvents, sizes.get());
+        std::copy (other.data.get(),    other.data    + dataUsed,  data.get());
+    }
+
+    return *this;
+}
+
+MidiEventList::~MidiEventList() {}
+
+void MidiEventList::ensureCapacity (int maxNumEvents, int maxNumBytes)
+{
+    if (maxNumEvents > eventCapacity)
+    {
+        eventCapacity = maxNumEvents;
+
+        times.realloc   ((size_t) eventCapacity);
+        offsets.realloc ((size_t) eventCapacity);
+        sizes.realloc   ((size_t) eventCapacity);
+
+        scratchTimes.malloc   ((size_t) eventCapacity);
+        scratchOffsets.malloc ((size_t) eventCapacity);
+        scratchSizes.malloc   ((size_t) eventCapacity);
+        order.malloc          ((size_t) eventCapacity);
+    }
+
+    if (maxNumBytes > dataCapacity)
+    {
+        dataCapacity = maxNumBytes;
+        data.realloc ((size_t) dataCapacity);
+    }
+}
+
+//==============================================================================
+void MidiEventList::clear() noexcept
+{
+    numEvents = 0;
+    dataUsed = 0;
+    sorted = true;
+}
+
+void MidiEventList::clear (int startSample, int numSamples) noexcept
+{
+    sort();
+
+    auto start = getIndexOfFirstEventAtOrAfter (startSample);
+    auto end   = getIndexOfFirstEventAtOrAfter (startSample + numSamples);
+    auto numToMove = (size_t) (numEvents - end);
+
+    if (end > start)
+    {
+        memmove (times + start,   times + end,   numToMove * sizeof (int));
+        memmove (offsets + start, offsets + end, numToMove * sizeof (uint32));
+        memmove (sizes + start,   sizes + end,   numToMove * sizeof (uint32));
+
+        numEvents -= (end - start);
+
+        if (numEvents == 0)
+            dataUsed = 0;
+    }
+}
+
+//==============================================================================
+bool MidiEventList::append (const void* newData, int maxBytes, int sampleNumber) noexcept
+{
+    auto numBytes = MidiBufferHelpers::findActualEventLength (static_cast<const uint8*> (newData), maxBytes);
+
+    if (numBytes <= 0 || numEvents >= eventCapacity || dataUsed + numBytes > dataCapacity)
+        return false;
+
+    memcpy (data + dataUsed, newData, (size_t) numBytes);
+
+    if (numEvents > 0 && times[numEvents - 1] > sampleNumber)
+        sorted = false;
+
+    times[numEvents] = sampleNumber;
+    offsets[numEvents] = (uint32) dataUsed;
+    sizes[numEvents] = (uint32) numBytes;
+
+    ++numEvents;
+    dataUsed += numBytes;
+    return true;
+}
+
+void MidiEventList::insertAtSortedPosition (int index) noexcept
+{
+    auto time = times[index];
+    auto offset = offsets[index];
+    auto size = sizes[index];
+
+    auto position = (int) (std::upper_bound (times.get(), times + index, time) - times.get());
+    auto numToMove = (size_t) (index - position);
+
+    memmove (times + position + 1,   times + position,   numToMove * sizeof (int));
+    memmove (offsets + position + 1, offsets + position, numToMove * sizeof (uint32));
+    memmove (sizes + position + 1,   sizes + position,   numToMove * sizeof (uint32));
+
+    times[position] = time;
+    offsets[position] = offset;
+    sizes[position] = size;
+}
+
+bool MidiEventList::addEvent (const MidiMessage& m, int sampleNumber) noexcept
+{
+    return addEvent (m.getRawData(), m.getRawDataSize(), sampleNumber);
+}
+
+bool MidiEventList::addEvent (const void* newData, int maxBytes, int sampleNumber) noexcept
+{
+    auto wasSorted = sorted;
+
+    if (! append (newData, maxBytes, sampleNumber))
+        return false;
+
+    if (wasSorted && ! sorted)
+    {
+        insertAtSortedPosition (numEvents - 1);
+        sorted = true;
+    }
+
+    return true;
+}
+
+bool MidiEventList::appendEvent (const MidiMessage& m, int sampleNumber) noexcept
+{
+    return append (m.getRawData(), m.getRawDataSize(), sampleNumber);
+}
+
+bool MidiEventList::appendEvent (const void* newData, int maxBytes, int sampleNumber) noexcept
+{
+    return append (newData, maxBytes, sampleNumber);
+}
+
+void MidiEventList::sort() noexcept
+{
+    if (sorted)
+        return;
+
+    for (int i = 0; i < numEvents; ++i)
+        order[i] = (uint32) i;
+
+    // Comparing the original indexes of events with equal times makes the sort stable,
+    // without needing std::stable_sort, which may allocate a temporary buffer.
+    std::sort (order.get(), order + numEvents, [this] (uint32 a, uint32 b)
+    {
+        return times[a] < times[b] || (times[a] == times[b] && a < b);
+    });
+
+    for (int i = 0; i < numEvents; ++i)
+    {
+        auto source = order[i];
+        scratchTimes[i]   = times[source];
+        scratchOffsets[i] = offsets[source];
+        scratchSizes[i]   = sizes[source];
+    }
+
+    times.swapWith (scratchTimes);
+    offsets.swapWith (scratchOffsets);
+    sizes.swapWith (scratchSizes);
+
+    sorted = true;
+}
+
+//==============================================================================
+bool MidiEventList::addEvents (const MidiEventList& other, int startSample, int numSamples, int sampleDeltaToAdd) noexcept
+{
+    jassert (other.isSorted());
+    jassert (this != &other);
+
+    bool allAdded = true;
+
+    for (int i = other.getIndexOfFirstEventAtOrAfter (startSample); i < other.numEvents; ++i)
+    {
+        auto position = other.times[i];
+
+        if (numSamples >= 0 && position >= startSample + numSamples)
+            break;
+
+        allAdded = append (other.data + other.offsets[i], (int) other.sizes[i], position + sampleDeltaToAdd) && allAdded;
+    }
+
+    sort();
+    return allAdded;
+}
+
+bool MidiEventList::addEvents (const MidiBuffer& otherBuffer, int startSample, int numSamples, int sampleDeltaToAdd) noexcept
+{
+    MidiBuffer::Iterator i (otherBuffer);
+    i.setNextSamplePosition (startSample);
+
+    const uint8* eventData;
+    int eventSize, position;
+    bool allAdded = true;
+
+    while (i.getNextEvent (eventData, eventSize, position)
+            && (position < startSample + numSamples || numSamples < 0))
+    {
+        allAdded = append (eventData, eventSize, position + sampleDeltaToAdd) && allAdded;
+    }
+
+    sort();
+    return allAdded;
+}
+
+void MidiEventList::copyTo (MidiBuffer& destination) const
+{
+    jassert (isSorted());
+
+    destination.ensureSize ((size_t) (dataUsed + numEvents * (int) (sizeof (int32) + sizeof (uint16))));
+
+    for (int i = 0; i < numEvents; ++i)
+        destination.addEvent (data + offsets[i], (int) sizes[i], times[i]);
+}
+
+//==============================================================================
+MidiMessage MidiEventList::getEventAsMessage (int index) const
+{
+    return MidiMessage (getEventData (index), getEventDataSize (index), getEventTime (index));
+}
+
+int MidiEventList::getIndexOfFirstEventAtOrAfter (int samplePosition) const noexcept
+{
+    jassert (isSorted()); // call sort() after appending events!
+
+    return (int) (std::lower_bound (times.get(), times + numEvents, samplePosition) - times.get());
+}
+
+int MidiEventList::getFirstEventTime() const noexcept
+{
+    jassert (isSorted());
+    return numEvents > 0 ? times[0] : 0;
+}
+
+int MidiEventList::getLastEventTime() const noexcept
+{
+    jassert (isSorted());
+    return numEvents > 0 ? times[numEvents - 1] : 0;
+}
+
+void MidiEventList::swapWith (MidiEventList& other) noexcept
+{
+    times.swapWith (other.times);
+    scratchTimes.swapWith (other.scratchTimes);
+    offsets.swapWith (other.offsets);
+    scratchOffsets.swapWith (other.scratchOffsets);
+    sizes.swapWith (other.sizes);
+    scratchSizes.swapWith (other.scratchSizes);
+    order.swapWith (other.order);
+    data.swapWith (other.data);
+
+    std::swap (numEvents, other.numEvents);
+    std::swap (eventCapacity, other.eventCapacity);
+    std::swap (dataUsed, other.dataUsed);
+    std::swap (dataCapacity, other.dataCapacity);
+    std::swap (sorted, other.sorted);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct MidiEventListTests  : public UnitTest
+{
+    MidiEventListTests()
+        : UnitTest ("MidiEventList", UnitTestCategories::midi)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Events are kept in order");
+        {
+            Random r (1234);
+            MidiEventList list (1000, 3000);
+            MidiBuffer buffer;
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                auto time = r.nextInt (100);
+                auto m = MidiMessage::controllerEvent (1 + r.nextInt (16), r.nextInt (128), r.nextInt (128));
+
+                expect (list.addEvent (m, time));
+                buffer.addEvent (m, time);
+            }
+
+            expect (list.isSorted());
+            expectEquals (list.getNumEvents(), 1000);
+            expectMatches (list, buffer);
+        }
+
+        beginTest ("Appending then sorting matches adding");
+        {
+            Random r (2345);
+            MidiEventList list (5000, 15000);
+            MidiBuffer buffer;
+
+            for (int i = 0; i < 5000; ++i)
+            {
+                auto time = r.nextInt (512);
+                auto m = MidiMessage::noteOn (1 + r.nextInt (16), r.nextInt (128), (uint8) (1 + r.nextInt (127)));
+
+                expect (list.appendEvent (m, time));
+                buffer.addEvent (m, time);
+            }
+
+            expect (! list.isSorted());
+            list.sort();
+            expect (list.isSorted());
+            expectMatches (list, buffer);
+        }
+
+        beginTest ("Lookup");
+        {
+            MidiEventList list;
+
+            for (int i = 0; i < 100; ++i)
+                list.addEvent (MidiMessage::noteOn (1, 60, 1.0f), i * 10);
+
+            expectEquals (list.getIndexOfFirstEventAtOrAfter (0), 0);
+            expectEquals (list.getIndexOfFirstEventAtOrAfter (10), 1);
+            expectEquals (list.getIndexOfFirstEventAtOrAfter (11), 2);
+            expectEquals (list.getIndexOfFirstEventAtOrAfter (5000), 100);
+            expectEquals (list.getFirstEventTime(), 0);
+            expectEquals (list.getLastEventTime(), 990);
+        }
+
+        beginTest ("Clearing and copying ranges");
+        {
+            MidiEventList list;
+
+            for (int i = 0; i < 100; ++i)
+                list.addEvent (MidiMessage::noteOn (1, i, 1.0f), i);
+
+            MidiEventList copy;
+            expect (copy.addEvents (list, 10, 20, 100));
+            expectEquals (copy.getNumEvents(), 20);
+            expectEquals (copy.getFirstEventTime(), 110);
+            expectEquals (copy.getEventAsMessage (0).getNoteNumber(), 10);
+
+            list.clear (50, 25);
+            expectEquals (list.getNumEvents(), 75);
+            expectEquals (list.getEventTime (49), 49);
+            expectEquals (list.getEventTime (50), 75);
+
+            MidiBuffer buffer;
+            list.copyTo (buffer);
+            expectEquals (buffer.getNumEvents(), 75);
+            expectMatches (MidiEventList (buffer), buffer);
+        }
+
+        beginTest ("Capacity is never exceeded");
+        {
+            MidiEventList list (10, 25);
+            uint8 sysex[] = { 0xf0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xf7 };
+
+            for (int i = 0; i < 8; ++i)
+                expect (list.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 8 - i));
+
+            expect (! list.addEvent (sysex, (int) sizeof (sysex), 0));
+            expect (! list.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 0));
+            expectEquals (list.getNumEvents(), 8);
+            expectEquals (list.getEventCapacity(), 10);
+            expectEquals (list.getDataCapacity(), 25);
+
+            list.ensureCapacity (20, 100);
+            expect (list.addEvent (sysex, (int) sizeof (sysex), 0));
+            expectEquals (list.getEventDataSize (0), (int) sizeof (sysex));
+            expectEquals (list.getNumEvents(), 9);
+        }
+
+        beginTest ("Benchmark");
+        {
+            // a dense MPE-style stream: 16 channels of controller data, each in time order,
+            // arriving one channel after another
+            const int numEvents = 10000, blockSize = 512;
+            Array<std::pair<int, MidiMessage>> events;
+
+            for (int channel = 1; channel <= 16; ++channel)
+                for (int i = 0; i < numEvents / 16; ++i)
+                    events.add ({ i * blockSize / (numEvents / 16), MidiMessage::channelPressureChange (channel, i % 128) });
+
+            MidiBuffer buffer;
+            buffer.ensureSize ((size_t) numEvents * 10);
+
+            auto start = Time::getMillisecondCounterHiRes();
+
+            for (auto& e : events)
+                buffer.addEvent (e.second, e.first);
+
+            auto bufferTime = Time::getMillisecondCounterHiRes() - start;
+
+            MidiEventList list (numEvents, numEvents * 3);
+            const int numRepeats = 20;
+            start = Time::getMillisecondCounterHiRes();
+
+            for (int repeat = 0; repeat < numRepeats; ++repeat)
+            {
+                list.clear();
+
+                for (auto& e : events)
+                    list.appendEvent (e.second, e.first);
+
+                list.sort();
+            }
+
+            auto listTime = (Time::getMillisecondCounterHiRes() - start) / numRepeats;
+
+            expectMatches (list, buffer);
+
+            logMessage ("Adding " + String (numEvents) + " interleaved events - MidiBuffer: " + String (roundToInt (bufferTime * 1000.0))
+                          + " us, MidiEventList: " + String (roundToInt (listTime * 1000.0)) + " us");
+
+            int found = 0;
+            start = Time::getMillisecondCounterHiRes();
+
+            for (int pos = 0; pos < blockSize; ++pos)
+            {
+                MidiBuffer::Iterator i (buffer);
+                i.setNextSamplePosition (pos);
+                MidiMessage m;
+                int samplePos;
+                found += i.getNextEvent (m, samplePos) ? 1 : 0;
+            }
+
+            bufferTime = Time::getMillisecondCounterHiRes() - start;
+            start = Time::getMillisecondCounterHiRes();
+
+            for (int pos = 0; pos < blockSize; ++pos)
+                found += list.getIndexOfFirstEventAtOrAfter (pos) < list.getNumEvents() ? 1 : 0;
+
+            listTime = Time::getMillisecondCounterHiRes() - start;
+
+            expectEquals (found, 2 * blockSize);
+            logMessage ("Looking up " + String (blockSize) + " positions - MidiBuffer: " + String (roundToInt (bufferTime * 1000.0))
+                          + " us, MidiEventList: " + String (listTime * 1000.0, 1) + " us");
+        }
+    }
+
+    void expectMatches (const MidiEventList& list, const MidiBuffer& buffer)
+    {
+        MidiBuffer::Iterator iter (buffer);
+        const uint8* eventData;
+        int eventSize, position, index = 0;
+        bool allMatch = true;
+
+        while (iter.getNextEvent (eventData, eventSize, position))
+        {
+            allMatch = allMatch
+                        && index < list.getNumEvents()
+                        && list.getEventTime (index) == position
+                        && list.getEventDataSize (index) == eventSize
+                        && memcmp (list.getEventData (index), eventData, (size_t) eventSize) == 0;
+            ++index;
+        }
+
+        expect (allMatch);
+        expectEquals (index, list.getNumEvents());
+    }
+};
+
+static MidiEventListTests midiEventListTests;
+
+#endif
+
+} // namespace juce
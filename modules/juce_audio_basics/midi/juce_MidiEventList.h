@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Holds a list of time-stamped midi events, for use with dense event streams.
+
+    This does the same job as a MidiBuffer, but is organised so that large numbers of
+    events can be added and searched quickly. The timestamps are kept in their own array,
+    separately from the message data, so finding the events at a given time is a binary
+    search rather than a walk through the buffer. Events that arrive in order are simply
+    appended, and a batch of out-of-order events can be appended with appendEvent() and
+    then sorted in one go with sort().
+
+    The list has a fixed capacity, which is set by the constructor or by ensureCapacity(),
+    and it never allocates memory when events are added or sorted, so it can be used
+    on the audio thread. If there isn't space for an event, it isn't added.
+
+    Events with the same timestamp are kept in the order in which they were added.
+
+    @see MidiBuffer, MidiMessage
+
+    @tags{Audio}
+*/
+class JUCE_API  MidiEventList
+{
+public:
+    //==============================================================================
+    /** Creates a list with space for a number of events, and a number of bytes of
+        message data.
+    */
+    MidiEventList (int maxNumEvents = 1024, int maxNumBytes = 8192);
+
+    /** Creates a list containing the events in a MidiBuffer. */
+    explicit MidiEventList (const MidiBuffer&);
+
+    /** Creates a copy of another list. */
+    MidiEventList (const MidiEventList&);
+
+    /** Makes a copy of another list. */
+    MidiEventList& operator= (const MidiEventList&);
+
+    /** Destructor. */
+    ~MidiEventList();
+
+    //==============================================================================
+    /** Preallocates space for a number of events and bytes of message data.
+        This allocates memory, so don't call it on the audio thread.
+    */
+    void ensureCapacity (int maxNumEvents, int maxNumBytes);
+
+    /** Returns the number of events that the list can hold. */
+    int getEventCapacity() const noexcept                   { return eventCapacity; }
+
+    /** Returns the number of bytes of message data that the list can hold. */
+    int getDataCapacity() const noexcept                    { return dataCapacity; }
+
+    //==============================================================================
+    /** Removes all the events. */
+    void clear() noexcept;
+
+    /** Removes all events for which (start <= event position < start + numSamples).
+        Note that the space that their data occupied isn't reused until clear() is called.
+    */
+    void clear (int start, int numSamples) noexcept;
+
+    /** Returns true if the list is empty. */
+    bool isEmpty() const noexcept                           { return numEvents == 0; }
+
+    /** Returns the number of events in the list. */
+    int getNumEvents() const noexcept                       { return numEvents; }
+
+    //==============================================================================
+    /** Adds an event, keeping the list sorted.
+
+        Adding an event that's later than (or at the same time as) the last one is a
+        quick append. An earlier event is inserted at its sorted position.
+
+        Returns false if there wasn't space for the event.
+    */
+    bool addEvent (const MidiMessage& midiMessage, int sampleNumber) noexcept;
+
+    /** Adds an event from raw midi data, keeping the list sorted.
+        As with MidiBuffer::addEvent(), only the number of bytes that the event really
+        uses are stored. Returns false if there wasn't space for the event, or if the
+        data isn't a valid midi event.
+    */
+    bool addEvent (const void* rawMidiData, int maxBytesOfMidiData, int sampleNumber) noexcept;
+
+    /** Appends an event to the end of the list, without sorting it.
+
+        After appending a batch of events, call sort() before reading from the list. This
+        is much quicker than adding out-of-order events one at a time with addEvent().
+
+        Returns false if there wasn't space for the event.
+    */
+    bool appendEvent (const MidiMessage& midiMessage, int sampleNumber) noexcept;
+
+    /** Appends an event from raw midi data, without sorting it. @see sort */
+    bool appendEvent (const void* rawMidiData, int maxBytesOfMidiData, int sampleNumber) noexcept;
+
+    /** Sorts any events that have been appended out of order.
+        This is a stable sort, and doesn't allocate any memory.
+    */
+    void sort() noexcept;
+
+    /** Returns true if the events are in order. */
+    bool isSorted() const noexcept                          { return sorted; }
+
+    /** Adds the events from another list whose positions are in the range
+        (startSample <= position < startSample + numSamples), offsetting their timestamps
+        by sampleDeltaToAdd. If numSamples is less than 0, all events after startSample
+        are added.
+
+        Returns false if some of the events didn't fit.
+    */
+    bool addEvents (const MidiEventList& otherList, int startSample, int numSamples, int sampleDeltaToAdd) noexcept;
+
+    /** Adds the events from a MidiBuffer, in the same way as the other addEvents() method. */
+    bool addEvents (const MidiBuffer& otherBuffer, int startSample, int numSamples, int sampleDeltaToAdd) noexcept;
+
+    /** Adds all of the events in this list to a MidiBuffer. */
+    void copyTo (MidiBuffer& destination) const;
+
+    //==============================================================================
+    /** Returns the sample position of an event. */
+    int getEventTime (int index) const noexcept             { jassert (isPositiveAndBelow (index, numEvents)); return times[index]; }
+
+    /** Returns a pointer to the raw data of an event. */
+    const uint8* getEventData (int index) const noexcept    { jassert (isPositiveAndBelow (index, numEvents)); return data + offsets[index]; }
+
+    /** Returns the number of bytes of data in an event. */
+    int getEventDataSize (int index) const noexcept         { jassert (isPositiveAndBelow (index, numEvents)); return (int) sizes[index]; }
+
+    /** Returns one of the events as a MidiMessage, with its timestamp set to the event's position. */
+    MidiMessage getEventAsMessage (int index) const;
+
+    /** Returns the index of the first event whose position is greater than or equal
+        to the given sample position, or getNumEvents() if there isn't one.
+    */
+    int getIndexOfFirstEventAtOrAfter (int samplePosition) const noexcept;
+
+    /** Returns the sample number of the first event in the list, or 0 if it's empty. */
+    int getFirstEventTime() const noexcept;
+
+    /** Returns the sample number of the last event in the list, or 0 if it's empty. */
+    int getLastEventTime() const noexcept;
+
+    //==============================================================================
+    /** Exchanges the contents of this list with another one. */
+    void swapWith (MidiEventList&) noexcept;
+
+private:
+    //==============================================================================
+    HeapBlock<int> times, scratchTimes;
+    HeapBlock<uint32> offsets, scratchOffsets, sizes, scratchSizes, order;
+    HeapBlock<uint8> data;
+    int numEvents = 0, eventCapacity = 0;
+    int dataUsed = 0, dataCapacity = 0;
+    bool sorted = true;
+
+    bool append (const void*, int maxBytes, int sampleNumber) noexcept;
+    void insertAtSortedPosition (int index) noexcept;
+
+    JUCE_LEAK_DETECTOR (MidiEventList)
+};
+
+} // namespace juce
@@ -337,7 +337,7 @@ void MidiFile::readNextTrack (const uint8* data, int size, bool createMatchingNo
         return a->message.isNoteOff() && b->message.isNoteOn();
     });
 
-    addTrack (result);
+    tracks.add (new MidiMessageSequence (std::move (result)));
 
     if (createMatchingNoteOffs)
         tracks.getLast()->updateMatchedPairs();
@@ -27,6 +27,65 @@ MidiMessageSequence::MidiEventHolder::MidiEventHolder (const MidiMessage& mm) :
 MidiMessageSequence::MidiEventHolder::MidiEventHolder (MidiMessage&& mm) : message (std::move (mm)) {}
 MidiMessageSequence::MidiEventHolder::~MidiEventHolder() {}
 
+//==============================================================================
+// Allocates MidiEventHolders in blocks, and recycles the slots of deleted events
+class MidiMessageSequence::EventPool
+{
+public:
+    EventPool() = default;
+
+    template <typename MessageType>
+    MidiEventHolder* create (MessageType&& message)
+    {
+        return new (allocate()) MidiEventHolder (std::forward<MessageType> (message));
+    }
+
+    void destroy (MidiEventHolder* event)
+    {
+        event->~MidiEventHolder();
+        freeSlots.add (event);
+    }
+
+    void reserve (int numEvents)
+    {
+        auto numAvailable = freeSlots.size() + (blockSize - numUsedInBlock);
+
+        if (numEvents > numAvailable)
+            addBlock (numEvents - numAvailable);
+    }
+
+private:
+    using Slot = typename std::aligned_storage<sizeof (MidiEventHolder), alignof (MidiEventHolder)>::type;
+
+    std::vector<std::unique_ptr<Slot[]>> blocks;
+    Array<void*> freeSlots;
+    int blockSize = 0, numUsedInBlock = 0;
+
+    void* allocate()
+    {
+        if (! freeSlots.isEmpty())
+            return freeSlots.removeAndReturn (freeSlots.size() - 1);
+
+        if (numUsedInBlock >= blockSize)
+            addBlock (jmin (4096, jmax (64, blockSize * 2)));
+
+        return blocks.back().get() + numUsedInBlock++;
+    }
+
+    void addBlock (int size)
+    {
+        // any unused slots at the end of the current block are kept for re-use
+        for (int i = numUsedInBlock; i < blockSize; ++i)
+            freeSlots.add (blocks.back().get() + i);
+
+        blocks.emplace_back (new Slot[(size_t) size]);
+        blockSize = size;
+        numUsedInBlock = 0;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (EventPool)
+};
+
 //==============================================================================
 MidiMessageSequence::MidiMessageSequence()
 {
@@ -34,7 +93,10 @@ MidiMessageSequence::MidiMessageSequence()
 
 MidiMessageSequence::MidiMessageSequence (const MidiMessageSequence& other)
 {
-    list.addCopiesOf (other.list);
+    ensureStorageAllocated (other.list.size());
+
+    for (auto* m : other.list)
+        list.add (createEvent (m->message));
 
     for (int i = 0; i < list.size(); ++i)
     {
@@ -53,28 +115,65 @@ MidiMessageSequence& MidiMessageSequence::operator= (const MidiMessageSequence&
 }
 
 MidiMessageSequence::MidiMessageSequence (MidiMessageSequence&& other) noexcept
-    : list (std::move (other.list))
+    : list (std::move (other.list)), pool (std::move (other.pool))
 {
 }
 
 MidiMessageSequence& MidiMessageSequence::operator= (MidiMessageSequence&& other) noexcept
 {
+    deleteAllEvents();
     list = std::move (other.list);
+    pool = std::move (other.pool);
     return *this;
 }
 
 MidiMessageSequence::~MidiMessageSequence()
 {
+    deleteAllEvents();
 }
 
 void MidiMessageSequence::swapWith (MidiMessageSequence& other) noexcept
 {
     list.swapWith (other.list);
+    std::swap (pool, other.pool);
 }
 
 void MidiMessageSequence::clear()
 {
+    deleteAllEvents();
     list.clear();
+    pool.reset();
+}
+
+void MidiMessageSequence::ensureStorageAllocated (int numEvents)
+{
+    list.ensureStorageAllocated (numEvents);
+
+    if (pool == nullptr)
+        pool.reset (new EventPool());
+
+    pool->reserve (numEvents - list.size());
+}
+
+MidiMessageSequence::MidiEventHolder* MidiMessageSequence::createEvent (const MidiMessage& message)
+{
+    if (pool == nullptr)
+        pool.reset (new EventPool());
+
+    return pool->create (message);
+}
+
+void MidiMessageSequence::removeEvent (int index)
+{
+    pool->destroy (list.removeAndReturn (index));
+}
+
+void MidiMessageSequence::deleteAllEvents()
+{
+    for (auto* m : list)
+        pool->destroy (m);
+
+    list.clearQuick();
 }
 
 int MidiMessageSequence::getNumEvents() const noexcept
@@ -92,6 +191,41 @@ MidiMessageSequence::MidiEventHolder* const* MidiMessageSequence::begin() const
 MidiMessageSequence::MidiEventHolder** MidiMessageSequence::end() noexcept                 { return list.end(); }
 MidiMessageSequence::MidiEventHolder* const* MidiMessageSequence::end() const noexcept     { return list.end(); }
 
+namespace MidiMessageSequenceHelpers
+{
+    using Holder = MidiMessageSequence::MidiEventHolder;
+
+    static bool isEarlier (const Holder* a, const Holder* b) noexcept
+    {
+        return a->message.getTimeStamp() < b->message.getTimeStamp();
+    }
+
+    // returns the index of the first event at or after the given time, assuming
+    // that the events between start and end are sorted
+    static int findFirstAtOrAfter (Holder* const* events, int start, int end, double time) noexcept
+    {
+        return (int) (std::lower_bound (events + start, events + end, time,
+                                        [] (const Holder* h, double t) { return h->message.getTimeStamp() < t; }) - events);
+    }
+
+    // finds an event by searching the other events with the same timestamp, falling
+    // back to a linear search if the sequence isn't sorted
+    static int findEvent (Holder* const* events, int start, int end, const Holder* event) noexcept
+    {
+        auto time = event->message.getTimeStamp();
+
+        for (int i = findFirstAtOrAfter (events, start, end, time); i < end && events[i]->message.getTimeStamp() == time; ++i)
+            if (events[i] == event)
+                return i;
+
+        for (int i = start; i < end; ++i)
+            if (events[i] == event)
+                return i;
+
+        return -1;
+    }
+}
+
 double MidiMessageSequence::getTimeOfMatchingKeyUp (int index) const noexcept
 {
     if (auto* meh = list[index])
@@ -107,9 +241,10 @@ int MidiMessageSequence::getIndexOfMatchingKeyUp (int index) const noexcept
     {
         if (auto* noteOff = meh->noteOffObject)
         {
-            for (int i = index; i < list.size(); ++i)
-                if (list.getUnchecked(i) == noteOff)
-                    return i;
+            auto i = MidiMessageSequenceHelpers::findEvent (list.begin(), index, list.size(), noteOff);
+
+            if (i >= 0)
+                return i;
 
             jassertfalse; // we've somehow got a pointer to a note-off object that isn't in the sequence
         }
@@ -120,19 +255,37 @@ int MidiMessageSequence::getIndexOfMatchingKeyUp (int index) const noexcept
 
 int MidiMessageSequence::getIndexOf (const MidiEventHolder* event) const noexcept
 {
-    return list.indexOf (event);
+    if (event == nullptr)
+        return -1;
+
+    return MidiMessageSequenceHelpers::findEvent (list.begin(), 0, list.size(), event);
 }
 
 int MidiMessageSequence::getNextIndexAtTime (double timeStamp) const noexcept
 {
-    auto numEvents = list.size();
-    int i;
+    return MidiMessageSequenceHelpers::findFirstAtOrAfter (list.begin(), 0, list.size(), timeStamp);
+}
+
+MidiMessageSequence MidiMessageSequence::getSubsequence (double startTime, double endTime) const
+{
+    auto start = getNextIndexAtTime (startTime);
+    auto end = jmax (start, getNextIndexAtTime (endTime));
+
+    MidiMessageSequence result;
+    result.ensureStorageAllocated (end - start);
+
+    for (int i = start; i < end; ++i)
+        result.list.add (result.createEvent (list.getUnchecked (i)->message));
+
+    for (int i = start; i < end; ++i)
+    {
+        auto noteOffIndex = getIndexOfMatchingKeyUp (i);
 
-    for (i = 0; i < numEvents; ++i)
-        if (list.getUnchecked(i)->message.getTimeStamp() >= timeStamp)
-            break;
+        if (noteOffIndex >= start && noteOffIndex < end)
+            result.list.getUnchecked (i - start)->noteOffObject = result.list.getUnchecked (noteOffIndex - start);
+    }
 
-    return i;
+    return result;
 }
 
 //==============================================================================
@@ -159,24 +312,47 @@ MidiMessageSequence::MidiEventHolder* MidiMessageSequence::addEvent (MidiEventHo
 {
     newEvent->message.addToTimeStamp (timeAdjustment);
     auto time = newEvent->message.getTimeStamp();
-    int i;
 
-    for (i = list.size(); --i >= 0;)
-        if (list.getUnchecked(i)->message.getTimeStamp() <= time)
-            break;
+    if (list.isEmpty() || list.getLast()->message.getTimeStamp() <= time)
+    {
+        list.add (newEvent);
+    }
+    else
+    {
+        auto i = std::upper_bound (list.begin(), list.end(), time,
+                                   [] (double t, const MidiEventHolder* h) { return t < h->message.getTimeStamp(); });
+
+        list.insert ((int) (i - list.begin()), newEvent);
+    }
 
-    list.insert (i + 1, newEvent);
     return newEvent;
 }
 
 MidiMessageSequence::MidiEventHolder* MidiMessageSequence::addEvent (const MidiMessage& newMessage, double timeAdjustment)
 {
-    return addEvent (new MidiEventHolder (newMessage), timeAdjustment);
+    return addEvent (createEvent (newMessage), timeAdjustment);
 }
 
 MidiMessageSequence::MidiEventHolder* MidiMessageSequence::addEvent (MidiMessage&& newMessage, double timeAdjustment)
 {
-    return addEvent (new MidiEventHolder (std::move (newMessage)), timeAdjustment);
+    if (pool == nullptr)
+        pool.reset (new EventPool());
+
+    return addEvent (pool->create (std::move (newMessage)), timeAdjustment);
+}
+
+void MidiMessageSequence::addEvents (const Array<MidiMessage>& newMessages, double timeAdjustment)
+{
+    ensureStorageAllocated (list.size() + newMessages.size());
+
+    for (auto& m : newMessages)
+    {
+        auto* newOne = createEvent (m);
+        newOne->message.addToTimeStamp (timeAdjustment);
+        list.add (newOne);
+    }
+
+    sort();
 }
 
 void MidiMessageSequence::deleteEvent (int index, bool deleteMatchingNoteUp)
@@ -186,15 +362,17 @@ void MidiMessageSequence::deleteEvent (int index, bool deleteMatchingNoteUp)
         if (deleteMatchingNoteUp)
             deleteEvent (getIndexOfMatchingKeyUp (index), false);
 
-        list.remove (index);
+        removeEvent (index);
     }
 }
 
 void MidiMessageSequence::addSequence (const MidiMessageSequence& other, double timeAdjustment)
 {
+    ensureStorageAllocated (list.size() + other.list.size());
+
     for (auto* m : other)
     {
-        auto newOne = new MidiEventHolder (m->message);
+        auto newOne = createEvent (m->message);
         newOne->message.addToTimeStamp (timeAdjustment);
         list.add (newOne);
     }
@@ -213,7 +391,7 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
 
         if (t >= firstAllowableTime && t < endOfAllowableDestTimes)
         {
-            auto newOne = new MidiEventHolder (m->message);
+            auto newOne = createEvent (m->message);
             newOne->message.setTimeStamp (t);
             list.add (newOne);
         }
@@ -224,49 +402,67 @@ void MidiMessageSequence::addSequence (const MidiMessageSequence& other,
 
 void MidiMessageSequence::sort() noexcept
 {
-    std::stable_sort (list.begin(), list.end(),
-                      [] (const MidiEventHolder* a, const MidiEventHolder* b) { return a->message.getTimeStamp() < b->message.getTimeStamp(); });
+    if (! std::is_sorted (list.begin(), list.end(), MidiMessageSequenceHelpers::isEarlier))
+        std::stable_sort (list.begin(), list.end(), MidiMessageSequenceHelpers::isEarlier);
 }
 
 void MidiMessageSequence::updateMatchedPairs() noexcept
 {
-    for (int i = 0; i < list.size(); ++i)
+    // This makes a single pass through the sequence, keeping track of the note-on
+    // that's waiting for a note-off on each channel and key. A note-on that's followed
+    // by another note-on for the same key gets a new note-off inserted before the
+    // second one, so the new events are collected into a new list as we go.
+    HeapBlock<MidiEventHolder*> pendingNoteOns (16 * 128, true);
+    Array<MidiEventHolder*> newList;
+    auto numEvents = list.size();
+
+    for (int i = 0; i < numEvents; ++i)
     {
-        auto* meh = list.getUnchecked(i);
-        auto& m1 = meh->message;
+        auto* meh = list.getUnchecked (i);
+        auto& m = meh->message;
+        auto isNoteOn = m.isNoteOn();
 
-        if (m1.isNoteOn())
+        if (isNoteOn || m.isNoteOff())
         {
-            meh->noteOffObject = nullptr;
-            auto note = m1.getNoteNumber();
-            auto chan = m1.getChannel();
-            auto len = list.size();
+            auto channel = m.getChannel();
 
-            for (int j = i + 1; j < len; ++j)
+            if (isPositiveAndNotGreaterThan (channel - 1, 15))
             {
-                auto* meh2 = list.getUnchecked(j);
-                auto& m = meh2->message;
+                auto& pending = pendingNoteOns[(channel - 1) * 128 + m.getNoteNumber()];
 
-                if (m.getNoteNumber() == note && m.getChannel() == chan)
+                if (isNoteOn)
                 {
-                    if (m.isNoteOff())
+                    if (pending != nullptr)
                     {
-                        meh->noteOffObject = meh2;
-                        break;
-                    }
+                        if (newList.isEmpty())
+                        {
+                            newList.ensureStorageAllocated (numEvents + 16);
+                            newList.addArray (list.begin(), i);
+                        }
 
-                    if (m.isNoteOn())
-                    {
-                        auto newEvent = new MidiEventHolder (MidiMessage::noteOff (chan, note));
-                        list.insert (j, newEvent);
+                        auto* newEvent = createEvent (MidiMessage::noteOff (channel, m.getNoteNumber()));
                         newEvent->message.setTimeStamp (m.getTimeStamp());
-                        meh->noteOffObject = newEvent;
-                        break;
+                        pending->noteOffObject = newEvent;
+                        newList.add (newEvent);
                     }
+
+                    meh->noteOffObject = nullptr;
+                    pending = meh;
+                }
+                else if (pending != nullptr)
+                {
+                    pending->noteOffObject = meh;
+                    pending = nullptr;
                 }
             }
         }
+
+        if (! newList.isEmpty())
+            newList.add (meh);
     }
+
+    if (! newList.isEmpty())
+        list.swapWith (newList);
 }
 
 void MidiMessageSequence::addTimeToMessages (double delta) noexcept
@@ -298,14 +494,14 @@ void MidiMessageSequence::deleteMidiChannelMessages (const int channelNumberToRe
 {
     for (int i = list.size(); --i >= 0;)
         if (list.getUnchecked(i)->message.isForChannel (channelNumberToRemove))
-            list.remove(i);
+            removeEvent (i);
 }
 
 void MidiMessageSequence::deleteSysExMessages()
 {
     for (int i = list.size(); --i >= 0;)
         if (list.getUnchecked(i)->message.isSysEx())
-            list.remove(i);
+            removeEvent (i);
 }
 
 //==============================================================================
@@ -402,6 +598,117 @@ struct MidiMessageSequenceTest  : public UnitTest
         expectEquals (s.getNumEvents(), 7);
         expectEquals (s.getIndexOfMatchingKeyUp (0), -1); // Truncated note, should be no note off
         expectEquals (s.getTimeOfMatchingKeyUp (1), 5.0);
+
+        beginTest ("Repeated note-ons");
+        {
+            MidiMessageSequence r;
+            r.addEvent (MidiMessage::noteOn  (1, 60, 0.5f).withTimeStamp (0.0));
+            r.addEvent (MidiMessage::noteOn  (1, 60, 0.5f).withTimeStamp (1.0));
+            r.addEvent (MidiMessage::noteOn  (2, 60, 0.5f).withTimeStamp (1.5));
+            r.addEvent (MidiMessage::noteOn  (1, 60, 0.0f).withTimeStamp (2.0)); // velocity 0 acts as a note-off
+            r.addEvent (MidiMessage::noteOff (2, 60, 0.5f).withTimeStamp (3.0));
+            r.updateMatchedPairs();
+
+            // a note-off is inserted before the second note-on to end the first one
+            expectEquals (r.getNumEvents(), 6);
+            expect (r.getEventPointer (1)->message.isNoteOff());
+            expectEquals (r.getEventTime (1), 1.0);
+            expectEquals (r.getIndexOfMatchingKeyUp (0), 1);
+            expectEquals (r.getIndexOfMatchingKeyUp (2), 4);
+            expectEquals (r.getIndexOfMatchingKeyUp (3), 5);
+
+            // pairing again shouldn't add any more events
+            r.updateMatchedPairs();
+            expectEquals (r.getNumEvents(), 6);
+
+            MidiMessageSequence copy (r);
+            expectEquals (copy.getIndexOfMatchingKeyUp (3), 5);
+            expect (copy.getEventPointer (3)->noteOffObject == copy.getEventPointer (5));
+        }
+
+        beginTest ("Adding many events");
+        {
+            Array<MidiMessage> messages;
+
+            for (int i = 0; i < 100; ++i)
+                messages.add (MidiMessage::controllerEvent (1, 7, i).withTimeStamp ((i * 37) % 100));
+
+            MidiMessageSequence r;
+            r.addEvent (MidiMessage::controllerEvent (1, 1, 0).withTimeStamp (50.0));
+            r.addEvents (messages, 10.0);
+
+            expectEquals (r.getNumEvents(), 101);
+            expectEquals (r.getStartTime(), 10.0);
+            expectEquals (r.getEndTime(), 109.0);
+
+            for (int i = 1; i < r.getNumEvents(); ++i)
+                expect (r.getEventTime (i - 1) <= r.getEventTime (i));
+
+            // events added earlier stay ahead of later ones with the same time
+            auto index = r.getNextIndexAtTime (50.0);
+            expectEquals (r.getEventPointer (index)->message.getControllerNumber(), 1);
+
+            r.deleteMidiChannelMessages (1);
+            expectEquals (r.getNumEvents(), 0);
+
+            r.addEvent (MidiMessage::noteOn (1, 10, 0.5f).withTimeStamp (5.0));
+            expectEquals (r.getNumEvents(), 1);
+        }
+
+        beginTest ("Subsequences");
+        {
+            MidiMessageSequence r;
+            r.addEvent (MidiMessage::noteOn  (1, 60, 0.5f).withTimeStamp (0.0));
+            r.addEvent (MidiMessage::noteOn  (1, 62, 0.5f).withTimeStamp (2.0));
+            r.addEvent (MidiMessage::noteOff (1, 62, 0.5f).withTimeStamp (3.0));
+            r.addEvent (MidiMessage::noteOn  (1, 64, 0.5f).withTimeStamp (4.0));
+            r.addEvent (MidiMessage::noteOff (1, 60, 0.5f).withTimeStamp (5.0));
+            r.addEvent (MidiMessage::noteOff (1, 64, 0.5f).withTimeStamp (6.0));
+            r.updateMatchedPairs();
+
+            auto sub = r.getSubsequence (1.0, 6.0);
+            expectEquals (sub.getNumEvents(), 4);
+            expectEquals (sub.getStartTime(), 2.0);
+            expectEquals (sub.getEndTime(), 5.0);
+            expectEquals (sub.getIndexOfMatchingKeyUp (0), 1);
+            expectEquals (sub.getIndexOfMatchingKeyUp (2), -1); // its note-off is outside the range
+        }
+
+        beginTest ("Performance");
+        {
+            Random random (1234);
+            Array<MidiMessage> messages;
+            const int numNotes = 100000;
+
+            for (int i = 0; i < numNotes; ++i)
+            {
+                auto note = random.nextInt (128);
+                auto start = random.nextDouble() * 1000.0;
+
+                messages.add (MidiMessage::noteOn  (1 + (i & 15), note, 0.5f).withTimeStamp (start));
+                messages.add (MidiMessage::noteOff (1 + (i & 15), note, 0.5f).withTimeStamp (start + random.nextDouble()));
+            }
+
+            auto startTime = Time::getHighResolutionTicks();
+
+            MidiMessageSequence r;
+            r.addEvents (messages);
+            auto buildTime = Time::getHighResolutionTicks();
+
+            r.updateMatchedPairs();
+            auto pairTime = Time::getHighResolutionTicks();
+
+            MidiMessageSequence copy (r);
+            auto copyTime = Time::getHighResolutionTicks();
+
+            expect (copy.getNumEvents() >= numNotes * 2);
+
+            auto ms = [] (int64 ticks) { return String (Time::highResolutionTicksToSeconds (ticks) * 1000.0, 1) + " ms"; };
+
+            logMessage ("Building " + String (numNotes * 2) + " events: " + ms (buildTime - startTime)
+                         + ", pairing: " + ms (pairTime - buildTime)
+                         + ", copying: " + ms (copyTime - pairTime));
+        }
     }
 };
 
@@ -30,6 +30,9 @@ namespace juce
     This allows the sequence to be manipulated, and also to be read from and
     written to a standard midi file.
 
+    The events are allocated in blocks that are owned by the sequence, rather than
+    individually, so building and copying large sequences is cheap.
+
     @see MidiMessage, MidiFile
 
     @tags{Audio}
@@ -135,6 +138,14 @@ public:
     */
     int getNextIndexAtTime (double timeStamp) const noexcept;
 
+    /** Returns a copy of the events whose timestamps are in the range
+        (startTime <= time < endTime).
+
+        Note-on events whose matching note-off is also in the range remain linked to it
+        in the new sequence.
+    */
+    MidiMessageSequence getSubsequence (double startTime, double endTime) const;
+
     //==============================================================================
     /** Returns the timestamp of the first event in the sequence.
         @see getEndTime
@@ -180,6 +191,25 @@ public:
     */
     MidiEventHolder* addEvent (MidiMessage&& newMessage, double timeAdjustment = 0);
 
+    /** Inserts a set of midi messages into the sequence.
+
+        This is much quicker than adding a large number of messages one at a time,
+        because the new messages are appended and the sequence is sorted once.
+        Messages with the same timestamp stay in the order in which they were added.
+
+        Remember to call updateMatchedPairs() after adding note-on events.
+
+        @param newMessages      the messages to add (internal copies will be made)
+        @param timeAdjustment   an optional value to add to the timestamps of the messages
+        @see updateMatchedPairs
+    */
+    void addEvents (const Array<MidiMessage>& newMessages, double timeAdjustment = 0);
+
+    /** Preallocates space for a number of events, to avoid reallocating when events
+        are added.
+    */
+    void ensureStorageAllocated (int numEvents);
+
     /** Deletes one of the events in the sequence.
 
         Remember to call updateMatchedPairs() after removing events.
@@ -296,9 +326,15 @@ public:
 private:
     //==============================================================================
     friend class MidiFile;
-    OwnedArray<MidiEventHolder> list;
+    class EventPool;
+
+    Array<MidiEventHolder*> list;
+    std::unique_ptr<EventPool> pool;
 
     MidiEventHolder* addEvent (MidiEventHolder*, double);
+    MidiEventHolder* createEvent (const MidiMessage&);
+    void removeEvent (int index);
+    void deleteAllEvents();
 
     JUCE_LEAK_DETECTOR (MidiMessageSequence)
 };
@@ -47,4 +47,17 @@ void MPESynthesiserVoice::clearCurrentNote() noexcept
     currentlyPlayingNote = MPENote();
 }
 
+void MPESynthesiserVoice::setCurrentSampleRate (double newRate)
+{
+    currentSampleRate = newRate;
+    SinglePrecisionVoiceRenderer::allocate (tempBuffer);
+}
+
+void MPESynthesiserVoice::renderNextBlock (AudioBuffer<double>& outputBuffer, int startSample, int numSamples)
+{
+    if (isActive())
+        SinglePrecisionVoiceRenderer::renderAndAdd (tempBuffer, outputBuffer, startSample, numSamples,
+                                                    [this] (AudioBuffer<float>& b, int s, int n) { renderNextBlock (b, s, n); });
+}
+
 } // namespace juce
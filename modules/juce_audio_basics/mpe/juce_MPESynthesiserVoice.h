@@ -134,12 +134,19 @@ public:
 
     /** Renders the next block of 64-bit data for this voice.
 
-        Support for 64-bit audio is optional. You can choose to not override this method if
-        you don't need it (the default implementation simply does nothing).
+        As with the 32-bit version, the output must be added to the buffer's existing contents.
+
+        Support for 64-bit audio is optional. The default implementation renders the 32-bit
+        version into a cleared scratch buffer and adds that to the output, so you only need
+        to override this if your voice can render doubles directly.
+
+        Note that in older versions of JUCE, the default implementation did nothing, so voices
+        that didn't override it were silent when rendering 64-bit audio. If your voice relied
+        on that, override this method with an empty one.
     */
-    virtual void renderNextBlock (AudioBuffer<double>& /*outputBuffer*/,
-                                  int /*startSample*/,
-                                  int /*numSamples*/) {}
+    virtual void renderNextBlock (AudioBuffer<double>& outputBuffer,
+                                  int startSample,
+                                  int numSamples);
 
     /** Changes the voice's reference sample rate.
 
@@ -147,9 +154,12 @@ public:
         accordingly.
 
         This method is called by the synth, and subclasses can access the current rate with
-        the currentSampleRate member.
+        the currentSampleRate member. If you override it, call the base class version too,
+        because that's where the buffer used by the default 64-bit renderNextBlock() is
+        allocated. Otherwise it's allocated by the first 64-bit render, which will be on
+        the audio thread.
     */
-    virtual void setCurrentSampleRate (double newRate)    { currentSampleRate = newRate; }
+    virtual void setCurrentSampleRate (double newRate);
 
     /** Returns the current target sample rate at which rendering is being done.
         Subclasses may need to know this so that they can pitch things correctly.
@@ -185,6 +195,8 @@ private:
     //==============================================================================
     friend class MPESynthesiser;
 
+    AudioBuffer<float> tempBuffer;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MPESynthesiserVoice)
 };
 
@@ -0,0 +1,993 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace RealtimeMPEInstrumentHelpers
+{
+    static const uint8 noLSBValueReceived = 0xff;
+
+    static bool isKeyDown (const MPENote& note) noexcept
+    {
+        return note.keyState == MPENote::keyDown || note.keyState == MPENote::keyDownAndSustained;
+    }
+
+    static bool isValidChannelAndNote (int midiChannel, int midiNoteNumber) noexcept
+    {
+        return isPositiveAndBelow (midiChannel - 1, 16) && isPositiveAndBelow (midiNoteNumber, 128);
+    }
+}
+
+//==============================================================================
+RealtimeMPEInstrument::RealtimeMPEInstrument (int maxNotes, int changeQueueSize)
+    : slots ((size_t) jmax (1, maxNotes)),
+      maxNumNotes (jmax (1, maxNotes)),
+      changeQueue (jmax (16, changeQueueSize) + 1),   // an AbstractFifo holds one item less than its size
+      changes ((size_t) jmax (16, changeQueueSize) + 1)
+{
+    jassert (maxNotes > 0 && maxNotes <= 16 * 128);
+
+    std::fill_n (lastPressureLowerBitReceivedOnChannel, 16, RealtimeMPEInstrumentHelpers::noLSBValueReceived);
+    std::fill_n (lastTimbreLowerBitReceivedOnChannel, 16, RealtimeMPEInstrumentHelpers::noLSBValueReceived);
+    std::fill_n (isMemberChannelSustained, 16, false);
+
+    pitchbendDimension.value = &MPENote::pitchbend;
+    pressureDimension.value = &MPENote::pressure;
+    timbreDimension.value = &MPENote::timbre;
+
+    pitchbendDimension.changeType = ChangeType::pitchbend;
+    pressureDimension.changeType = ChangeType::pressure;
+    timbreDimension.changeType = ChangeType::timbre;
+
+    // the default value for pressure is 0, for all other dimension it is centre (= default MPEValue)
+    std::fill_n (pressureDimension.lastValueReceivedOnChannel, 16, MPEValue::minValue());
+
+    clearNotes();
+}
+
+RealtimeMPEInstrument::~RealtimeMPEInstrument()
+{
+}
+
+//==============================================================================
+MPEZoneLayout RealtimeMPEInstrument::getZoneLayout() const noexcept
+{
+    return zoneLayout;
+}
+
+void RealtimeMPEInstrument::setZoneLayout (MPEZoneLayout newLayout)
+{
+    releaseAllNotes();
+
+    legacyMode.isEnabled = false;
+    zoneLayout = newLayout;
+}
+
+void RealtimeMPEInstrument::enableLegacyMode (int pitchbendRange, Range<int> channelRange)
+{
+    releaseAllNotes();
+
+    legacyMode.isEnabled = true;
+    legacyMode.pitchbendRange = pitchbendRange;
+    legacyMode.channelRange = channelRange;
+    zoneLayout.clearAllZones();
+}
+
+void RealtimeMPEInstrument::setLegacyModeChannelRange (Range<int> channelRange)
+{
+    jassert (Range<int> (1, 17).contains (channelRange));
+
+    releaseAllNotes();
+    legacyMode.channelRange = channelRange;
+}
+
+void RealtimeMPEInstrument::setLegacyModePitchbendRange (int pitchbendRange)
+{
+    jassert (pitchbendRange >= 0 && pitchbendRange <= 96);
+
+    releaseAllNotes();
+    legacyMode.pitchbendRange = pitchbendRange;
+}
+
+void RealtimeMPEInstrument::setPressureTrackingMode (TrackingMode modeToUse) noexcept   { pressureDimension.trackingMode = modeToUse; }
+void RealtimeMPEInstrument::setPitchbendTrackingMode (TrackingMode modeToUse) noexcept  { pitchbendDimension.trackingMode = modeToUse; }
+void RealtimeMPEInstrument::setTimbreTrackingMode (TrackingMode modeToUse) noexcept     { timbreDimension.trackingMode = modeToUse; }
+
+//==============================================================================
+bool RealtimeMPEInstrument::isMemberChannel (int midiChannel) const noexcept
+{
+    if (legacyMode.isEnabled)
+        return legacyMode.channelRange.contains (midiChannel);
+
+    return zoneLayout.getLowerZone().isUsingChannelAsMemberChannel (midiChannel)
+            || zoneLayout.getUpperZone().isUsingChannelAsMemberChannel (midiChannel);
+}
+
+bool RealtimeMPEInstrument::isMasterChannel (int midiChannel) const noexcept
+{
+    if (legacyMode.isEnabled)
+        return false;
+
+    const auto lowerZone = zoneLayout.getLowerZone();
+    const auto upperZone = zoneLayout.getUpperZone();
+
+    return (lowerZone.isActive() && midiChannel == lowerZone.getMasterChannel())
+            || (upperZone.isActive() && midiChannel == upperZone.getMasterChannel());
+}
+
+bool RealtimeMPEInstrument::isUsingChannel (int midiChannel) const noexcept
+{
+    if (legacyMode.isEnabled)
+        return legacyMode.channelRange.contains (midiChannel);
+
+    return zoneLayout.getLowerZone().isUsing (midiChannel)
+            || zoneLayout.getUpperZone().isUsing (midiChannel);
+}
+
+//==============================================================================
+void RealtimeMPEInstrument::addListener (Listener* listenerToAdd)
+{
+    listeners.add (listenerToAdd);
+    numListeners = listeners.size();
+}
+
+void RealtimeMPEInstrument::removeListener (Listener* listenerToRemove)
+{
+    listeners.remove (listenerToRemove);
+    numListeners = listeners.size();
+}
+
+void RealtimeMPEInstrument::setRealtimeListener (Listener* newListener) noexcept
+{
+    realtimeListener = newListener;
+}
+
+int RealtimeMPEInstrument::getNumPendingChanges() const noexcept
+{
+    return changeQueue.getNumReady();
+}
+
+void RealtimeMPEInstrument::postChange (ChangeType type, const MPENote& note) noexcept
+{
+    if (auto* l = realtimeListener)
+    {
+        switch (type)
+        {
+            case ChangeType::added:      l->noteAdded (note); break;
+            case ChangeType::pressure:   l->notePressureChanged (note); break;
+            case ChangeType::pitchbend:  l->notePitchbendChanged (note); break;
+            case ChangeType::timbre:     l->noteTimbreChanged (note); break;
+            case ChangeType::keyState:   l->noteKeyStateChanged (note); break;
+            case ChangeType::released:   l->noteReleased (note); break;
+            default:                     break;
+        }
+    }
+
+    if (numListeners.load() == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    changeQueue.prepareToWrite (1, start1, size1, start2, size2);
+
+    if (size1 == 0)
+    {
+        ++numDroppedChanges;
+        return;
+    }
+
+    changes[start1] = { type, note };
+    changeQueue.finishedWrite (1);
+}
+
+void RealtimeMPEInstrument::dispatchPendingChanges()
+{
+    int start1, size1, start2, size2;
+    changeQueue.prepareToRead (changeQueue.getNumReady(), start1, size1, start2, size2);
+
+    auto dispatch = [this] (int start, int num)
+    {
+        for (int i = start; i < start + num; ++i)
+        {
+            auto note = changes[i].note;
+
+            switch (changes[i].type)
+            {
+                case ChangeType::added:      listeners.call ([&] (Listener& l) { l.noteAdded (note); }); break;
+                case ChangeType::pressure:   listeners.call ([&] (Listener& l) { l.notePressureChanged (note); }); break;
+                case ChangeType::pitchbend:  listeners.call ([&] (Listener& l) { l.notePitchbendChanged (note); }); break;
+                case ChangeType::timbre:     listeners.call ([&] (Listener& l) { l.noteTimbreChanged (note); }); break;
+                case ChangeType::keyState:   listeners.call ([&] (Listener& l) { l.noteKeyStateChanged (note); }); break;
+                case ChangeType::released:   listeners.call ([&] (Listener& l) { l.noteReleased (note); }); break;
+                default:                     break;
+            }
+        }
+    };
+
+    dispatch (start1, size1);
+    dispatch (start2, size2);
+    changeQueue.finishedRead (size1 + size2);
+}
+
+//==============================================================================
+void RealtimeMPEInstrument::clearNotes() noexcept
+{
+    for (int i = 0; i < maxNumNotes; ++i)
+        slots[i].next = (i + 1 < maxNumNotes ? i + 1 : -1);
+
+    firstFreeSlot = 0;
+    firstNote = lastNote = -1;
+    numNotes = 0;
+
+    std::fill_n (firstOnChannel, 16, -1);
+    std::fill_n (lastOnChannel, 16, -1);
+    std::fill_n (&slotForNote[0][0], 16 * 128, (int16) -1);
+}
+
+int RealtimeMPEInstrument::addNote (const MPENote& note) noexcept
+{
+    if (firstFreeSlot < 0)
+        releaseNote (firstNote, MPEValue::from7BitInt (64));
+
+    auto index = firstFreeSlot;
+    auto& slot = slots[index];
+    firstFreeSlot = slot.next;
+
+    auto channel = note.midiChannel - 1;
+
+    slot.note = note;
+    slot.prev = lastNote;
+    slot.next = -1;
+    slot.prevOnChannel = lastOnChannel[channel];
+    slot.nextOnChannel = -1;
+
+    if (lastNote >= 0)  slots[lastNote].next = index;
+    else                firstNote = index;
+
+    if (lastOnChannel[channel] >= 0)  slots[lastOnChannel[channel]].nextOnChannel = index;
+    else                              firstOnChannel[channel] = index;
+
+    lastNote = index;
+    lastOnChannel[channel] = index;
+    slotForNote[channel][note.initialNote] = (int16) index;
+    ++numNotes;
+
+    return index;
+}
+
+void RealtimeMPEInstrument::removeNote (int index) noexcept
+{
+    auto& slot = slots[index];
+    auto channel = slot.note.midiChannel - 1;
+
+    if (slot.prev >= 0)  slots[slot.prev].next = slot.next;
+    else                 firstNote = slot.next;
+
+    if (slot.next >= 0)  slots[slot.next].prev = slot.prev;
+    else                 lastNote = slot.prev;
+
+    if (slot.prevOnChannel >= 0)  slots[slot.prevOnChannel].nextOnChannel = slot.nextOnChannel;
+    else                          firstOnChannel[channel] = slot.nextOnChannel;
+
+    if (slot.nextOnChannel >= 0)  slots[slot.nextOnChannel].prevOnChannel = slot.prevOnChannel;
+    else                          lastOnChannel[channel] = slot.prevOnChannel;
+
+    slotForNote[channel][slot.note.initialNote] = -1;
+    slot.next = firstFreeSlot;
+    firstFreeSlot = index;
+    --numNotes;
+}
+
+void RealtimeMPEInstrument::releaseNote (int index, MPEValue noteOffVelocity) noexcept
+{
+    auto& note = slots[index].note;
+    note.keyState = MPENote::off;
+    note.noteOffVelocity = noteOffVelocity;
+    postChange (ChangeType::released, note);
+    removeNote (index);
+}
+
+void RealtimeMPEInstrument::releaseAllNotes() noexcept
+{
+    for (auto i = lastNote; i >= 0;)
+    {
+        auto prev = slots[i].prev;
+        releaseNote (i, MPEValue::from7BitInt (64)); // some reasonable number
+        i = prev;
+    }
+}
+
+//==============================================================================
+int RealtimeMPEInstrument::findNote (int midiChannel, int midiNoteNumber) const noexcept
+{
+    if (! RealtimeMPEInstrumentHelpers::isValidChannelAndNote (midiChannel, midiNoteNumber))
+        return -1;
+
+    return slotForNote[midiChannel - 1][midiNoteNumber];
+}
+
+int RealtimeMPEInstrument::findNote (int midiChannel, TrackingMode mode) const noexcept
+{
+    // for the "all notes" tracking mode, this method can never possibly
+    // work because it returns 0 or 1 note but there might be more than one!
+    jassert (mode != MPEInstrument::allNotesOnChannel);
+
+    if (mode == MPEInstrument::lastNotePlayedOnChannel)  return findLastNotePlayed (midiChannel);
+    if (mode == MPEInstrument::lowestNoteOnChannel)      return findNoteByPitch (midiChannel, std::less<int>());
+    if (mode == MPEInstrument::highestNoteOnChannel)     return findNoteByPitch (midiChannel, std::greater<int>());
+
+    return -1;
+}
+
+int RealtimeMPEInstrument::findLastNotePlayed (int midiChannel) const noexcept
+{
+    if (isPositiveAndBelow (midiChannel - 1, 16))
+        for (auto i = lastOnChannel[midiChannel - 1]; i >= 0; i = slots[i].prevOnChannel)
+            if (RealtimeMPEInstrumentHelpers::isKeyDown (slots[i].note))
+                return i;
+
+    return -1;
+}
+
+template <typename Comparator>
+int RealtimeMPEInstrument::findNoteByPitch (int midiChannel, Comparator isBetter) const noexcept
+{
+    int result = -1;
+
+    if (isPositiveAndBelow (midiChannel - 1, 16))
+    {
+        for (auto i = lastOnChannel[midiChannel - 1]; i >= 0; i = slots[i].prevOnChannel)
+        {
+            auto& note = slots[i].note;
+
+            if (RealtimeMPEInstrumentHelpers::isKeyDown (note)
+                 && (result < 0 || isBetter ((int) note.initialNote, (int) slots[result].note.initialNote)))
+                result = i;
+        }
+    }
+
+    return result;
+}
+
+//==============================================================================
+MPENote RealtimeMPEInstrument::getNote (int index) const noexcept
+{
+    if (isPositiveAndBelow (index, numNotes))
+    {
+        auto i = firstNote;
+
+        while (--index >= 0)
+            i = slots[i].next;
+
+        return slots[i].note;
+    }
+
+    return {};
+}
+
+MPENote RealtimeMPEInstrument::getNote (int midiChannel, int midiNoteNumber) const noexcept
+{
+    auto i = findNote (midiChannel, midiNoteNumber);
+    return i >= 0 ? slots[i].note : MPENote();
+}
+
+MPENote RealtimeMPEInstrument::getMostRecentNote (int midiChannel) const noexcept
+{
+    auto i = findLastNotePlayed (midiChannel);
+    return i >= 0 ? slots[i].note : MPENote();
+}
+
+MPENote RealtimeMPEInstrument::getMostRecentNoteOtherThan (MPENote otherThanThisNote) const noexcept
+{
+    for (auto i = lastNote; i >= 0; i = slots[i].prev)
+        if (slots[i].note != otherThanThisNote)
+            return slots[i].note;
+
+    return {};
+}
+
+//==============================================================================
+void RealtimeMPEInstrument::processNextMidiEvent (const MidiMessage& message)
+{
+    zoneLayout.processNextMidiEvent (message);
+
+    auto channel = message.getChannel();
+
+    if (message.isNoteOn (true))
+    {
+        // a note-on with velocity 0 is a note-off with an unknown velocity, for which
+        // the MPE convention is to use 64
+        if (message.getVelocity() == 0)
+            noteOff (channel, message.getNoteNumber(), MPEValue::from7BitInt (64));
+        else
+            noteOn (channel, message.getNoteNumber(), MPEValue::from7BitInt (message.getVelocity()));
+    }
+    else if (message.isNoteOff (false))
+    {
+        noteOff (channel, message.getNoteNumber(), MPEValue::from7BitInt (message.getVelocity()));
+    }
+    else if (message.isResetAllControllers() || message.isAllNotesOff())
+    {
+        releaseNotesForReset (channel);
+    }
+    else if (message.isPitchWheel())
+    {
+        pitchbend (channel, MPEValue::from14BitInt (message.getPitchWheelValue()));
+    }
+    else if (message.isChannelPressure())
+    {
+        pressure (channel, MPEValue::from7BitInt (message.getChannelPressureValue()));
+    }
+    else if (message.isController())
+    {
+        auto value = message.getControllerValue();
+
+        switch (message.getControllerNumber())
+        {
+            case 64:    sustainPedal   (channel, message.isSustainPedalOn());   break;
+            case 66:    sostenutoPedal (channel, message.isSostenutoPedalOn()); break;
+            case 70:    handleMSB (channel, value, lastPressureLowerBitReceivedOnChannel, pressureDimension); break;
+            case 74:    handleMSB (channel, value, lastTimbreLowerBitReceivedOnChannel, timbreDimension); break;
+            case 102:   lastPressureLowerBitReceivedOnChannel[channel - 1] = (uint8) value; break;
+            case 106:   lastTimbreLowerBitReceivedOnChannel[channel - 1] = (uint8) value; break;
+            default:    break;
+        }
+    }
+    else if (message.isAftertouch())
+    {
+        if (isMasterChannel (channel))
+            polyAftertouch (channel, message.getNoteNumber(), MPEValue::from7BitInt (message.getAfterTouchValue()));
+    }
+}
+
+void RealtimeMPEInstrument::handleMSB (int midiChannel, int value, const uint8* lsbs, MPEDimension& dimension) noexcept
+{
+    auto lsb = lsbs[midiChannel - 1];
+
+    updateDimension (midiChannel, dimension,
+                     lsb == RealtimeMPEInstrumentHelpers::noLSBValueReceived ? MPEValue::from7BitInt (value)
+                                                                             : MPEValue::from14BitInt (lsb + (value << 7)));
+}
+
+void RealtimeMPEInstrument::releaseNotesForReset (int midiChannel) noexcept
+{
+    // in MPE mode, "reset all controllers" is per-zone and expected on the master channel;
+    // in legacy mode, it is per MIDI channel (within the channel range used).
+
+    if (legacyMode.isEnabled && legacyMode.channelRange.contains (midiChannel))
+    {
+        for (auto i = lastOnChannel[midiChannel - 1]; i >= 0;)
+        {
+            auto prev = slots[i].prevOnChannel;
+            releaseNote (i, MPEValue::from7BitInt (64)); // some reasonable number
+            i = prev;
+        }
+    }
+    else if (isMasterChannel (midiChannel))
+    {
+        auto zone = (midiChannel == 1 ? zoneLayout.getLowerZone()
+                                      : zoneLayout.getUpperZone());
+
+        for (auto i = lastNote; i >= 0;)
+        {
+            auto prev = slots[i].prev;
+
+            if (zone.isUsing (slots[i].note.midiChannel))
+                releaseNote (i, MPEValue::from7BitInt (64));
+
+            i = prev;
+        }
+    }
+}
+
+//==============================================================================
+void RealtimeMPEInstrument::noteOn (int midiChannel, int midiNoteNumber, MPEValue midiNoteOnVelocity) noexcept
+{
+    if (! isUsingChannel (midiChannel) || ! isPositiveAndBelow (midiNoteNumber, 128))
+        return;
+
+    MPENote newNote (midiChannel,
+                     midiNoteNumber,
+                     midiNoteOnVelocity,
+                     getInitialValueForNewNote (midiChannel, pitchbendDimension),
+                     getInitialValueForNewNote (midiChannel, pressureDimension),
+                     getInitialValueForNewNote (midiChannel, timbreDimension),
+                     isMemberChannelSustained[midiChannel - 1] ? MPENote::keyDownAndSustained : MPENote::keyDown);
+
+    updateNoteTotalPitchbend (newNote);
+
+    // a second note-on for the same note retriggers it
+    auto alreadyPlaying = findNote (midiChannel, midiNoteNumber);
+
+    if (alreadyPlaying >= 0)
+        releaseNote (alreadyPlaying, MPEValue::from7BitInt (64));
+
+    auto index = addNote (newNote);
+    postChange (ChangeType::added, slots[index].note);
+}
+
+void RealtimeMPEInstrument::noteOff (int midiChannel, int midiNoteNumber, MPEValue midiNoteOffVelocity) noexcept
+{
+    if (numNotes == 0 || ! isUsingChannel (midiChannel))
+        return;
+
+    auto index = findNote (midiChannel, midiNoteNumber);
+
+    if (index < 0)
+        return;
+
+    auto& note = slots[index].note;
+    note.keyState = (note.keyState == MPENote::keyDownAndSustained) ? MPENote::sustained : MPENote::off;
+    note.noteOffVelocity = midiNoteOffVelocity;
+
+    // If no more notes are playing on this channel, reset the dimension values
+    if (findLastNotePlayed (midiChannel) < 0)
+    {
+        pressureDimension.lastValueReceivedOnChannel[midiChannel - 1] = MPEValue::minValue();
+        pitchbendDimension.lastValueReceivedOnChannel[midiChannel - 1] = MPEValue::centreValue();
+        timbreDimension.lastValueReceivedOnChannel[midiChannel - 1] = MPEValue::centreValue();
+    }
+
+    if (note.keyState == MPENote::off)
+    {
+        postChange (ChangeType::released, note);
+        removeNote (index);
+    }
+    else
+    {
+        postChange (ChangeType::keyState, note);
+    }
+}
+
+//==============================================================================
+void RealtimeMPEInstrument::pitchbend (int midiChannel, MPEValue value) noexcept   { updateDimension (midiChannel, pitchbendDimension, value); }
+void RealtimeMPEInstrument::pressure (int midiChannel, MPEValue value) noexcept    { updateDimension (midiChannel, pressureDimension, value); }
+void RealtimeMPEInstrument::timbre (int midiChannel, MPEValue value) noexcept      { updateDimension (midiChannel, timbreDimension, value); }
+
+void RealtimeMPEInstrument::polyAftertouch (int midiChannel, int midiNoteNumber, MPEValue value) noexcept
+{
+    auto index = findNote (midiChannel, midiNoteNumber);
+
+    if (index >= 0)
+    {
+        auto& note = slots[index].note;
+
+        if (pressureDimension.getValue (note) != value)
+        {
+            pressureDimension.getValue (note) = value;
+            postChange (ChangeType::pressure, note);
+        }
+    }
+}
+
+MPEValue RealtimeMPEInstrument::getInitialValueForNewNote (int midiChannel, MPEDimension& dimension) const noexcept
+{
+    if (findLastNotePlayed (midiChannel) >= 0)
+        return &dimension == &pressureDimension ? MPEValue::minValue() : MPEValue::centreValue();
+
+    return dimension.lastValueReceivedOnChannel[midiChannel - 1];
+}
+
+void RealtimeMPEInstrument::updateDimension (int midiChannel, MPEDimension& dimension, MPEValue value) noexcept
+{
+    if (! isPositiveAndBelow (midiChannel - 1, 16))
+        return;
+
+    dimension.lastValueReceivedOnChannel[midiChannel - 1] = value;
+
+    if (numNotes == 0)
+        return;
+
+    if (isMemberChannel (midiChannel))
+    {
+        if (dimension.trackingMode == MPEInstrument::allNotesOnChannel)
+        {
+            for (auto i = lastOnChannel[midiChannel - 1]; i >= 0; i = slots[i].prevOnChannel)
+                updateDimensionForNote (slots[i].note, dimension, value);
+        }
+        else
+        {
+            auto index = findNote (midiChannel, dimension.trackingMode);
+
+            if (index >= 0)
+                updateDimensionForNote (slots[index].note, dimension, value);
+        }
+    }
+    else if (isMasterChannel (midiChannel))
+    {
+        updateDimensionMaster (midiChannel == 1, dimension, value);
+    }
+}
+
+void RealtimeMPEInstrument::updateDimensionMaster (bool isLowerZone, MPEDimension& dimension, MPEValue value) noexcept
+{
+    auto zone = (isLowerZone ? zoneLayout.getLowerZone()
+                             : zoneLayout.getUpperZone());
+
+    if (! zone.isActive())
+        return;
+
+    for (auto i = lastNote; i >= 0; i = slots[i].prev)
+    {
+        auto& note = slots[i].note;
+
+        if (! zone.isUsing (note.midiChannel))
+            continue;
+
+        if (&dimension == &pitchbendDimension)
+        {
+            // master pitchbend is a special case: we don't change the note's own pitchbend,
+            // instead we have to update its total (master + note) pitchbend.
+            updateNoteTotalPitchbend (note);
+            postChange (ChangeType::pitchbend, note);
+        }
+        else if (dimension.getValue (note) != value)
+        {
+            dimension.getValue (note) = value;
+            postChange (dimension.changeType, note);
+        }
+    }
+}
+
+void RealtimeMPEInstrument::updateDimensionForNote (MPENote& note, MPEDimension& dimension, MPEValue value) noexcept
+{
+    if (dimension.getValue (note) != value)
+    {
+        dimension.getValue (note) = value;
+
+        if (&dimension == &pitchbendDimension)
+            updateNoteTotalPitchbend (note);
+
+        postChange (dimension.changeType, note);
+    }
+}
+
+void RealtimeMPEInstrument::updateNoteTotalPitchbend (MPENote& note) noexcept
+{
+    if (legacyMode.isEnabled)
+    {
+        note.totalPitchbendInSemitones = note.pitchbend.asSignedFloat() * legacyMode.pitchbendRange;
+    }
+    else
+    {
+        auto zone = zoneLayout.getLowerZone();
+
+        if (! zone.isUsing (note.midiChannel))
+        {
+            if (zoneLayout.getUpperZone().isUsing (note.midiChannel))
+            {
+                zone = zoneLayout.getUpperZone();
+            }
+            else
+            {
+                // this note doesn't belong to any zone!
+                jassertfalse;
+                return;
+            }
+        }
+
+        auto notePitchbendInSemitones = 0.0f;
+
+        if (zone.isUsingChannelAsMemberChannel (note.midiChannel))
+            notePitchbendInSemitones = note.pitchbend.asSignedFloat() * zone.perNotePitchbendRange;
+
+        auto masterPitchbendInSemitones = pitchbendDimension.lastValueReceivedOnChannel[zone.getMasterChannel() - 1]
+                                                            .asSignedFloat()
+                                          * zone.masterPitchbendRange;
+
+        note.totalPitchbendInSemitones = notePitchbendInSemitones + masterPitchbendInSemitones;
+    }
+}
+
+//==============================================================================
+void RealtimeMPEInstrument::sustainPedal (int midiChannel, bool isDown) noexcept
+{
+    handleSustainOrSostenuto (midiChannel, isDown, false);
+}
+
+void RealtimeMPEInstrument::sostenutoPedal (int midiChannel, bool isDown) noexcept
+{
+    handleSustainOrSostenuto (midiChannel, isDown, true);
+}
+
+void RealtimeMPEInstrument::handleSustainOrSostenuto (int midiChannel, bool isDown, bool isSostenuto) noexcept
+{
+    // in MPE mode, sustain/sostenuto is per-zone and expected on the master channel;
+    // in legacy mode, sustain/sostenuto is per MIDI channel (within the channel range used).
+
+    if (legacyMode.isEnabled ? (! legacyMode.channelRange.contains (midiChannel)) : (! isMasterChannel (midiChannel)))
+        return;
+
+    auto zone = (midiChannel == 1 ? zoneLayout.getLowerZone()
+                                  : zoneLayout.getUpperZone());
+
+    for (auto i = (legacyMode.isEnabled ? lastOnChannel[midiChannel - 1] : lastNote); i >= 0;)
+    {
+        auto& slot = slots[i];
+        auto prev = legacyMode.isEnabled ? slot.prevOnChannel : slot.prev;
+        auto& note = slot.note;
+
+        if (legacyMode.isEnabled || zone.isUsing (note.midiChannel))
+        {
+            if (note.keyState == MPENote::keyDown && isDown)
+                note.keyState = MPENote::keyDownAndSustained;
+            else if (note.keyState == MPENote::sustained && ! isDown)
+                note.keyState = MPENote::off;
+            else if (note.keyState == MPENote::keyDownAndSustained && ! isDown)
+                note.keyState = MPENote::keyDown;
+
+            if (note.keyState == MPENote::off)
+            {
+                postChange (ChangeType::released, note);
+                removeNote (i);
+            }
+            else
+            {
+                postChange (ChangeType::keyState, note);
+            }
+        }
+
+        i = prev;
+    }
+
+    if (! isSostenuto)
+    {
+        if (legacyMode.isEnabled)
+        {
+            isMemberChannelSustained[midiChannel - 1] = isDown;
+        }
+        else
+        {
+            if (zone.isLowerZone())
+                for (auto i = zone.getFirstMemberChannel(); i <= zone.getLastMemberChannel(); ++i)
+                    isMemberChannelSustained[i - 1] = isDown;
+            else
+                for (auto i = zone.getFirstMemberChannel(); i >= zone.getLastMemberChannel(); --i)
+                    isMemberChannelSustained[i - 1] = isDown;
+        }
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class RealtimeMPEInstrumentTests  : public UnitTest
+{
+public:
+    RealtimeMPEInstrumentTests()
+        : UnitTest ("RealtimeMPEInstrument class", UnitTestCategories::midi)
+    {}
+
+    void runTest() override
+    {
+        MPEZoneLayout layout;
+        layout.setLowerZone (7);
+        layout.setUpperZone (6);
+
+        beginTest ("Matches MPEInstrument");
+        {
+            for (auto legacy : { false, true })
+            {
+                MPEInstrument reference;
+                RealtimeMPEInstrument test (256, 1 << 16);
+                ChangeRecorder expected, actual;
+
+                reference.addListener (&expected);
+                test.addListener (&actual);
+
+                if (legacy)
+                {
+                    reference.enableLegacyMode (12);
+                    test.enableLegacyMode (12);
+                }
+                else
+                {
+                    reference.setZoneLayout (layout);
+                    test.setZoneLayout (layout);
+                }
+
+                reference.setPitchbendTrackingMode (MPEInstrument::lowestNoteOnChannel);
+                test.setPitchbendTrackingMode (MPEInstrument::lowestNoteOnChannel);
+                reference.setTimbreTrackingMode (MPEInstrument::allNotesOnChannel);
+                test.setTimbreTrackingMode (MPEInstrument::allNotesOnChannel);
+
+                Random random (legacy ? 4321 : 1234);
+
+                for (int i = 0; i < 20000; ++i)
+                {
+                    auto message = createRandomMessage (random);
+                    reference.processNextMidiEvent (message);
+                    test.processNextMidiEvent (message);
+
+                    if ((i & 63) == 0)
+                        test.dispatchPendingChanges();
+                }
+
+                test.dispatchPendingChanges();
+
+                expectEquals (test.getNumDroppedChanges(), (int64) 0);
+                expect (actual.changes.size() > 1000);
+                expect (actual.changes == expected.changes);
+                expectEquals (test.getNumPlayingNotes(), reference.getNumPlayingNotes());
+
+                for (int i = 0; i < reference.getNumPlayingNotes(); ++i)
+                {
+                    auto note = reference.getNote (i);
+                    expect (ChangeRecorder::describe (test.getNote (i)) == ChangeRecorder::describe (note));
+                    expect (ChangeRecorder::describe (test.getNote (note.midiChannel, note.initialNote)) == ChangeRecorder::describe (note));
+                    expect (ChangeRecorder::describe (test.getMostRecentNote (note.midiChannel))
+                             == ChangeRecorder::describe (reference.getMostRecentNote (note.midiChannel)));
+                }
+            }
+        }
+
+        beginTest ("Changes are dispatched later");
+        {
+            RealtimeMPEInstrument test (4, 16);
+            ChangeRecorder deferred, realtime;
+            test.addListener (&deferred);
+            test.setRealtimeListener (&realtime);
+            test.setZoneLayout (layout);
+
+            test.noteOn (2, 60, MPEValue::from7BitInt (100));
+            test.pressure (2, MPEValue::from7BitInt (50));
+
+            expectEquals (realtime.changes.size(), 2);
+            expectEquals (deferred.changes.size(), 0);
+            expectEquals (test.getNumPendingChanges(), 2);
+
+            test.dispatchPendingChanges();
+            expect (deferred.changes == realtime.changes);
+            expectEquals (test.getNumPendingChanges(), 0);
+
+            for (int i = 0; i < 20; ++i)
+                test.pressure (2, MPEValue::from7BitInt (i));
+
+            expectEquals (test.getNumDroppedChanges(), (int64) 4);
+        }
+
+        beginTest ("Oldest note is released when full");
+        {
+            RealtimeMPEInstrument test (4);
+            test.setZoneLayout (layout);
+
+            for (int i = 0; i < 6; ++i)
+                test.noteOn (2 + i, 60, MPEValue::from7BitInt (100));
+
+            expectEquals (test.getNumPlayingNotes(), 4);
+            expect (! test.getNote (2, 60).isValid());
+            expect (! test.getNote (3, 60).isValid());
+            expect (test.getNote (4, 60).isValid());
+            expectEquals ((int) test.getNote (3).midiChannel, 7);
+
+            test.releaseAllNotes();
+            expectEquals (test.getNumPlayingNotes(), 0);
+        }
+
+        beginTest ("Performance");
+        {
+            MPEInstrument reference;
+            RealtimeMPEInstrument test;
+            reference.setZoneLayout (layout);
+            test.setZoneLayout (layout);
+
+            // hold 8 notes on each member channel, then send lots of expression changes
+            Array<MidiMessage> messages;
+
+            for (int channel = 2; channel <= 14; ++channel)
+                for (int note = 0; note < 8; ++note)
+                    messages.add (MidiMessage::noteOn (channel, 40 + note * 3, (uint8) 100));
+
+            Random random (99);
+
+            for (int i = 0; i < 200000; ++i)
+            {
+                auto channel = 2 + random.nextInt (13);
+
+                switch (random.nextInt (3))
+                {
+                    case 0:   messages.add (MidiMessage::pitchWheel (channel, random.nextInt (16384))); break;
+                    case 1:   messages.add (MidiMessage::channelPressureChange (channel, random.nextInt (128))); break;
+                    default:  messages.add (MidiMessage::controllerEvent (channel, 74, random.nextInt (128))); break;
+                }
+            }
+
+            auto timeProcessing = [&] (std::function<void (const MidiMessage&)> process)
+            {
+                auto start = Time::getHighResolutionTicks();
+
+                for (auto& m : messages)
+                    process (m);
+
+                return Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) * 1000.0;
+            };
+
+            auto referenceTime = timeProcessing ([&] (const MidiMessage& m) { reference.processNextMidiEvent (m); });
+            auto testTime      = timeProcessing ([&] (const MidiMessage& m) { test.processNextMidiEvent (m); });
+
+            expectEquals (test.getNumPlayingNotes(), reference.getNumPlayingNotes());
+
+            logMessage ("Processing " + String (messages.size()) + " messages with "
+                         + String (test.getNumPlayingNotes()) + " notes playing: MPEInstrument "
+                         + String (referenceTime, 1) + " ms, RealtimeMPEInstrument " + String (testTime, 1) + " ms");
+        }
+    }
+
+private:
+    //==============================================================================
+    struct ChangeRecorder  : public MPEInstrument::Listener
+    {
+        static String describe (const MPENote& note)
+        {
+            if (! note.isValid())
+                return "invalid";
+
+            return String (note.midiChannel) + "/" + String (note.initialNote)
+                    + " v" + String (note.noteOnVelocity.as7BitInt())
+                    + " o" + String (note.noteOffVelocity.as7BitInt())
+                    + " p" + String (note.pitchbend.as14BitInt())
+                    + " t" + String (note.totalPitchbendInSemitones, 3)
+                    + " z" + String (note.pressure.as14BitInt())
+                    + " y" + String (note.timbre.as14BitInt())
+                    + " k" + String ((int) note.keyState);
+        }
+
+        void noteAdded (MPENote note) override              { changes.add ("added " + describe (note)); }
+        void notePressureChanged (MPENote note) override    { changes.add ("pressure " + describe (note)); }
+        void notePitchbendChanged (MPENote note) override   { changes.add ("pitchbend " + describe (note)); }
+        void noteTimbreChanged (MPENote note) override      { changes.add ("timbre " + describe (note)); }
+        void noteKeyStateChanged (MPENote note) override    { changes.add ("keyState " + describe (note)); }
+        void noteReleased (MPENote note) override           { changes.add ("released " + describe (note)); }
+
+        StringArray changes;
+    };
+
+    static MidiMessage createRandomMessage (Random& random)
+    {
+        auto channel = 1 + random.nextInt (16);
+        auto note = 58 + random.nextInt (6);
+
+        switch (random.nextInt (12))
+        {
+            case 0:
+            case 1:
+            case 2:   return MidiMessage::noteOn (channel, note, (uint8) random.nextInt (128));
+            case 3:
+            case 4:   return MidiMessage::noteOff (channel, note, (uint8) random.nextInt (128));
+            case 5:   return MidiMessage::pitchWheel (channel, random.nextInt (16384));
+            case 6:   return MidiMessage::channelPressureChange (channel, random.nextInt (128));
+            case 7:   return MidiMessage::controllerEvent (channel, random.nextBool() ? 74 : 106, random.nextInt (128));
+            case 8:   return MidiMessage::controllerEvent (channel, random.nextBool() ? 70 : 102, random.nextInt (128));
+            case 9:   return MidiMessage::controllerEvent (channel, random.nextBool() ? 64 : 66, random.nextBool() ? 127 : 0);
+            case 10:  return MidiMessage::aftertouchChange (channel, note, random.nextInt (128));
+            default:  return random.nextInt (20) == 0 ? MidiMessage::allControllersOff (channel)
+                                                      : MidiMessage::pitchWheel (channel, random.nextInt (16384));
+        }
+    }
+};
+
+static RealtimeMPEInstrumentTests realtimeMPEInstrumentUnitTests;
+
+#endif
+
+} // namespace juce
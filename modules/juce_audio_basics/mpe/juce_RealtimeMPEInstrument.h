@@ -0,0 +1,290 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An MPE instrument which can be driven from the audio thread.
+
+    This implements the same note and channel management as MPEInstrument, but
+    without a lock, and without allocating memory once it has been constructed.
+    The playing notes are indexed by channel and note number, so finding the note(s)
+    that a message applies to doesn't involve searching through all the notes.
+
+    All the methods which change the instrument's state must be called from a single
+    thread (usually the audio thread). The exceptions are the listener methods:
+    the changes to the notes are queued, and the listeners are only called when
+    dispatchPendingChanges() is called, which should be done regularly on some other
+    thread, e.g. from a Timer on the message thread. If the queue fills up because
+    the changes aren't being dispatched quickly enough, the newest changes are
+    discarded.
+
+    If you need to react to changes on the audio thread, a single realtime listener
+    can be set with setRealtimeListener(), which will be called synchronously.
+
+    The instrument has a fixed maximum number of notes. If a note-on arrives when
+    that many notes are playing, the oldest note is released to make room for it.
+
+    @see MPEInstrument, MPENote, MPEZoneLayout
+
+    @tags{Audio}
+*/
+class JUCE_API  RealtimeMPEInstrument
+{
+public:
+    //==============================================================================
+    /** Creates an instrument which can play up to maxNumNotes notes at once, and
+        queue up to changeQueueSize changes for its listeners.
+
+        Like MPEInstrument, it starts with inactive lower and upper zones.
+    */
+    RealtimeMPEInstrument (int maxNumNotes = 256, int changeQueueSize = 1024);
+
+    /** Destructor. */
+    ~RealtimeMPEInstrument();
+
+    //==============================================================================
+    /** Returns the current zone layout of the instrument. */
+    MPEZoneLayout getZoneLayout() const noexcept;
+
+    /** Re-sets the zone layout of the instrument. This will release all the
+        currently playing notes and disable legacy mode.
+    */
+    void setZoneLayout (MPEZoneLayout newLayout);
+
+    /** Returns true if the given MIDI channel (1-16) is a note channel in any of the
+        instrument's MPE zones, or in the legacy mode channel range.
+    */
+    bool isMemberChannel (int midiChannel) const noexcept;
+
+    /** Returns true if the given MIDI channel (1-16) is an active zone's master channel. */
+    bool isMasterChannel (int midiChannel) const noexcept;
+
+    /** Returns true if the given MIDI channel (1-16) is used by any of the instrument's
+        MPE zones, or is in the legacy mode channel range.
+    */
+    bool isUsingChannel (int midiChannel) const noexcept;
+
+    //==============================================================================
+    using TrackingMode = MPEInstrument::TrackingMode;
+
+    /** Sets the MPE tracking mode for the pressure dimension. @see MPEInstrument::TrackingMode */
+    void setPressureTrackingMode (TrackingMode modeToUse) noexcept;
+
+    /** Sets the MPE tracking mode for the pitchbend dimension. @see MPEInstrument::TrackingMode */
+    void setPitchbendTrackingMode (TrackingMode modeToUse) noexcept;
+
+    /** Sets the MPE tracking mode for the timbre dimension. @see MPEInstrument::TrackingMode */
+    void setTimbreTrackingMode (TrackingMode modeToUse) noexcept;
+
+    //==============================================================================
+    /** Processes a MIDI message, in the same way as MPEInstrument::processNextMidiEvent(). */
+    void processNextMidiEvent (const MidiMessage& message);
+
+    /** Starts a note. @see MPEInstrument::noteOn */
+    void noteOn (int midiChannel, int midiNoteNumber, MPEValue midiNoteOnVelocity) noexcept;
+
+    /** Releases a note. @see MPEInstrument::noteOff */
+    void noteOff (int midiChannel, int midiNoteNumber, MPEValue midiNoteOffVelocity) noexcept;
+
+    /** Applies a pitchbend to a member or master channel. @see MPEInstrument::pitchbend */
+    void pitchbend (int midiChannel, MPEValue pitchbend) noexcept;
+
+    /** Applies a pressure change to a member or master channel. @see MPEInstrument::pressure */
+    void pressure (int midiChannel, MPEValue value) noexcept;
+
+    /** Applies a timbre change to a member or master channel. @see MPEInstrument::timbre */
+    void timbre (int midiChannel, MPEValue value) noexcept;
+
+    /** Applies a poly-aftertouch change to a note. @see MPEInstrument::polyAftertouch */
+    void polyAftertouch (int midiChannel, int midiNoteNumber, MPEValue value) noexcept;
+
+    /** Presses or releases the sustain pedal. @see MPEInstrument::sustainPedal */
+    void sustainPedal (int midiChannel, bool isDown) noexcept;
+
+    /** Presses or releases the sostenuto pedal. @see MPEInstrument::sostenutoPedal */
+    void sostenutoPedal (int midiChannel, bool isDown) noexcept;
+
+    /** Releases all the currently playing notes. */
+    void releaseAllNotes() noexcept;
+
+    //==============================================================================
+    /** Returns the number of notes that are playing. */
+    int getNumPlayingNotes() const noexcept                 { return numNotes; }
+
+    /** Returns the maximum number of notes that can play at once. */
+    int getMaximumNumNotes() const noexcept                 { return maxNumNotes; }
+
+    /** Returns the note at the given index, where the most recently added note is the
+        last one. This has to step through the notes, so use the other methods where
+        possible.
+    */
+    MPENote getNote (int index) const noexcept;
+
+    /** Returns the note that is playing on the given channel with the given initial
+        note number, or an invalid MPENote if there isn't one.
+    */
+    MPENote getNote (int midiChannel, int midiNoteNumber) const noexcept;
+
+    /** Returns the most recent note that is held down on the given channel, or an
+        invalid MPENote if there isn't one.
+    */
+    MPENote getMostRecentNote (int midiChannel) const noexcept;
+
+    /** Returns the most recent note other than the one passed in, or an invalid
+        MPENote if there isn't one.
+    */
+    MPENote getMostRecentNoteOtherThan (MPENote otherThanThisNote) const noexcept;
+
+    //==============================================================================
+    using Listener = MPEInstrument::Listener;
+
+    /** Adds a listener, which will be called from dispatchPendingChanges().
+        Listeners must be added and removed on the same thread that calls
+        dispatchPendingChanges().
+    */
+    void addListener (Listener* listenerToAdd);
+
+    /** Removes a listener. */
+    void removeListener (Listener* listenerToRemove);
+
+    /** Calls the listeners for all the changes that have been queued since the last
+        call. This mustn't be called on the thread that is driving the instrument.
+    */
+    void dispatchPendingChanges();
+
+    /** Returns the number of changes waiting to be dispatched. */
+    int getNumPendingChanges() const noexcept;
+
+    /** Returns the number of changes that were discarded because the queue was full. */
+    int64 getNumDroppedChanges() const noexcept             { return numDroppedChanges.load(); }
+
+    /** Sets a listener which is called synchronously, on the thread that is driving the
+        instrument, whenever a note changes. Pass nullptr to remove it.
+    */
+    void setRealtimeListener (Listener* newListener) noexcept;
+
+    //==============================================================================
+    /** Puts the instrument into legacy mode, releasing any playing notes.
+        @see MPEInstrument::enableLegacyMode
+    */
+    void enableLegacyMode (int pitchbendRange = 2,
+                           Range<int> channelRange = Range<int> (1, 17));
+
+    /** Returns true if the instrument is in legacy mode. */
+    bool isLegacyModeEnabled() const noexcept               { return legacyMode.isEnabled; }
+
+    /** Returns the range of MIDI channels (1-16) to be used for notes when in legacy mode. */
+    Range<int> getLegacyModeChannelRange() const noexcept   { return legacyMode.channelRange; }
+
+    /** Re-sets the range of MIDI channels (1-16) to be used for notes when in legacy mode. */
+    void setLegacyModeChannelRange (Range<int> channelRange);
+
+    /** Returns the pitchbend range in semitones (0-96) to be used for notes when in legacy mode. */
+    int getLegacyModePitchbendRange() const noexcept        { return legacyMode.pitchbendRange; }
+
+    /** Re-sets the pitchbend range in semitones (0-96) to be used for notes when in legacy mode. */
+    void setLegacyModePitchbendRange (int pitchbendRange);
+
+private:
+    //==============================================================================
+    enum class ChangeType : uint8
+    {
+        added, pressure, pitchbend, timbre, keyState, released
+    };
+
+    struct Change
+    {
+        ChangeType type;
+        MPENote note;
+    };
+
+    // The playing notes are held in fixed slots, which are linked into a list of all
+    // the notes in the order they were added, and a list for each channel.
+    struct Slot
+    {
+        MPENote note;
+        int prev, next, prevOnChannel, nextOnChannel;
+    };
+
+    struct LegacyMode
+    {
+        bool isEnabled = false;
+        Range<int> channelRange { 1, 17 };
+        int pitchbendRange = 2;
+    };
+
+    struct MPEDimension
+    {
+        TrackingMode trackingMode = MPEInstrument::lastNotePlayedOnChannel;
+        MPEValue lastValueReceivedOnChannel[16];
+        MPEValue MPENote::* value;
+        ChangeType changeType;
+        MPEValue& getValue (MPENote& note) noexcept   { return note.*(value); }
+    };
+
+    HeapBlock<Slot> slots;
+    int maxNumNotes, numNotes = 0;
+    int firstNote = -1, lastNote = -1, firstFreeSlot = 0;
+    int firstOnChannel[16], lastOnChannel[16];
+    int16 slotForNote[16][128];
+
+    MPEZoneLayout zoneLayout;
+    LegacyMode legacyMode;
+    MPEDimension pitchbendDimension, pressureDimension, timbreDimension;
+    uint8 lastPressureLowerBitReceivedOnChannel[16];
+    uint8 lastTimbreLowerBitReceivedOnChannel[16];
+    bool isMemberChannelSustained[16];
+
+    AbstractFifo changeQueue;
+    HeapBlock<Change> changes;
+    std::atomic<int> numListeners { 0 };
+    std::atomic<int64> numDroppedChanges { 0 };
+    ListenerList<Listener> listeners;
+    Listener* realtimeListener = nullptr;
+
+    void postChange (ChangeType, const MPENote&) noexcept;
+    void clearNotes() noexcept;
+    int addNote (const MPENote&) noexcept;
+    void removeNote (int slot) noexcept;
+    void releaseNote (int slot, MPEValue noteOffVelocity) noexcept;
+    int findNote (int midiChannel, int midiNoteNumber) const noexcept;
+    int findNote (int midiChannel, TrackingMode) const noexcept;
+    int findLastNotePlayed (int midiChannel) const noexcept;
+    template <typename Comparator>
+    int findNoteByPitch (int midiChannel, Comparator) const noexcept;
+
+    void updateDimension (int midiChannel, MPEDimension&, MPEValue) noexcept;
+    void updateDimensionMaster (bool isLowerZone, MPEDimension&, MPEValue) noexcept;
+    void updateDimensionForNote (MPENote&, MPEDimension&, MPEValue) noexcept;
+    MPEValue getInitialValueForNewNote (int midiChannel, MPEDimension&) const noexcept;
+    void updateNoteTotalPitchbend (MPENote&) noexcept;
+    void releaseNotesForReset (int midiChannel) noexcept;
+    void handleSustainOrSostenuto (int midiChannel, bool isDown, bool isSostenuto) noexcept;
+    void handleMSB (int midiChannel, int value, const uint8* lsbs, MPEDimension&) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeMPEInstrument)
+};
+
+} // namespace juce
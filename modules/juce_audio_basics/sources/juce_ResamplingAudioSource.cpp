@@ -51,6 +51,7 @@ void ResamplingAudioSource::prepareToPlay (int samplesPerBlockExpected, double s
     input->prepareToPlay (scaledBlockSize, sampleRate * ratio);
 
     buffer.setSize (numChannels, scaledBlockSize + 32);
+    sincBuffer.setSize (numChannels, scaledBlockSize + WindowedSincKernel::numTaps + 32);
 
     filterStates.calloc (numChannels);
     srcBuffers.calloc (numChannels);
@@ -69,12 +70,28 @@ void ResamplingAudioSource::flushBuffers()
     sampsInBuffer = 0;
     subSampleOffset = 0.0;
     resetFilters();
+    resetSincBuffer();
+}
+
+void ResamplingAudioSource::setInterpolation (Interpolation newInterpolation)
+{
+    if (newInterpolation == Interpolation::sinc)
+        WindowedSincKernel::prepareTables();
+
+    const ScopedLock sl (callbackLock);
+
+    if (interpolation != newInterpolation)
+    {
+        interpolation = newInterpolation;
+        flushBuffers();
+    }
 }
 
 void ResamplingAudioSource::releaseResources()
 {
     input->releaseResources();
     buffer.setSize (numChannels, 0);
+    sincBuffer.setSize (numChannels, 0);
 }
 
 void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& info)
@@ -88,6 +105,12 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
         localRatio = ratio;
     }
 
+    if (interpolation == Interpolation::sinc)
+    {
+        getNextSincBlock (info, localRatio);
+        return;
+    }
+
     if (lastRatio != localRatio)
     {
         createLowPass (localRatio);
@@ -195,6 +218,82 @@ void ResamplingAudioSource::getNextAudioBlock (const AudioSourceChannelInfo& inf
     jassert (sampsInBuffer >= 0);
 }
 
+//==============================================================================
+void ResamplingAudioSource::resetSincBuffer()
+{
+    // the buffer starts with enough silence to fill the interpolator's history
+    sincBuffer.clear();
+    numSincSamplesBuffered = WindowedSincKernel::numBefore;
+    sincPosition = WindowedSincKernel::numBefore;
+    lastSincRatio = 0;
+}
+
+void ResamplingAudioSource::getNextSincBlock (const AudioSourceChannelInfo& info, double targetRatio)
+{
+    // the ratio is ramped from the one used at the end of the last block
+    auto startRatio = lastSincRatio > 0 ? lastSincRatio : targetRatio;
+    auto ratioStep = (targetRatio - startRatio) / jmax (1, info.numSamples);
+    lastSincRatio = targetRatio;
+
+    auto kernel = WindowedSincKernel::forRatio (jmax (startRatio, targetRatio));
+
+    auto lastPosition = sincPosition + info.numSamples * 0.5 * (startRatio + targetRatio);
+    auto samplesNeeded = (int) lastPosition + WindowedSincKernel::numAfter + 2;
+
+    if (sincBuffer.getNumSamples() < samplesNeeded)
+        sincBuffer.setSize (numChannels, samplesNeeded + 32, true, true);
+
+    if (samplesNeeded > numSincSamplesBuffered)
+    {
+        AudioSourceChannelInfo readInfo (&sincBuffer, numSincSamplesBuffered, samplesNeeded - numSincSamplesBuffered);
+        input->getNextAudioBlock (readInfo);
+        numSincSamplesBuffered = samplesNeeded;
+    }
+
+    auto channelsToProcess = jmin (numChannels, info.buffer->getNumChannels());
+
+    for (int channel = 0; channel < channelsToProcess; ++channel)
+    {
+        destBuffers[channel] = info.buffer->getWritePointer (channel, info.startSample);
+        srcBuffers[channel] = sincBuffer.getReadPointer (channel);
+    }
+
+    auto position = sincPosition;
+    auto currentRatio = startRatio;
+
+    for (int i = 0; i < info.numSamples; ++i)
+    {
+        auto index = (int) position;
+        auto alpha = (float) (position - index);
+
+        for (int channel = 0; channel < channelsToProcess; ++channel)
+            destBuffers[channel][i] = kernel.interpolate (srcBuffers[channel] + index, alpha);
+
+        position += currentRatio;
+        currentRatio += ratioStep;
+    }
+
+    // discard the samples that are no longer needed for the interpolator's history
+    auto numToDiscard = jmin ((int) position - WindowedSincKernel::numBefore, numSincSamplesBuffered);
+
+    if (numToDiscard > 0)
+    {
+        auto numToKeep = numSincSamplesBuffered - numToDiscard;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            auto* data = sincBuffer.getWritePointer (channel);
+            memmove (data, data + numToDiscard, sizeof (float) * (size_t) numToKeep);
+        }
+
+        numSincSamplesBuffered = numToKeep;
+        position -= numToDiscard;
+    }
+
+    sincPosition = position;
+}
+
+//==============================================================================
 void ResamplingAudioSource::createLowPass (const double frequencyRatio)
 {
     const double proportionalRate = (frequencyRatio > 1.0) ? 0.5 / frequencyRatio
@@ -262,4 +361,158 @@ void ResamplingAudioSource::applyFilter (float* samples, int num, FilterState& f
     }
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class ResamplingAudioSourceTests  : public UnitTest
+{
+public:
+    ResamplingAudioSourceTests()
+        : UnitTest ("ResamplingAudioSource", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        using Interpolation = ResamplingAudioSource::Interpolation;
+
+        beginTest ("Sinc interpolation reproduces a sine wave");
+        {
+            for (auto ratio : { 0.6, 1.0, 1.5, 3.1 })
+            {
+                const double frequency = 0.05;
+                auto output = render (Interpolation::sinc, frequency, ratio, 4096, 256);
+                float maxError = 0;
+
+                for (int i = 64; i < output.getNumSamples(); ++i)
+                {
+                    auto expected = (float) std::sin (MathConstants<double>::twoPi * frequency * ratio * i);
+
+                    for (int channel = 0; channel < output.getNumChannels(); ++channel)
+                        maxError = jmax (maxError, std::abs (output.getSample (channel, i) - expected));
+                }
+
+                expect (maxError < 0.002f, "ratio " + String (ratio) + ": error " + String (maxError));
+            }
+        }
+
+        beginTest ("Sinc interpolation removes frequencies above the new Nyquist frequency");
+        {
+            // a sine at 0.4 cycles per sample, played at twice the speed, is above
+            // the output's Nyquist frequency, so it should disappear rather than alias
+            auto linearLevel = Decibels::gainToDecibels (getRMSLevel (render (Interpolation::linear, 0.4, 2.0, 8192, 512)));
+            auto sincLevel   = Decibels::gainToDecibels (getRMSLevel (render (Interpolation::sinc, 0.4, 2.0, 8192, 512)));
+
+            logMessage ("Aliasing at a ratio of 2: linear " + String (linearLevel, 1) + " dB, sinc " + String (sincLevel, 1) + " dB");
+
+            expect (sincLevel < -60.0f);
+            expect (sincLevel < linearLevel - 30.0f);
+        }
+
+        beginTest ("Ratio changes are smoothed");
+        {
+            ResamplingAudioSource source (new SineSource (0.01), true, 1);
+            source.setInterpolation (Interpolation::sinc);
+            source.prepareToPlay (128, 44100.0);
+
+            Random random (7);
+            AudioBuffer<float> block (1, 128);
+            Array<float> output;
+
+            for (int i = 0; i < 100; ++i)
+            {
+                source.setResamplingRatio (random.nextBool() ? 0.8 : 1.25);
+                source.getNextAudioBlock (AudioSourceChannelInfo (block));
+                output.addArray (block.getReadPointer (0), block.getNumSamples());
+            }
+
+            // a step in the ratio would show up as a jump in the slope of the output
+            float maxCurvature = 0;
+
+            for (int i = 64; i < output.size() - 1; ++i)
+                maxCurvature = jmax (maxCurvature, std::abs (output[i + 1] - 2.0f * output[i] + output[i - 1]));
+
+            expect (maxCurvature < 0.01f, "curvature " + String (maxCurvature));
+        }
+
+        beginTest ("Performance");
+        {
+            AudioBuffer<float> noise (2, 44100);
+            Random random (1);
+
+            for (int channel = 0; channel < noise.getNumChannels(); ++channel)
+                for (int i = 0; i < noise.getNumSamples(); ++i)
+                    noise.setSample (channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            for (auto interpolation : { Interpolation::linear, Interpolation::sinc })
+            {
+                const int numSamples = 44100 * 20;
+                auto start = Time::getHighResolutionTicks();
+                render (new MemoryAudioSource (noise, false, true), interpolation, 1.37, numSamples, 512);
+                auto seconds = Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start);
+
+                logMessage (String (interpolation == Interpolation::linear ? "Linear" : "Sinc")
+                             + ": " + String (seconds * 1000.0, 1) + " ms for 20 seconds of stereo audio ("
+                             + String (roundToInt (20.0 / seconds)) + "x realtime)");
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct SineSource  : public AudioSource
+    {
+        SineSource (double cyclesPerSample)  : frequency (cyclesPerSample) {}
+
+        void prepareToPlay (int, double) override {}
+        void releaseResources() override {}
+
+        void getNextAudioBlock (const AudioSourceChannelInfo& info) override
+        {
+            for (int i = 0; i < info.numSamples; ++i)
+            {
+                auto value = (float) std::sin (MathConstants<double>::twoPi * frequency * (double) position++);
+
+                for (int channel = 0; channel < info.buffer->getNumChannels(); ++channel)
+                    info.buffer->setSample (channel, info.startSample + i, value);
+            }
+        }
+
+        double frequency;
+        int64 position = 0;
+    };
+
+    static AudioBuffer<float> render (ResamplingAudioSource::Interpolation interpolation,
+                                      double frequency, double ratio, int numSamples, int blockSize)
+    {
+        return render (new SineSource (frequency), interpolation, ratio, numSamples, blockSize);
+    }
+
+    static AudioBuffer<float> render (AudioSource* input, ResamplingAudioSource::Interpolation interpolation,
+                                      double ratio, int numSamples, int blockSize)
+    {
+        ResamplingAudioSource source (input, true, 2);
+        source.setInterpolation (interpolation);
+        source.setResamplingRatio (ratio);
+        source.prepareToPlay (blockSize, 44100.0);
+
+        AudioBuffer<float> output (2, numSamples);
+
+        for (int start = 0; start < numSamples; start += blockSize)
+            source.getNextAudioBlock (AudioSourceChannelInfo (&output, start, jmin (blockSize, numSamples - start)));
+
+        return output;
+    }
+
+    static float getRMSLevel (const AudioBuffer<float>& buffer)
+    {
+        // skips the start, where the filters are settling
+        return buffer.getRMSLevel (0, 1024, buffer.getNumSamples() - 1024);
+    }
+};
+
+static ResamplingAudioSourceTests resamplingAudioSourceTests;
+
+#endif
+
 } // namespace juce
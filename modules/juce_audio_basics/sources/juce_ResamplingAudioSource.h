@@ -27,7 +27,11 @@ namespace juce
 /**
     A type of AudioSource that takes an input source and changes its sample rate.
 
-    @see AudioSource, LagrangeInterpolator, CatmullRomInterpolator
+    By default, the source uses linear interpolation with a simple anti-aliasing
+    filter, which is cheap but not very accurate. For better quality, a band-limited
+    windowed-sinc interpolator can be selected with setInterpolation().
+
+    @see AudioSource, LagrangeInterpolator, CatmullRomInterpolator, WindowedSincKernel
 
     @tags{Audio}
 */
@@ -68,6 +72,23 @@ public:
     /** Clears any buffers and filters that the resampler is using. */
     void flushBuffers();
 
+    //==============================================================================
+    /** The algorithms that a ResamplingAudioSource can use. */
+    enum class Interpolation
+    {
+        linear,     /**< Linear interpolation, with a two-pole low-pass filter to reduce aliasing. */
+        sinc        /**< 32-point windowed-sinc interpolation. This is band-limited, and changes
+                         to the resampling ratio are ramped smoothly over each block. */
+    };
+
+    /** Selects the interpolation algorithm. The default is Interpolation::linear.
+        Changing it will clear the resampler's buffers.
+    */
+    void setInterpolation (Interpolation newInterpolation);
+
+    /** Returns the interpolation algorithm that is being used. */
+    Interpolation getInterpolation() const noexcept             { return interpolation; }
+
     //==============================================================================
     void prepareToPlay (int samplesPerBlockExpected, double sampleRate) override;
     void releaseResources() override;
@@ -100,6 +121,14 @@ private:
 
     void applyFilter (float* samples, int num, FilterState& fs);
 
+    Interpolation interpolation = Interpolation::linear;
+    AudioBuffer<float> sincBuffer;
+    int numSincSamplesBuffered = 0;
+    double sincPosition = 0, lastSincRatio = 0;
+
+    void resetSincBuffer();
+    void getNextSincBlock (const AudioSourceChannelInfo&, double targetRatio);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResamplingAudioSource)
 };
 
@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/*
+    Used by the default double-precision renderNextBlock() of SynthesiserVoice and
+    MPESynthesiserVoice, which render the voice's single-precision output into a
+    scratch buffer and then add that to the output.
+*/
+struct SinglePrecisionVoiceRenderer
+{
+    // longer blocks are rendered in several pieces of this size
+    enum { maxBlockSize = 1024 };
+
+    // The voices call this when their sample rate is set, so that rendering a stereo
+    // block doesn't have to allocate on the audio thread.
+    static void allocate (AudioBuffer<float>& scratch, int numChannels = 2)
+    {
+        scratch.setSize (numChannels, maxBlockSize, false, false, true);
+    }
+
+    template <typename RenderFunction>
+    static void renderAndAdd (AudioBuffer<float>& scratch, AudioBuffer<double>& output,
+                              int startSample, int numSamples, RenderFunction&& renderFloat)
+    {
+        auto numChannels = output.getNumChannels();
+
+        // This only allocates if the buffer wasn't allocated when the voice's sample rate
+        // was set, or if the output has more channels than it was allocated for.
+        if (numChannels > scratch.getNumChannels() || scratch.getNumSamples() == 0)
+            allocate (scratch, numChannels);
+
+        // Voices add their output to the buffer, so rendering into silence and then adding
+        // the result avoids copying the existing output in and back out again.
+        for (int done = 0; done < numSamples;)
+        {
+            auto numThisTime = jmin (numSamples - done, scratch.getNumSamples());
+            AudioBuffer<float> block (scratch.getArrayOfWritePointers(), numChannels, numThisTime);
+            block.clear();
+
+            renderFloat (block, 0, numThisTime);
+
+            if (! block.hasBeenCleared())
+                for (int ch = 0; ch < numChannels; ++ch)
+                    FloatVectorOperations::add (output.getWritePointer (ch, startSample + done),
+                                                block.getReadPointer (ch), numThisTime);
+
+            done += numThisTime;
+        }
+    }
+};
+
+} // namespace juce
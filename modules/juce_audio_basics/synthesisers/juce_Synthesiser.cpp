@@ -38,6 +38,7 @@ bool SynthesiserVoice::isPlayingChannel (const int midiChannel) const
 void SynthesiserVoice::setCurrentPlaybackSampleRate (const double newRate)
 {
     currentSampleRate = newRate;
+    SinglePrecisionVoiceRenderer::allocate (tempBuffer);
 }
 
 bool SynthesiserVoice::isVoiceActive() const
@@ -50,6 +51,9 @@ void SynthesiserVoice::clearCurrentNote()
     currentlyPlayingNote = -1;
     currentlyPlayingSound = nullptr;
     currentPlayingMidiChannel = 0;
+
+    if (ownerSynth != nullptr)
+        ownerSynth->voiceStopped (this);
 }
 
 void SynthesiserVoice::aftertouchChanged (int) {}
@@ -63,13 +67,28 @@ bool SynthesiserVoice::wasStartedBefore (const SynthesiserVoice& other) const no
 void SynthesiserVoice::renderNextBlock (AudioBuffer<double>& outputBuffer,
                                         int startSample, int numSamples)
 {
-    AudioBuffer<double> subBuffer (outputBuffer.getArrayOfWritePointers(),
-                                   outputBuffer.getNumChannels(),
-                                   startSample, numSamples);
+    if (isVoiceActive())
+        SinglePrecisionVoiceRenderer::renderAndAdd (tempBuffer, outputBuffer, startSample, numSamples,
+                                                    [this] (AudioBuffer<float>& b, int s, int n) { renderNextBlock (b, s, n); });
+}
+
+int SynthesiserVoice::getMaximumBatchSize() const
+{
+    return 1;
+}
+
+void SynthesiserVoice::renderBatch (SynthesiserVoice* const* voicesToRender, int numVoices,
+                                    AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    for (int i = 0; i < numVoices; ++i)
+        voicesToRender[i]->renderNextBlock (outputBuffer, startSample, numSamples);
+}
 
-    tempBuffer.makeCopyOf (subBuffer, true);
-    renderNextBlock (tempBuffer, 0, numSamples);
-    subBuffer.makeCopyOf (tempBuffer, true);
+void SynthesiserVoice::renderBatch (SynthesiserVoice* const* voicesToRender, int numVoices,
+                                    AudioBuffer<double>& outputBuffer, int startSample, int numSamples)
+{
+    for (int i = 0; i < numVoices; ++i)
+        voicesToRender[i]->renderNextBlock (outputBuffer, startSample, numSamples);
 }
 
 //==============================================================================
@@ -81,52 +100,400 @@ Synthesiser::Synthesiser()
 
 Synthesiser::~Synthesiser()
 {
+    deleteRemovedVoicesAndSounds();
+
+    // any changes that never reached the audio thread still own their voices
+    pendingChangeFifo.read (pendingChangeFifo.getNumReady()).forEach ([this] (int index)
+    {
+        auto& change = pendingChanges[index];
+
+        if (change.type == PendingChange::Type::addVoice)
+            delete change.voice;
+
+        change.voice = nullptr;
+        change.sound = nullptr;
+    });
+}
+
+//==============================================================================
+Synthesiser::ScopedRenderingLock::ScopedRenderingLock (const Synthesiser& s)  : owner (s)
+{
+    if (owner.renderingThread == Thread::getCurrentThreadId())
+        return;
+
+    // Once this thread has been counted, any block that starts will take the lock, so it
+    // only has to wait for a block that was already being rendered without it.
+    ++owner.numThreadsNeedingLock;
+
+    while (owner.isRenderingWithoutLock)
+        Thread::yield();
+
+    owner.lock.enter();
+    isLocked = true;
+}
+
+Synthesiser::ScopedRenderingLock::~ScopedRenderingLock()
+{
+    if (isLocked)
+    {
+        owner.lock.exit();
+        --owner.numThreadsNeedingLock;
+    }
 }
 
 //==============================================================================
 SynthesiserVoice* Synthesiser::getVoice (const int index) const
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
     return voices [index];
 }
 
 void Synthesiser::clearVoices()
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
+
+    for (auto* voice : voices)
+        voice->ownerSynth = nullptr;
+
     voices.clear();
+    voiceCount = 0;
+    freeVoices.clear();
+    std::fill (std::begin (voicesOnNote), std::end (voicesOnNote), nullptr);
+
+    // clear() releases the storage that queued additions are relying on
+    voices.ensureStorageAllocated (numReservedVoices);
 }
 
 SynthesiserVoice* Synthesiser::addVoice (SynthesiserVoice* const newVoice)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
     newVoice->setCurrentPlaybackSampleRate (sampleRate);
-    return voices.add (newVoice);
+    reserveVoiceStorage (voices.size() + 1);
+    addToVoiceIndex (newVoice);
+    voices.add (newVoice);
+    voiceCount = voices.size();
+    return newVoice;
 }
 
 void Synthesiser::removeVoice (const int index)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
+
+    if (auto* voice = voices[index])
+        removeFromVoiceIndex (voice);
+
     voices.remove (index);
+    voices.ensureStorageAllocated (numReservedVoices);
+    voiceCount = voices.size();
 }
 
 void Synthesiser::clearSounds()
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
     sounds.clear();
+    sounds.ensureStorageAllocated (numReservedSounds);
+    soundCount = 0;
 }
 
 SynthesiserSound* Synthesiser::addSound (const SynthesiserSound::Ptr& newSound)
 {
-    const ScopedLock sl (lock);
-    return sounds.add (newSound);
+    const ScopedRenderingLock sl (*this);
+    reserveSoundStorage (sounds.size() + 1);
+    sounds.add (newSound);
+    soundCount = sounds.size();
+    return newSound.get();
 }
 
 void Synthesiser::removeSound (const int index)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
     sounds.remove (index);
+    sounds.ensureStorageAllocated (numReservedSounds);
+    soundCount = sounds.size();
+}
+
+//==============================================================================
+bool Synthesiser::addVoiceAsync (SynthesiserVoice* newVoice)
+{
+    jassert (newVoice != nullptr);
+
+    // This is called again when the change is applied, in case the rate changes in the
+    // meantime, but calling it here lets the voice allocate anything it needs on this thread.
+    newVoice->setCurrentPlaybackSampleRate (sampleRate);
+
+    if (postChange (PendingChange::Type::addVoice, newVoice, nullptr))
+        return true;
+
+    delete newVoice;
+    return false;
+}
+
+bool Synthesiser::removeVoiceAsync (SynthesiserVoice* voiceToRemove)
+{
+    return postChange (PendingChange::Type::removeVoice, voiceToRemove, nullptr);
+}
+
+bool Synthesiser::addSoundAsync (const SynthesiserSound::Ptr& newSound)
+{
+    jassert (newSound != nullptr);
+    return postChange (PendingChange::Type::addSound, nullptr, newSound.get());
+}
+
+bool Synthesiser::removeSoundAsync (const SynthesiserSound::Ptr& soundToRemove)
+{
+    return postChange (PendingChange::Type::removeSound, nullptr, soundToRemove.get());
+}
+
+bool Synthesiser::postChange (PendingChange::Type type, SynthesiserVoice* voice, SynthesiserSound* sound)
+{
+    const ScopedLock sl (pendingChangeWriteLock);
+
+    // freeing up the removed objects here means there's always room for the
+    // audio thread to retire everything that's still in the queue
+    deleteRemovedVoicesAndSounds();
+
+    if (pendingChangeFifo.getFreeSpace() == 0)
+        return false;
+
+    // Every change that's still queued might turn out to be an addition, so this is
+    // enough room for applyPendingChanges() to run without allocating. The lock is only
+    // needed on the rare occasions when the lists have to grow. The audio thread updates
+    // the counts before it takes a change off the queue, so reading the queue first means
+    // that a change which is being applied can't be missed.
+    auto numQueued = pendingChangeFifo.getNumReady() + 1;
+
+    if (type == PendingChange::Type::addVoice && voiceCount + numQueued > numReservedVoices)
+    {
+        const ScopedRenderingLock renderLock (*this);
+        reserveVoiceStorage (voices.size() + numQueued);
+    }
+
+    if (type == PendingChange::Type::addSound && soundCount + numQueued > numReservedSounds)
+    {
+        const ScopedRenderingLock renderLock (*this);
+        reserveSoundStorage (sounds.size() + numQueued);
+    }
+
+    pendingChangeFifo.write (1).forEach ([&] (int index)
+    {
+        auto& change = pendingChanges[index];
+        change.type = type;
+        change.voice = voice;
+        change.sound = sound;
+    });
+
+    return true;
+}
+
+void Synthesiser::deleteRemovedVoicesAndSounds()
+{
+    const ScopedLock sl (pendingChangeWriteLock);
+
+    removedObjectFifo.read (removedObjectFifo.getNumReady()).forEach ([this] (int index)
+    {
+        auto& removed = removedObjects[index];
+        delete removed.voice;
+        removed.voice = nullptr;
+        removed.sound = nullptr;
+    });
+}
+
+void Synthesiser::applyPendingChanges()
+{
+    auto numReady = pendingChangeFifo.getNumReady();
+
+    if (numReady == 0)
+        return;
+
+    pendingChangeFifo.read (numReady).forEach ([this] (int index)
+    {
+        auto& change = pendingChanges[index];
+
+        switch (change.type)
+        {
+            // postChange() has already reserved room for these, so adding doesn't allocate
+            case PendingChange::Type::addVoice:
+                change.voice->setCurrentPlaybackSampleRate (sampleRate);
+                addToVoiceIndex (change.voice);
+                voices.add (change.voice);
+                voiceCount = voices.size();
+                break;
+
+            // Removing an item directly could make the array shrink its storage, so
+            // instead the survivors are copied into a spare array of the same capacity,
+            // and the two arrays are swapped.
+            case PendingChange::Type::removeVoice:
+                if (voices.contains (change.voice))
+                {
+                    removeFromVoiceIndex (change.voice);
+
+                    for (auto* voice : voices)
+                        if (voice != change.voice)
+                            spareVoices.add (voice);
+
+                    voices.swapWith (spareVoices);
+                    spareVoices.clearQuick (false);
+                    voiceCount = voices.size();
+                    retireObject (change.voice, nullptr);
+                }
+                break;
+
+            case PendingChange::Type::addSound:
+                sounds.add (change.sound);
+                soundCount = sounds.size();
+                break;
+
+            case PendingChange::Type::removeSound:
+                // the retired entry keeps the sound alive so it's never deleted on this thread
+                retireObject (nullptr, change.sound.get());
+
+                for (auto* sound : sounds)
+                    if (sound != change.sound.get())
+                        spareSounds.add (sound);
+
+                sounds.swapWith (spareSounds);
+                spareSounds.clearQuick();
+                soundCount = sounds.size();
+                break;
+
+            default:
+                jassertfalse;
+                break;
+        }
+
+        change.voice = nullptr;
+        change.sound = nullptr;
+    });
+}
+
+void Synthesiser::reserveVoiceStorage (int numVoices)
+{
+    if (numVoices <= numReservedVoices)
+        return;
+
+    numVoices = jmax (numVoices, numReservedVoices * 2);
+
+    voices.ensureStorageAllocated (numVoices);
+    spareVoices.ensureStorageAllocated (numVoices);
+    batchedVoices.ensureStorageAllocated (numVoices);
+    freeVoices.reserve ((size_t) numVoices);
+    numReservedVoices = numVoices;
+}
+
+void Synthesiser::reserveSoundStorage (int numSounds)
+{
+    if (numSounds <= numReservedSounds)
+        return;
+
+    numSounds = jmax (numSounds, numReservedSounds * 2);
+
+    sounds.ensureStorageAllocated (numSounds);
+    spareSounds.ensureStorageAllocated (numSounds);
+    numReservedSounds = numSounds;
+}
+
+void Synthesiser::retireObject (SynthesiserVoice* voice, SynthesiserSound* sound)
+{
+    if (removedObjectFifo.getFreeSpace() == 0)
+    {
+        jassertfalse; // shouldn't be possible, as postChange() empties this queue before adding to the other one
+        delete voice;
+        return;
+    }
+
+    removedObjectFifo.write (1).forEach ([&] (int index)
+    {
+        auto& removed = removedObjects[index];
+        removed.voice = voice;
+        removed.sound = sound;
+    });
+}
+
+//==============================================================================
+void Synthesiser::addToVoiceIndex (SynthesiserVoice* voice)
+{
+    voice->ownerSynth = this;
+
+    if (voice->getCurrentlyPlayingNote() >= 0)
+        voiceStarted (voice);
+    else
+        voiceStopped (voice);
+}
+
+void Synthesiser::removeFromVoiceIndex (SynthesiserVoice* voice)
+{
+    removeFromNoteIndex (voice);
+    removeFromFreeList (voice);
+    voice->ownerSynth = nullptr;
+}
+
+void Synthesiser::voiceStarted (SynthesiserVoice* voice)
+{
+    removeFromFreeList (voice);
+    removeFromNoteIndex (voice);
+
+    auto note = voice->getCurrentlyPlayingNote();
+
+    if (isPositiveAndBelow (note, numElementsInArray (voicesOnNote)))
+    {
+        voice->indexedNote = note;
+        voice->previousVoiceOnNote = nullptr;
+        voice->nextVoiceOnNote = voicesOnNote[note];
+
+        if (voice->nextVoiceOnNote != nullptr)
+            voice->nextVoiceOnNote->previousVoiceOnNote = voice;
+
+        voicesOnNote[note] = voice;
+    }
+}
+
+void Synthesiser::voiceStopped (SynthesiserVoice* voice)
+{
+    removeFromNoteIndex (voice);
+
+    if (voice->freeListIndex < 0)
+    {
+        voice->freeListIndex = (int) freeVoices.size();
+        freeVoices.push_back (voice);
+    }
+}
+
+void Synthesiser::removeFromNoteIndex (SynthesiserVoice* voice)
+{
+    if (voice->indexedNote < 0)
+        return;
+
+    if (voice->previousVoiceOnNote != nullptr)
+        voice->previousVoiceOnNote->nextVoiceOnNote = voice->nextVoiceOnNote;
+    else
+        voicesOnNote[voice->indexedNote] = voice->nextVoiceOnNote;
+
+    if (voice->nextVoiceOnNote != nullptr)
+        voice->nextVoiceOnNote->previousVoiceOnNote = voice->previousVoiceOnNote;
+
+    voice->previousVoiceOnNote = nullptr;
+    voice->nextVoiceOnNote = nullptr;
+    voice->indexedNote = -1;
 }
 
+void Synthesiser::removeFromFreeList (SynthesiserVoice* voice)
+{
+    auto index = voice->freeListIndex;
+
+    if (index < 0)
+        return;
+
+    jassert (freeVoices[(size_t) index] == voice);
+
+    // unlike Array::removeLast(), pop_back() never gives back storage, so this can't allocate
+    auto* last = freeVoices.back();
+    freeVoices[(size_t) index] = last;
+    last->freeListIndex = index;
+    freeVoices.pop_back();
+    voice->freeListIndex = -1;
+}
+
+//==============================================================================
 void Synthesiser::setNoteStealingEnabled (const bool shouldSteal)
 {
     shouldStealNotes = shouldSteal;
@@ -139,12 +506,24 @@ void Synthesiser::setMinimumRenderingSubdivisionSize (int numSamples, bool shoul
     subBlockSubdivisionIsStrict = shouldBeStrict;
 }
 
+void Synthesiser::setVoiceBatchingEnabled (bool shouldBatchVoices) noexcept
+{
+    batchingEnabled = shouldBatchVoices;
+}
+
+void Synthesiser::prepareBatchRendering (int numChannels, int maximumBlockSize)
+{
+    const ScopedRenderingLock sl (*this);
+    batchBufferFloat .setSize (numChannels, maximumBlockSize, false, false, true);
+    batchBufferDouble.setSize (numChannels, maximumBlockSize, false, false, true);
+}
+
 //==============================================================================
 void Synthesiser::setCurrentPlaybackSampleRate (const double newRate)
 {
     if (sampleRate != newRate)
     {
-        const ScopedLock sl (lock);
+        const ScopedRenderingLock sl (*this);
         allNotesOff (0, false);
         sampleRate = newRate;
 
@@ -161,6 +540,34 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
 {
     // must set the sample rate before using this!
     jassert (sampleRate != 0);
+
+    // The lock is only needed if another thread is waiting for it in a ScopedRenderingLock,
+    // which won't go ahead while isRenderingWithoutLock is set.
+    renderingThread = Thread::getCurrentThreadId();
+    isRenderingWithoutLock = true;
+
+    if (numThreadsNeedingLock > 0)
+    {
+        isRenderingWithoutLock = false;
+
+        const ScopedLock sl (lock);
+        processMidiAndRenderVoices (outputAudio, midiData, startSample, numSamples);
+    }
+    else
+    {
+        processMidiAndRenderVoices (outputAudio, midiData, startSample, numSamples);
+        isRenderingWithoutLock = false;
+    }
+
+    renderingThread = nullptr;
+}
+
+template <typename floatType>
+void Synthesiser::processMidiAndRenderVoices (AudioBuffer<floatType>& outputAudio,
+                                              const MidiBuffer& midiData,
+                                              int startSample,
+                                              int numSamples)
+{
     const int targetChannels = outputAudio.getNumChannels();
 
     MidiBuffer::Iterator midiIterator (midiData);
@@ -170,7 +577,7 @@ void Synthesiser::processNextBlock (AudioBuffer<floatType>& outputAudio,
     int midiEventPos;
     MidiMessage m;
 
-    const ScopedLock sl (lock);
+    applyPendingChanges();
 
     while (numSamples > 0)
     {
@@ -231,16 +638,85 @@ void Synthesiser::renderNextBlock (AudioBuffer<double>& outputAudio, const MidiB
 
 void Synthesiser::renderVoices (AudioBuffer<float>& buffer, int startSample, int numSamples)
 {
+    if (batchingEnabled)
+    {
+        renderVoicesInBatches (buffer, batchBufferFloat, startSample, numSamples);
+        return;
+    }
+
     for (auto* voice : voices)
         voice->renderNextBlock (buffer, startSample, numSamples);
 }
 
 void Synthesiser::renderVoices (AudioBuffer<double>& buffer, int startSample, int numSamples)
 {
+    if (batchingEnabled)
+    {
+        renderVoicesInBatches (buffer, batchBufferDouble, startSample, numSamples);
+        return;
+    }
+
     for (auto* voice : voices)
         voice->renderNextBlock (buffer, startSample, numSamples);
 }
 
+template <typename floatType>
+void Synthesiser::renderVoicesInBatches (AudioBuffer<floatType>& buffer, AudioBuffer<floatType>& scratch,
+                                         int startSample, int numSamples)
+{
+    batchedVoices.clearQuick();
+
+    for (auto* voice : voices)
+    {
+        if (voice->getMaximumBatchSize() <= 1)
+            voice->renderNextBlock (buffer, startSample, numSamples);
+        else if (voice->isVoiceActive())
+            batchedVoices.add (voice);
+    }
+
+    if (batchedVoices.isEmpty())
+        return;
+
+    auto numChannels = buffer.getNumChannels();
+
+    // resizing the scratch buffer here could allocate, so if prepareBatchRendering() wasn't
+    // told about a block this big, the batchable voices are just rendered one at a time
+    if (numChannels > scratch.getNumChannels() || numSamples > scratch.getNumSamples())
+    {
+        for (auto* voice : batchedVoices)
+            voice->renderNextBlock (buffer, startSample, numSamples);
+
+        return;
+    }
+
+    // a view of just the channels that are in use, so voices see the same layout as the output
+    AudioBuffer<floatType> batchBuffer (scratch.getArrayOfWritePointers(), numChannels, numSamples);
+    batchBuffer.clear();
+
+    for (int i = 0; i < batchedVoices.size();)
+    {
+        auto* first = batchedVoices.getUnchecked (i);
+        auto maxBatchSize = first->getMaximumBatchSize();
+        int numInBatch = 1;
+
+        // pull any later voices of the same class forward, so that each batch is contiguous
+        for (int j = i + 1; j < batchedVoices.size() && numInBatch < maxBatchSize; ++j)
+        {
+            if (typeid (*batchedVoices.getUnchecked (j)) == typeid (*first))
+            {
+                batchedVoices.swap (i + numInBatch, j);
+                ++numInBatch;
+            }
+        }
+
+        first->renderBatch (batchedVoices.begin() + i, numInBatch, batchBuffer, 0, numSamples);
+        i += numInBatch;
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch)
+        buffer.addFrom (ch, startSample, batchBuffer, ch, 0, numSamples);
+}
+
 void Synthesiser::handleMidiEvent (const MidiMessage& m)
 {
     const int channel = m.getChannel();
@@ -286,7 +762,7 @@ void Synthesiser::noteOn (const int midiChannel,
                           const int midiNoteNumber,
                           const float velocity)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     for (auto* sound : sounds)
     {
@@ -294,10 +770,16 @@ void Synthesiser::noteOn (const int midiChannel,
         {
             // If hitting a note that's still ringing, stop it first (it could be
             // still playing because of the sustain or sostenuto pedal).
-            for (auto* voice : voices)
+            for (auto* voice = voicesOnNote[midiNoteNumber & 127]; voice != nullptr;)
+            {
+                auto* next = voice->nextVoiceOnNote;
+
                 if (voice->getCurrentlyPlayingNote() == midiNoteNumber && voice->isPlayingChannel (midiChannel))
                     stopVoice (voice, 1.0f, true);
 
+                voice = next;
+            }
+
             startVoice (findFreeVoice (sound, midiChannel, midiNoteNumber, shouldStealNotes),
                         sound, midiChannel, midiNoteNumber, velocity);
         }
@@ -323,6 +805,9 @@ void Synthesiser::startVoice (SynthesiserVoice* const voice,
         voice->setSostenutoPedalDown (false);
         voice->setSustainPedalDown (sustainPedalsDown[midiChannel]);
 
+        if (voice->ownerSynth == this)
+            voiceStarted (voice);
+
         voice->startNote (midiNoteNumber, velocity, sound,
                           lastPitchWheelValues [midiChannel - 1]);
     }
@@ -343,10 +828,12 @@ void Synthesiser::noteOff (const int midiChannel,
                            const float velocity,
                            const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
-    for (auto* voice : voices)
+    for (auto* voice = voicesOnNote[midiNoteNumber & 127]; voice != nullptr;)
     {
+        auto* next = voice->nextVoiceOnNote;
+
         if (voice->getCurrentlyPlayingNote() == midiNoteNumber
               && voice->isPlayingChannel (midiChannel))
         {
@@ -364,12 +851,14 @@ void Synthesiser::noteOff (const int midiChannel,
                 }
             }
         }
+
+        voice = next;
     }
 }
 
 void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -380,7 +869,7 @@ void Synthesiser::allNotesOff (const int midiChannel, const bool allowTailOff)
 
 void Synthesiser::handlePitchWheel (const int midiChannel, const int wheelValue)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -399,7 +888,7 @@ void Synthesiser::handleController (const int midiChannel,
         default:    break;
     }
 
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -408,9 +897,9 @@ void Synthesiser::handleController (const int midiChannel,
 
 void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aftertouchValue)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
-    for (auto* voice : voices)
+    for (auto* voice = voicesOnNote[midiNoteNumber & 127]; voice != nullptr; voice = voice->nextVoiceOnNote)
         if (voice->getCurrentlyPlayingNote() == midiNoteNumber
               && (midiChannel <= 0 || voice->isPlayingChannel (midiChannel)))
             voice->aftertouchChanged (aftertouchValue);
@@ -418,7 +907,7 @@ void Synthesiser::handleAftertouch (int midiChannel, int midiNoteNumber, int aft
 
 void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureValue)
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     for (auto* voice : voices)
         if (midiChannel <= 0 || voice->isPlayingChannel (midiChannel))
@@ -428,7 +917,7 @@ void Synthesiser::handleChannelPressure (int midiChannel, int channelPressureVal
 void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     if (isDown)
     {
@@ -458,7 +947,7 @@ void Synthesiser::handleSustainPedal (int midiChannel, bool isDown)
 void Synthesiser::handleSostenutoPedal (int midiChannel, bool isDown)
 {
     jassert (midiChannel > 0 && midiChannel <= 16);
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
     for (auto* voice : voices)
     {
@@ -489,8 +978,18 @@ SynthesiserVoice* Synthesiser::findFreeVoice (SynthesiserSound* soundToPlay,
                                               int midiChannel, int midiNoteNumber,
                                               const bool stealIfNoneAvailable) const
 {
-    const ScopedLock sl (lock);
+    const ScopedRenderingLock sl (*this);
 
+    for (int i = (int) freeVoices.size(); --i >= 0;)
+    {
+        auto* voice = freeVoices[(size_t) i];
+
+        if ((! voice->isVoiceActive()) && voice->canPlaySound (soundToPlay))
+            return voice;
+    }
+
+    // A voice which overrides isVoiceActive() may become free without clearing its
+    // note, so check all of them before resorting to stealing one.
     for (auto* voice : voices)
         if ((! voice->isVoiceActive()) && voice->canPlaySound (soundToPlay))
             return voice;
@@ -527,15 +1026,6 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
 
             usableVoices.add (voice);
 
-            // NB: Using a functor rather than a lambda here due to scare-stories about
-            // compilers generating code containing heap allocations..
-            struct Sorter
-            {
-                bool operator() (const SynthesiserVoice* a, const SynthesiserVoice* b) const noexcept { return a->wasStartedBefore (*b); }
-            };
-
-            std::sort (usableVoices.begin(), usableVoices.end(), Sorter());
-
             if (! voice->isPlayingButReleased()) // Don't protect released notes
             {
                 auto note = voice->getCurrentlyPlayingNote();
@@ -549,6 +1039,15 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
         }
     }
 
+    // NB: Using a functor rather than a lambda here due to scare-stories about
+    // compilers generating code containing heap allocations..
+    struct Sorter
+    {
+        bool operator() (const SynthesiserVoice* a, const SynthesiserVoice* b) const noexcept { return a->wasStartedBefore (*b); }
+    };
+
+    std::sort (usableVoices.begin(), usableVoices.end(), Sorter());
+
     // Eliminate pathological cases (ie: only 1 note playing): we always give precedence to the lowest note(s)
     if (top == low)
         top = nullptr;
@@ -583,4 +1082,369 @@ SynthesiserVoice* Synthesiser::findVoiceToSteal (SynthesiserSound* soundToPlay,
     return low;
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SynthesiserVoiceAllocationTests  : public UnitTest
+{
+public:
+    SynthesiserVoiceAllocationTests()
+        : UnitTest ("Synthesiser voice allocation", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Free voices are found and released");
+        {
+            Synthesiser synth;
+            createSynth (synth, 4);
+
+            for (int note = 60; note < 64; ++note)
+                synth.noteOn (1, note, 1.0f);
+
+            expectEquals (countActiveVoices (synth), 4);
+            expect (findVoiceFor (synth, 60) != findVoiceFor (synth, 63));
+
+            synth.noteOff (1, 61, 1.0f, false);
+            expectEquals (countActiveVoices (synth), 3);
+            expect (findVoiceFor (synth, 61) == nullptr);
+
+            synth.noteOn (1, 70, 1.0f);
+            expectEquals (countActiveVoices (synth), 4);
+            expect (findVoiceFor (synth, 70) != nullptr);
+
+            synth.allNotesOff (0, false);
+            expectEquals (countActiveVoices (synth), 0);
+        }
+
+        beginTest ("Stealing keeps the lowest and highest notes");
+        {
+            Synthesiser synth;
+            createSynth (synth, 4);
+
+            for (auto note : { 60, 62, 64, 65 })
+                synth.noteOn (1, note, 1.0f);
+
+            synth.noteOn (1, 67, 1.0f);
+
+            expect (findVoiceFor (synth, 62) == nullptr);
+            expect (findVoiceFor (synth, 60) != nullptr);
+            expect (findVoiceFor (synth, 65) != nullptr);
+            expect (findVoiceFor (synth, 67) != nullptr);
+        }
+
+        beginTest ("Retriggering a sustained note stops the old voice");
+        {
+            Synthesiser synth;
+            createSynth (synth, 4);
+
+            synth.handleSustainPedal (1, true);
+            synth.noteOn (1, 60, 1.0f);
+            synth.noteOff (1, 60, 1.0f, true);
+            synth.noteOn (1, 60, 1.0f);
+
+            expectEquals (countActiveVoices (synth), 1);
+        }
+
+        beginTest ("Asynchronous changes are applied at the next block");
+        {
+            Synthesiser synth;
+            createSynth (synth, 2);
+
+            int numDeleted = 0;
+            auto* extraVoice = new TestVoice (&numDeleted);
+
+            expect (synth.addVoiceAsync (extraVoice));
+            expectEquals (synth.getNumVoices(), 2);
+
+            AudioBuffer<float> buffer (1, 64);
+            MidiBuffer midi;
+            synth.renderNextBlock (buffer, midi, 0, 64);
+            expectEquals (synth.getNumVoices(), 3);
+
+            for (int note = 60; note < 63; ++note)
+                synth.noteOn (1, note, 1.0f);
+
+            expectEquals (countActiveVoices (synth), 3);
+
+            SynthesiserSound::Ptr extraSound (new TestSound());
+            expect (synth.addSoundAsync (extraSound));
+            expect (synth.removeVoiceAsync (extraVoice));
+            synth.renderNextBlock (buffer, midi, 0, 64);
+
+            expectEquals (synth.getNumVoices(), 2);
+            expectEquals (synth.getNumSounds(), 2);
+            expectEquals (numDeleted, 0);
+
+            synth.deleteRemovedVoicesAndSounds();
+            expectEquals (numDeleted, 1);
+
+            expect (synth.removeSoundAsync (extraSound));
+            synth.renderNextBlock (buffer, midi, 0, 64);
+            expectEquals (synth.getNumSounds(), 1);
+        }
+
+        beginTest ("Applying queued changes doesn't reallocate");
+        {
+            StorageCheckingSynth synth;
+            createSynth (synth, 2);
+
+            SynthesiserSound::Ptr extraSound (new TestSound());
+            Array<SynthesiserVoice*> extraVoices;
+
+            for (int i = 0; i < 8; ++i)
+            {
+                extraVoices.add (new TestVoice());
+                expect (synth.addVoiceAsync (extraVoices.getLast()));
+            }
+
+            expect (synth.addSoundAsync (extraSound));
+
+            auto* voiceStorage = synth.getVoiceStorage();
+            auto* soundStorage = synth.getSoundStorage();
+
+            AudioBuffer<float> buffer (1, 64);
+            MidiBuffer midi;
+            synth.renderNextBlock (buffer, midi, 0, 64);
+
+            expectEquals (synth.getNumVoices(), 10);
+            expectEquals (synth.getNumSounds(), 2);
+            expect (synth.getVoiceStorage() == voiceStorage);
+            expect (synth.getSoundStorage() == soundStorage);
+
+            // each removal swaps the list with its spare, so two of them bring the original storage back
+            for (int i = 0; i < 2; ++i)
+            {
+                expect (synth.removeVoiceAsync (extraVoices[i]));
+                expect (synth.removeSoundAsync (extraSound));
+                synth.renderNextBlock (buffer, midi, 0, 64);
+                expect (synth.addSoundAsync (extraSound));
+                synth.renderNextBlock (buffer, midi, 0, 64);
+            }
+
+            expectEquals (synth.getNumVoices(), 8);
+            expectEquals (synth.getNumSounds(), 2);
+            expect (synth.getVoiceStorage() == voiceStorage);
+            expect (synth.getSoundStorage() == soundStorage);
+        }
+
+        beginTest ("Unapplied changes are cleaned up");
+        {
+            int numDeleted = 0;
+
+            {
+                Synthesiser synth;
+
+                for (int i = 0; i < 10; ++i)
+                    synth.addVoiceAsync (new TestVoice (&numDeleted));
+            }
+
+            expectEquals (numDeleted, 10);
+        }
+
+        beginTest ("Double-precision rendering adds the float output");
+        {
+            // this voice's buffer isn't allocated until the first render, as it doesn't
+            // call the base class when its sample rate is set
+            ConstantVoice voice;
+            voice.setCurrentPlaybackSampleRate (44100.0);
+
+            AudioBuffer<double> buffer (2, 3000);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                FloatVectorOperations::fill (buffer.getWritePointer (ch), 1.0, buffer.getNumSamples());
+
+            voice.renderNextBlock (buffer, 10, 2500);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            {
+                expectEquals (buffer.getSample (ch, 9), 1.0);
+                expectEquals (buffer.getSample (ch, 10), 1.25);
+                expectEquals (buffer.getSample (ch, 2509), 1.25);
+                expectEquals (buffer.getSample (ch, 2510), 1.0);
+            }
+        }
+
+        beginTest ("Rendering doesn't wait for the lock");
+        {
+            LockExposingSynth synth;
+            createSynth (synth, 4);
+
+            RenderThread thread (synth, 1);
+
+            {
+                const ScopedLock sl (synth.getLock());
+                thread.startThread();
+                expect (thread.waitForThreadToExit (5000));
+            }
+
+            thread.waitForThreadToExit (-1);
+        }
+
+        beginTest ("Other threads still get exclusive access");
+        {
+            LockExposingSynth synth;
+            std::atomic<int> numRendering { 0 };
+            synth.addSound (new TestSound());
+
+            for (int i = 0; i < 4; ++i)
+                synth.addVoice (new TestVoice (nullptr, &numRendering));
+
+            synth.setCurrentPlaybackSampleRate (44100.0);
+
+            for (int note = 60; note < 64; ++note)
+                synth.noteOn (1, note, 1.0f);
+
+            RenderThread thread (synth, 200);
+            thread.startThread();
+
+            for (int i = 0; i < 50; ++i)
+            {
+                LockExposingSynth::Lock sl (synth);
+                expectEquals (numRendering.load(), 0);
+            }
+
+            expect (thread.waitForThreadToExit (10000));
+        }
+
+        beginTest ("Benchmark");
+        {
+            Synthesiser synth;
+            createSynth (synth, 256);
+
+            const int numIterations = 200;
+            auto start = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < numIterations; ++i)
+            {
+                for (int note = 0; note < 128; ++note)
+                    synth.noteOn (1, note, 1.0f);
+
+                for (int note = 0; note < 128; ++note)
+                    synth.noteOff (1, note, 1.0f, false);
+            }
+
+            logMessage ("Note on/off with 256 voices: "
+                          + String ((Time::getMillisecondCounterHiRes() - start) * 1.0e6 / (numIterations * 256), 1)
+                          + " ns per event");
+        }
+    }
+
+private:
+    struct TestSound  : public SynthesiserSound
+    {
+        bool appliesToNote (int) override       { return true; }
+        bool appliesToChannel (int) override    { return true; }
+    };
+
+    struct TestVoice  : public SynthesiserVoice
+    {
+        TestVoice (int* deletionCounter = nullptr, std::atomic<int>* renderCounter = nullptr)
+            : numDeleted (deletionCounter), numRendering (renderCounter) {}
+
+        ~TestVoice() override
+        {
+            if (numDeleted != nullptr)
+                ++*numDeleted;
+        }
+
+        bool canPlaySound (SynthesiserSound*) override                          { return true; }
+        void startNote (int, float, SynthesiserSound*, int) override            {}
+        void stopNote (float, bool) override                                    { clearCurrentNote(); }
+        void pitchWheelMoved (int) override                                     {}
+        void controllerMoved (int, int) override                                {}
+        using SynthesiserVoice::renderNextBlock;
+
+        void renderNextBlock (AudioBuffer<float>&, int, int) override
+        {
+            if (numRendering != nullptr && isVoiceActive())
+            {
+                ++*numRendering;
+                Thread::sleep (1);
+                --*numRendering;
+            }
+        }
+
+        int* numDeleted;
+        std::atomic<int>* numRendering;
+    };
+
+    struct ConstantVoice  : public TestVoice
+    {
+        bool isVoiceActive() const override                                     { return true; }
+        void setCurrentPlaybackSampleRate (double) override                     {}
+        using TestVoice::renderNextBlock;
+
+        void renderNextBlock (AudioBuffer<float>& buffer, int startSample, int numSamples) override
+        {
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                FloatVectorOperations::add (buffer.getWritePointer (ch, startSample), 0.25f, numSamples);
+        }
+    };
+
+    struct StorageCheckingSynth  : public Synthesiser
+    {
+        const void* getVoiceStorage() const noexcept   { return voices.begin(); }
+        const void* getSoundStorage() const noexcept   { return sounds.begin(); }
+    };
+
+    struct LockExposingSynth  : public Synthesiser
+    {
+        using Lock = ScopedRenderingLock;
+        const CriticalSection& getLock() const noexcept   { return lock; }
+    };
+
+    struct RenderThread  : public Thread
+    {
+        RenderThread (Synthesiser& s, int blocks)  : Thread ("Synth render"), synth (s), numBlocks (blocks) {}
+
+        void run() override
+        {
+            AudioBuffer<float> buffer (1, 64);
+            MidiBuffer midi;
+
+            for (int i = 0; i < numBlocks; ++i)
+                synth.renderNextBlock (buffer, midi, 0, 64);
+        }
+
+        Synthesiser& synth;
+        const int numBlocks;
+    };
+
+    static void createSynth (Synthesiser& synth, int numVoices)
+    {
+        synth.addSound (new TestSound());
+
+        for (int i = 0; i < numVoices; ++i)
+            synth.addVoice (new TestVoice());
+
+        synth.setCurrentPlaybackSampleRate (44100.0);
+    }
+
+    static int countActiveVoices (const Synthesiser& synth)
+    {
+        int num = 0;
+
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (synth.getVoice (i)->isVoiceActive())
+                ++num;
+
+        return num;
+    }
+
+    static SynthesiserVoice* findVoiceFor (const Synthesiser& synth, int note)
+    {
+        for (int i = 0; i < synth.getNumVoices(); ++i)
+            if (synth.getVoice (i)->getCurrentlyPlayingNote() == note)
+                return synth.getVoice (i);
+
+        return nullptr;
+    }
+};
+
+static SynthesiserVoiceAllocationTests synthesiserVoiceAllocationTests;
+
+#endif
+
 } // namespace juce
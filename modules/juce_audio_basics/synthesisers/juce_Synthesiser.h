@@ -23,6 +23,8 @@
 namespace juce
 {
 
+class Synthesiser;
+
 //==============================================================================
 /**
     Describes one of the sounds that a Synthesiser can play.
@@ -187,18 +189,58 @@ public:
                                   int startSample,
                                   int numSamples) = 0;
 
-    /** A double-precision version of renderNextBlock() */
+    /** A double-precision version of renderNextBlock().
+
+        As with the float version, the output must be added to the buffer's existing contents.
+
+        The default implementation renders the float version into a cleared scratch buffer,
+        in pieces of up to 1024 samples, and adds that to the output, so voices that only
+        support single precision still work in a double-precision host. Override this if
+        your voice can render doubles directly, which avoids that extra buffer.
+    */
     virtual void renderNextBlock (AudioBuffer<double>& outputBuffer,
                                   int startSample,
                                   int numSamples);
 
+    //==============================================================================
+    /** Returns the number of voices of this class that renderBatch() can render in one go.
+
+        The default of 1 means that the voice is always rendered on its own with
+        renderNextBlock(). A voice which can render several notes in parallel (e.g. one
+        per SIMD lane) should return the size of the group it can handle, typically 4 or 8.
+    */
+    virtual int getMaximumBatchSize() const;
+
+    /** Renders a group of active voices together.
+
+        The Synthesiser calls this on the first voice of each group. All the voices in the
+        array are of the same class as this one, are currently active, and there will be no
+        more of them than getMaximumBatchSize() returned.
+
+        As with renderNextBlock(), the output must be added to the buffer, and any voice
+        that finishes must call clearCurrentNote(). The synthesiser passes in a scratch
+        buffer that is shared by all the batched voices and then accumulated into the
+        real output in one pass.
+
+        The default implementation just calls renderNextBlock() on each of the voices.
+    */
+    virtual void renderBatch (SynthesiserVoice* const* voicesToRender, int numVoices,
+                              AudioBuffer<float>& outputBuffer, int startSample, int numSamples);
+
+    /** A double-precision version of renderBatch() */
+    virtual void renderBatch (SynthesiserVoice* const* voicesToRender, int numVoices,
+                              AudioBuffer<double>& outputBuffer, int startSample, int numSamples);
+
     /** Changes the voice's reference sample rate.
 
         The rate is set so that subclasses know the output rate and can set their pitch
         accordingly.
 
         This method is called by the synth, and subclasses can access the current rate with
-        the currentSampleRate member.
+        the currentSampleRate member. If you override it, call the base class version too,
+        because that's where the buffer used by the default double-precision renderNextBlock()
+        is allocated. Otherwise it's allocated by the first double-precision render, which
+        will be on the audio thread.
     */
     virtual void setCurrentPlaybackSampleRate (double newRate);
 
@@ -274,6 +316,12 @@ private:
 
     AudioBuffer<float> tempBuffer;
 
+    // bookkeeping for the owning synth's free-voice list and note index
+    Synthesiser* ownerSynth = nullptr;
+    SynthesiserVoice* previousVoiceOnNote = nullptr;
+    SynthesiserVoice* nextVoiceOnNote = nullptr;
+    int indexedNote = -1, freeListIndex = -1;
+
     JUCE_LEAK_DETECTOR (SynthesiserVoice)
 };
 
@@ -302,6 +350,13 @@ private:
     what the target playback rate is. This value is passed on to the voices so that
     they can pitch their output correctly.
 
+    The rendering callback doesn't normally take a lock. Methods such as addVoice() and
+    noteOn() can still be called from other threads, but while one of them is running,
+    the audio thread has to wait for it. To change the voices or sounds while the synth
+    is playing without stalling the audio thread, use addVoiceAsync(), removeVoiceAsync(),
+    addSoundAsync() and removeSoundAsync(), which queue the change to be applied at the
+    start of the next block.
+
     @tags{Audio}
 */
 class JUCE_API  Synthesiser
@@ -339,6 +394,29 @@ public:
     /** Deletes one of the voices. */
     void removeVoice (int index);
 
+    /** Schedules a voice to be added at the start of the next rendered block.
+
+        Unlike addVoice(), this doesn't normally take the synth's lock, so it won't block
+        the audio thread if it's called while the synth is playing. The only exception is
+        when the synth needs more room in its voice list, in which case it briefly takes
+        the lock to grow the list here, so that the audio thread never has to allocate.
+        The synthesiser takes ownership of the voice straight away, even though it won't
+        appear in the list of voices until the next block has been rendered.
+
+        Returns false if too many changes are already waiting to be applied, in which
+        case the voice is deleted.
+    */
+    bool addVoiceAsync (SynthesiserVoice* newVoice);
+
+    /** Schedules a voice to be removed at the start of the next rendered block.
+
+        The voice is deleted later on by a non-audio thread, on a subsequent call to one
+        of the asynchronous methods, deleteRemovedVoicesAndSounds(), or the synth's destructor.
+
+        Returns false if too many changes are already waiting to be applied.
+    */
+    bool removeVoiceAsync (SynthesiserVoice* voiceToRemove);
+
     //==============================================================================
     /** Deletes all sounds. */
     void clearSounds();
@@ -359,6 +437,26 @@ public:
     /** Removes and deletes one of the sounds. */
     void removeSound (int index);
 
+    /** Schedules a sound to be added at the start of the next rendered block, without
+        blocking the audio thread.
+        Returns false if too many changes are already waiting to be applied.
+        @see addVoiceAsync
+    */
+    bool addSoundAsync (const SynthesiserSound::Ptr& newSound);
+
+    /** Schedules a sound to be removed at the start of the next rendered block, without
+        blocking the audio thread. Its reference is released later on a non-audio thread.
+        Returns false if too many changes are already waiting to be applied.
+        @see removeVoiceAsync
+    */
+    bool removeSoundAsync (const SynthesiserSound::Ptr& soundToRemove);
+
+    /** Releases any voices and sounds that were removed by removeVoiceAsync() or
+        removeSoundAsync() and which the audio thread has finished with.
+        This must not be called on the audio thread.
+    */
+    void deleteRemovedVoicesAndSounds();
+
     //==============================================================================
     /** If set to true, then the synth will try to take over an existing voice if
         it runs out and needs to play another note.
@@ -557,11 +655,65 @@ public:
     */
     void setMinimumRenderingSubdivisionSize (int numSamples, bool shouldBeStrict = false) noexcept;
 
+    /** Enables or disables batched rendering of voices.
+
+        When enabled, voices whose getMaximumBatchSize() is greater than 1 are grouped by
+        class and rendered with SynthesiserVoice::renderBatch() into a scratch buffer, which
+        is then added to the output once. Other voices are always rendered individually.
+
+        This is off by default, because the scratch buffer costs an extra clear and copy per
+        block, which only pays off for voices that really do render several notes at once.
+        Batching also needs prepareBatchRendering() to have been called: the scratch buffer is
+        never resized on the audio thread, so any block that's bigger than the prepared size
+        is rendered one voice at a time instead.
+
+        @see prepareBatchRendering
+    */
+    void setVoiceBatchingEnabled (bool shouldBatchVoices) noexcept;
+
+    /** Returns true if batched voice rendering is enabled.
+        @see setVoiceBatchingEnabled
+    */
+    bool isVoiceBatchingEnabled() const noexcept                { return batchingEnabled; }
+
+    /** Allocates the scratch buffers used by batched rendering.
+
+        Call this before playback starts (e.g. from your processor's prepareToPlay()) with
+        the number of output channels and the largest block size you'll render.
+        @see setVoiceBatchingEnabled
+    */
+    void prepareBatchRendering (int numChannels, int maximumBlockSize);
+
 protected:
     //==============================================================================
-    /** This is used to control access to the rendering callback and the note trigger methods. */
+    /** This is used to control access to the rendering callback and the note trigger methods.
+
+        The rendering callback only takes this lock while another thread is using a
+        ScopedRenderingLock, so to keep the audio thread out of the way, subclasses must
+        use one of those rather than locking this directly.
+    */
     CriticalSection lock;
 
+    /** Gives the calling thread exclusive access to the voices and sounds while it's in scope.
+
+        On the thread that's rendering a block this does nothing, as it already has
+        exclusive access. On any other thread, it waits for any block that's being rendered
+        without the lock to finish, and then takes the lock. Until it's released, the
+        rendering callback takes the lock too.
+    */
+    class JUCE_API  ScopedRenderingLock
+    {
+    public:
+        explicit ScopedRenderingLock (const Synthesiser&);
+        ~ScopedRenderingLock();
+
+    private:
+        const Synthesiser& owner;
+        bool isLocked = false;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRenderingLock)
+    };
+
     OwnedArray<SynthesiserVoice> voices;
     ReferenceCountedArray<SynthesiserSound> sounds;
 
@@ -569,8 +721,8 @@ protected:
     int lastPitchWheelValues [16];
 
     /** Renders the voices for the given range.
-        By default this just calls renderNextBlock() on each voice, but you may need
-        to override it to handle custom cases.
+        By default this calls renderNextBlock() on each voice, or renderBatch() on groups
+        of voices that support it, but you may need to override it to handle custom cases.
     */
     virtual void renderVoices (AudioBuffer<float>& outputAudio,
                                int startSample, int numSamples);
@@ -580,6 +732,11 @@ protected:
     /** Searches through the voices to find one that's not currently playing, and
         which can play the given sound.
 
+        The default implementation keeps a list of the voices that have become free, so
+        this is normally a constant-time operation, and returns the voice that became free
+        most recently. It only falls back to scanning all the voices in order when that
+        list can't provide a suitable voice.
+
         Returns nullptr if all voices are busy and stealing isn't enabled.
 
         To implement a custom note-stealing algorithm, you can either override this
@@ -621,15 +778,66 @@ protected:
 
 private:
     //==============================================================================
+    friend class SynthesiserVoice;
+
+    struct PendingChange
+    {
+        enum class Type { addVoice, removeVoice, addSound, removeSound };
+
+        Type type = Type::addVoice;
+        SynthesiserVoice* voice = nullptr;
+        SynthesiserSound::Ptr sound;
+    };
+
+    enum { maxPendingChanges = 128 };
+
+    AbstractFifo pendingChangeFifo { maxPendingChanges }, removedObjectFifo { maxPendingChanges };
+    PendingChange pendingChanges[maxPendingChanges], removedObjects[maxPendingChanges];
+    CriticalSection pendingChangeWriteLock;
+
+    OwnedArray<SynthesiserVoice> spareVoices;
+    ReferenceCountedArray<SynthesiserSound> spareSounds;
+    std::atomic<int> numReservedVoices { 0 }, numReservedSounds { 0 };
+    std::atomic<int> voiceCount { 0 }, soundCount { 0 };
+
+    mutable std::atomic<int> numThreadsNeedingLock { 0 };
+    std::atomic<bool> isRenderingWithoutLock { false };
+    std::atomic<Thread::ThreadID> renderingThread { nullptr };
+
+    std::vector<SynthesiserVoice*> freeVoices;
+    SynthesiserVoice* voicesOnNote[128] = {};
+
     double sampleRate = 0;
     uint32 lastNoteOnCounter = 0;
     int minimumSubBlockSize = 32;
     bool subBlockSubdivisionIsStrict = false;
-    bool shouldStealNotes = true;
+    bool shouldStealNotes = true, batchingEnabled = false;
     BigInteger sustainPedalsDown;
 
+    Array<SynthesiserVoice*> batchedVoices;
+    AudioBuffer<float> batchBufferFloat;
+    AudioBuffer<double> batchBufferDouble;
+
     template <typename floatType>
     void processNextBlock (AudioBuffer<floatType>&, const MidiBuffer&, int startSample, int numSamples);
+    template <typename floatType>
+    void processMidiAndRenderVoices (AudioBuffer<floatType>&, const MidiBuffer&, int startSample, int numSamples);
+
+    bool postChange (PendingChange::Type, SynthesiserVoice*, SynthesiserSound*);
+    void applyPendingChanges();
+    void retireObject (SynthesiserVoice*, SynthesiserSound*);
+    void reserveVoiceStorage (int numVoices);
+    void reserveSoundStorage (int numSounds);
+
+    void addToVoiceIndex (SynthesiserVoice*);
+    void removeFromVoiceIndex (SynthesiserVoice*);
+    void voiceStarted (SynthesiserVoice*);
+    void voiceStopped (SynthesiserVoice*);
+    void removeFromNoteIndex (SynthesiserVoice*);
+    void removeFromFreeList (SynthesiserVoice*);
+
+    template <typename floatType>
+    void renderVoicesInBatches (AudioBuffer<floatType>&, AudioBuffer<floatType>& scratch, int startSample, int numSamples);
 
    #if JUCE_CATCH_DEPRECATED_CODE_MISUSE
     // Note the new parameters for these methods.
@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+// A windowed-sinc kernel for each of a set of cut-off frequencies, sampled at
+// numPhases fractional positions. Each row is stored with the difference to the
+// next row, so that the kernel can be linearly interpolated between phases.
+struct WindowedSincKernel::Tables
+{
+    static constexpr int numPhases = 64;
+    static constexpr int numBands = 13;
+
+    Tables()  : coefficients ((size_t) (numBands * (numPhases + 1) * numTaps)),
+                deltas ((size_t) (numBands * (numPhases + 1) * numTaps))
+    {
+        const double halfWidth = numAfter;
+
+        for (int band = 0; band < numBands; ++band)
+        {
+            auto cutoff = 1.0 / getMaximumRatio (band);
+
+            for (int phase = 0; phase <= numPhases; ++phase)
+            {
+                auto* row = getRow (coefficients.data(), band, phase);
+                auto alpha = phase / (double) numPhases;
+                double sum = 0;
+
+                for (int i = 0; i < numTaps; ++i)
+                {
+                    auto t = (i - numBefore) - alpha;
+                    auto x = MathConstants<double>::pi * cutoff * t;
+                    auto sinc = x != 0 ? std::sin (x) / x : 1.0;
+                    auto w = MathConstants<double>::pi * t / halfWidth;
+                    auto window = std::abs (t) < halfWidth ? 0.42 + 0.5 * std::cos (w) + 0.08 * std::cos (2.0 * w) : 0.0;
+
+                    row[i] = (float) (sinc * window);
+                    sum += row[i];
+                }
+
+                for (int i = 0; i < numTaps; ++i)
+                    row[i] = (float) (row[i] / sum);
+            }
+
+            for (int phase = 0; phase < numPhases; ++phase)
+                for (int i = 0; i < numTaps; ++i)
+                    getRow (deltas.data(), band, phase)[i] = getRow (coefficients.data(), band, phase + 1)[i]
+                                                               - getRow (coefficients.data(), band, phase)[i];
+        }
+    }
+
+    static double getMaximumRatio (int band) noexcept     { return 1.0 + 0.25 * band; }
+
+    template <typename Type>
+    static Type* getRow (Type* table, int band, int phase) noexcept
+    {
+        return table + (band * (numPhases + 1) + phase) * numTaps;
+    }
+
+    static const Tables& getInstance()
+    {
+        static Tables tables;
+        return tables;
+    }
+
+    std::vector<float> coefficients, deltas;
+};
+
+//==============================================================================
+WindowedSincKernel::WindowedSincKernel (const float* c, const float* d) noexcept
+    : coefficients (c), deltas (d)
+{
+}
+
+WindowedSincKernel WindowedSincKernel::forRatio (double ratio) noexcept
+{
+    auto& tables = Tables::getInstance();
+    auto band = jlimit (0, Tables::numBands - 1, (int) std::ceil ((ratio - 1.0) * 4.0 - 1.0e-9));
+
+    return { Tables::getRow (tables.coefficients.data(), band, 0),
+             Tables::getRow (tables.deltas.data(), band, 0) };
+}
+
+void WindowedSincKernel::prepareTables()
+{
+    Tables::getInstance();
+}
+
+float WindowedSincKernel::interpolate (const float* in, float alpha) const noexcept
+{
+    auto phase = alpha * (float) Tables::numPhases;
+    auto index = jmin ((int) phase, Tables::numPhases - 1);
+    auto frac = phase - (float) index;
+
+    // returns the sum of in[i] * (c[i] + frac * d[i])
+    auto* x = in - numBefore;
+    auto* c = coefficients + index * numTaps;
+    auto* d = deltas + index * numTaps;
+
+   #if JUCE_USE_SSE_INTRINSICS
+    auto f = _mm_set1_ps (frac);
+    auto sum = _mm_setzero_ps();
+
+    for (int i = 0; i < numTaps; i += 4)
+        sum = _mm_add_ps (sum, _mm_mul_ps (_mm_loadu_ps (x + i),
+                                           _mm_add_ps (_mm_loadu_ps (c + i), _mm_mul_ps (f, _mm_loadu_ps (d + i)))));
+
+    sum = _mm_add_ps (sum, _mm_movehl_ps (sum, sum));
+    sum = _mm_add_ss (sum, _mm_shuffle_ps (sum, sum, 1));
+    return _mm_cvtss_f32 (sum);
+   #elif JUCE_USE_ARM_NEON
+    auto f = vdupq_n_f32 (frac);
+    auto sum = vdupq_n_f32 (0);
+
+    for (int i = 0; i < numTaps; i += 4)
+        sum = vmlaq_f32 (sum, vld1q_f32 (x + i), vmlaq_f32 (vld1q_f32 (c + i), f, vld1q_f32 (d + i)));
+
+    auto pair = vadd_f32 (vget_low_f32 (sum), vget_high_f32 (sum));
+    return vget_lane_f32 (vpadd_f32 (pair, pair), 0);
+   #else
+    float sum = 0;
+
+    for (int i = 0; i < numTaps; ++i)
+        sum += x[i] * (c[i] + frac * d[i]);
+
+    return sum;
+   #endif
+}
+
+} // namespace juce
@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A polyphase windowed-sinc filter kernel, for band-limited interpolation.
+
+    The kernel is 32 points long, and is sampled at 64 fractional positions, between
+    which its coefficients are linearly interpolated. A set of kernels with different
+    cut-off frequencies is provided, so that a signal which is being resampled to a
+    lower rate (i.e. played back faster) can be filtered to avoid aliasing. The
+    kernels are shared between all instances.
+
+    @see LagrangeInterpolator, CatmullRomInterpolator
+
+    @tags{Audio}
+*/
+class JUCE_API  WindowedSincKernel
+{
+public:
+    //==============================================================================
+    /** The number of input points before the interpolated position that are used. */
+    static constexpr int numBefore = 15;
+
+    /** The number of input points after the interpolated position that are used. */
+    static constexpr int numAfter = 16;
+
+    /** The total number of input points that are used. */
+    static constexpr int numTaps = numBefore + numAfter + 1;
+
+    //==============================================================================
+    /** Returns the kernel to use when resampling with the given ratio of input samples
+        per output sample.
+
+        For ratios above 1.0, the cut-off frequency is lowered to avoid aliasing. Above a
+        ratio of 4.0 the cut-off is no longer lowered, so some aliasing will occur.
+    */
+    static WindowedSincKernel forRatio (double samplesInPerOutputSample) noexcept;
+
+    /** Builds the shared tables, if that hasn't already been done. This is done
+        automatically when they're first used, but can be called beforehand, to avoid
+        doing it on the audio thread.
+    */
+    static void prepareTables();
+
+    //==============================================================================
+    /** Returns the value at a fractional position between in[0] and in[1].
+        The points from in[-numBefore] to in[numAfter] must be readable.
+    */
+    float interpolate (const float* in, float alpha) const noexcept;
+
+private:
+    //==============================================================================
+    struct Tables;
+
+    const float* coefficients;
+    const float* deltas;
+
+    WindowedSincKernel (const float*, const float*) noexcept;
+};
+
+} // namespace juce
@@ -0,0 +1,434 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+RealtimeMidiMessageCollector::RealtimeMidiMessageCollector (int queueSizeInBytes)
+    : fifo (jmax (256, queueSizeInBytes)),
+      queue ((size_t) jmax (256, queueSizeInBytes)),
+      scratch ((size_t) jmax (256, queueSizeInBytes))
+{
+}
+
+RealtimeMidiMessageCollector::~RealtimeMidiMessageCollector()
+{
+}
+
+//==============================================================================
+void RealtimeMidiMessageCollector::reset (double newSampleRate)
+{
+    jassert (newSampleRate > 0);
+
+   #if JUCE_DEBUG
+    hasCalledReset = true;
+   #endif
+    sampleRate = newSampleRate;
+    needsTimingReset = true;
+
+    // this is done from the reading side, so it's safe while messages are being added
+    fifo.finishedRead (fifo.getNumReady());
+}
+
+bool RealtimeMidiMessageCollector::addMessageToQueue (const MidiMessage& message)
+{
+   #if JUCE_DEBUG
+    jassert (hasCalledReset); // you need to call reset() to set the correct sample rate before using this object
+   #endif
+
+    // the messages that come in here need to be time-stamped correctly - see MidiInput
+    // for details of what the number should be.
+    jassert (message.getTimeStamp() != 0);
+
+    EventHeader header { message.getTimeStamp(), message.getRawDataSize() };
+    auto totalSize = (int) sizeof (EventHeader) + header.numBytes;
+
+    const SpinLock::ScopedLockType sl (writerLock);
+
+    if (fifo.getFreeSpace() < totalSize)
+    {
+        ++numDroppedMessages;
+        return false;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (totalSize, start1, size1, start2, size2);
+
+    write (start1, &header, (int) sizeof (EventHeader));
+    write (start1 + (int) sizeof (EventHeader), message.getRawData(), header.numBytes);
+
+    fifo.finishedWrite (totalSize);
+    return true;
+}
+
+void RealtimeMidiMessageCollector::write (int position, const void* source, int numBytes) noexcept
+{
+    auto size = fifo.getTotalSize();
+    position %= size;
+    auto numBeforeWrap = jmin (numBytes, size - position);
+
+    memcpy (queue + position, source, (size_t) numBeforeWrap);
+    memcpy (queue, addBytesToPointer (source, numBeforeWrap), (size_t) (numBytes - numBeforeWrap));
+}
+
+void RealtimeMidiMessageCollector::read (int position, void* dest, int numBytes) const noexcept
+{
+    auto size = fifo.getTotalSize();
+    position %= size;
+    auto numBeforeWrap = jmin (numBytes, size - position);
+
+    memcpy (dest, queue + position, (size_t) numBeforeWrap);
+    memcpy (addBytesToPointer (dest, numBeforeWrap), queue, (size_t) (numBytes - numBeforeWrap));
+}
+
+//==============================================================================
+void RealtimeMidiMessageCollector::removeNextBlockOfMessages (MidiBuffer& destBuffer, int numSamples)
+{
+    removeNextBlockOfMessages (destBuffer, numSamples, Time::getMillisecondCounterHiRes() * 0.001);
+}
+
+void RealtimeMidiMessageCollector::removeNextBlockOfMessages (MidiBuffer& destBuffer, int numSamples, double timeNow)
+{
+   #if JUCE_DEBUG
+    jassert (hasCalledReset); // you need to call reset() to set the correct sample rate before using this object
+   #endif
+
+    jassert (numSamples > 0);
+
+    updateBlockTimes (timeNow, numSamples);
+
+    auto samplesPerSecond = numSamples / jmax (1.0e-6, windowEnd - windowStart);
+
+    for (;;)
+    {
+        auto numReady = fifo.getNumReady();
+
+        if (numReady < (int) sizeof (EventHeader))
+            break;
+
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (numReady, start1, size1, start2, size2);
+
+        EventHeader header;
+        read (start1, &header, (int) sizeof (EventHeader));
+
+        // messages which arrived after the start of this block are left for the next one,
+        // unless their timestamps are nonsense
+        if (header.time >= windowEnd && header.time < timeNow + 1.0)
+            break;
+
+        read (start1 + (int) sizeof (EventHeader), scratch, header.numBytes);
+        fifo.finishedRead ((int) sizeof (EventHeader) + header.numBytes);
+
+        // if the messages haven't been collected for a long time, throw away the old ones
+        if (header.time < windowEnd - 1.0)
+            continue;
+
+        auto samplePosition = roundToInt ((header.time - windowStart) * samplesPerSecond);
+        destBuffer.addEvent (scratch, header.numBytes, jlimit (0, numSamples - 1, samplePosition));
+    }
+}
+
+void RealtimeMidiMessageCollector::updateBlockTimes (double timeNow, int numSamples) noexcept
+{
+    auto blockLength = numSamples / sampleRate;
+
+    // Each message is delivered in the block after the one in which it arrived, so the
+    // block being rendered covers the messages that arrived between the start times of
+    // the previous block and this one. The start times are smoothed by a delay-locked
+    // loop, which follows the audio clock but filters out the scheduling jitter, and
+    // they're moved back by the amount that callbacks have recently arrived early, so
+    // that all the messages in a window have arrived by the time it is read.
+    if (needsTimingReset
+         || numSamples != lastNumSamples
+         || std::abs (timeNow - nextBlockTime) > jmax (0.1, 4.0 * blockLength))
+    {
+        auto omega = MathConstants<double>::twoPi * 0.25 * blockLength; // a bandwidth of 0.25Hz
+        filterCoeffB = MathConstants<double>::sqrt2 * omega;
+        filterCoeffC = omega * omega;
+
+        windowStart = timeNow - blockLength;
+        windowEnd = timeNow;
+        nextBlockTime = timeNow + blockLength;
+        filteredBlockLength = blockLength;
+        earlyCallbackMargin = 0;
+        lastNumSamples = numSamples;
+        needsTimingReset = false;
+        return;
+    }
+
+    auto error = timeNow - nextBlockTime;
+    earlyCallbackMargin = jmax (earlyCallbackMargin * 0.999, -error);
+
+    windowStart = windowEnd;
+    windowEnd = jmax (windowStart, nextBlockTime - earlyCallbackMargin);
+    nextBlockTime += filterCoeffB * error + filteredBlockLength;
+    filteredBlockLength += filterCoeffC * error;
+}
+
+//==============================================================================
+void RealtimeMidiMessageCollector::handleNoteOn (MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+{
+    MidiMessage m (MidiMessage::noteOn (midiChannel, midiNoteNumber, velocity));
+    m.setTimeStamp (Time::getMillisecondCounterHiRes() * 0.001);
+
+    addMessageToQueue (m);
+}
+
+void RealtimeMidiMessageCollector::handleNoteOff (MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity)
+{
+    MidiMessage m (MidiMessage::noteOff (midiChannel, midiNoteNumber, velocity));
+    m.setTimeStamp (Time::getMillisecondCounterHiRes() * 0.001);
+
+    addMessageToQueue (m);
+}
+
+void RealtimeMidiMessageCollector::handleIncomingMidiMessage (MidiInput*, const MidiMessage& message)
+{
+    addMessageToQueue (message);
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class RealtimeMidiMessageCollectorTests  : public UnitTest
+{
+public:
+    RealtimeMidiMessageCollectorTests()
+        : UnitTest ("RealtimeMidiMessageCollector", UnitTestCategories::midi)
+    {}
+
+    void runTest() override
+    {
+        const double sampleRate = 48000.0;
+        const int blockSize = 480;
+        const double blockLength = blockSize / sampleRate;
+
+        beginTest ("Events are delivered one block later");
+        {
+            RealtimeMidiMessageCollector collector;
+            collector.reset (sampleRate);
+
+            const double start = 1000.0;
+            MidiBuffer buffer;
+            collector.removeNextBlockOfMessages (buffer, blockSize, start);
+            expect (buffer.isEmpty());
+
+            for (int i = 0; i < 10; ++i)
+                collector.addMessageToQueue (MidiMessage::noteOn (1, 60 + i, (uint8) 100)
+                                               .withTimeStamp (start + blockLength * i / 10.0));
+
+            // a message that arrives after the start of the next block
+            collector.addMessageToQueue (MidiMessage::noteOn (1, 80, (uint8) 100)
+                                           .withTimeStamp (start + blockLength * 1.5));
+
+            collector.removeNextBlockOfMessages (buffer, blockSize, start + blockLength);
+            expectEquals (buffer.getNumEvents(), 10);
+
+            MidiBuffer::Iterator iter (buffer);
+            MidiMessage m;
+            int position, index = 0;
+
+            while (iter.getNextEvent (m, position))
+            {
+                expectEquals (m.getNoteNumber(), 60 + index);
+                expectEquals (position, index * blockSize / 10);
+                ++index;
+            }
+
+            buffer.clear();
+            collector.removeNextBlockOfMessages (buffer, blockSize, start + 2.0 * blockLength);
+            expectEquals (buffer.getNumEvents(), 1);
+            expectEquals (buffer.getFirstEventTime(), blockSize / 2);
+        }
+
+        beginTest ("Callback jitter is smoothed");
+        {
+            RealtimeMidiMessageCollector collector;
+            collector.reset (sampleRate);
+
+            Random random (42);
+            MidiBuffer buffer;
+            const double start = 50.0;
+            int minPosition = blockSize, maxPosition = 0;
+
+            for (int block = 0; block < 2000; ++block)
+            {
+                // one event exactly halfway through each block period
+                collector.addMessageToQueue (MidiMessage::noteOn (1, 60, (uint8) 100)
+                                               .withTimeStamp (start + (block - 0.5) * blockLength));
+
+                buffer.clear();
+                auto callbackTime = start + block * blockLength + random.nextDouble() * 0.002;
+                collector.removeNextBlockOfMessages (buffer, blockSize, callbackTime);
+
+                if (block > 500)
+                {
+                    expectEquals (buffer.getNumEvents(), 1);
+                    minPosition = jmin (minPosition, buffer.getFirstEventTime());
+                    maxPosition = jmax (maxPosition, buffer.getFirstEventTime());
+                }
+            }
+
+            // 2ms of callback jitter would be 96 samples of event jitter if it wasn't filtered
+            expect (maxPosition - minPosition < 24, "jitter: " + String (maxPosition - minPosition));
+        }
+
+        beginTest ("Full queue and stale messages");
+        {
+            RealtimeMidiMessageCollector collector (256);
+            collector.reset (sampleRate);
+
+            int numAdded = 0;
+
+            for (int i = 0; i < 100; ++i)
+                if (collector.addMessageToQueue (MidiMessage::noteOn (1, 60, (uint8) 100).withTimeStamp (10.0)))
+                    ++numAdded;
+
+            expectEquals (numAdded, 255 / 19);
+            expectEquals (collector.getNumDroppedMessages(), 100 - numAdded);
+
+            // messages that are more than a second old are thrown away
+            MidiBuffer buffer;
+            collector.removeNextBlockOfMessages (buffer, blockSize, 20.0);
+            expect (buffer.isEmpty());
+            expect (collector.addMessageToQueue (MidiMessage::noteOn (1, 60, (uint8) 100).withTimeStamp (20.0)));
+        }
+
+        beginTest ("Jitter compared with MidiMessageCollector");
+        {
+            MidiMessageCollector original;
+            RealtimeMidiMessageCollector realtime;
+            original.reset (sampleRate);
+            realtime.reset (sampleRate);
+
+            const int numMessages = 400;
+            Array<double> sendTimes;
+            sendTimes.resize (numMessages);
+
+            struct SenderThread  : public Thread
+            {
+                SenderThread (MidiMessageCollector& o, RealtimeMidiMessageCollector& r, Array<double>& t)
+                    : Thread ("MIDI sender"), originalCollector (o), realtimeCollector (r), times (t) {}
+
+                void run() override
+                {
+                    for (int i = 0; i < times.size() && ! threadShouldExit(); ++i)
+                    {
+                        auto time = Time::getMillisecondCounterHiRes() * 0.001;
+                        times.set (i, time);
+
+                        auto message = MidiMessage::pitchWheel (1, i).withTimeStamp (time);
+                        originalCollector.addMessageToQueue (message);
+                        realtimeCollector.addMessageToQueue (message);
+                        Thread::sleep (1);
+                    }
+                }
+
+                MidiMessageCollector& originalCollector;
+                RealtimeMidiMessageCollector& realtimeCollector;
+                Array<double>& times;
+            };
+
+            Array<int64> originalPositions, realtimePositions;
+            originalPositions.insertMultiple (0, -1, numMessages);
+            realtimePositions.insertMultiple (0, -1, numMessages);
+
+            auto collect = [] (const MidiBuffer& buffer, int64 blockStart, Array<int64>& positions)
+            {
+                MidiBuffer::Iterator iter (buffer);
+                MidiMessage m;
+                int position;
+
+                while (iter.getNextEvent (m, position))
+                    if (m.isPitchWheel())
+                        positions.set (m.getPitchWheelValue(), blockStart + position);
+            };
+
+            SenderThread sender (original, realtime, sendTimes);
+            Random random (1);
+            MidiBuffer originalBuffer, realtimeBuffer;
+            originalBuffer.ensureSize (4096);
+            realtimeBuffer.ensureSize (4096);
+
+            auto startTime = Time::getMillisecondCounterHiRes() * 0.001;
+            sender.startThread();
+
+            for (int64 block = 0; sender.isThreadRunning() || block < 4; ++block)
+            {
+                // simulate an audio callback which runs at the right rate on average, but with
+                // up to 2ms of scheduling jitter
+                auto callbackTime = startTime + block * blockLength + random.nextDouble() * 0.002;
+
+                while (Time::getMillisecondCounterHiRes() * 0.001 < callbackTime)
+                    Thread::sleep (1);
+
+                originalBuffer.clear();
+                realtimeBuffer.clear();
+                original.removeNextBlockOfMessages (originalBuffer, blockSize);
+                realtime.removeNextBlockOfMessages (realtimeBuffer, blockSize);
+
+                collect (originalBuffer, block * blockSize, originalPositions);
+                collect (realtimeBuffer, block * blockSize, realtimePositions);
+            }
+
+            auto measureJitter = [&] (const Array<int64>& positions)
+            {
+                // the jitter is the spread of the latencies, after removing the average latency
+                StatisticsAccumulator<double> latencies;
+
+                for (int i = 0; i < numMessages; ++i)
+                    if (positions[i] >= 0)
+                        latencies.addValue (positions[i] - (sendTimes[i] - startTime) * sampleRate);
+
+                return latencies;
+            };
+
+            auto originalJitter = measureJitter (originalPositions);
+            auto realtimeJitter = measureJitter (realtimePositions);
+
+            expectEquals ((int) realtimeJitter.getCount(), numMessages);
+            expectEquals (realtime.getNumDroppedMessages(), 0);
+
+            auto describe = [] (const StatisticsAccumulator<double>& s)
+            {
+                return "std deviation " + String (s.getStandardDeviation(), 1) + " samples, range "
+                         + String (s.getMaxValue() - s.getMinValue(), 1) + " samples";
+            };
+
+            // These figures depend on how promptly the OS wakes up the sender and callback
+            // threads, so they vary a lot between runs and machines, and aren't checked.
+            logMessage ("Latency spread for " + String (numMessages) + " messages sent about 1ms apart, with "
+                         + String (blockSize) + "-sample blocks at " + String (sampleRate / 1000.0, 0)
+                         + "kHz and up to 2ms of callback jitter:");
+            logMessage ("MidiMessageCollector: " + describe (originalJitter));
+            logMessage ("RealtimeMidiMessageCollector: " + describe (realtimeJitter));
+        }
+    }
+};
+
+static RealtimeMidiMessageCollectorTests realtimeMidiMessageCollectorTests;
+
+#endif
+
+} // namespace juce
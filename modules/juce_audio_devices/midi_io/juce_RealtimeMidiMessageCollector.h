@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Collects incoming realtime MIDI messages and turns them into blocks for an audio
+    callback, without any locking on the audio thread.
+
+    This does the same job as MidiMessageCollector, but the messages are passed to
+    the audio thread through a lock-free FIFO, so removeNextBlockOfMessages() never
+    waits for the MIDI thread, and neither side allocates memory. If several threads
+    add messages at once, they're serialised with a SpinLock, but this is never taken
+    by the audio thread.
+
+    Rather than squeezing all the messages that arrived since the last callback into
+    the next block, the collector keeps a smoothed estimate of when each audio block
+    starts, and delivers each message exactly one block after it arrived. This means
+    that the jitter in the timing of the audio callbacks doesn't affect the spacing
+    of the events.
+
+    The FIFO has a fixed size. If it fills up, new messages are discarded, and can be
+    counted with getNumDroppedMessages().
+
+    @see MidiMessageCollector, MidiInput
+
+    @tags{Audio}
+*/
+class JUCE_API  RealtimeMidiMessageCollector    : public MidiKeyboardStateListener,
+                                                  public MidiInputCallback
+{
+public:
+    //==============================================================================
+    /** Creates a collector whose FIFO can hold the given number of bytes. Each message
+        uses its size plus 16 bytes.
+    */
+    RealtimeMidiMessageCollector (int queueSizeInBytes = 65536);
+
+    /** Destructor. */
+    ~RealtimeMidiMessageCollector() override;
+
+    //==============================================================================
+    /** Clears any messages from the queue, and sets the sample rate.
+
+        You need to call this method before starting to use the collector. It must be
+        called from the audio thread, or while the audio callback isn't running.
+    */
+    void reset (double sampleRate);
+
+    /** Takes an incoming real-time message and adds it to the queue.
+
+        The message's timestamp must be in seconds, using the same clock as
+        Time::getMillisecondCounterHiRes() (as the messages from a MidiInput are).
+
+        Returns false if there wasn't space for the message in the queue.
+    */
+    bool addMessageToQueue (const MidiMessage& message);
+
+    /** Removes the pending messages that belong in the next block, and adds them to a buffer.
+
+        This should be called by the audio callback for every block, because the times
+        of the calls are used to position the events within the blocks.
+
+        It doesn't allocate any memory, as long as the destination buffer has enough space.
+
+        Precondition: numSamples must be greater than 0.
+    */
+    void removeNextBlockOfMessages (MidiBuffer& destBuffer, int numSamples);
+
+    /** Removes the next block of messages, using the given time (in seconds, measured
+        on the same clock as Time::getMillisecondCounterHiRes()) as the time at which the
+        block is being processed.
+
+        This is useful if you have a more accurate time for the block than the time at
+        which the callback happens to run.
+    */
+    void removeNextBlockOfMessages (MidiBuffer& destBuffer, int numSamples, double blockTimeSeconds);
+
+    /** Returns the number of messages that were discarded because the queue was full. */
+    int getNumDroppedMessages() const noexcept              { return numDroppedMessages.load(); }
+
+    //==============================================================================
+    /** @internal */
+    void handleNoteOn (MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
+    /** @internal */
+    void handleNoteOff (MidiKeyboardState*, int midiChannel, int midiNoteNumber, float velocity) override;
+    /** @internal */
+    void handleIncomingMidiMessage (MidiInput*, const MidiMessage&) override;
+
+private:
+    //==============================================================================
+    struct EventHeader
+    {
+        double time;
+        int numBytes;
+    };
+
+    AbstractFifo fifo;
+    HeapBlock<uint8> queue, scratch;
+    SpinLock writerLock;
+    std::atomic<int> numDroppedMessages { 0 };
+    double sampleRate = 44100.0;
+
+    // These are only used by the audio thread, to estimate the block times
+    double windowStart = 0, windowEnd = 0, nextBlockTime = 0, filteredBlockLength = 0, earlyCallbackMargin = 0;
+    double filterCoeffB = 0, filterCoeffC = 0;
+    int lastNumSamples = 0;
+    bool needsTimingReset = true;
+
+   #if JUCE_DEBUG
+    bool hasCalledReset = false;
+   #endif
+
+    void write (int position, const void* source, int numBytes) noexcept;
+    void read (int position, void* dest, int numBytes) const noexcept;
+    void updateBlockTimes (double timeNow, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeMidiMessageCollector)
+};
+
+} // namespace juce
@@ -812,6 +812,7 @@ public:
                                          reader.bytesPerFrame * reader.lengthInSamples, reader.bytesPerFrame),
           littleEndian (reader.littleEndian)
     {
+        dataIsBigEndian = ! littleEndian;
     }
 
     bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
@@ -820,7 +821,7 @@ public:
         clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
                                            startSampleInFile, numSamples, lengthInSamples);
 
-        if (map == nullptr || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
+        if (! ensureSamplesAreMapped ({ startSampleInFile, startSampleInFile + numSamples }))
         {
             jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
             return false;
@@ -842,7 +843,14 @@ public:
     {
         auto num = (int) numChannels;
 
-        if (map == nullptr || ! mappedSection.contains (sample))
+        if (! isPositiveAndBelow (sample, lengthInSamples))
+        {
+            // like read(), anything outside the file comes back as silence
+            zeromem (result, (size_t) num * sizeof (float));
+            return;
+        }
+
+        if (! ensureSamplesAreMapped ({ sample, sample + 1 }))
         {
             jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
 
@@ -885,7 +893,7 @@ public:
     {
         numSamples = jmin (numSamples, lengthInSamples - startSampleInFile);
 
-        if (map == nullptr || numSamples <= 0 || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
+        if (numSamples <= 0 || ! ensureSamplesAreMapped ({ startSampleInFile, startSampleInFile + numSamples }))
         {
             jassert (numSamples <= 0); // you must make sure that the window contains all the samples you're going to attempt to read.
 
@@ -185,13 +185,17 @@ static const char* const flacFormatName = "FLAC file";
 class FlacReader  : public AudioFormatReader
 {
 public:
-    FlacReader (InputStream* in)  : AudioFormatReader (in, flacFormatName)
+    FlacReader (InputStream* in, bool streaming = false)
+        : AudioFormatReader (in, flacFormatName), isStreaming (streaming)
     {
         lengthInSamples = 0;
         decoder = FlacNamespace::FLAC__stream_decoder_new();
 
-        ok = FLAC__stream_decoder_init_stream (decoder,
-                                               readCallback_, seekCallback_, tellCallback_, lengthCallback_,
+        // without the seek, tell and length callbacks, the decoder only reads forwards
+        ok = FLAC__stream_decoder_init_stream (decoder, readCallback_,
+                                               streaming ? nullptr : seekCallback_,
+                                               streaming ? nullptr : tellCallback_,
+                                               streaming ? nullptr : lengthCallback_,
                                                eofCallback_, writeCallback_, metadataCallback_, errorCallback_,
                                                this) == FlacNamespace::FLAC__STREAM_DECODER_INIT_STATUS_OK;
 
@@ -199,7 +203,11 @@ public:
         {
             FLAC__stream_decoder_process_until_end_of_metadata (decoder);
 
-            if (lengthInSamples == 0 && sampleRate > 0)
+            if (lengthInSamples == 0 && sampleRate > 0 && isStreaming)
+            {
+                lengthInSamples = std::numeric_limits<int64>::max();
+            }
+            else if (lengthInSamples == 0 && sampleRate > 0)
             {
                 // the length hasn't been stored in the metadata, so we'll need to
                 // work it out the length the hard way, by scanning the whole file..
@@ -237,6 +245,16 @@ public:
         if (! ok)
             return false;
 
+        if (isStreaming && startSampleInFile < reservoirStart)
+        {
+            // the stream has already gone past this position
+            for (int i = numDestChannels; --i >= 0;)
+                if (destSamples[i] != nullptr)
+                    zeromem (destSamples[i] + startOffsetInDestBuffer, (size_t) numSamples * sizeof (int));
+
+            return false;
+        }
+
         while (numSamples > 0)
         {
             if (startSampleInFile >= reservoirStart
@@ -263,12 +281,13 @@ public:
                 {
                     samplesInReservoir = 0;
                 }
-                else if (startSampleInFile < reservoirStart
-                          || startSampleInFile > reservoirStart + jmax (samplesInReservoir, 511))
+                else if (! isStreaming
+                          && (startSampleInFile < reservoirStart
+                               || startSampleInFile > reservoirStart + jmax (samplesInReservoir, 511)))
                 {
                     // had some problems with flac crashing if the read pos is aligned more
                     // accurately than this. Probably fixed in newer versions of the library, though.
-                    reservoirStart = (int) (startSampleInFile & ~511);
+                    reservoirStart = startSampleInFile & ~511;
                     samplesInReservoir = 0;
                     FLAC__stream_decoder_seek_absolute (decoder, (FlacNamespace::FLAC__uint64) reservoirStart);
                 }
@@ -277,6 +296,10 @@ public:
                     reservoirStart += samplesInReservoir;
                     samplesInReservoir = 0;
                     FLAC__stream_decoder_process_single (decoder);
+
+                    if (lengthInSamples == std::numeric_limits<int64>::max()
+                         && FLAC__stream_decoder_get_state (decoder) == FlacNamespace::FLAC__STREAM_DECODER_END_OF_STREAM)
+                        lengthInSamples = reservoirStart + samplesInReservoir;
                 }
 
                 if (samplesInReservoir == 0)
@@ -331,7 +354,19 @@ public:
     //==============================================================================
     static FlacNamespace::FLAC__StreamDecoderReadStatus readCallback_ (const FlacNamespace::FLAC__StreamDecoder*, FlacNamespace::FLAC__byte buffer[], size_t* bytes, void* client_data)
     {
-        *bytes = (size_t) static_cast<const FlacReader*> (client_data)->input->read (buffer, (int) *bytes);
+        auto* reader = static_cast<FlacReader*> (client_data);
+
+        // When a streaming reader is given something that isn't a FLAC stream, the decoder
+        // would read all of it looking for a header, so it gives up after a while.
+        if (reader->isStreaming && reader->sampleRate == 0)
+        {
+            if (reader->numBytesReadBeforeHeader > 65536)
+                return FlacNamespace::FLAC__STREAM_DECODER_READ_STATUS_ABORT;
+
+            reader->numBytesReadBeforeHeader += (int) *bytes;
+        }
+
+        *bytes = (size_t) reader->input->read (buffer, (int) *bytes);
         return FlacNamespace::FLAC__STREAM_DECODER_READ_STATUS_CONTINUE;
     }
 
@@ -381,8 +416,10 @@ public:
 private:
     FlacNamespace::FLAC__StreamDecoder* decoder;
     AudioBuffer<float> reservoir;
-    int reservoirStart = 0, samplesInReservoir = 0;
+    int64 reservoirStart = 0;
+    int samplesInReservoir = 0, numBytesReadBeforeHeader = 0;
     bool ok = false, scanningForLength = false;
+    const bool isStreaming;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlacReader)
 };
@@ -397,17 +434,8 @@ public:
           streamStartPos (output != nullptr ? jmax (output->getPosition(), 0ll) : 0ll)
     {
         encoder = FlacNamespace::FLAC__stream_encoder_new();
-
-        if (qualityOptionIndex > 0)
-            FLAC__stream_encoder_set_compression_level (encoder, (uint32) jmin (8, qualityOptionIndex));
-
-        FLAC__stream_encoder_set_do_mid_side_stereo (encoder, numChannels == 2);
-        FLAC__stream_encoder_set_loose_mid_side_stereo (encoder, numChannels == 2);
-        FLAC__stream_encoder_set_channels (encoder, numChannels);
-        FLAC__stream_encoder_set_bits_per_sample (encoder, jmin ((unsigned int) 24, bitsPerSample));
-        FLAC__stream_encoder_set_sample_rate (encoder, (unsigned int) sampleRate);
+        setEncoderOptions (encoder, numChannels, bitsPerSample, sampleRate, qualityOptionIndex);
         FLAC__stream_encoder_set_blocksize (encoder, 0);
-        FLAC__stream_encoder_set_do_escape_coding (encoder, true);
 
         ok = FLAC__stream_encoder_init_stream (encoder,
                                                encodeWriteCallback, encodeSeekCallback,
@@ -469,6 +497,20 @@ public:
         return output->write (data, (size_t) size);
     }
 
+    static void setEncoderOptions (FlacNamespace::FLAC__StreamEncoder* enc, uint32 numChans, uint32 bits,
+                                   double rate, int qualityOptionIndex)
+    {
+        if (qualityOptionIndex > 0)
+            FLAC__stream_encoder_set_compression_level (enc, (uint32) jmin (8, qualityOptionIndex));
+
+        FLAC__stream_encoder_set_do_mid_side_stereo (enc, numChans == 2);
+        FLAC__stream_encoder_set_loose_mid_side_stereo (enc, numChans == 2);
+        FLAC__stream_encoder_set_channels (enc, numChans);
+        FLAC__stream_encoder_set_bits_per_sample (enc, jmin ((unsigned int) 24, bits));
+        FLAC__stream_encoder_set_sample_rate (enc, (unsigned int) rate);
+        FLAC__stream_encoder_set_do_escape_coding (enc, true);
+    }
+
     static void packUint32 (FlacNamespace::FLAC__uint32 val, FlacNamespace::FLAC__byte* b, const int bytes)
     {
         b += bytes;
@@ -552,6 +594,421 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FlacWriter)
 };
 
+#if JUCE_INCLUDE_FLAC_CODE || ! defined (JUCE_INCLUDE_FLAC_CODE)
+
+//==============================================================================
+// Encodes chunks of a stream on a ThreadPool. Each chunk is a whole number of
+// fixed-size frames, and is given to its own encoder. FLAC frames are independent
+// of each other, so the only thing that ties a frame to its position in the stream
+// is the frame number in its header, which is patched (along with the header and
+// frame CRCs) before the chunks are written out in order. The stream header and
+// the MD5 of the audio are written here rather than by the encoders.
+class ParallelFlacWriter  : public AudioFormatWriter
+{
+public:
+    ParallelFlacWriter (OutputStream* out, double rate, uint32 numChans, uint32 bits,
+                        int qualityOptionIndex, ThreadPool& pool)
+        : AudioFormatWriter (out, flacFormatName, rate, numChans, bits),
+          threadPool (pool),
+          quality (qualityOptionIndex),
+          blockSize (qualityOptionIndex <= 2 ? 1152 : 4096),
+          samplesPerChunk (blockSize * framesPerChunk),
+          maxChunksInFlight (2 * pool.getNumThreads() + 1),
+          streamStartPos (output != nullptr ? jmax (output->getPosition(), 0ll) : 0ll)
+    {
+        assertNotCalledFromPool();
+
+        // make sure that an encoder will accept these settings
+        auto* encoder = createEncoder (nullptr);
+        ok = encoder != nullptr;
+
+        if (encoder != nullptr)
+            FlacNamespace::FLAC__stream_encoder_delete (encoder);
+
+        if (ok)
+        {
+            output->write ("fLaC", 4);
+            output->writeIntBigEndian ((int) (0x80000000 | streamInfoLength)); // the last metadata block
+            output->writeRepeatedByte (0, streamInfoLength);
+
+            FlacNamespace::FLAC__MD5Init (&md5);
+        }
+    }
+
+    ~ParallelFlacWriter() override
+    {
+        assertNotCalledFromPool();
+
+        if (ok)
+        {
+            if (currentChunk != nullptr && currentChunk->numSamples > 0)
+                submitChunk();
+
+            while (! chunksInFlight.isEmpty())
+                writeFinishedChunks (true);
+
+            writeStreamInfo();
+            output->flush();
+        }
+        else
+        {
+            output = nullptr; // to stop the base class deleting this, as it needs to be returned
+                              // to the caller of createWriter()
+        }
+    }
+
+    //==============================================================================
+    bool write (const int** samplesToWrite, int numSamples) override
+    {
+        assertNotCalledFromPool();
+
+        if (! ok)
+            return false;
+
+        auto bitsToShift = 32 - (int) bitsPerSample;
+        bool channelsPresent = true;
+
+        for (int done = 0; done < numSamples;)
+        {
+            if (currentChunk == nullptr)
+            {
+                currentChunk = getEmptyChunk();
+
+                if (currentChunk == nullptr)
+                    return false;
+            }
+
+            auto numToCopy = jmin (numSamples - done, samplesPerChunk - currentChunk->numSamples);
+
+            for (unsigned int i = 0; i < numChannels; ++i)
+            {
+                auto* dest = currentChunk->getChannel ((int) i, samplesPerChunk) + currentChunk->numSamples;
+                channelsPresent = channelsPresent && samplesToWrite[i] != nullptr;
+
+                if (channelsPresent)
+                {
+                    auto* src = samplesToWrite[i] + done;
+
+                    for (int j = 0; j < numToCopy; ++j)
+                        dest[j] = src[j] >> bitsToShift;
+                }
+                else
+                {
+                    zeromem (dest, (size_t) numToCopy * sizeof (int));
+                }
+            }
+
+            currentChunk->numSamples += numToCopy;
+            done += numToCopy;
+
+            if (currentChunk->numSamples == samplesPerChunk)
+                submitChunk();
+        }
+
+        return ! failed;
+    }
+
+    bool ok = false;
+
+private:
+    //==============================================================================
+    struct Chunk
+    {
+        Chunk (int numChans, int samplesPerChannel)  : samples ((size_t) (numChans * samplesPerChannel)) {}
+
+        int* getChannel (int channel, int samplesPerChannel) const noexcept   { return samples + channel * samplesPerChannel; }
+
+        HeapBlock<int> samples;
+        int numSamples = 0;
+        uint32 firstFrameNumber = 0;
+        MemoryOutputStream encoded;
+        uint32 minFrameSize = 0, maxFrameSize = 0;
+        std::atomic<bool> isFinished { false };
+        bool failed = false;
+    };
+
+    enum { framesPerChunk = 16, streamInfoLength = 34 };
+
+    ThreadPool& threadPool;
+    const int quality, blockSize, samplesPerChunk, maxChunksInFlight;
+    const int64 streamStartPos;
+
+    OwnedArray<Chunk> chunks;
+    Array<Chunk*> emptyChunks, chunksInFlight;
+    Chunk* currentChunk = nullptr;
+    WaitableEvent chunkFinished;
+
+    FlacNamespace::FLAC__MD5Context md5;
+    uint64 numSamplesSubmitted = 0;
+    uint32 minFrameSize = 0, maxFrameSize = 0;
+    bool failed = false;
+
+    //==============================================================================
+    // The writer waits for the pool's jobs to finish, so if it was used from one of
+    // those jobs, the pool's threads could all end up waiting for each other.
+    void assertNotCalledFromPool() const
+    {
+        jassert (! threadPool.contains (ThreadPoolJob::getCurrentThreadPoolJob()));
+    }
+
+    Chunk* getEmptyChunk()
+    {
+        writeFinishedChunks (false);
+
+        while (chunksInFlight.size() >= maxChunksInFlight)
+            writeFinishedChunks (true);
+
+        if (failed)
+            return nullptr;
+
+        auto* c = emptyChunks.isEmpty() ? chunks.add (new Chunk ((int) numChannels, samplesPerChunk))
+                                        : emptyChunks.removeAndReturn (emptyChunks.size() - 1);
+        c->numSamples = 0;
+        c->encoded.reset();
+        c->minFrameSize = c->maxFrameSize = 0;
+        c->isFinished = false;
+        c->failed = false;
+        return c;
+    }
+
+    void submitChunk()
+    {
+        auto* c = currentChunk;
+        currentChunk = nullptr;
+
+        c->firstFrameNumber = (uint32) (numSamplesSubmitted / (uint64) blockSize);
+        numSamplesSubmitted += (uint64) c->numSamples;
+
+        HeapBlock<const FlacNamespace::FLAC__int32*> channels (numChannels);
+
+        for (unsigned int i = 0; i < numChannels; ++i)
+            channels[i] = c->getChannel ((int) i, samplesPerChunk);
+
+        FlacNamespace::FLAC__MD5Accumulate (&md5, channels, numChannels, (unsigned) c->numSamples, (bitsPerSample + 7) / 8);
+
+        chunksInFlight.add (c);
+
+        threadPool.addJob ([this, c]
+        {
+            encodeChunk (*c);
+            c->isFinished = true;
+            chunkFinished.signal();
+        });
+    }
+
+    // Writes the chunks at the front of the queue that have been encoded. If waitForOne
+    // is true and the first chunk isn't ready, this waits for it.
+    void writeFinishedChunks (bool waitForOne)
+    {
+        while (! chunksInFlight.isEmpty())
+        {
+            auto* c = chunksInFlight.getFirst();
+
+            if (! c->isFinished)
+            {
+                if (! waitForOne)
+                    break;
+
+                chunkFinished.wait (100);
+                continue;
+            }
+
+            waitForOne = false;
+
+            if (c->failed || ! output->write (c->encoded.getData(), c->encoded.getDataSize()))
+                failed = true;
+
+            if (c->maxFrameSize > 0)
+            {
+                minFrameSize = minFrameSize == 0 ? c->minFrameSize : jmin (minFrameSize, c->minFrameSize);
+                maxFrameSize = jmax (maxFrameSize, c->maxFrameSize);
+            }
+
+            chunksInFlight.remove (0);
+            emptyChunks.add (c);
+        }
+    }
+
+    void writeStreamInfo()
+    {
+        using namespace FlacNamespace;
+
+        FLAC__byte digest[16];
+        FLAC__MD5Final (digest, &md5);
+
+        unsigned char buffer[streamInfoLength];
+        auto channelsMinus1 = numChannels - 1;
+        auto bitsMinus1 = jmin ((unsigned int) 24, bitsPerSample) - 1;
+        auto rate = (unsigned int) sampleRate;
+
+        FlacWriter::packUint32 ((FLAC__uint32) blockSize, buffer, 2);
+        FlacWriter::packUint32 ((FLAC__uint32) blockSize, buffer + 2, 2);
+        FlacWriter::packUint32 (minFrameSize, buffer + 4, 3);
+        FlacWriter::packUint32 (maxFrameSize, buffer + 7, 3);
+        buffer[10] = (uint8) ((rate >> 12) & 0xff);
+        buffer[11] = (uint8) ((rate >> 4) & 0xff);
+        buffer[12] = (uint8) (((rate & 0x0f) << 4) | (channelsMinus1 << 1) | (bitsMinus1 >> 4));
+        buffer[13] = (FLAC__byte) (((bitsMinus1 & 0x0f) << 4) | (unsigned int) ((numSamplesSubmitted >> 32) & 0x0f));
+        FlacWriter::packUint32 ((FLAC__uint32) numSamplesSubmitted, buffer + 14, 4);
+        memcpy (buffer + 18, digest, 16);
+
+        const bool seekOk = output->setPosition (streamStartPos + 8);
+        ignoreUnused (seekOk);
+
+        // if this fails, you've given it an output stream that can't seek! It needs
+        // to be able to seek back to write the header
+        jassert (seekOk);
+
+        output->write (buffer, streamInfoLength);
+    }
+
+    //==============================================================================
+    FlacNamespace::FLAC__StreamEncoder* createEncoder (Chunk* chunk) const
+    {
+        using namespace FlacNamespace;
+
+        auto* encoder = FLAC__stream_encoder_new();
+
+        if (encoder != nullptr)
+        {
+            FlacWriter::setEncoderOptions (encoder, numChannels, bitsPerSample, sampleRate, quality);
+            FLAC__stream_encoder_set_blocksize (encoder, (unsigned) blockSize);
+            FLAC__stream_encoder_set_do_md5 (encoder, false);
+
+            if (FLAC__stream_encoder_init_stream (encoder, chunkWriteCallback, nullptr, nullptr, nullptr, chunk)
+                  != FLAC__STREAM_ENCODER_INIT_STATUS_OK)
+            {
+                FLAC__stream_encoder_delete (encoder);
+                encoder = nullptr;
+            }
+        }
+
+        return encoder;
+    }
+
+    void encodeChunk (Chunk& c) const
+    {
+        using namespace FlacNamespace;
+
+        auto* encoder = createEncoder (&c);
+
+        if (encoder == nullptr)
+        {
+            c.failed = true;
+            return;
+        }
+
+        HeapBlock<const FLAC__int32*> channels (numChannels);
+
+        for (unsigned int i = 0; i < numChannels; ++i)
+            channels[i] = c.getChannel ((int) i, samplesPerChunk);
+
+        if (! FLAC__stream_encoder_process (encoder, channels, (unsigned) c.numSamples))
+            c.failed = true;
+
+        if (! FLAC__stream_encoder_finish (encoder))
+            c.failed = true;
+
+        FLAC__stream_encoder_delete (encoder);
+    }
+
+    static FlacNamespace::FLAC__StreamEncoderWriteStatus chunkWriteCallback (const FlacNamespace::FLAC__StreamEncoder*,
+                                                                             const FlacNamespace::FLAC__byte buffer[],
+                                                                             size_t bytes,
+                                                                             unsigned int samples,
+                                                                             unsigned int currentFrame,
+                                                                             void* clientData)
+    {
+        // calls with no samples are the encoder's stream header, which is written separately
+        if (samples > 0 && clientData != nullptr)
+        {
+            auto& c = *static_cast<Chunk*> (clientData);
+            auto sizeBefore = c.encoded.getDataSize();
+
+            if (! appendFrame (c.encoded, buffer, bytes, c.firstFrameNumber + currentFrame))
+                return FlacNamespace::FLAC__STREAM_ENCODER_WRITE_STATUS_FATAL_ERROR;
+
+            auto frameSize = (uint32) (c.encoded.getDataSize() - sizeBefore);
+            c.minFrameSize = c.minFrameSize == 0 ? frameSize : jmin (c.minFrameSize, frameSize);
+            c.maxFrameSize = jmax (c.maxFrameSize, frameSize);
+        }
+
+        return FlacNamespace::FLAC__STREAM_ENCODER_WRITE_STATUS_OK;
+    }
+
+    // Appends a frame to the stream, with its frame number changed to the given one.
+    static bool appendFrame (MemoryOutputStream& out, const uint8* frame, size_t size, uint32 frameNumber)
+    {
+        using namespace FlacNamespace;
+
+        if (size < 8)
+            return false;
+
+        auto oldNumberLength = getCodedNumberLength (frame[4]);
+        auto blockSizeCode = frame[2] >> 4;
+        auto rateCode = frame[2] & 15;
+        auto extraHeaderLength = (blockSizeCode == 6 ? 1 : (blockSizeCode == 7 ? 2 : 0))
+                               + (rateCode == 12 ? 1 : ((rateCode == 13 || rateCode == 14) ? 2 : 0));
+        auto oldHeaderLength = 4 + oldNumberLength + extraHeaderLength;
+
+        if (oldNumberLength == 0 || (size_t) oldHeaderLength + 3 > size)
+            return false;
+
+        uint8 header[16];
+        memcpy (header, frame, 4);
+        auto numberLength = writeCodedNumber (frameNumber, header + 4);
+        memcpy (header + 4 + numberLength, frame + 4 + oldNumberLength, (size_t) extraHeaderLength);
+        auto headerLength = 4 + numberLength + extraHeaderLength;
+        header[headerLength] = FLAC__crc8 (header, (unsigned) headerLength);
+
+        auto start = out.getDataSize();
+        out.write (header, (size_t) headerLength + 1);
+        out.write (frame + oldHeaderLength + 1, size - (size_t) oldHeaderLength - 3);
+
+        auto* data = static_cast<const uint8*> (out.getData()) + start;
+        auto crc = (uint16) FLAC__crc16 (data, (unsigned) (out.getDataSize() - start));
+        out.writeShortBigEndian ((short) crc);
+        return true;
+    }
+
+    // Frame numbers are coded in the same way as UTF-8 characters.
+    static int getCodedNumberLength (uint8 firstByte) noexcept
+    {
+        if ((firstByte & 0x80) == 0)     return 1;
+        if ((firstByte & 0xe0) == 0xc0)  return 2;
+        if ((firstByte & 0xf0) == 0xe0)  return 3;
+        if ((firstByte & 0xf8) == 0xf0)  return 4;
+        if ((firstByte & 0xfc) == 0xf8)  return 5;
+        if ((firstByte & 0xfe) == 0xfc)  return 6;
+        return 0;
+    }
+
+    static int writeCodedNumber (uint32 value, uint8* dest) noexcept
+    {
+        if (value < 0x80)
+        {
+            dest[0] = (uint8) value;
+            return 1;
+        }
+
+        int numBytes = value < 0x800 ? 2 : value < 0x10000 ? 3 : value < 0x200000 ? 4 : value < 0x4000000 ? 5 : 6;
+        auto numBitsInFirstByte = 7 - numBytes;
+
+        for (int i = numBytes; --i > 0;)
+        {
+            dest[i] = (uint8) (0x80 | (value & 0x3f));
+            value >>= 6;
+        }
+
+        dest[0] = (uint8) ((0xff << (8 - numBytes)) | (value & ((1u << numBitsInFirstByte) - 1)));
+        return numBytes;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelFlacWriter)
+};
+
+#endif
+
 
 //==============================================================================
 FlacAudioFormat::FlacAudioFormat()  : AudioFormat (flacFormatName, ".flac") {}
@@ -585,6 +1042,19 @@ AudioFormatReader* FlacAudioFormat::createReaderFor (InputStream* in, const bool
     return nullptr;
 }
 
+AudioFormatReader* FlacAudioFormat::createStreamingReaderFor (InputStream* in, const bool deleteStreamIfOpeningFails)
+{
+    std::unique_ptr<FlacReader> r (new FlacReader (in, true));
+
+    if (r->sampleRate > 0)
+        return r.release();
+
+    if (! deleteStreamIfOpeningFails)
+        r->input = nullptr;
+
+    return nullptr;
+}
+
 AudioFormatWriter* FlacAudioFormat::createWriterFor (OutputStream* out,
                                                      double sampleRate,
                                                      unsigned int numberOfChannels,
@@ -603,11 +1073,183 @@ AudioFormatWriter* FlacAudioFormat::createWriterFor (OutputStream* out,
     return nullptr;
 }
 
+AudioFormatWriter* FlacAudioFormat::createWriterFor (OutputStream* out,
+                                                     double sampleRate,
+                                                     unsigned int numberOfChannels,
+                                                     int bitsPerSample,
+                                                     const StringPairArray& metadataValues,
+                                                     int qualityOptionIndex,
+                                                     ThreadPool& threadPool)
+{
+   #if JUCE_INCLUDE_FLAC_CODE || ! defined (JUCE_INCLUDE_FLAC_CODE)
+    ignoreUnused (metadataValues);
+
+    if (out != nullptr && getPossibleBitDepths().contains (bitsPerSample))
+    {
+        std::unique_ptr<ParallelFlacWriter> w (new ParallelFlacWriter (out, sampleRate, numberOfChannels,
+                                                                       (uint32) bitsPerSample, qualityOptionIndex,
+                                                                       threadPool));
+        if (w->ok)
+            return w.release();
+    }
+
+    return nullptr;
+   #else
+    ignoreUnused (threadPool);
+    return createWriterFor (out, sampleRate, numberOfChannels, bitsPerSample, metadataValues, qualityOptionIndex);
+   #endif
+}
+
 StringArray FlacAudioFormat::getQualityOptions()
 {
     return { "0 (Fastest)", "1", "2", "3", "4", "5 (Default)","6", "7", "8 (Highest quality)" };
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct FlacAudioFormatTests  : public UnitTest
+{
+    FlacAudioFormatTests()
+        : UnitTest ("FLAC audio format", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Encoding on several threads");
+        {
+            struct Settings { int numChannels, bitsPerSample, quality, numSamples, numThreads; };
+            const Settings settings[] = { { 3, 24, 5, 200000 + 1234, 3 },
+                                          { 2, 16, 0, 100000, 2 },
+                                          { 1, 16, 8, 4096 * 16, 1 },
+                                          { 2, 24, 5, 100, 2 },
+                                          { 2, 16, 5, 0, 2 },
+                                          { 2, 16, 1, 1152 * 16 * 300 + 5, 4 } };
+
+            for (auto& s : settings)
+            {
+                auto source = createSignal (random, s.numChannels, s.numSamples, s.bitsPerSample);
+
+                ThreadPool pool (s.numThreads);
+                auto single   = encode (source, s.bitsPerSample, s.quality, nullptr);
+                auto parallel = encode (source, s.bitsPerSample, s.quality, &pool);
+
+                expect (decodesTo (parallel, source, s.bitsPerSample));
+                expect (decodesTo (single, source, s.bitsPerSample));
+
+                // the STREAMINFO blocks should have the same block sizes, length and MD5
+                auto* a = static_cast<const uint8*> (single.getData()) + 8;
+                auto* b = static_cast<const uint8*> (parallel.getData()) + 8;
+                expect (memcmp (a, b, 4) == 0);
+                expect (memcmp (a + 10, b + 10, 24) == 0);
+            }
+        }
+
+        beginTest ("Encoding throughput");
+        {
+            const int numChannels = 8, sampleRate = 96000, numSeconds = 5;
+            auto source = createSignal (random, numChannels, sampleRate * numSeconds, 24);
+
+            auto logThroughput = [&] (const String& description, ThreadPool* pool)
+            {
+                auto start = Time::getMillisecondCounterHiRes();
+                encode (source, 24, 5, pool);
+                auto elapsed = (Time::getMillisecondCounterHiRes() - start) / 1000.0;
+
+                logMessage (String (numChannels) + " channels of 24-bit " + String (sampleRate / 1000) + "kHz, "
+                              + description + ": " + String (numSeconds / elapsed, 1) + "x realtime");
+            };
+
+            logThroughput ("single-threaded writer", nullptr);
+
+            for (int numThreads = 1; numThreads <= 8; numThreads *= 2)
+            {
+                ThreadPool pool (numThreads);
+                logThroughput (String (numThreads) + " threads", &pool);
+            }
+        }
+    }
+
+private:
+    // A noisy signal, with some sines to give the encoder something to predict.
+    static AudioBuffer<int> createSignal (Random& random, int numChannels, int numSamples, int bitsPerSample)
+    {
+        AudioBuffer<int> buffer (numChannels, numSamples);
+        auto maxValue = (1 << (bitsPerSample - 1)) - 1;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto value = 0.5 * std::sin (i * 0.01 * (ch + 1)) + 0.2 * std::sin (i * 0.13) + 0.05 * (random.nextDouble() - 0.5);
+                buffer.setSample (ch, i, roundToInt (value * maxValue) << (32 - bitsPerSample));
+            }
+        }
+
+        return buffer;
+    }
+
+    static MemoryBlock encode (const AudioBuffer<int>& source, int bitsPerSample, int quality, ThreadPool* pool)
+    {
+        MemoryBlock data;
+        FlacAudioFormat format;
+        auto* out = new MemoryOutputStream (data, false);
+
+        std::unique_ptr<AudioFormatWriter> writer (pool != nullptr
+            ? format.createWriterFor (out, 48000.0, (unsigned int) source.getNumChannels(), bitsPerSample, {}, quality, *pool)
+            : format.createWriterFor (out, 48000.0, (unsigned int) source.getNumChannels(), bitsPerSample, {}, quality));
+
+        // write in awkwardly-sized pieces
+        for (int pos = 0; pos < source.getNumSamples();)
+        {
+            auto numToWrite = jmin (source.getNumSamples() - pos, 3000 + pos % 7919);
+            HeapBlock<const int*> channels ((size_t) source.getNumChannels() + 1, true);
+
+            for (int ch = 0; ch < source.getNumChannels(); ++ch)
+                channels[ch] = source.getReadPointer (ch, pos);
+
+            writer->write (channels, numToWrite);
+            pos += numToWrite;
+        }
+
+        writer.reset();
+        return data;
+    }
+
+    static bool decodesTo (const MemoryBlock& data, const AudioBuffer<int>& expected, int bitsPerSample)
+    {
+        FlacAudioFormat format;
+        std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (data, false), true));
+
+        if (reader == nullptr
+             || reader->lengthInSamples != expected.getNumSamples()
+             || (int) reader->numChannels != expected.getNumChannels()
+             || (int) reader->bitsPerSample != bitsPerSample)
+            return false;
+
+        if (expected.getNumSamples() == 0)
+            return true;
+
+        AudioBuffer<int> decoded (expected.getNumChannels(), expected.getNumSamples());
+        reader->read (decoded.getArrayOfWritePointers(), decoded.getNumChannels(), 0, decoded.getNumSamples(), false);
+
+        for (int ch = 0; ch < expected.getNumChannels(); ++ch)
+            if (memcmp (decoded.getReadPointer (ch), expected.getReadPointer (ch), (size_t) expected.getNumSamples() * sizeof (int)) != 0)
+                return false;
+
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (FlacAudioFormatTests)
+};
+
+static const FlacAudioFormatTests flacAudioFormatTests;
+
+#endif
+
 #endif
 
 } // namespace juce
@@ -58,12 +58,44 @@ public:
     AudioFormatReader* createReaderFor (InputStream* sourceStream,
                                         bool deleteStreamIfOpeningFails) override;
 
+    AudioFormatReader* createStreamingReaderFor (InputStream* sourceStream,
+                                                 bool deleteStreamIfOpeningFails) override;
+
     AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
                                         double sampleRateToUse,
                                         unsigned int numberOfChannels,
                                         int bitsPerSample,
                                         const StringPairArray& metadataValues,
                                         int qualityOptionIndex) override;
+
+    /** Creates a writer which encodes on several threads at once.
+
+        The audio is split into chunks of a few FLAC frames, and each chunk is encoded by
+        a job on the ThreadPool that's passed in. The encoded chunks are written out in
+        order, so the result is an ordinary FLAC stream, but encoding can use as many
+        cores as the pool has threads. The writer holds a few chunks of audio per thread
+        in memory while they're being encoded.
+
+        The ThreadPool can be shared by several writers, and must not be deleted while
+        any of them are still in use. The other parameters are the same as for the other
+        createWriterFor() method.
+
+        The writer waits for the pool's jobs when its queue of chunks is full and when
+        it's deleted, so it mustn't be used from a job that's running on the same pool:
+        if all the pool's threads end up waiting like that, none of them are left to do
+        the encoding, and they'll deadlock. Either use a separate pool for the encoding,
+        or call the writer from a thread that isn't part of the pool.
+
+        If JUCE_INCLUDE_FLAC_CODE is disabled, this just returns an ordinary writer.
+    */
+    AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
+                                        double sampleRateToUse,
+                                        unsigned int numberOfChannels,
+                                        int bitsPerSample,
+                                        const StringPairArray& metadataValues,
+                                        int qualityOptionIndex,
+                                        ThreadPool& threadPool);
+
     using AudioFormat::createWriterFor;
 
 private:
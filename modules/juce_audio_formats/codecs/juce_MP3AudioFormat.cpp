@@ -1549,31 +1549,155 @@ struct MP3Stream
     {
         frameIndex = jmax (0, frameIndex);
 
-        while (frameIndex >= frameStreamPositions.size() * storedStartPosInterval)
+        if (! isFrameIndexed (frameIndex))
         {
-            int dummy = 0;
-            auto result = decodeNextBlock (nullptr, nullptr, dummy);
+            if (useTableOfContents && ! indexIsComplete && tableOfContents.size() > 1)
+                return seekUsingTableOfContents (frameIndex);
 
-            if (result < 0)
-                return false;
+            if (scanFrameHeaders (frameIndex))
+            {
+                if (! isFrameIndexed (frameIndex))
+                    return false;
+            }
+            else
+            {
+                while (! isFrameIndexed (frameIndex))
+                {
+                    int dummy = 0;
+                    auto result = decodeNextBlock (nullptr, nullptr, dummy);
 
-            if (result > 0)
-                break;
+                    if (result < 0)
+                        return false;
+
+                    if (result > 0)
+                        break;
+                }
+            }
         }
 
         frameIndex = jmin (frameIndex & ~(storedStartPosInterval - 1),
                            frameStreamPositions.size() * storedStartPosInterval - 1);
         stream.setPosition (frameStreamPositions.getUnchecked (frameIndex / storedStartPosInterval));
         currentFrameIndex = frameIndex;
+        positionIsApproximate = false;
         reset();
         return true;
     }
 
+    // Fills in the seek table by stepping from one frame header to the next, without
+    // decoding any audio. A negative frameIndex means the whole stream is indexed.
+    // This fails for free-format streams, whose headers don't give the frame length,
+    // so they can only be indexed by decoding them.
+    bool scanFrameHeaders (int frameIndex)
+    {
+        if (frameStreamPositions.isEmpty())
+            return false;
+
+        auto oldPos = stream.getPosition();
+        auto index = (frameStreamPositions.size() - 1) * (int) storedStartPosInterval;
+        auto pos = frameStreamPositions.getLast();
+        bool canScan = true;
+
+        while (! indexIsComplete && (frameIndex < 0 || ! isFrameIndexed (frameIndex)))
+        {
+            stream.setPosition (pos);
+            auto frameLength = getFrameLength ((uint32) stream.readIntBigEndian());
+
+            if (frameLength <= 0)
+            {
+                canScan = false;
+                break;
+            }
+
+            pos = findFrameHeader (pos + frameLength);
+
+            if (pos < 0)
+            {
+                indexIsComplete = true;
+                break;
+            }
+
+            if ((++index & (storedStartPosInterval - 1)) == 0)
+                frameStreamPositions.add (pos);
+        }
+
+        stream.setPosition (oldPos);
+        return canScan;
+    }
+
+    bool writeSeekIndex (OutputStream& out)
+    {
+        if (! (scanFrameHeaders (-1) && indexIsComplete))
+            return false;
+
+        out.writeInt (seekIndexMagic);
+        out.writeInt64 (stream.getTotalLength());
+        out.writeInt (storedStartPosInterval);
+        out.writeInt (frameStreamPositions.size());
+        out.writeInt64 (frameStreamPositions.getFirst());
+
+        for (int i = 1; i < frameStreamPositions.size(); ++i)
+            if (! out.writeCompressedInt ((int) (frameStreamPositions.getUnchecked (i) - frameStreamPositions.getUnchecked (i - 1))))
+                return false;
+
+        return true;
+    }
+
+    bool readSeekIndex (InputStream& in)
+    {
+        if (frameStreamPositions.isEmpty()
+             || in.readInt() != seekIndexMagic
+             || in.readInt64() != stream.getTotalLength()
+             || in.readInt() != storedStartPosInterval)
+            return false;
+
+        auto numEntries = in.readInt();
+
+        // The index comes from outside, so its size is checked before anything is allocated.
+        // No valid frame is smaller than 24 bytes, which limits how many entries this stream
+        // could possibly need, and each entry after the first takes at least one byte.
+        const int64 minFrameBytes = 24;
+        auto maxEntries = stream.getTotalLength() / (minFrameBytes * storedStartPosInterval) + 1;
+        auto bytesRemaining = in.getNumBytesRemaining();
+
+        if (numEntries <= 0 || numEntries > maxEntries
+             || (bytesRemaining >= 0 && numEntries - 1 > bytesRemaining)
+             || in.readInt64() != frameStreamPositions.getFirst())
+            return false;
+
+        Array<int64> positions;
+        positions.ensureStorageAllocated (numEntries);
+        positions.add (frameStreamPositions.getFirst());
+
+        for (int i = 1; i < numEntries; ++i)
+        {
+            auto delta = in.readCompressedInt();
+
+            if (delta <= 0)
+                return false;
+
+            positions.add (positions.getLast() + delta);
+        }
+
+        // a quick check that the index really belongs to this stream
+        auto oldPos = stream.getPosition();
+        stream.setPosition (positions.getLast());
+        auto lastHeaderIsValid = isValidHeader ((uint32) stream.readIntBigEndian(), frame.layer);
+        stream.setPosition (oldPos);
+
+        if (! lastHeaderIsValid)
+            return false;
+
+        frameStreamPositions.swapWith (positions);
+        indexIsComplete = true;
+        return true;
+    }
+
     MP3Frame frame;
     VBRTagData vbrTagData;
     BufferedInputStream stream;
     int numFrames = 0, currentFrameIndex = 0;
-    bool vbrHeaderFound = false;
+    bool vbrHeaderFound = false, useTableOfContents = false;
 
 private:
     bool headerParsed, sideParsed, dataParsed, needToSyncBitStream;
@@ -1610,6 +1734,79 @@ private:
 
     enum { storedStartPosInterval = 4 };
     Array<int64> frameStreamPositions;
+    bool indexIsComplete = false, positionIsApproximate = false;
+
+    // The byte offsets from the first frame, at regular frame intervals, taken from
+    // a Xing or VBRI header's table of contents
+    Array<int64> tableOfContents;
+    double framesPerTableEntry = 0;
+
+    static constexpr int seekIndexMagic = (int) 0x4933504d; // 'MP3I'
+
+    bool isFrameIndexed (int frameIndex) const noexcept
+    {
+        return frameIndex < frameStreamPositions.size() * storedStartPosInterval;
+    }
+
+    static int getFrameLength (uint32 header) noexcept
+    {
+        if (! isValidHeader (header, 0) || ((header >> 12) & 15) == 0)
+            return 0;
+
+        MP3Frame f;
+        f.decodeHeader (header);
+        return f.frameSize + 4;
+    }
+
+    int64 findFrameHeader (int64 startPos)
+    {
+        stream.setPosition (startPos);
+        uint32 header = 0;
+
+        for (int offset = -3; offset <= 32768 && ! stream.isExhausted(); ++offset)
+        {
+            header = (header << 8) | (uint8) stream.readByte();
+
+            if (offset >= 0 && isValidHeader (header, frame.layer))
+                return startPos + offset;
+        }
+
+        return -1;
+    }
+
+    bool seekUsingTableOfContents (int frameIndex)
+    {
+        // the table doesn't count the frame that holds it
+        auto entry = jmax (0.0, (frameIndex - 1) / framesPerTableEntry);
+        auto i = jmin ((int) entry, tableOfContents.size() - 2);
+        auto start = tableOfContents.getUnchecked (i);
+        auto end   = tableOfContents.getUnchecked (i + 1);
+        auto searchPos = frameStreamPositions.getFirst() + start + (int64) ((entry - i) * (double) (end - start));
+
+        for (;;)
+        {
+            auto pos = findFrameHeader (searchPos);
+
+            if (pos < 0)
+                return false;
+
+            // make sure this isn't a false sync by checking that another frame follows it
+            stream.setPosition (pos);
+            auto frameLength = getFrameLength ((uint32) stream.readIntBigEndian());
+            stream.setPosition (pos + frameLength);
+
+            if (frameLength > 0 && isValidHeader ((uint32) stream.readIntBigEndian(), frame.layer))
+            {
+                stream.setPosition (pos);
+                currentFrameIndex = frameIndex;
+                positionIsApproximate = true;
+                reset();
+                return true;
+            }
+
+            searchPos = pos + 1;
+        }
+    }
 
     struct SideInfoLayer1
     {
@@ -1721,7 +1918,7 @@ private:
 
         if (offset >= 0)
         {
-            if ((currentFrameIndex & (storedStartPosInterval - 1)) == 0)
+            if (! positionIsApproximate && (currentFrameIndex & (storedStartPosInterval - 1)) == 0)
                 frameStreamPositions.set (currentFrameIndex / storedStartPosInterval, oldPos + offset);
 
             ++currentFrameIndex;
@@ -1743,11 +1940,71 @@ private:
         {
             numFrames = (int) vbrTagData.frames;
             oldPos += jmax (vbrTagData.headersize, 1);
+
+            if (tableOfContents.isEmpty() && (vbrTagData.flags & 7) == 7 && vbrTagData.frames > 0)
+            {
+                for (int i = 0; i < 100; ++i)
+                    tableOfContents.add ((int64) vbrTagData.toc[i] * vbrTagData.bytes / 256);
+
+                tableOfContents.add ((int64) vbrTagData.bytes);
+                framesPerTableEntry = vbrTagData.frames / 100.0;
+            }
+        }
+        else
+        {
+            auto frameLength = readVBRIHeader (xing, oldPos);
+            vbrHeaderFound = frameLength > 0;
+            oldPos += frameLength;
         }
 
         stream.setPosition (oldPos);
     }
 
+    // Fraunhofer encoders write a VBRI header rather than a Xing one. This returns
+    // the length of the frame that holds it, or 0 if there isn't one.
+    int readVBRIHeader (const uint8* data, int64 framePos)
+    {
+        auto* d = data + 36;
+
+        if (! (d[0] == 'V' && d[1] == 'B' && d[2] == 'R' && d[3] == 'I'))
+            return 0;
+
+        auto frameLength = getFrameLength (ByteOrder::bigEndianInt (data));
+
+        if (frameLength <= 0)
+            return 0;
+
+        numFrames = (int) ByteOrder::bigEndianInt (d + 14);
+
+        auto numEntries     = (int) ByteOrder::bigEndianShort (d + 18);
+        auto scale          = (int) ByteOrder::bigEndianShort (d + 20);
+        auto entrySize      = (int) ByteOrder::bigEndianShort (d + 22);
+        auto framesPerEntry = (int) ByteOrder::bigEndianShort (d + 24);
+
+        if (tableOfContents.isEmpty() && numEntries > 0 && framesPerEntry > 0
+             && entrySize >= 1 && entrySize <= 4)
+        {
+            stream.setPosition (framePos + 36 + 26);
+            int64 offset = 0;
+            tableOfContents.add (offset);
+
+            for (int i = 0; i < numEntries; ++i)
+            {
+                uint32 size = 0;
+
+                for (int j = 0; j < entrySize; ++j)
+                    size = (size << 8) | (uint8) stream.readByte();
+
+                offset += (int64) size * scale;
+                tableOfContents.add (offset);
+            }
+
+            framesPerTableEntry = framesPerEntry;
+        }
+
+        return frameLength;
+    }
+
     void decodeLayer1Frame (float* pcm0, float* pcm1, int& samplesDone) noexcept
     {
         float fraction[2][32];
@@ -2941,10 +3198,11 @@ static const char* const mp3FormatName = "MP3 file";
 class MP3Reader : public AudioFormatReader
 {
 public:
-    MP3Reader (InputStream* const in)
+    MP3Reader (InputStream* const in, bool streaming = false)
         : AudioFormatReader (in, mp3FormatName),
-          stream (*in), currentPosition (0),
-          decodedStart (0), decodedEnd (0)
+          streamingInput (streaming ? new RewindableInputStream (in, 65536, false) : nullptr),
+          stream (streaming ? *streamingInput : *in), currentPosition (0),
+          decodedStart (0), decodedEnd (0), isStreaming (streaming)
     {
         skipID3();
         const int64 streamPos = stream.stream.getPosition();
@@ -2964,7 +3222,18 @@ public:
     {
         jassert (destSamples != nullptr);
 
-        if (currentPosition != startSampleInFile)
+        if (currentPosition != startSampleInFile && isStreaming)
+        {
+            if (startSampleInFile < currentPosition || ! skipForwards (startSampleInFile - currentPosition))
+            {
+                for (int i = numDestChannels; --i >= 0;)
+                    if (destSamples[i] != nullptr)
+                        zeromem (destSamples[i] + startOffsetInDestBuffer, (size_t) numSamples * sizeof (float));
+
+                return false;
+            }
+        }
+        else if (currentPosition != startSampleInFile)
         {
             if (! stream.seek ((int) (startSampleInFile / 1152 - 1)))
             {
@@ -3005,6 +3274,9 @@ public:
         {
             if (decodedEnd <= decodedStart && ! readNextBlock())
             {
+                if (lengthInSamples == std::numeric_limits<int64>::max())
+                    lengthInSamples = currentPosition;
+
                 for (int i = numDestChannels; --i >= 0;)
                     if (destSamples[i] != nullptr)
                         zeromem (destSamples[i] + startOffsetInDestBuffer, (size_t) numSamples * sizeof (float));
@@ -3028,12 +3300,41 @@ public:
         return true;
     }
 
+    bool loadSeekIndex (InputStream& in)                { return stream.readSeekIndex (in); }
+    bool writeSeekIndex (OutputStream& out)             { return ! isStreaming && stream.writeSeekIndex (out); }
+    void setUsesTableOfContents (bool b) noexcept       { stream.useTableOfContents = b; }
+
 private:
+    // when streaming, this lets the decoder go back after looking ahead for a frame header
+    std::unique_ptr<InputStream> streamingInput;
     MP3Stream stream;
     int64 currentPosition;
     enum { decodedDataSize = 1152 };
     float decoded0[decodedDataSize], decoded1[decodedDataSize];
     int decodedStart, decodedEnd;
+    const bool isStreaming;
+
+    // A streaming reader can't seek, so it moves forwards by decoding and discarding
+    bool skipForwards (int64 numToSkip)
+    {
+        while (numToSkip > 0)
+        {
+            if (decodedEnd <= decodedStart && ! readNextBlock())
+            {
+                if (lengthInSamples == std::numeric_limits<int64>::max())
+                    lengthInSamples = currentPosition;
+
+                return false;
+            }
+
+            auto numToUse = (int) jmin ((int64) (decodedEnd - decodedStart), numToSkip);
+            decodedStart += numToUse;
+            currentPosition += numToUse;
+            numToSkip -= numToUse;
+        }
+
+        return true;
+    }
 
     void createEmptyDecodedData() noexcept
     {
@@ -3097,6 +3398,10 @@ private:
     {
         int64 numFrames = stream.numFrames;
 
+        // the size of a stream that's still arriving doesn't say how long it'll be
+        if (numFrames <= 0 && isStreaming)
+            return std::numeric_limits<int64>::max();
+
         if (numFrames <= 0)
         {
             const int64 streamSize = stream.stream.getTotalLength();
@@ -3132,11 +3437,36 @@ bool MP3AudioFormat::isCompressed()                 { return true; }
 StringArray MP3AudioFormat::getQualityOptions()     { return {}; }
 
 AudioFormatReader* MP3AudioFormat::createReaderFor (InputStream* sourceStream, const bool deleteStreamIfOpeningFails)
+{
+    return createReaderFor (sourceStream, nullptr, false, deleteStreamIfOpeningFails);
+}
+
+AudioFormatReader* MP3AudioFormat::createStreamingReaderFor (InputStream* sourceStream, const bool deleteStreamIfOpeningFails)
+{
+    std::unique_ptr<MP3Decoder::MP3Reader> r (new MP3Decoder::MP3Reader (sourceStream, true));
+
+    if (r->lengthInSamples > 0)
+        return r.release();
+
+    if (! deleteStreamIfOpeningFails)
+        r->input = nullptr;
+
+    return nullptr;
+}
+
+AudioFormatReader* MP3AudioFormat::createReaderFor (InputStream* sourceStream, InputStream* seekIndex,
+                                                    bool useTableOfContents, bool deleteStreamIfOpeningFails)
 {
     std::unique_ptr<MP3Decoder::MP3Reader> r (new MP3Decoder::MP3Reader (sourceStream));
 
     if (r->lengthInSamples > 0)
+    {
+        if (seekIndex != nullptr)
+            r->loadSeekIndex (*seekIndex);
+
+        r->setUsesTableOfContents (useTableOfContents);
         return r.release();
+    }
 
     if (! deleteStreamIfOpeningFails)
         r->input = nullptr;
@@ -3152,6 +3482,229 @@ AudioFormatWriter* MP3AudioFormat::createWriterFor (OutputStream*, double /*samp
     return nullptr;
 }
 
+bool MP3AudioFormat::writeSeekIndex (AudioFormatReader& reader, OutputStream& destination)
+{
+    if (auto* r = dynamic_cast<MP3Decoder::MP3Reader*> (&reader))
+        return r->writeSeekIndex (destination);
+
+    return false;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct MP3SeekIndexTests  : public UnitTest
+{
+    MP3SeekIndexTests()
+        : UnitTest ("MP3 seek index", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        MP3AudioFormat format;
+        auto stream = createStream (2000, false);
+
+        MemoryBlock scannedIndex;
+
+        beginTest ("Scanning the headers finds the same frames as decoding");
+        {
+            std::unique_ptr<AudioFormatReader> reader (createReader (format, stream));
+            expect (reader != nullptr);
+            expect (writeIndex (*reader, scannedIndex));
+
+            MemoryBlock decodedIndex;
+            std::unique_ptr<AudioFormatReader> decodingReader (createReader (format, stream));
+            AudioBuffer<float> buffer (2, 1152 * 8);
+
+            for (int64 pos = 0; pos < decodingReader->lengthInSamples; pos += buffer.getNumSamples())
+                decodingReader->read (&buffer, 0, buffer.getNumSamples(), pos, true, true);
+
+            expect (writeIndex (*decodingReader, decodedIndex));
+            expect (decodedIndex == scannedIndex);
+        }
+
+        beginTest ("Saved index");
+        {
+            MemoryInputStream indexStream (scannedIndex, false);
+            std::unique_ptr<AudioFormatReader> reader (createReader (format, stream, &indexStream));
+
+            MemoryBlock rewrittenIndex;
+            expect (writeIndex (*reader, rewrittenIndex));
+            expect (rewrittenIndex == scannedIndex);
+
+            AudioBuffer<float> buffer (2, 1152);
+            expect (reader->readSamples (const_cast<int**> (reinterpret_cast<int* const*> (buffer.getArrayOfWritePointers())),
+                                         2, 0, reader->lengthInSamples - 1152 * 3, 1152));
+        }
+
+        beginTest ("Mismatched index is ignored");
+        {
+            MemoryBlock otherIndex;
+
+            {
+                std::unique_ptr<AudioFormatReader> otherReader (createReader (format, createStream (1000, false)));
+                expect (writeIndex (*otherReader, otherIndex));
+            }
+
+            MemoryInputStream indexStream (otherIndex, false);
+            std::unique_ptr<AudioFormatReader> reader (createReader (format, stream, &indexStream));
+
+            MemoryBlock rewrittenIndex;
+            expect (writeIndex (*reader, rewrittenIndex));
+            expect (rewrittenIndex == scannedIndex);
+        }
+
+        beginTest ("Index with an impossible number of entries is ignored");
+        {
+            // the entry count follows the magic number, stream length and interval
+            for (auto numEntries : { std::numeric_limits<int>::max(), 100000 })
+            {
+                MemoryBlock corruptIndex (scannedIndex);
+                auto storedValue = ByteOrder::swapIfBigEndian ((uint32) numEntries);
+                corruptIndex.copyFrom (&storedValue, 16, sizeof (storedValue));
+
+                MemoryInputStream indexStream (corruptIndex, false);
+                std::unique_ptr<AudioFormatReader> reader (createReader (format, stream, &indexStream));
+                expect (reader != nullptr);
+
+                MemoryBlock rewrittenIndex;
+                expect (writeIndex (*reader, rewrittenIndex));
+                expect (rewrittenIndex == scannedIndex);
+            }
+        }
+
+        beginTest ("Xing table of contents");
+        {
+            auto vbrStream = createStream (2000, true);
+            std::unique_ptr<AudioFormatReader> reader (createReader (format, vbrStream, nullptr, true));
+            expectEquals (reader->lengthInSamples, (int64) 2000 * 1152);
+
+            AudioBuffer<float> buffer (2, 1152);
+            auto** dest = const_cast<int**> (reinterpret_cast<int* const*> (buffer.getArrayOfWritePointers()));
+            expect (reader->readSamples (dest, 2, 0, 1500 * 1152, 1152));
+            expect (reader->readSamples (dest, 2, 0, 1000 * 1152, 1152));
+            expect (reader->readSamples (dest, 2, 0, 100 * 1152, 1152));
+
+            // jumping with the table mustn't leave inexact positions in the index
+            MemoryBlock index, exactIndex;
+            expect (writeIndex (*reader, index));
+
+            std::unique_ptr<AudioFormatReader> exactReader (createReader (format, vbrStream));
+            expect (writeIndex (*exactReader, exactIndex));
+            expect (index == exactIndex);
+        }
+
+        beginTest ("Seek performance");
+        {
+            auto longStream = createStream (10000, false);
+            auto seekPos = (int64) 9990 * 1152;
+            AudioBuffer<float> buffer (2, 1152);
+
+            auto timeSeek = [&] (InputStream* index)
+            {
+                auto start = Time::getMillisecondCounterHiRes();
+                std::unique_ptr<AudioFormatReader> reader (createReader (format, longStream, index));
+                reader->read (&buffer, 0, buffer.getNumSamples(), seekPos, true, true);
+                return Time::getMillisecondCounterHiRes() - start;
+            };
+
+            auto scanTime = timeSeek (nullptr);
+
+            MemoryBlock index;
+            {
+                std::unique_ptr<AudioFormatReader> reader (createReader (format, longStream));
+                expect (writeIndex (*reader, index));
+            }
+
+            MemoryInputStream indexStream (index, false);
+            auto indexedTime = timeSeek (&indexStream);
+
+            auto start = Time::getMillisecondCounterHiRes();
+            {
+                std::unique_ptr<AudioFormatReader> reader (createReader (format, longStream));
+
+                for (int64 pos = 0; pos <= seekPos; pos += buffer.getNumSamples())
+                    reader->read (&buffer, 0, buffer.getNumSamples(), pos, true, true);
+            }
+            auto decodeTime = Time::getMillisecondCounterHiRes() - start;
+
+            logMessage ("First seek to the end of a 10000 frame stream: decoding up to it "
+                          + String (decodeTime, 1) + " ms, scanning the headers "
+                          + String (scanTime, 1) + " ms, with a saved index ("
+                          + String ((int) index.getSize()) + " bytes) "
+                          + String (indexedTime, 1) + " ms");
+        }
+    }
+
+private:
+    // Makes a stream of silent 128kbps MPEG-1 layer 3 frames, with an ID3 tag at the
+    // start, and a few bytes of junk between some of the frames.
+    static MemoryBlock createStream (int numFrames, bool withXingHeader)
+    {
+        MemoryOutputStream out;
+
+        const uint8 id3Tag[] = { 'I', 'D', '3', 3, 0, 0, 0, 0, 0, 100 };
+        out.write (id3Tag, sizeof (id3Tag));
+        out.writeRepeatedByte (0, 100);
+
+        auto writeFrame = [&out] (bool padded, const uint8* payload, size_t payloadSize)
+        {
+            const uint8 header[] = { 0xff, 0xfb, (uint8) (padded ? 0x92 : 0x90), 0x00 };
+            out.write (header, sizeof (header));
+
+            auto frameLength = padded ? 418 : 417;
+            out.write (payload, payloadSize);
+            out.writeRepeatedByte (0, (size_t) frameLength - 4 - payloadSize);
+        };
+
+        if (withXingHeader)
+        {
+            auto audioBytes = (uint32) (numFrames * 418);
+
+            MemoryOutputStream xing;
+            xing.writeRepeatedByte (0, 32);
+            xing.write ("Xing", 4);
+            xing.writeIntBigEndian (7);
+            xing.writeIntBigEndian (numFrames);
+            xing.writeIntBigEndian ((int) audioBytes);
+
+            for (int i = 0; i < 100; ++i)
+                xing.writeByte ((char) (i * 256 / 100));
+
+            writeFrame (false, static_cast<const uint8*> (xing.getData()), xing.getDataSize());
+        }
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            writeFrame (withXingHeader || i % 3 == 0, nullptr, 0);
+
+            if (! withXingHeader && i % 97 == 50)
+                out.writeRepeatedByte (0, 5);
+        }
+
+        return out.getMemoryBlock();
+    }
+
+    static AudioFormatReader* createReader (MP3AudioFormat& format, const MemoryBlock& data,
+                                            InputStream* index = nullptr, bool useTableOfContents = false)
+    {
+        return format.createReaderFor (new MemoryInputStream (data, false), index, useTableOfContents, true);
+    }
+
+    static bool writeIndex (AudioFormatReader& reader, MemoryBlock& destination)
+    {
+        MemoryOutputStream out (destination, false);
+        return MP3AudioFormat::writeSeekIndex (reader, out);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (MP3SeekIndexTests)
+};
+
+static const MP3SeekIndexTests mp3SeekIndexTests;
+
+#endif
+
 #endif
 
 } // namespace juce
@@ -62,11 +62,42 @@ public:
 
     //==============================================================================
     AudioFormatReader* createReaderFor (InputStream*, bool deleteStreamIfOpeningFails) override;
+    AudioFormatReader* createStreamingReaderFor (InputStream*, bool deleteStreamIfOpeningFails) override;
 
     AudioFormatWriter* createWriterFor (OutputStream*, double sampleRateToUse,
                                         unsigned int numberOfChannels, int bitsPerSample,
                                         const StringPairArray& metadataValues, int qualityOptionIndex) override;
     using AudioFormat::createWriterFor;
+
+    //==============================================================================
+    /** Creates a reader, optionally giving it a seek index that was saved earlier.
+
+        To seek, an MP3 reader needs to know where each frame starts. It finds this out
+        as it goes, by stepping through the frame headers up to the furthest position
+        that it's been asked to read, which means reading through that much of the
+        file. If you've saved the stream's index with writeSeekIndex(), passing it in as
+        seekIndex lets the reader jump straight to any position. An index that doesn't
+        match the stream is ignored. The reader doesn't keep the seekIndex stream, so
+        the caller still owns it.
+
+        If useTableOfContents is true and the file has a Xing or VBRI header containing
+        a table of contents, jumps to parts of the file that the reader hasn't indexed
+        yet are made by looking them up in that table instead. This is quick, but the
+        table is coarse, so the audio that's read after such a jump may be a few frames
+        away from the position that was asked for.
+    */
+    AudioFormatReader* createReaderFor (InputStream* sourceStream, InputStream* seekIndex,
+                                        bool useTableOfContents, bool deleteStreamIfOpeningFails);
+
+    /** Indexes all the frames in the stream that a reader is using, and writes the
+        index to a stream, so that it can be passed to createReaderFor() when the same
+        file is opened again.
+
+        The reader must have been created by an MP3AudioFormat. Returns false if it
+        wasn't, if it's a streaming reader, or if its stream can't be indexed without
+        decoding it (which is the case for free-format streams).
+    */
+    static bool writeSeekIndex (AudioFormatReader& reader, OutputStream& destination);
 };
 
 #endif
@@ -117,13 +117,16 @@ const char* const OggVorbisAudioFormat::id3trackNumber = "id3trackNumber";
 class OggReader : public AudioFormatReader
 {
 public:
-    OggReader (InputStream* inp)  : AudioFormatReader (inp, oggFormatName)
+    OggReader (InputStream* inp, bool streaming = false)
+        : AudioFormatReader (inp, oggFormatName), isStreaming (streaming)
     {
         sampleRate = 0;
         usesFloatingPointData = true;
 
+        // without a seek function, vorbisfile opens the stream in its unseekable mode,
+        // which only reads forwards
         callbacks.read_func  = &oggReadCallback;
-        callbacks.seek_func  = &oggSeekCallback;
+        callbacks.seek_func  = streaming ? nullptr : &oggSeekCallback;
         callbacks.close_func = &oggCloseCallback;
         callbacks.tell_func  = &oggTellCallback;
 
@@ -143,7 +146,8 @@ public:
             addMetadataItem (comment, "GENRE",       OggVorbisAudioFormat::id3genre);
             addMetadataItem (comment, "TRACKNUMBER", OggVorbisAudioFormat::id3trackNumber);
 
-            lengthInSamples = (uint32) ov_pcm_total (&ovFile, -1);
+            lengthInSamples = streaming ? std::numeric_limits<int64>::max()
+                                        : (int64) (uint32) ov_pcm_total (&ovFile, -1);
             numChannels = (unsigned int) info->channels;
             bitsPerSample = 16;
             sampleRate = info->rate;
@@ -194,11 +198,19 @@ public:
             if (startSampleInFile < reservoirStart
                 || startSampleInFile + numSamples > reservoirStart + samplesInReservoir)
             {
+                if (isStreaming)
+                {
+                    if (! readNextStreamingBlock (startSampleInFile))
+                        break;
+
+                    continue;
+                }
+
                 // buffer miss, so refill the reservoir
-                reservoirStart = jmax (0, (int) startSampleInFile);
+                reservoirStart = jmax ((int64) 0, startSampleInFile);
                 samplesInReservoir = reservoir.getNumSamples();
 
-                if (reservoirStart != (int) ov_pcm_tell (&ovFile))
+                if (reservoirStart != ov_pcm_tell (&ovFile))
                     ov_pcm_seek (&ovFile, reservoirStart);
 
                 int bitStream = 0;
@@ -232,11 +244,56 @@ public:
             for (int i = numDestChannels; --i >= 0;)
                 if (destSamples[i] != nullptr)
                     zeromem (destSamples[i] + startOffsetInDestBuffer, (size_t) numSamples * sizeof (int));
+
+            // a streaming reader can't go back to a position that it has already passed
+            if (isStreaming && startSampleInFile < reservoirStart)
+                return false;
         }
 
         return true;
     }
 
+    // Decodes the next block of a stream into the reservoir, discarding any blocks
+    // that come before the position that's wanted. Returns false at the end of the
+    // stream, or if the position has already been passed.
+    bool readNextStreamingBlock (int64 positionWanted)
+    {
+        if (positionWanted < reservoirStart)
+            return false;
+
+        float** dataIn = nullptr;
+
+        for (;;)
+        {
+            reservoirStart += samplesInReservoir;
+            samplesInReservoir = 0;
+
+            int bitStream = 0;
+            auto samps = (int) ov_read_float (&ovFile, &dataIn, reservoir.getNumSamples(), &bitStream);
+
+            if (samps == OV_HOLE)
+                continue;
+
+            if (samps <= 0)
+            {
+                if (lengthInSamples == std::numeric_limits<int64>::max())
+                    lengthInSamples = reservoirStart;
+
+                return false;
+            }
+
+            samplesInReservoir = samps;
+
+            if (positionWanted < reservoirStart + samplesInReservoir)
+                break;
+        }
+
+        for (int i = jmin ((int) numChannels, reservoir.getNumChannels()); --i >= 0;)
+            memcpy (reservoir.getWritePointer (i), dataIn[i], (size_t) samplesInReservoir * sizeof (float));
+
+        return true;
+    }
+
     //==============================================================================
     static size_t oggReadCallback (void* ptr, size_t size, size_t nmemb, void* datasource)
     {
@@ -270,7 +327,9 @@ private:
     OggVorbisNamespace::OggVorbis_File ovFile;
     OggVorbisNamespace::ov_callbacks callbacks;
     AudioBuffer<float> reservoir;
-    int reservoirStart = 0, samplesInReservoir = 0;
+    int64 reservoirStart = 0;
+    int samplesInReservoir = 0;
+    const bool isStreaming;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OggReader)
 };
@@ -465,6 +524,19 @@ AudioFormatReader* OggVorbisAudioFormat::createReaderFor (InputStream* in, bool
     return nullptr;
 }
 
+AudioFormatReader* OggVorbisAudioFormat::createStreamingReaderFor (InputStream* in, bool deleteStreamIfOpeningFails)
+{
+    std::unique_ptr<OggReader> r (new OggReader (in, true));
+
+    if (r->sampleRate > 0)
+        return r.release();
+
+    if (! deleteStreamIfOpeningFails)
+        r->input = nullptr;
+
+    return nullptr;
+}
+
 AudioFormatWriter* OggVorbisAudioFormat::createWriterFor (OutputStream* out,
                                                           double sampleRate,
                                                           unsigned int numChannels,
@@ -85,6 +85,9 @@ public:
     AudioFormatReader* createReaderFor (InputStream* sourceStream,
                                         bool deleteStreamIfOpeningFails) override;
 
+    AudioFormatReader* createStreamingReaderFor (InputStream* sourceStream,
+                                                 bool deleteStreamIfOpeningFails) override;
+
     AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
                                         double sampleRateToUse,
                                         unsigned int numberOfChannels,
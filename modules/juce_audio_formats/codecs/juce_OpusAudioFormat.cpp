@@ -0,0 +1,1244 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_USE_OPUS
+
+#if ! JUCE_USE_OGGVORBIS
+ #error "The Opus format uses the Ogg code from the Ogg-Vorbis format, so JUCE_USE_OGGVORBIS must be enabled"
+#endif
+
+namespace OpusNamespace
+{
+ #include <opus_multistream.h>
+}
+
+//==============================================================================
+static const char* const opusFormatName = "Opus file";
+
+const char* const OpusAudioFormat::encoderName = "encoder";
+const char* const OpusAudioFormat::id3title = "id3title";
+const char* const OpusAudioFormat::id3artist = "id3artist";
+const char* const OpusAudioFormat::id3album = "id3album";
+const char* const OpusAudioFormat::id3comment = "id3comment";
+const char* const OpusAudioFormat::id3date = "id3date";
+const char* const OpusAudioFormat::id3genre = "id3genre";
+const char* const OpusAudioFormat::id3trackNumber = "id3trackNumber";
+
+namespace OpusHelpers
+{
+    enum
+    {
+        opusSampleRate = 48000,
+        maxSamplesPerPacket = 5760,     // 120ms, the longest duration that a packet can have
+        preRollSamples = 3840,          // 80ms, the decoder pre-roll recommended by RFC 7845
+        maxBytesPerStream = 1275 * 3 + 7
+    };
+
+    static const char* const metadataNames[][2] =
+    {
+        { OpusAudioFormat::encoderName,    "ENCODER" },
+        { OpusAudioFormat::id3title,       "TITLE" },
+        { OpusAudioFormat::id3artist,      "ARTIST" },
+        { OpusAudioFormat::id3album,       "ALBUM" },
+        { OpusAudioFormat::id3comment,     "COMMENT" },
+        { OpusAudioFormat::id3date,        "DATE" },
+        { OpusAudioFormat::id3genre,       "GENRE" },
+        { OpusAudioFormat::id3trackNumber, "TRACKNUMBER" }
+    };
+
+    static const int bitRates[] = { 32, 48, 64, 96, 128, 160, 192, 256, 320, 510 };
+
+    static int getNumSamplesInPacket (const void* data, size_t size) noexcept
+    {
+        return jmax (0, OpusNamespace::opus_packet_get_nb_samples (static_cast<const unsigned char*> (data),
+                                                                   (OpusNamespace::opus_int32) size, opusSampleRate));
+    }
+}
+
+//==============================================================================
+class OpusReader  : public AudioFormatReader
+{
+public:
+    OpusReader (InputStream* inp)  : AudioFormatReader (inp, opusFormatName)
+    {
+        using namespace OggVorbisNamespace;
+        using namespace OpusNamespace;
+
+        sampleRate = 0;
+        usesFloatingPointData = true;
+        bitsPerSample = 32;
+
+        ogg_sync_init (&sync);
+        ogg_stream_init (&stream, 0);
+
+        if (input->getTotalLength() > 0 && readHeaders())
+        {
+            int error = 0;
+            decoder = opus_multistream_decoder_create (OpusHelpers::opusSampleRate, (int) numChannels,
+                                                       numStreams, numCoupledStreams, channelMapping, &error);
+
+            if (decoder != nullptr)
+            {
+                opus_multistream_decoder_ctl (decoder, OPUS_SET_GAIN (outputGain));
+
+                lengthInSamples = jmax ((int64) 0, findLastGranulePosition() - preSkip);
+                sampleRate = OpusHelpers::opusSampleRate;
+
+                decoded.setSize ((int) numChannels, OpusHelpers::maxSamplesPerPacket);
+                interleaved.malloc (numChannels * (size_t) OpusHelpers::maxSamplesPerPacket);
+            }
+        }
+    }
+
+    ~OpusReader() override
+    {
+        if (decoder != nullptr)
+            OpusNamespace::opus_multistream_decoder_destroy (decoder);
+
+        OggVorbisNamespace::ogg_stream_clear (&stream);
+        OggVorbisNamespace::ogg_sync_clear (&sync);
+    }
+
+    //==============================================================================
+    bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                      int64 startSampleInFile, int numSamples) override
+    {
+        clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
+                                           startSampleInFile, numSamples, lengthInSamples);
+        bool hasSeeked = false;
+
+        while (numSamples > 0)
+        {
+            auto offsetInDecoded = startSampleInFile - decodedStart;
+
+            if (offsetInDecoded >= 0 && offsetInDecoded < numDecoded)
+            {
+                auto numToCopy = (int) jmin ((int64) numSamples, numDecoded - offsetInDecoded);
+
+                for (int i = jmin (numDestChannels, decoded.getNumChannels()); --i >= 0;)
+                    if (destSamples[i] != nullptr)
+                        memcpy (destSamples[i] + startOffsetInDestBuffer,
+                                decoded.getReadPointer (i, (int) offsetInDecoded),
+                                (size_t) numToCopy * sizeof (float));
+
+                startSampleInFile += numToCopy;
+                startOffsetInDestBuffer += numToCopy;
+                numSamples -= numToCopy;
+                continue;
+            }
+
+            if (! hasSeeked && (offsetInDecoded < 0 || offsetInDecoded > numDecoded + samplesToDecodeBeforeSeeking))
+            {
+                seekTowards (startSampleInFile);
+                hasSeeked = true;
+                continue;
+            }
+
+            // if the data's missing, or the seek didn't get far enough back, there's nothing
+            // that can be decoded for this part of the range
+            if (offsetInDecoded < 0 || ! decodeNextPacket())
+            {
+                auto numToClear = offsetInDecoded < 0 ? (int) jmin ((int64) numSamples, -offsetInDecoded)
+                                                      : numSamples;
+
+                for (int i = numDestChannels; --i >= 0;)
+                    if (destSamples[i] != nullptr)
+                        zeromem (destSamples[i] + startOffsetInDestBuffer, (size_t) numToClear * sizeof (float));
+
+                startSampleInFile += numToClear;
+                startOffsetInDestBuffer += numToClear;
+                numSamples -= numToClear;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    //==============================================================================
+    enum
+    {
+        samplesToDecodeBeforeSeeking = OpusHelpers::opusSampleRate / 2,
+        bytesToReadAtOnce = 8192,
+        bisectionLimit = 16384,
+        bytesToSearchForLastPage = 65536
+    };
+
+    OggVorbisNamespace::ogg_sync_state sync;
+    OggVorbisNamespace::ogg_stream_state stream;
+    OpusNamespace::OpusMSDecoder* decoder = nullptr;
+
+    int serialNumber = 0, numStreams = 0, numCoupledStreams = 0, preSkip = 0, outputGain = 0;
+    unsigned char channelMapping[256] = {};
+    int64 audioDataStart = 0, syncPosition = 0, lastPagePosition = 0;
+
+    Array<MemoryBlock> packets;
+    int64 nextPacketPosition = -1;   // the granule position at the start of the first packet in the list
+
+    AudioBuffer<float> decoded;
+    HeapBlock<float> interleaved;
+    int64 decodedStart = std::numeric_limits<int64>::min() / 2;
+    int numDecoded = 0;
+
+    //==============================================================================
+    void setStreamPosition (int64 position)
+    {
+        input->setPosition (position);
+        OggVorbisNamespace::ogg_sync_reset (&sync);
+        syncPosition = position;
+    }
+
+    // Reads the next page that belongs to the Opus stream (or to any stream, if
+    // anyStream is true), and sets lastPagePosition to where it started.
+    bool readNextPage (OggVorbisNamespace::ogg_page& page, bool anyStream = false)
+    {
+        using namespace OggVorbisNamespace;
+
+        for (;;)
+        {
+            auto result = ogg_sync_pageseek (&sync, &page);
+
+            if (result > 0)
+            {
+                auto pagePosition = syncPosition;
+                syncPosition += result;
+
+                if (anyStream || ogg_page_serialno (&page) == serialNumber)
+                {
+                    lastPagePosition = pagePosition;
+                    return true;
+                }
+            }
+            else if (result < 0)
+            {
+                syncPosition -= result;
+            }
+            else
+            {
+                auto* buffer = ogg_sync_buffer (&sync, bytesToReadAtOnce);
+                auto numRead = input->read (buffer, bytesToReadAtOnce);
+
+                if (numRead <= 0)
+                    return false;
+
+                ogg_sync_wrote (&sync, numRead);
+            }
+        }
+    }
+
+    //==============================================================================
+    bool readHeaders()
+    {
+        using namespace OggVorbisNamespace;
+        ogg_page page;
+
+        // find the start of the Opus stream, skipping any other streams that are multiplexed with it
+        for (;;)
+        {
+            if (! (readNextPage (page, true) && ogg_page_bos (&page)))
+                return false;
+
+            if (page.body_len >= 8 && memcmp (page.body, "OpusHead", 8) == 0)
+                break;
+        }
+
+        serialNumber = ogg_page_serialno (&page);
+        ogg_stream_reset_serialno (&stream, serialNumber);
+        ogg_stream_pagein (&stream, &page);
+
+        ogg_packet packet;
+
+        if (ogg_stream_packetout (&stream, &packet) != 1 || ! parseHeader (packet.packet, (size_t) packet.bytes))
+            return false;
+
+        while (ogg_stream_packetout (&stream, &packet) != 1)
+        {
+            if (! readNextPage (page))
+                return false;
+
+            ogg_stream_pagein (&stream, &page);
+        }
+
+        parseTags (packet.packet, (size_t) packet.bytes);
+
+        // the audio starts on the page after the tags
+        audioDataStart = syncPosition;
+        return true;
+    }
+
+    bool parseHeader (const unsigned char* data, size_t size)
+    {
+        if (size < 19 || memcmp (data, "OpusHead", 8) != 0 || (data[8] & 0xf0) != 0)
+            return false;
+
+        numChannels = data[9];
+        preSkip = ByteOrder::littleEndianShort (data + 10);
+        outputGain = (int16) ByteOrder::littleEndianShort (data + 16);
+
+        if (data[18] == 0)
+        {
+            numStreams = 1;
+            numCoupledStreams = (int) numChannels - 1;
+            channelMapping[0] = 0;
+            channelMapping[1] = 1;
+
+            return numChannels == 1 || numChannels == 2;
+        }
+
+        if (size < 21 + numChannels)
+            return false;
+
+        numStreams = data[19];
+        numCoupledStreams = data[20];
+        memcpy (channelMapping, data + 21, numChannels);
+
+        return numChannels > 0 && numStreams > 0 && numCoupledStreams <= numStreams;
+    }
+
+    void parseTags (const unsigned char* data, size_t size)
+    {
+        MemoryInputStream in (data, size, false);
+        char magic[8];
+
+        if (in.read (magic, 8) != 8 || memcmp (magic, "OpusTags", 8) != 0)
+            return;
+
+        in.skipNextBytes ((uint32) in.readInt());
+
+        for (auto numComments = in.readInt(); --numComments >= 0 && ! in.isExhausted();)
+        {
+            auto length = (size_t) (uint32) in.readInt();
+
+            if (length > (size_t) in.getNumBytesRemaining())
+                break;
+
+            auto comment = String::fromUTF8 (static_cast<const char*> (in.getData()) + in.getPosition(), (int) length);
+            in.skipNextBytes ((int64) length);
+
+            for (auto& names : OpusHelpers::metadataNames)
+                if (comment.upToFirstOccurrenceOf ("=", false, false).equalsIgnoreCase (names[1]))
+                    metadataValues.set (names[0], comment.fromFirstOccurrenceOf ("=", false, false));
+        }
+    }
+
+    // Looks backwards from the end of the file for the last page that has a granule position
+    int64 findLastGranulePosition()
+    {
+        OggVorbisNamespace::ogg_page page;
+
+        for (auto end = input->getTotalLength(); end > audioDataStart; end -= bytesToSearchForLastPage)
+        {
+            setStreamPosition (jmax (audioDataStart, end - bytesToSearchForLastPage));
+            int64 lastGranule = -1;
+
+            while (readNextPage (page) && lastPagePosition < end)
+                if (OggVorbisNamespace::ogg_page_granulepos (&page) >= 0)
+                    lastGranule = OggVorbisNamespace::ogg_page_granulepos (&page);
+
+            if (lastGranule >= 0)
+                return lastGranule;
+        }
+
+        return 0;
+    }
+
+    //==============================================================================
+    // Finds a page that's a little before the given sample, and gets ready to start decoding from there.
+    void seekTowards (int64 sample)
+    {
+        using namespace OggVorbisNamespace;
+
+        auto targetGranule = sample + preSkip - OpusHelpers::preRollSamples;
+        auto low = audioDataStart, high = input->getTotalLength();
+        ogg_page page;
+
+        // Each packet starts no later than the end of the page before it, so decoding from a
+        // page whose granule position is before the target will reach the target.
+        while (targetGranule > 0 && high - low > bisectionLimit)
+        {
+            auto middle = low + (high - low) / 2;
+            setStreamPosition (middle);
+
+            bool foundEarlierPage = false;
+
+            while (readNextPage (page) && lastPagePosition < high)
+            {
+                auto granule = ogg_page_granulepos (&page);
+
+                if (granule >= 0)
+                {
+                    foundEarlierPage = granule < targetGranule;
+                    break;
+                }
+            }
+
+            if (foundEarlierPage)
+                low = lastPagePosition;
+            else
+                high = middle;
+        }
+
+        setStreamPosition (low);
+        ogg_stream_reset (&stream);
+        OpusNamespace::opus_multistream_decoder_ctl (decoder, OPUS_RESET_STATE);
+
+        packets.clearQuick();
+        nextPacketPosition = -1;
+        numDecoded = 0;
+        decodedStart = std::numeric_limits<int64>::min() / 2;
+    }
+
+    bool decodeNextPacket()
+    {
+        using namespace OggVorbisNamespace;
+
+        // After a seek, the position of the packets isn't known until a page with a granule
+        // position arrives. The last packet that ends on that page finishes at that position,
+        // so the start of the first one can be worked out from the packets' durations.
+        while (packets.isEmpty() || nextPacketPosition < 0)
+        {
+            ogg_page page;
+
+            if (! readNextPage (page))
+                return false;
+
+            if (ogg_stream_pagein (&stream, &page) != 0)
+                continue;
+
+            ogg_packet packet;
+
+            for (int result; (result = ogg_stream_packetout (&stream, &packet)) != 0;)
+            {
+                if (result < 0)
+                {
+                    // a gap in the data, so the packets before it can't be placed
+                    packets.clearQuick();
+                    nextPacketPosition = -1;
+                    continue;
+                }
+
+                if (packet.bytes > 0)
+                    packets.add (MemoryBlock (packet.packet, (size_t) packet.bytes));
+            }
+
+            auto granule = ogg_page_granulepos (&page);
+
+            if (nextPacketPosition < 0 && granule >= 0)
+            {
+                nextPacketPosition = granule;
+
+                for (auto& p : packets)
+                    nextPacketPosition -= OpusHelpers::getNumSamplesInPacket (p.getData(), p.getSize());
+            }
+        }
+
+        auto& packet = packets.getReference (0);
+        auto numSamples = OpusNamespace::opus_multistream_decode_float (decoder,
+                                                                        static_cast<const unsigned char*> (packet.getData()),
+                                                                        (OpusNamespace::opus_int32) packet.getSize(),
+                                                                        interleaved, OpusHelpers::maxSamplesPerPacket, 0);
+
+        if (numSamples < 0)
+        {
+            // a corrupt packet, so let the decoder fill in its duration
+            auto duration = jmax (120, OpusHelpers::getNumSamplesInPacket (packet.getData(), packet.getSize()));
+            numSamples = jmax (0, OpusNamespace::opus_multistream_decode_float (decoder, nullptr, 0, interleaved, duration, 0));
+        }
+
+        packets.remove (0);
+
+        for (int i = 0; i < (int) numChannels; ++i)
+        {
+            auto* dest = decoded.getWritePointer (i);
+
+            for (int j = 0; j < numSamples; ++j)
+                dest[j] = interleaved[j * (int) numChannels + i];
+        }
+
+        decodedStart = nextPacketPosition - preSkip;
+        numDecoded = numSamples;
+        nextPacketPosition += numSamples;
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpusReader)
+};
+
+//==============================================================================
+class OpusWriter  : public AudioFormatWriter
+{
+public:
+    OpusWriter (OutputStream* out, double rate, unsigned int numChans, unsigned int bits,
+                int qualityIndex, const StringPairArray& metadata, ThreadPool* pool)
+        : AudioFormatWriter (out, opusFormatName, rate, numChans, bits),
+          threadPool (pool),
+          frameSize ((int) rate / 50),
+          samplesPerBlock (pool != nullptr ? frameSize * framesPerChunk : frameSize),
+          rateMultiplier (OpusHelpers::opusSampleRate / jmax (1, (int) rate)),
+          maxChunksInFlight (pool != nullptr ? 2 * pool->getNumThreads() + 1 : 0)
+    {
+        assertNotCalledFromPool();
+
+        using namespace OpusNamespace;
+
+        usesFloatingPointData = true;
+        bitRate = OpusHelpers::bitRates[jlimit (0, numElementsInArray (OpusHelpers::bitRates) - 1, qualityIndex)]
+                    * 1000 * (int) numChans / 2;
+
+        if (rateMultiplier * (int) rate != OpusHelpers::opusSampleRate || numChans == 0 || numChans > 8)
+            return;
+
+        encoder = createEncoder (numStreams, numCoupledStreams, channelMapping);
+
+        if (encoder == nullptr)
+            return;
+
+        opus_int32 lookaheadSamples = 0;
+        opus_multistream_encoder_ctl (encoder, OPUS_GET_LOOKAHEAD (&lookaheadSamples));
+        lookahead = (int) lookaheadSamples;
+
+        if (threadPool == nullptr)
+        {
+            block.calloc (numChans * (size_t) frameSize);
+            packetData.malloc ((size_t) (OpusHelpers::maxBytesPerStream * numStreams));
+        }
+        else
+        {
+            // the pool's jobs each make their own encoder
+            opus_multistream_encoder_destroy (encoder);
+            encoder = nullptr;
+        }
+
+        OggVorbisNamespace::ogg_stream_init (&os, Random::getSystemRandom().nextInt());
+        writeHeaders (metadata);
+        ok = true;
+    }
+
+    ~OpusWriter() override
+    {
+        assertNotCalledFromPool();
+
+        if (ok)
+        {
+            // Pad the last frame, and then add enough silence to push the audio that's
+            // still in the encoder's lookahead out of it.
+            auto numSamplesNeeded = numSamplesWritten + lookahead;
+
+            while (numInBlock > 0 || numFramesStarted * frameSize < numSamplesNeeded || numFramesStarted == 0)
+            {
+                auto* dest = getBlockToFill();
+
+                if (dest == nullptr)
+                    break;
+
+                auto numStillNeeded = jmax ((int64) numInBlock, numSamplesNeeded - numFramesStarted * frameSize, (int64) 1);
+                auto numInFrames = (int) jmin ((int64) samplesPerBlock, (numStillNeeded + frameSize - 1) / frameSize * frameSize);
+
+                zeromem (dest + numInBlock * (int) numChannels,
+                         (size_t) (numInFrames - numInBlock) * numChannels * sizeof (float));
+                numInBlock = numInFrames;
+                finishBlock();
+            }
+
+            while (! chunksInFlight.isEmpty())
+                writeFinishedChunks (true);
+
+            if (pendingPacket.getSize() > 0)
+                writePacket (pendingPacket, true);
+
+            if (encoder != nullptr)
+                OpusNamespace::opus_multistream_encoder_destroy (encoder);
+
+            OggVorbisNamespace::ogg_stream_clear (&os);
+            output->flush();
+        }
+        else
+        {
+            if (encoder != nullptr)
+                OpusNamespace::opus_multistream_encoder_destroy (encoder);
+
+            output = nullptr; // to stop the base class deleting this, as it needs to be returned
+                              // to the caller of createWriter()
+        }
+    }
+
+    //==============================================================================
+    bool write (const int** samplesToWrite, int numSamples) override
+    {
+        assertNotCalledFromPool();
+
+        if (! ok)
+            return false;
+
+        auto** source = reinterpret_cast<const float**> (samplesToWrite);
+        bool channelsPresent = true;
+
+        for (int done = 0; done < numSamples;)
+        {
+            auto* dest = getBlockToFill();
+
+            if (dest == nullptr)
+                return false;
+
+            auto numToCopy = jmin (numSamples - done, samplesPerBlock - numInBlock);
+            dest += numInBlock * (int) numChannels;
+
+            for (int i = 0; i < (int) numChannels; ++i)
+            {
+                channelsPresent = channelsPresent && source[i] != nullptr;
+
+                for (int j = 0; j < numToCopy; ++j)
+                    dest[j * (int) numChannels + i] = channelsPresent ? source[i][done + j] : 0.0f;
+            }
+
+            numInBlock += numToCopy;
+            numSamplesWritten += numToCopy;
+            done += numToCopy;
+
+            if (numInBlock == samplesPerBlock)
+                finishBlock();
+        }
+
+        return ! failed;
+    }
+
+    bool ok = false;
+
+private:
+    //==============================================================================
+    struct Chunk
+    {
+        HeapBlock<float> samples;       // the pre-roll frames, followed by the chunk's frames
+        int numPreRollFrames = 0, numFrames = 0;
+        MemoryOutputStream encoded;
+        Array<int> packetSizes;
+        std::atomic<bool> isFinished { false };
+        bool failed = false;
+    };
+
+    enum
+    {
+        framesPerChunk = 50,
+        preRollFrames = OpusHelpers::preRollSamples / (OpusHelpers::opusSampleRate / 50)
+    };
+
+    ThreadPool* threadPool;
+    const int frameSize, samplesPerBlock, rateMultiplier, maxChunksInFlight;
+    int bitRate = 0, lookahead = 0, numStreams = 0, numCoupledStreams = 0;
+    unsigned char channelMapping[256] = {};
+    OpusNamespace::OpusMSEncoder* encoder = nullptr;
+
+    HeapBlock<float> block;
+    int numInBlock = 0;
+    int64 numSamplesWritten = 0, numFramesStarted = 0;
+
+    OwnedArray<Chunk> chunks;
+    Array<Chunk*> emptyChunks, chunksInFlight;
+    Chunk* currentChunk = nullptr;
+    Chunk* previousChunk = nullptr;
+    WaitableEvent chunkFinished;
+
+    OggVorbisNamespace::ogg_stream_state os;
+    HeapBlock<unsigned char> packetData;
+    MemoryBlock pendingPacket;
+    int64 packetNumber = 0, numPacketsWritten = 0;
+    bool failed = false;
+
+    //==============================================================================
+    OpusNamespace::OpusMSEncoder* createEncoder (int& streams, int& coupledStreams, unsigned char* mapping) const
+    {
+        using namespace OpusNamespace;
+
+        int error = 0;
+        auto* enc = opus_multistream_surround_encoder_create ((opus_int32) sampleRate, (int) numChannels, numChannels > 2 ? 1 : 0,
+                                                              &streams, &coupledStreams, mapping, OPUS_APPLICATION_AUDIO, &error);
+
+        if (enc != nullptr)
+            opus_multistream_encoder_ctl (enc, OPUS_SET_BITRATE (bitRate));
+
+        return enc;
+    }
+
+    // The writer waits for the pool's jobs to finish, so if it was used from one of
+    // those jobs, the pool's threads could all end up waiting for each other.
+    void assertNotCalledFromPool() const
+    {
+        jassert (threadPool == nullptr || ! threadPool->contains (ThreadPoolJob::getCurrentThreadPoolJob()));
+    }
+
+    void writeHeaders (const StringPairArray& metadata)
+    {
+        MemoryOutputStream header;
+        header.write ("OpusHead", 8);
+        header.writeByte (1);
+        header.writeByte ((char) numChannels);
+        header.writeShort ((short) (lookahead * rateMultiplier));
+        header.writeInt ((int) sampleRate);
+        header.writeShort (0);
+        header.writeByte (numChannels > 2 ? 1 : 0);
+
+        if (numChannels > 2)
+        {
+            header.writeByte ((char) numStreams);
+            header.writeByte ((char) numCoupledStreams);
+            header.write (channelMapping, numChannels);
+        }
+
+        StringArray comments;
+
+        for (auto& names : OpusHelpers::metadataNames)
+        {
+            auto value = metadata[names[0]];
+
+            if (value.isNotEmpty())
+                comments.add (String (names[1]) + "=" + value);
+        }
+
+        MemoryOutputStream tags;
+        tags.write ("OpusTags", 8);
+
+        String vendor (OpusNamespace::opus_get_version_string());
+        tags.writeInt ((int) vendor.getNumBytesAsUTF8());
+        tags << vendor;
+        tags.writeInt (comments.size());
+
+        for (auto& c : comments)
+        {
+            tags.writeInt ((int) c.getNumBytesAsUTF8());
+            tags << c;
+        }
+
+        addPacketToStream (header.getData(), header.getDataSize(), 0, true, false);
+        flushPages();
+        addPacketToStream (tags.getData(), tags.getDataSize(), 0, false, false);
+        flushPages();
+    }
+
+    void addPacketToStream (const void* data, size_t size, int64 granule, bool isFirst, bool isLast)
+    {
+        OggVorbisNamespace::ogg_packet packet;
+        packet.packet = static_cast<unsigned char*> (const_cast<void*> (data));
+        packet.bytes = (long) size;
+        packet.b_o_s = isFirst ? 1 : 0;
+        packet.e_o_s = isLast ? 1 : 0;
+        packet.granulepos = granule;
+        packet.packetno = packetNumber++;
+
+        OggVorbisNamespace::ogg_stream_packetin (&os, &packet);
+    }
+
+    void writePage (const OggVorbisNamespace::ogg_page& page)
+    {
+        if (! (output->write (page.header, (size_t) page.header_len)
+                && output->write (page.body, (size_t) page.body_len)))
+            failed = true;
+    }
+
+    void flushPages()
+    {
+        OggVorbisNamespace::ogg_page page;
+
+        while (OggVorbisNamespace::ogg_stream_flush (&os, &page) != 0)
+            writePage (page);
+    }
+
+    // The last packet has to be marked as the end of the stream, and its granule
+    // position trims the padding from the end, so each packet is held back until
+    // the next one arrives.
+    void addPacket (const void* data, size_t size)
+    {
+        if (pendingPacket.getSize() > 0)
+            writePacket (pendingPacket, false);
+
+        pendingPacket.replaceWith (data, size);
+    }
+
+    void writePacket (const MemoryBlock& packet, bool isLast)
+    {
+        ++numPacketsWritten;
+
+        auto granule = isLast ? (lookahead + numSamplesWritten) * rateMultiplier
+                              : numPacketsWritten * frameSize * rateMultiplier;
+
+        addPacketToStream (packet.getData(), packet.getSize(), granule, false, isLast);
+
+        if (isLast)
+        {
+            flushPages();
+        }
+        else
+        {
+            OggVorbisNamespace::ogg_page page;
+
+            while (OggVorbisNamespace::ogg_stream_pageout (&os, &page) != 0)
+                writePage (page);
+        }
+    }
+
+    //==============================================================================
+    float* getBlockToFill()
+    {
+        if (threadPool == nullptr)
+            return block;
+
+        if (currentChunk == nullptr)
+        {
+            currentChunk = getEmptyChunk();
+
+            if (currentChunk == nullptr)
+                return nullptr;
+        }
+
+        return currentChunk->samples + currentChunk->numPreRollFrames * frameSize * (int) numChannels;
+    }
+
+    void finishBlock()
+    {
+        auto numFrames = numInBlock / frameSize;
+        jassert (numFrames * frameSize == numInBlock);
+
+        numFramesStarted += numFrames;
+        numInBlock = 0;
+
+        if (threadPool == nullptr)
+        {
+            auto size = OpusNamespace::opus_multistream_encode_float (encoder, block, frameSize, packetData,
+                                                                      OpusHelpers::maxBytesPerStream * numStreams);
+
+            if (size < 0)
+                failed = true;
+            else
+                addPacket (packetData, (size_t) size);
+        }
+        else
+        {
+            currentChunk->numFrames = numFrames;
+            submitChunk();
+        }
+    }
+
+    //==============================================================================
+    Chunk* getEmptyChunk()
+    {
+        writeFinishedChunks (false);
+
+        while (chunksInFlight.size() >= maxChunksInFlight)
+            writeFinishedChunks (true);
+
+        if (failed)
+            return nullptr;
+
+        Chunk* c;
+
+        if (emptyChunks.isEmpty())
+        {
+            c = chunks.add (new Chunk());
+            c->samples.malloc ((size_t) ((preRollFrames + framesPerChunk) * frameSize) * numChannels);
+        }
+        else
+        {
+            c = emptyChunks.removeAndReturn (emptyChunks.size() - 1);
+        }
+
+        // The first chunk starts from silence, like the stream itself, and the others
+        // start with the 80ms of audio before them. (The previous chunk may have been
+        // recycled as this one, so its frames are moved rather than copied)
+        int numPreRollFrames = 0;
+
+        if (previousChunk != nullptr)
+        {
+            auto samplesPerFrame = (size_t) frameSize * numChannels;
+            auto numPreviousFrames = previousChunk->numPreRollFrames + previousChunk->numFrames;
+            numPreRollFrames = jmin ((int) preRollFrames, numPreviousFrames);
+
+            memmove (c->samples,
+                     previousChunk->samples + (size_t) (numPreviousFrames - numPreRollFrames) * samplesPerFrame,
+                     (size_t) numPreRollFrames * samplesPerFrame * sizeof (float));
+        }
+
+        c->numPreRollFrames = numPreRollFrames;
+
+        c->numFrames = 0;
+        c->encoded.reset();
+        c->packetSizes.clearQuick();
+        c->isFinished = false;
+        c->failed = false;
+        return c;
+    }
+
+    void submitChunk()
+    {
+        auto* c = currentChunk;
+        currentChunk = nullptr;
+        previousChunk = c;
+        chunksInFlight.add (c);
+
+        threadPool->addJob ([this, c]
+        {
+            encodeChunk (*c);
+            c->isFinished = true;
+            chunkFinished.signal();
+        });
+    }
+
+    // Each chunk gets a new encoder, which encodes the pre-roll first and throws those
+    // packets away. The packets of the previous chunk will have left the decoder in
+    // much the same state as this encoder has reached by the end of the pre-roll, so
+    // the join between the two chunks isn't audible.
+    void encodeChunk (Chunk& c) const
+    {
+        using namespace OpusNamespace;
+
+        int streams = 0, coupledStreams = 0;
+        unsigned char mapping[256];
+        auto* enc = createEncoder (streams, coupledStreams, mapping);
+
+        if (enc == nullptr)
+        {
+            c.failed = true;
+            return;
+        }
+
+        HeapBlock<unsigned char> packet ((size_t) (OpusHelpers::maxBytesPerStream * numStreams));
+        auto samplesPerFrame = frameSize * (int) numChannels;
+
+        for (int i = 0; i < c.numPreRollFrames + c.numFrames; ++i)
+        {
+            auto size = opus_multistream_encode_float (enc, c.samples + i * samplesPerFrame, frameSize,
+                                                       packet, OpusHelpers::maxBytesPerStream * numStreams);
+
+            if (size < 0)
+            {
+                c.failed = true;
+                break;
+            }
+
+            if (i >= c.numPreRollFrames)
+            {
+                c.encoded.write (packet, (size_t) size);
+                c.packetSizes.add (size);
+            }
+        }
+
+        opus_multistream_encoder_destroy (enc);
+    }
+
+    // Writes the chunks at the front of the queue that have been encoded. If waitForOne
+    // is true and the first chunk isn't ready, this waits for it.
+    void writeFinishedChunks (bool waitForOne)
+    {
+        while (! chunksInFlight.isEmpty())
+        {
+            auto* c = chunksInFlight.getFirst();
+
+            if (! c->isFinished)
+            {
+                if (! waitForOne)
+                    break;
+
+                chunkFinished.wait (100);
+                continue;
+            }
+
+            waitForOne = false;
+
+            if (c->failed)
+                failed = true;
+
+            auto* data = static_cast<const char*> (c->encoded.getData());
+
+            for (auto size : c->packetSizes)
+            {
+                addPacket (data, (size_t) size);
+                data += size;
+            }
+
+            chunksInFlight.remove (0);
+            emptyChunks.add (c);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpusWriter)
+};
+
+//==============================================================================
+OpusAudioFormat::OpusAudioFormat()  : AudioFormat (opusFormatName, ".opus")
+{
+}
+
+OpusAudioFormat::~OpusAudioFormat()
+{
+}
+
+Array<int> OpusAudioFormat::getPossibleSampleRates()
+{
+    return { 8000, 12000, 16000, 24000, 48000 };
+}
+
+Array<int> OpusAudioFormat::getPossibleBitDepths()
+{
+    return { 32 };
+}
+
+bool OpusAudioFormat::canDoStereo()    { return true; }
+bool OpusAudioFormat::canDoMono()      { return true; }
+bool OpusAudioFormat::isCompressed()   { return true; }
+
+StringArray OpusAudioFormat::getQualityOptions()
+{
+    StringArray options;
+
+    for (auto bitRate : OpusHelpers::bitRates)
+        options.add (String (bitRate) + " kbps");
+
+    return options;
+}
+
+AudioFormatReader* OpusAudioFormat::createReaderFor (InputStream* in, bool deleteStreamIfOpeningFails)
+{
+    std::unique_ptr<OpusReader> r (new OpusReader (in));
+
+    if (r->sampleRate > 0)
+        return r.release();
+
+    if (! deleteStreamIfOpeningFails)
+        r->input = nullptr;
+
+    return nullptr;
+}
+
+AudioFormatWriter* OpusAudioFormat::createWriterFor (OutputStream* out,
+                                                     double sampleRate,
+                                                     unsigned int numChannels,
+                                                     int bitsPerSample,
+                                                     const StringPairArray& metadataValues,
+                                                     int qualityOptionIndex)
+{
+    if (out == nullptr)
+        return nullptr;
+
+    std::unique_ptr<OpusWriter> w (new OpusWriter (out, sampleRate, numChannels, (unsigned int) bitsPerSample,
+                                                   qualityOptionIndex, metadataValues, nullptr));
+
+    return w->ok ? w.release() : nullptr;
+}
+
+AudioFormatWriter* OpusAudioFormat::createWriterFor (OutputStream* out,
+                                                     double sampleRate,
+                                                     unsigned int numChannels,
+                                                     int bitsPerSample,
+                                                     const StringPairArray& metadataValues,
+                                                     int qualityOptionIndex,
+                                                     ThreadPool& threadPool)
+{
+    if (out == nullptr)
+        return nullptr;
+
+    std::unique_ptr<OpusWriter> w (new OpusWriter (out, sampleRate, numChannels, (unsigned int) bitsPerSample,
+                                                   qualityOptionIndex, metadataValues, &threadPool));
+
+    return w->ok ? w.release() : nullptr;
+}
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct OpusAudioFormatTests  : public UnitTest
+{
+    OpusAudioFormatTests()
+        : UnitTest ("OpusAudioFormat", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Reading and writing");
+        {
+            ThreadPool pool (3);
+
+            for (auto numChannels : { 1, 2, 6 })
+            {
+                auto source = createSource (numChannels, 3 * 48000 + 123);
+
+                for (auto* threadPool : { (ThreadPool*) nullptr, &pool })
+                {
+                    auto data = encode (source, threadPool);
+                    std::unique_ptr<AudioFormatReader> reader (OpusAudioFormat().createReaderFor (new MemoryInputStream (data, false), true));
+
+                    expect (reader != nullptr);
+                    expectEquals (reader->sampleRate, 48000.0);
+                    expectEquals ((int) reader->numChannels, numChannels);
+                    expectEquals (reader->lengthInSamples, (int64) source.getNumSamples());
+                    expectEquals (reader->metadataValues[OpusAudioFormat::id3title], String ("Test"));
+
+                    AudioBuffer<float> result (numChannels, source.getNumSamples());
+                    reader->read (&result, 0, result.getNumSamples(), 0, true, true);
+
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        expectGreaterThan (getSignalToNoiseRatio (source, result, ch, 0, source.getNumSamples()), 15.0);
+                }
+            }
+        }
+
+        beginTest ("Joins between chunks encoded in parallel");
+        {
+            ThreadPool pool (3);
+            auto source = createSource (2, 6 * 48000);
+            auto serial = decode (encode (source, nullptr));
+            auto parallel = decode (encode (source, &pool));
+
+            // The chunks are a second long. A chunk whose encoder hadn't converged by the
+            // time it started would leave a burst of noise just after the join, so the
+            // 10ms sections around each one are compared with a serially-encoded stream.
+            for (int join = 48000; join < source.getNumSamples(); join += 48000)
+            {
+                for (int start = join - 960; start < join + 1920; start += 480)
+                {
+                    for (int ch = 0; ch < 2; ++ch)
+                    {
+                        expectGreaterThan (getSignalToNoiseRatio (source, parallel, ch, start, 480),
+                                           getSignalToNoiseRatio (source, serial, ch, start, 480) - 6.0);
+                    }
+                }
+            }
+        }
+
+        beginTest ("Seeking");
+        {
+            auto source = createSource (2, 10 * 48000);
+            auto data = encode (source, nullptr);
+            std::unique_ptr<AudioFormatReader> reader (OpusAudioFormat().createReaderFor (new MemoryInputStream (data, false), true));
+            expect (reader != nullptr);
+
+            AudioBuffer<float> all (2, source.getNumSamples());
+            reader->read (&all, 0, all.getNumSamples(), 0, true, true);
+
+            auto r = getRandom();
+            AudioBuffer<float> section (2, 2000);
+
+            for (int i = 0; i < 50; ++i)
+            {
+                auto start = r.nextInt (source.getNumSamples() + 1000) - 500;
+                reader->read (&section, 0, section.getNumSamples(), start, true, true);
+
+                float maxDifference = 0;
+
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    for (int n = 0; n < section.getNumSamples(); ++n)
+                    {
+                        auto pos = start + n;
+                        auto expected = isPositiveAndBelow (pos, all.getNumSamples()) ? all.getSample (ch, pos) : 0.0f;
+                        maxDifference = jmax (maxDifference, std::abs (section.getSample (ch, n) - expected));
+                    }
+                }
+
+                // the decoder is restarted before the seek position, so it's not bit-exact
+                expectLessThan (maxDifference, 0.02f);
+            }
+        }
+    }
+
+    static AudioBuffer<float> createSource (int numChannels, int numSamples)
+    {
+        AudioBuffer<float> buffer (numChannels, numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            // the encoder low-passes the LFE channel of a 5.1 stream, so that only gets the low tone
+            auto isLFE = (numChannels == 6 && ch == 5);
+
+            for (int n = 0; n < numSamples; ++n)
+                buffer.setSample (ch, n, (isLFE ? 0.0f : 0.3f * (float) std::sin (n * 0.02 * (ch + 1)))
+                                           + 0.2f * (float) std::sin (n * 0.0031 + ch));
+        }
+
+        return buffer;
+    }
+
+    MemoryBlock encode (const AudioBuffer<float>& source, ThreadPool* pool)
+    {
+        MemoryBlock data;
+        StringPairArray metadata;
+        metadata.set (OpusAudioFormat::id3title, "Test");
+
+        {
+            OpusAudioFormat format;
+            auto* out = new MemoryOutputStream (data, false);
+            std::unique_ptr<AudioFormatWriter> writer (pool != nullptr ? format.createWriterFor (out, 48000.0, (unsigned int) source.getNumChannels(), 32, metadata, 5, *pool)
+                                                                       : format.createWriterFor (out, 48000.0, (unsigned int) source.getNumChannels(), 32, metadata, 5));
+            expect (writer != nullptr);
+
+            // write in uneven blocks, to check the framing
+            for (int start = 0; start < source.getNumSamples();)
+            {
+                auto num = jmin (source.getNumSamples() - start, 1000 + start % 777);
+                writer->writeFromAudioSampleBuffer (source, start, num);
+                start += num;
+            }
+        }
+
+        return data;
+    }
+
+    AudioBuffer<float> decode (const MemoryBlock& data)
+    {
+        std::unique_ptr<AudioFormatReader> reader (OpusAudioFormat().createReaderFor (new MemoryInputStream (data, false), true));
+        expect (reader != nullptr);
+
+        AudioBuffer<float> result ((int) reader->numChannels, (int) reader->lengthInSamples);
+        reader->read (&result, 0, result.getNumSamples(), 0, true, true);
+        return result;
+    }
+
+    static double getSignalToNoiseRatio (const AudioBuffer<float>& original, const AudioBuffer<float>& decoded,
+                                         int channel, int start, int numSamples)
+    {
+        double signal = 0, noise = 0;
+
+        for (int n = start; n < start + numSamples; ++n)
+        {
+            auto s = original.getSample (channel, n);
+            auto d = decoded.getSample (channel, n) - s;
+            signal += s * s;
+            noise += d * d;
+        }
+
+        return 10.0 * std::log10 (signal / jmax (noise, 1.0e-20));
+    }
+};
+
+static const OpusAudioFormatTests opusAudioFormatTests;
+
+#endif
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,132 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_USE_OPUS || defined (DOXYGEN)
+
+//==============================================================================
+/**
+    Reads and writes the Opus audio format, in an Ogg container.
+
+    The Opus codec isn't included with JUCE, so to compile this you'll need to set the
+    JUCE_USE_OPUS flag, add the libopus headers to your header search path, and link to
+    libopus. The Ogg framing uses the Ogg code that comes with the Ogg-Vorbis format, so
+    JUCE_USE_OGGVORBIS must also be enabled.
+
+    Opus always decodes at 48kHz, so a reader's sample rate is 48000, whatever rate the
+    file was encoded from. Readers seek by bisecting the file using the pages' granule
+    positions, and start decoding a little before the requested position, so that the
+    decoder has converged by the time it gets there.
+
+    @see AudioFormat, OggVorbisAudioFormat
+
+    @tags{Audio}
+*/
+class JUCE_API  OpusAudioFormat  : public AudioFormat
+{
+public:
+    //==============================================================================
+    OpusAudioFormat();
+    ~OpusAudioFormat() override;
+
+    //==============================================================================
+    Array<int> getPossibleSampleRates() override;
+    Array<int> getPossibleBitDepths() override;
+    bool canDoStereo() override;
+    bool canDoMono() override;
+    bool isCompressed() override;
+
+    /** Returns the bit-rates that the writer can use.
+        These are for a stereo stream: for other numbers of channels, the bit-rate is
+        scaled in proportion.
+    */
+    StringArray getQualityOptions() override;
+
+    //==============================================================================
+    /** Metadata property name used by the Opus writer - if you set a string for this
+        value, it will be written into the file as the name of the encoder app.
+
+        @see createWriterFor
+    */
+    static const char* const encoderName;
+
+    static const char* const id3title;          /**< Metadata key for setting an ID3 title. */
+    static const char* const id3artist;         /**< Metadata key for setting an ID3 artist name. */
+    static const char* const id3album;          /**< Metadata key for setting an ID3 album. */
+    static const char* const id3comment;        /**< Metadata key for setting an ID3 comment. */
+    static const char* const id3date;           /**< Metadata key for setting an ID3 date. */
+    static const char* const id3genre;          /**< Metadata key for setting an ID3 genre. */
+    static const char* const id3trackNumber;    /**< Metadata key for setting an ID3 track number. */
+
+    //==============================================================================
+    AudioFormatReader* createReaderFor (InputStream* sourceStream,
+                                        bool deleteStreamIfOpeningFails) override;
+
+    AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
+                                        double sampleRateToUse,
+                                        unsigned int numberOfChannels,
+                                        int bitsPerSample,
+                                        const StringPairArray& metadataValues,
+                                        int qualityOptionIndex) override;
+
+    /** Creates a writer which encodes on several threads at once.
+
+        The audio is split into chunks of a second, and each chunk is encoded by a job on
+        the ThreadPool that's passed in. Each job's encoder starts 80ms before its chunk
+        (the pre-roll that RFC 7845 recommends for decoders) and throws away the packets
+        for that part, so that by the time the chunk starts, its state has converged with
+        that of an encoder which had been given the whole stream. The result decodes with
+        no audible joins, but isn't bit-identical to the output of the other writer.
+
+        The ThreadPool can be shared by several writers, and must not be deleted while
+        any of them are still in use. The other parameters are the same as for the other
+        createWriterFor() method.
+
+        The writer waits for the pool's jobs when its queue of chunks is full and when
+        it's deleted, so it mustn't be used from a job that's running on the same pool.
+        Either use a separate pool for the encoding, or call the writer from a thread
+        that isn't part of the pool.
+    */
+    AudioFormatWriter* createWriterFor (OutputStream* streamToWriteTo,
+                                        double sampleRateToUse,
+                                        unsigned int numberOfChannels,
+                                        int bitsPerSample,
+                                        const StringPairArray& metadataValues,
+                                        int qualityOptionIndex,
+                                        ThreadPool& threadPool);
+
+    using AudioFormat::createWriterFor;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (OpusAudioFormat)
+};
+
+
+#endif
+
+} // namespace juce
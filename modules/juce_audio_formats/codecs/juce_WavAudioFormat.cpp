@@ -934,7 +934,8 @@ namespace WavFileHelpers
 class WavAudioFormatReader  : public AudioFormatReader
 {
 public:
-    WavAudioFormatReader (InputStream* in)  : AudioFormatReader (in, wavFormatName)
+    WavAudioFormatReader (InputStream* in, bool streaming = false)
+        : AudioFormatReader (in, wavFormatName), isStreaming (streaming)
     {
         using namespace WavFileHelpers;
         uint64 len = 0, end = 0;
@@ -954,6 +955,10 @@ public:
         {
             len = (uint64) (uint32) input->readInt();
             end = len + (uint64) input->getPosition();
+
+            // a stream that's being written as it's sent can't fill in its size
+            if (isStreaming && (len == 0 || len == 0xffffffff))
+                end = std::numeric_limits<uint64>::max();
         }
         else
         {
@@ -975,7 +980,7 @@ public:
                 len = (uint64) input->readInt64();
                 end = len + (uint64) startOfRIFFChunk;
                 dataLength = input->readInt64();
-                input->setPosition (chunkEnd);
+                moveTo (chunkEnd);
             }
 
             while ((uint64) input->getPosition() < end && ! input->isExhausted())
@@ -1057,6 +1062,16 @@ public:
 
                     dataChunkStart = input->getPosition();
                     lengthInSamples = (bytesPerFrame > 0) ? (dataLength / bytesPerFrame) : 0;
+
+                    if (isStreaming)
+                    {
+                        // any chunks after the audio data can't be read without buffering
+                        // it all, so they're ignored
+                        if (dataLength <= 0 || dataLength == 0xffffffff)
+                            lengthInSamples = std::numeric_limits<int64>::max();
+
+                        break;
+                    }
                 }
                 else if (chunkType == chunkName ("bext"))
                 {
@@ -1154,7 +1169,7 @@ public:
                                 metadataValues.set (prefix + "Text",         textBlock.toString());
                             }
 
-                            input->setPosition (adtlChunkEnd);
+                            moveTo (adtlChunkEnd);
                         }
                     }
                 }
@@ -1173,7 +1188,7 @@ public:
                     break;
                 }
 
-                input->setPosition (chunkEnd);
+                moveTo (chunkEnd);
             }
         }
 
@@ -1193,7 +1208,15 @@ public:
         if (numSamples <= 0)
             return true;
 
-        input->setPosition (dataChunkStart + startSampleInFile * bytesPerFrame);
+        if (! moveTo (dataChunkStart + startSampleInFile * bytesPerFrame))
+        {
+            // a streaming reader has already gone past this position
+            for (int i = numDestChannels; --i >= 0;)
+                if (destSamples[i] != nullptr)
+                    zeromem (destSamples[i] + startOffsetInDestBuffer, (size_t) numSamples * sizeof (int));
+
+            return false;
+        }
 
         while (numSamples > 0)
         {
@@ -1207,6 +1230,9 @@ public:
             {
                 jassert (bytesRead >= 0);
                 zeromem (tempBuffer + bytesRead, (size_t) (numThisTime * bytesPerFrame - bytesRead));
+
+                if (lengthInSamples == std::numeric_limits<int64>::max())
+                    lengthInSamples = startSampleInFile + jmax (0, bytesRead) / bytesPerFrame;
             }
 
             copySampleData (bitsPerSample, usesFloatingPointData,
@@ -1214,6 +1240,7 @@ public:
                             tempBuffer, (int) numChannels, numThisTime);
 
             startOffsetInDestBuffer += numThisTime;
+            startSampleInFile += numThisTime;
             numSamples -= numThisTime;
         }
 
@@ -1279,10 +1306,29 @@ public:
     int bytesPerFrame = 0;
     bool isRF64 = false;
     bool isSubformatOggVorbis = false;
+    const bool isStreaming;
 
     AudioChannelSet channelLayout;
 
 private:
+    // A streaming reader can't reposition its stream, so it moves forwards by
+    // reading and discarding the bytes in between.
+    bool moveTo (int64 newPosition)
+    {
+        if (isStreaming)
+        {
+            auto numBytesToSkip = newPosition - input->getPosition();
+
+            if (numBytesToSkip >= 0)
+            {
+                input->skipNextBytes (numBytesToSkip);
+                return true;
+            }
+        }
+
+        return input->setPosition (newPosition);
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WavAudioFormatReader)
 };
 
@@ -1561,7 +1607,7 @@ public:
         clearSamplesBeyondAvailableLength (destSamples, numDestChannels, startOffsetInDestBuffer,
                                            startSampleInFile, numSamples, lengthInSamples);
 
-        if (map == nullptr || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
+        if (! ensureSamplesAreMapped ({ startSampleInFile, startSampleInFile + numSamples }))
         {
             jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
             return false;
@@ -1577,7 +1623,14 @@ public:
     {
         auto num = (int) numChannels;
 
-        if (map == nullptr || ! mappedSection.contains (sample))
+        if (! isPositiveAndBelow (sample, lengthInSamples))
+        {
+            // like read(), anything outside the file comes back as silence
+            zeromem (result, (size_t) num * sizeof (float));
+            return;
+        }
+
+        if (! ensureSamplesAreMapped ({ sample, sample + 1 }))
         {
             jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
 
@@ -1604,7 +1657,7 @@ public:
     {
         numSamples = jmin (numSamples, lengthInSamples - startSampleInFile);
 
-        if (map == nullptr || numSamples <= 0 || ! mappedSection.contains (Range<int64> (startSampleInFile, startSampleInFile + numSamples)))
+        if (numSamples <= 0 || ! ensureSamplesAreMapped ({ startSampleInFile, startSampleInFile + numSamples }))
         {
             jassert (numSamples <= 0); // you must make sure that the window contains all the samples you're going to attempt to read.
 
@@ -1694,6 +1747,28 @@ AudioFormatReader* WavAudioFormat::createReaderFor (InputStream* sourceStream, b
     return nullptr;
 }
 
+AudioFormatReader* WavAudioFormat::createStreamingReaderFor (InputStream* sourceStream, bool deleteStreamIfOpeningFails)
+{
+    std::unique_ptr<WavAudioFormatReader> r (new WavAudioFormatReader (sourceStream, true));
+
+   #if JUCE_USE_OGGVORBIS
+    if (r->isSubformatOggVorbis)
+    {
+        r->input = nullptr;
+        return OggVorbisAudioFormat().createStreamingReaderFor (sourceStream, deleteStreamIfOpeningFails);
+    }
+   #endif
+
+    if (r->sampleRate > 0 && r->numChannels > 0 && r->bytesPerFrame > 0 && r->bitsPerSample <= 32
+         && r->dataChunkStart > 0)
+        return r.release();
+
+    if (! deleteStreamIfOpeningFails)
+        r->input = nullptr;
+
+    return nullptr;
+}
+
 MemoryMappedAudioFormatReader* WavAudioFormat::createMemoryMappedReader (const File& file)
 {
     return createMemoryMappedReader (file.createInputStream());
@@ -1867,6 +1942,155 @@ struct WaveAudioFormatTests : public UnitTest
             expect (reader != nullptr);
             expect (reader->metadataValues == metadataValues, "Somehow, the metadata is different!");
         }
+
+        beginTest ("Round-tripping sample data");
+
+        for (auto bitDepth : { 16, 24, 32 })
+        {
+            auto r = getRandom();
+            const int numChannels = 3, numSamples = 5001;
+
+            AudioBuffer<float> original (numChannels, numSamples), result (numChannels, numSamples);
+            HeapBlock<int> intData ((size_t) (numChannels * numSamples));
+            const int* intChannels[] = { intData, intData + numSamples, intData + 2 * numSamples, nullptr };
+
+            for (int i = 0; i < numChannels * numSamples; ++i)
+                intData[i] = r.nextInt();
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                for (int i = 0; i < numSamples; ++i)
+                    original.setSample (chan, i, r.nextFloat() * 2.0f - 1.0f);
+
+            MemoryBlock data;
+
+            {
+                std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (data, false), 44100.0,
+                                                                                   numChannels, bitDepth, {}, 0));
+                expect (writer != nullptr);
+
+                if (bitDepth == 32)
+                    expect (writer->writeFromAudioSampleBuffer (original, 0, numSamples));
+                else
+                    expect (writer->write (intChannels, numSamples));
+            }
+
+            std::unique_ptr<AudioFormatReader> reader (format.createReaderFor (new MemoryInputStream (data, false), true));
+            expect (reader != nullptr && reader->lengthInSamples == numSamples);
+
+            if (bitDepth == 32)
+            {
+                expect (reader->read (result.getArrayOfWritePointers(), numChannels, 0, numSamples));
+
+                for (int chan = 0; chan < numChannels; ++chan)
+                    result.addFrom (chan, 0, original, chan, 0, numSamples, -1.0f);
+
+                expect (result.getMagnitude (0, numSamples) == 0.0f);
+            }
+            else
+            {
+                HeapBlock<int> readData ((size_t) (numChannels * numSamples));
+                int* readChannels[] = { readData, readData + numSamples, readData + 2 * numSamples };
+                expect (reader->read (readChannels, numChannels, 0, numSamples, false));
+
+                auto mask = (int) (0xffffffffu << (32 - bitDepth));
+                bool allMatched = true;
+
+                for (int i = 0; i < numChannels * numSamples; ++i)
+                    allMatched = allMatched && readData[i] == (intData[i] & mask);
+
+                expect (allMatched);
+            }
+        }
+
+        beginTest ("Memory-mapped reading with a sliding window");
+        {
+            auto r = getRandom();
+            const int numChannels = 4, numSamples = 100000;
+            AudioBuffer<float> original (numChannels, numSamples);
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                for (int i = 0; i < numSamples; ++i)
+                    original.setSample (chan, i, r.nextFloat() * 2.0f - 1.0f);
+
+            TemporaryFile tempFile (".wav");
+
+            {
+                std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (tempFile.getFile().createOutputStream(), 44100.0,
+                                                                                   numChannels, 32, {}, 0));
+                expect (writer != nullptr && writer->writeFromAudioSampleBuffer (original, 0, numSamples));
+            }
+
+            std::unique_ptr<MemoryMappedAudioFormatReader> reader (format.createMemoryMappedReader (tempFile.getFile()));
+            expect (reader != nullptr);
+
+            const int64 windowSize = 64 * 1024;
+            reader->setSlidingWindowSize (windowSize);
+            reader->setAccessPattern (MemoryMappedFile::randomAccess);
+
+            AudioBuffer<float> result (numChannels, 1000);
+            float frame[numChannels];
+            bool allMatched = true;
+
+            for (int i = 0; i < 50; ++i)
+            {
+                auto start = r.nextInt (numSamples - 1000);
+                auto length = 1 + r.nextInt (1000);
+
+                allMatched = reader->read (result.getArrayOfWritePointers(), numChannels, start, length) && allMatched;
+                allMatched = reader->getNumBytesUsed() <= (size_t) windowSize + 65536 && allMatched;
+
+                for (int chan = 0; chan < numChannels; ++chan)
+                    allMatched = memcmp (result.getReadPointer (chan), original.getReadPointer (chan, start), sizeof (float) * (size_t) length) == 0 && allMatched;
+
+                auto samplePos = r.nextInt (numSamples);
+                reader->getSample (samplePos, frame);
+
+                for (int chan = 0; chan < numChannels; ++chan)
+                    allMatched = frame[chan] == original.getSample (chan, samplePos) && allMatched;
+
+                if (auto* data = reader->getInterleavedFloatData ({ start, start + length }))
+                {
+                    for (int j = 0; j < length; ++j)
+                        for (int chan = 0; chan < numChannels; ++chan)
+                            allMatched = data[j * numChannels + chan] == original.getSample (chan, start + j) && allMatched;
+
+                    reader->prefetchSamples ({ start + length, start + 2 * length });
+                }
+                else
+                {
+                    allMatched = false;
+                }
+            }
+
+            expect (allMatched);
+
+            // A read that's bigger than the window should still work
+            reader->setAccessPattern (MemoryMappedFile::sequentialAccess);
+            AudioBuffer<float> wholeFile (numChannels, numSamples);
+            expect (reader->read (wholeFile.getArrayOfWritePointers(), numChannels, 0, numSamples));
+
+            for (int chan = 0; chan < numChannels; ++chan)
+                wholeFile.addFrom (chan, 0, original, chan, 0, numSamples, -1.0f);
+
+            expect (wholeFile.getMagnitude (0, numSamples) == 0.0f);
+
+            // Requests outside the file must never be treated as already mapped
+            for (auto outsidePos : { (int64) numSamples, (int64) -1 })
+            {
+                for (auto& s : frame)
+                    s = 1.0f;
+
+                reader->getSample (outsidePos, frame);
+
+                for (auto s : frame)
+                    expectEquals (s, 0.0f);
+            }
+
+            reader->setSlidingWindowSize (0);
+            expect (reader->mapEntireFile());
+            expect (reader->getInterleavedFloatData ({ numSamples - 10, numSamples + 10 }) == nullptr);
+            expect (reader->getInterleavedFloatData ({ -10, 10 }) == nullptr);
+        }
     }
 
 private:
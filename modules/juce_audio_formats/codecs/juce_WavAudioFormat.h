@@ -194,6 +194,9 @@ public:
     AudioFormatReader* createReaderFor (InputStream* sourceStream,
                                         bool deleteStreamIfOpeningFails) override;
 
+    AudioFormatReader* createStreamingReaderFor (InputStream* sourceStream,
+                                                 bool deleteStreamIfOpeningFails) override;
+
     MemoryMappedAudioFormatReader* createMemoryMappedReader (const File&)      override;
     MemoryMappedAudioFormatReader* createMemoryMappedReader (FileInputStream*) override;
 
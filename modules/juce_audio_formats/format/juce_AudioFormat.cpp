@@ -66,6 +66,14 @@ MemoryMappedAudioFormatReader* AudioFormat::createMemoryMappedReader (FileInputS
     return nullptr;
 }
 
+AudioFormatReader* AudioFormat::createStreamingReaderFor (InputStream* sourceStream, bool deleteStreamIfOpeningFails)
+{
+    if (deleteStreamIfOpeningFails)
+        delete sourceStream;
+
+    return nullptr;
+}
+
 bool AudioFormat::isChannelLayoutSupported (const AudioChannelSet& channelSet)
 {
     if (channelSet == AudioChannelSet::mono())      return canDoMono();
@@ -117,6 +117,32 @@ public:
     virtual MemoryMappedAudioFormatReader* createMemoryMappedReader (const File& file);
     virtual MemoryMappedAudioFormatReader* createMemoryMappedReader (FileInputStream* fin);
 
+    /** Tries to create a reader that decodes a stream in a single pass, without
+        needing to reposition it.
+
+        This is for streams that can only be read forwards, such as a network
+        connection or a pipe, so that the audio can be decoded as it arrives, rather
+        than having to be saved to a file first. The reader never needs to look more
+        than a short distance ahead of the data that it has decoded.
+
+        The samples should be read in order. Skipping forwards will decode and discard
+        the samples in between, and reading from a position before the last one that
+        was read will fail.
+
+        If the stream's header doesn't say how long it is, the reader's lengthInSamples
+        will be std::numeric_limits<int64>::max() until the end of the stream has been
+        reached, at which point it's set to the real length.
+
+        If this format can't decode a stream in this way, this returns nullptr, which is
+        what the default implementation does. The parameters are the same as for
+        createReaderFor(), although if opening the stream fails, some of it may have
+        been read.
+
+        @see AudioFormatManager::createStreamingReaderFor
+    */
+    virtual AudioFormatReader* createStreamingReaderFor (InputStream* sourceStream,
+                                                         bool deleteStreamIfOpeningFails);
+
     /** Tries to create an object that can write to a stream with this audio format.
 
         The writer object that is returned can be used to write to the stream, and
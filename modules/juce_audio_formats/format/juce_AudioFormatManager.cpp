@@ -65,6 +65,10 @@ void AudioFormatManager::registerBasicFormats()
     registerFormat (new OggVorbisAudioFormat(), false);
    #endif
 
+   #if JUCE_USE_OPUS
+    registerFormat (new OpusAudioFormat(), false);
+   #endif
+
    #if JUCE_MAC || JUCE_IOS
     registerFormat (new CoreAudioFormat(), false);
    #endif
@@ -163,4 +167,279 @@ AudioFormatReader* AudioFormatManager::createReaderFor (InputStream* audioFileSt
     return nullptr;
 }
 
+AudioFormatReader* AudioFormatManager::createStreamingReaderFor (InputStream* audioStream)
+{
+    // you need to actually register some formats before the manager can
+    // use them to open a stream!
+    jassert (getNumKnownFormats() > 0);
+
+    if (audioStream != nullptr)
+    {
+        // This needs to be big enough to hold everything that a format might read
+        // before it decides that the stream isn't one of its own.
+        std::unique_ptr<InputStream> in (new RewindableInputStream (audioStream, 256 * 1024, true));
+        auto originalStreamPos = in->getPosition();
+
+        for (auto* af : knownFormats)
+        {
+            if (auto* r = af->createStreamingReaderFor (in.get(), false))
+            {
+                in.release();
+                return r;
+            }
+
+            // if a format has read too far into the stream to move back, the others can't try it
+            if (! in->setPosition (originalStreamPos))
+                break;
+        }
+    }
+
+    return nullptr;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct StreamingAudioFormatReaderTests  : public UnitTest
+{
+    StreamingAudioFormatReaderTests()
+        : UnitTest ("Streaming AudioFormatReaders", UnitTestCategories::audio)
+    {}
+
+    // A stream that can only be read forwards, and doesn't know its length, like a pipe
+    struct ForwardOnlyStream  : public InputStream
+    {
+        ForwardOnlyStream (const MemoryBlock& d)  : data (d, true) {}
+
+        int64 getTotalLength() override             { return -1; }
+        int64 getPosition() override                { return data.getPosition(); }
+        bool setPosition (int64 pos) override       { return pos == data.getPosition(); }
+        bool isExhausted() override                 { return data.isExhausted(); }
+        int read (void* dest, int num) override     { return data.read (dest, num); }
+
+        MemoryInputStream data;
+    };
+
+    void runTest() override
+    {
+        AudioFormatManager manager;
+        manager.registerBasicFormats();
+
+        auto source = createSource (2, 100000);
+
+        beginTest ("WAV");
+        {
+            auto data = encode (WavAudioFormat(), source, 24, 0);
+            checkStreamingReader (manager, data, data, WavAudioFormat().getFormatName(), true, 0.0f);
+
+            // a stream that's written as it's sent doesn't know its size, so it leaves
+            // the size fields filled with -1
+            auto streamedData = data;
+            auto* bytes = static_cast<const char*> (data.getData());
+            auto dataChunk = std::search (bytes, bytes + data.getSize(), "data", "data" + 4) - bytes;
+            expect (dataChunk < (int64) data.getSize());
+            streamedData.copyFrom ("\xff\xff\xff\xff", 4, 4);
+            streamedData.copyFrom ("\xff\xff\xff\xff", (int) dataChunk + 4, 4);
+
+            checkStreamingReader (manager, data, streamedData, WavAudioFormat().getFormatName(), false, 0.0f);
+        }
+
+       #if JUCE_USE_FLAC
+        beginTest ("FLAC");
+        {
+            auto data = encode (FlacAudioFormat(), source, 24, 5);
+            checkStreamingReader (manager, data, data, FlacAudioFormat().getFormatName(), true, 0.0f);
+        }
+       #endif
+
+       #if JUCE_USE_OGGVORBIS
+        beginTest ("Ogg Vorbis");
+        {
+            auto data = encode (OggVorbisAudioFormat(), source, 16, 5);
+            checkStreamingReader (manager, data, data, OggVorbisAudioFormat().getFormatName(), false, 1.0e-5f);
+        }
+       #endif
+
+       #if JUCE_USE_MP3AUDIOFORMAT
+        beginTest ("MP3");
+        {
+            // with a Xing header, the stream says how many frames it has
+            auto data = createMP3Stream (300, true);
+            checkStreamingReader (manager, data, data, MP3AudioFormat().getFormatName(), true, 0.0f);
+
+            // without one, the length is only known once the end has been reached
+            data = createMP3Stream (300, false);
+            std::unique_ptr<AudioFormatReader> reader (manager.createStreamingReaderFor (new ForwardOnlyStream (data)));
+            expect (reader != nullptr);
+
+            if (reader != nullptr)
+            {
+                expectEquals (reader->getFormatName(), MP3AudioFormat().getFormatName());
+                expectEquals (reader->sampleRate, 44100.0);
+                expectEquals ((int) reader->numChannels, 2);
+                expectEquals (reader->lengthInSamples, std::numeric_limits<int64>::max());
+
+                AudioBuffer<float> block (2, 3000);
+                int64 position = 0;
+
+                while (reader->lengthInSamples == std::numeric_limits<int64>::max() && position < 1000000)
+                {
+                    reader->read (&block, 0, block.getNumSamples(), position, true, true);
+                    expectEquals (block.getMagnitude (0, block.getNumSamples()), 0.0f);
+                    position += block.getNumSamples();
+                }
+
+                // the decoder's output runs one frame past the last one in the stream,
+                // as it does when the stream can seek
+                expectEquals (reader->lengthInSamples, (int64) 301 * 1152);
+            }
+        }
+       #endif
+
+        beginTest ("Unknown data");
+        {
+            MemoryOutputStream text;
+
+            for (int i = 0; i < 10000; ++i)
+                text << "This isn't audio. ";
+
+            auto data = text.getMemoryBlock();
+
+            std::unique_ptr<AudioFormatReader> reader (manager.createStreamingReaderFor (new ForwardOnlyStream (data)));
+            expect (reader == nullptr);
+        }
+    }
+
+    static AudioBuffer<float> createSource (int numChannels, int numSamples)
+    {
+        AudioBuffer<float> buffer (numChannels, numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int n = 0; n < numSamples; ++n)
+                buffer.setSample (ch, n, 0.4f * (float) std::sin (n * 0.013 * (ch + 1))
+                                         + 0.3f * (float) std::sin (n * 0.0007 + ch));
+
+        return buffer;
+    }
+
+   #if JUCE_USE_MP3AUDIOFORMAT
+    // There's no MP3 encoder, so this makes a stream of silent 128kbps MPEG-1 layer 3
+    // frames at 44.1kHz, after an ID3 tag. If there's no Xing header to give the number
+    // of frames, a few bytes of junk are put between some of the frames, which the
+    // decoder has to search past.
+    static MemoryBlock createMP3Stream (int numFrames, bool withXingHeader)
+    {
+        MemoryOutputStream out;
+
+        const uint8 id3Tag[] = { 'I', 'D', '3', 3, 0, 0, 0, 0, 0, 100 };
+        out.write (id3Tag, sizeof (id3Tag));
+        out.writeRepeatedByte (0, 100);
+
+        auto writeFrame = [&out] (bool padded, const void* payload, size_t payloadSize)
+        {
+            const uint8 header[] = { 0xff, 0xfb, (uint8) (padded ? 0x92 : 0x90), 0x00 };
+            out.write (header, sizeof (header));
+            out.write (payload, payloadSize);
+            out.writeRepeatedByte (0, (size_t) (padded ? 418 : 417) - sizeof (header) - payloadSize);
+        };
+
+        if (withXingHeader)
+        {
+            MemoryOutputStream xing;
+            xing.writeRepeatedByte (0, 32);
+            xing.write ("Xing", 4);
+            xing.writeIntBigEndian (1); // only the frame count is present
+            xing.writeIntBigEndian (numFrames);
+
+            writeFrame (false, xing.getData(), xing.getDataSize());
+        }
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            writeFrame (i % 3 == 0, nullptr, 0);
+
+            if (! withXingHeader && i % 37 == 20)
+                out.writeRepeatedByte (0, 5);
+        }
+
+        return out.getMemoryBlock();
+    }
+   #endif
+
+    MemoryBlock encode (AudioFormat&& format, const AudioBuffer<float>& source, int bitDepth, int quality)
+    {
+        MemoryBlock data;
+
+        {
+            std::unique_ptr<AudioFormatWriter> writer (format.createWriterFor (new MemoryOutputStream (data, false), 44100.0,
+                                                                               (unsigned int) source.getNumChannels(),
+                                                                               bitDepth, {}, quality));
+            expect (writer != nullptr);
+
+            if (writer != nullptr)
+                writer->writeFromAudioSampleBuffer (source, 0, source.getNumSamples());
+        }
+
+        return data;
+    }
+
+    // Reads a stream in uneven blocks with a skip in the middle, and compares it with
+    // what a reader that can seek produces from the reference data.
+    void checkStreamingReader (AudioFormatManager& manager, const MemoryBlock& referenceData, const MemoryBlock& streamData,
+                               const String& formatName, bool isLengthKnown, float tolerance)
+    {
+        std::unique_ptr<AudioFormatReader> reference (manager.createReaderFor (new MemoryInputStream (referenceData, false)));
+        std::unique_ptr<AudioFormatReader> reader (manager.createStreamingReaderFor (new ForwardOnlyStream (streamData)));
+
+        expect (reference != nullptr);
+        expect (reader != nullptr);
+
+        if (reference == nullptr || reader == nullptr)
+            return;
+
+        expectEquals (reader->getFormatName(), formatName);
+        expectEquals (reader->sampleRate, reference->sampleRate);
+        expectEquals ((int) reader->numChannels, (int) reference->numChannels);
+        expectEquals (reader->lengthInSamples, isLengthKnown ? reference->lengthInSamples
+                                                             : std::numeric_limits<int64>::max());
+
+        auto length = (int) reference->lengthInSamples;
+        auto numChannels = (int) reader->numChannels;
+        AudioBuffer<float> expected (numChannels, length);
+        reference->read (&expected, 0, length, 0, true, true);
+
+        AudioBuffer<float> block (numChannels, 5000);
+        auto skipStart = length / 3, skipEnd = skipStart + 7777;
+        float maxDifference = 0;
+
+        for (int start = 0; start < length + 2000;)
+        {
+            if (start >= skipStart && start < skipEnd)
+                start = skipEnd;
+
+            auto num = 100 + start % 4321;
+
+            // some readers (e.g. the MP3 one) report a read that starts past the end as a failure
+            expect (reader->read (block.getArrayOfWritePointers(), numChannels, start, num) || start >= length);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+                for (int n = 0; n < num; ++n)
+                    maxDifference = jmax (maxDifference, std::abs (block.getSample (ch, n) - (start + n < length ? expected.getSample (ch, start + n) : 0.0f)));
+
+            start += num;
+        }
+
+        expectLessOrEqual (maxDifference, tolerance);
+        expectEquals (reader->lengthInSamples, (int64) length);
+
+        // going back to a position that's been passed isn't possible
+        expect (! reader->read (block.getArrayOfWritePointers(), numChannels, length / 2, 1000));
+    }
+};
+
+static StreamingAudioFormatReaderTests streamingAudioFormatReaderTests;
+
+#endif
+
 } // namespace juce
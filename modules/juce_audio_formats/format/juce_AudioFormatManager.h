@@ -140,6 +140,23 @@ public:
     */
     AudioFormatReader* createReaderFor (InputStream* audioFileStream);
 
+    /** Searches through the known formats to try to create a reader that can decode
+        this stream without repositioning it.
+
+        This is like createReaderFor(), but for streams that can only be read forwards,
+        such as network connections or pipes. The stream is wrapped in a
+        RewindableInputStream, so that each format can have a look at the start of it in
+        turn. See AudioFormat::createStreamingReaderFor() for the details of how the
+        reader that is returned behaves.
+
+        The stream object that is passed-in will be deleted by this method or by the
+        reader that is returned, so the caller should not keep any references to it.
+
+        If none of the registered formats can open the stream, it'll return nullptr.
+        If it returns a reader, it's the caller's responsibility to delete the reader.
+    */
+    AudioFormatReader* createStreamingReaderFor (InputStream* audioStream);
+
 private:
     //==============================================================================
     OwnedArray<AudioFormat> knownFormats;
@@ -420,15 +420,90 @@ bool MemoryMappedAudioFormatReader::mapSectionOfFile (Range<int64> samplesToMap)
         map.reset (new MemoryMappedFile (file, fileRange, MemoryMappedFile::readOnly));
 
         if (map->getData() == nullptr)
+        {
             map.reset();
+        }
         else
+        {
             mappedSection = Range<int64> (jmax ((int64) 0, filePosToSample (map->getRange().getStart() + (bytesPerFrame - 1))),
                                           jmin (lengthInSamples, filePosToSample (map->getRange().getEnd())));
+
+            if (accessPattern != MemoryMappedFile::sequentialAccess)
+                map->setAccessPattern (accessPattern);
+        }
     }
 
     return map != nullptr;
 }
 
+void MemoryMappedAudioFormatReader::setAccessPattern (MemoryMappedFile::AccessPattern pattern)
+{
+    accessPattern = pattern;
+
+    if (map != nullptr)
+        map->setAccessPattern (pattern);
+}
+
+void MemoryMappedAudioFormatReader::prefetchSamples (Range<int64> samples) noexcept
+{
+    if (map != nullptr)
+        map->prefetch ({ sampleToFilePos (samples.getStart()), sampleToFilePos (samples.getEnd()) });
+}
+
+void MemoryMappedAudioFormatReader::setSlidingWindowSize (int64 maxBytesToMap)
+{
+    jassert (maxBytesToMap >= 0);
+    slidingWindowBytes = maxBytesToMap;
+}
+
+bool MemoryMappedAudioFormatReader::ensureSamplesAreMapped (Range<int64> samples) const
+{
+    // Clipping the request to the file here would turn an out-of-range one into an empty
+    // range, which every mapping "contains", so it has to be rejected instead
+    if (samples.getStart() < 0 || samples.getEnd() > lengthInSamples)
+        return false;
+
+    if (map != nullptr && mappedSection.contains (samples))
+        return true;
+
+    if (slidingWindowBytes <= 0)
+        return false;
+
+    auto windowLength = jmax (samples.getLength(), slidingWindowBytes / bytesPerFrame);
+    auto start = accessPattern == MemoryMappedFile::sequentialAccess ? samples.getStart()
+                                                                     : samples.getStart() - (windowLength - samples.getLength()) / 2;
+
+    auto window = Range<int64> (0, lengthInSamples).constrainRange (Range<int64>::withStartAndLength (start, windowLength));
+
+    // The mapping is just a cache of the file's contents, so changing it doesn't change the
+    // reader's logical state, which is why this can be done from the const read methods
+    auto& reader = const_cast<MemoryMappedAudioFormatReader&> (*this);
+
+    if (! reader.mapSectionOfFile (window))
+        return false;
+
+    if (accessPattern == MemoryMappedFile::sequentialAccess)
+        reader.prefetchSamples (window);
+
+    return mappedSection.contains (samples);
+}
+
+const float* MemoryMappedAudioFormatReader::getInterleavedFloatData (Range<int64> samples)
+{
+    if (! usesFloatingPointData || bitsPerSample != 32 || bytesPerFrame != 4 * (int) numChannels
+         || dataIsBigEndian != ByteOrder::isBigEndian()
+         || samples.getStart() < 0 || samples.getEnd() > lengthInSamples
+         || ! ensureSamplesAreMapped (samples))
+        return nullptr;
+
+    auto data = sampleToPointer (samples.getStart());
+
+    if ((((pointer_sized_int) data) & 3) != 0)
+        return nullptr;
+
+    return static_cast<const float*> (data);
+}
+
 static int memoryReadDummyVariable; // used to force the compiler not to optimise-away the read operation
 
 void MemoryMappedAudioFormatReader::touchSample (int64 sample) const noexcept
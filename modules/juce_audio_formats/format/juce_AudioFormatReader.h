@@ -280,10 +280,27 @@ protected:
         using DestType   = AudioData::Pointer<DestSampleType,   AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::NonConst>;
         using SourceType = AudioData::Pointer<SourceSampleType, SourceEndianness, AudioData::Interleaved, AudioData::Const>;
 
+        // Integers being read as integers, and floats as floats, can be done a block at a time
+        enum
+        {
+            sourceFormat = AudioDataConverters::getDataFormat<SourceSampleType, SourceEndianness>(),
+            canConvertBlocks = sourceFormat >= 0
+                                 && (AudioDataConverters::usesVectorInstructions || SourceSampleType::bytesPerSample == 4)
+                                 && ((std::is_same<DestSampleType, AudioData::Int32>::value   && SourceSampleType::isFloat == 0)
+                                  || (std::is_same<DestSampleType, AudioData::Float32>::value && SourceSampleType::isFloat != 0))
+        };
+
         template <typename TargetType>
         static void read (TargetType* const* destData, int destOffset, int numDestChannels,
                           const void* sourceData, int numSourceChannels, int numSamples) noexcept
         {
+            if (canConvertBlocks)
+            {
+                AudioDataConverters::deinterleaveToInt32 ((AudioDataConverters::DataFormat) sourceFormat, sourceData, numSourceChannels,
+                                                          reinterpret_cast<int32* const*> (destData), destOffset, numDestChannels, numSamples);
+                return;
+            }
+
             for (int i = 0; i < numDestChannels; ++i)
             {
                 if (void* targetChan = destData[i])
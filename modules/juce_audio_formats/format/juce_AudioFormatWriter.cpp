@@ -216,16 +216,30 @@ public:
     Buffer (TimeSliceThread& tst, AudioFormatWriter* w, int channels, int numSamples)
         : fifo (numSamples),
           buffer (channels, numSamples),
-          timeSliceThread (tst),
+          timeSliceThread (&tst),
           writer (w)
     {
-        timeSliceThread.addTimeSliceClient (this);
+        timeSliceThread->addTimeSliceClient (this);
+    }
+
+    Buffer (ThreadedWriterPool& p, AudioFormatWriter* w, int channels, int numSamples)
+        : fifo (numSamples),
+          buffer (channels, numSamples),
+          pool (&p),
+          writer (w),
+          samplesPerWrite (jlimit (1, jmax (1, numSamples / 2), p.samplesPerWrite))
+    {
+        pool->addWriter (this);
     }
 
     ~Buffer() override
     {
         isRunning = false;
-        timeSliceThread.removeTimeSliceClient (this);
+
+        if (pool != nullptr)
+            pool->removeWriter (this);
+        else
+            timeSliceThread->removeTimeSliceClient (this);
 
         while (writePendingData() == 0)
         {}
@@ -236,13 +250,17 @@ public:
         if (numSamples <= 0 || ! isRunning)
             return true;
 
-        jassert (timeSliceThread.isThreadRunning());  // you need to get your thread running before pumping data into this!
+        jassert (pool != nullptr || timeSliceThread->isThreadRunning());  // you need to get your thread running before pumping data into this!
 
         int start1, size1, start2, size2;
         fifo.prepareToWrite (numSamples, start1, size1, start2, size2);
 
         if (size1 + size2 < numSamples)
+        {
+            ++numOverruns;
+            numSamplesDropped += numSamples;
             return false;
+        }
 
         for (int i = buffer.getNumChannels(); --i >= 0;)
         {
@@ -251,7 +269,17 @@ public:
         }
 
         fifo.finishedWrite (size1 + size2);
-        timeSliceThread.notify();
+
+        auto numReady = fifo.getNumReady();
+
+        if (numReady > maxNumSamplesBuffered)
+            maxNumSamplesBuffered = numReady;
+
+        if (pool == nullptr)
+            timeSliceThread->notify();
+        else if (numReady >= samplesPerWrite && ! hasNotifiedPool.exchange (true))
+            pool->notify();
+
         return true;
     }
 
@@ -260,9 +288,30 @@ public:
         return writePendingData();
     }
 
+    // Called by the pool's threads: this writes the data if there's enough of it, or if
+    // it's been waiting for too long, and returns true if anything was written.
+    bool writeIfReady (uint32 now, int maxMillisecondsToHoldData)
+    {
+        auto numReady = fifo.getNumReady();
+
+        if (numReady == 0
+             || (numReady < samplesPerWrite && now - lastWriteTime < (uint32) maxMillisecondsToHoldData))
+            return false;
+
+        if (isBeingWritten.exchange (true))
+            return false;
+
+        hasNotifiedPool = false;
+        auto wasWritten = (writePendingData() == 0);
+        isBeingWritten = false;
+        return wasWritten;
+    }
+
     int writePendingData()
     {
-        auto numToDo = fifo.getTotalSize() / 4;
+        // a pool writes everything in one go, to keep the writes large
+        auto numToDo = pool != nullptr ? fifo.getNumReady()
+                                       : fifo.getTotalSize() / 4;
 
         int start1, size1, start2, size2;
         fifo.prepareToRead (numToDo, start1, size1, start2, size2);
@@ -290,6 +339,9 @@ public:
         }
 
         fifo.finishedRead (size1 + size2);
+        totalSamplesWritten += size1 + size2;
+        ++numWrites;
+        lastWriteTime = Time::getMillisecondCounter();
 
         if (samplesPerFlush > 0)
         {
@@ -320,16 +372,41 @@ public:
         samplesPerFlush = numSamples;
     }
 
+    Statistics getStatistics() const noexcept
+    {
+        Statistics s;
+        s.bufferSize = fifo.getTotalSize() - 1;
+        s.numSamplesBuffered = fifo.getNumReady();
+        s.maxNumSamplesBuffered = maxNumSamplesBuffered;
+        s.numSamplesWritten = totalSamplesWritten;
+        s.numWrites = numWrites;
+        s.numOverruns = numOverruns;
+        s.numSamplesDropped = numSamplesDropped;
+        return s;
+    }
+
+    void resetStatistics() noexcept
+    {
+        maxNumSamplesBuffered = 0;
+        numOverruns = 0;
+        numSamplesDropped = 0;
+    }
+
 private:
     AbstractFifo fifo;
     AudioBuffer<float> buffer;
-    TimeSliceThread& timeSliceThread;
+    TimeSliceThread* timeSliceThread = nullptr;
+    ThreadedWriterPool* pool = nullptr;
     std::unique_ptr<AudioFormatWriter> writer;
     CriticalSection thumbnailLock;
     IncomingDataReceiver* receiver = {};
     int64 samplesWritten = 0;
-    int samplesPerFlush = 0, flushSampleCounter = 0;
-    std::atomic<bool> isRunning { true };
+    int samplesPerFlush = 0, flushSampleCounter = 0, samplesPerWrite = 0;
+    // read by other pool threads in writeIfReady() before they've taken isBeingWritten
+    std::atomic<uint32> lastWriteTime { Time::getMillisecondCounter() };
+    std::atomic<bool> isRunning { true }, isBeingWritten { false }, hasNotifiedPool { false };
+    std::atomic<int> maxNumSamplesBuffered { 0 };
+    std::atomic<int64> totalSamplesWritten { 0 }, numWrites { 0 }, numOverruns { 0 }, numSamplesDropped { 0 };
 
     JUCE_DECLARE_NON_COPYABLE (Buffer)
 };
@@ -339,6 +416,11 @@ AudioFormatWriter::ThreadedWriter::ThreadedWriter (AudioFormatWriter* writer, Ti
 {
 }
 
+AudioFormatWriter::ThreadedWriter::ThreadedWriter (AudioFormatWriter* writer, ThreadedWriterPool& pool, int numSamplesToBuffer)
+    : buffer (new AudioFormatWriter::ThreadedWriter::Buffer (pool, writer, (int) writer->numChannels, numSamplesToBuffer))
+{
+}
+
 AudioFormatWriter::ThreadedWriter::~ThreadedWriter()
 {
 }
@@ -358,4 +440,271 @@ void AudioFormatWriter::ThreadedWriter::setFlushInterval (int numSamplesPerFlush
     buffer->setFlushInterval (numSamplesPerFlush);
 }
 
+AudioFormatWriter::ThreadedWriter::Statistics AudioFormatWriter::ThreadedWriter::getStatistics() const noexcept
+{
+    return buffer->getStatistics();
+}
+
+void AudioFormatWriter::ThreadedWriter::resetStatistics() noexcept
+{
+    buffer->resetStatistics();
+}
+
+//==============================================================================
+class AudioFormatWriter::ThreadedWriterPool::WriterThread  : public Thread
+{
+public:
+    WriterThread (const String& name, ThreadedWriterPool& p)  : Thread (name), pool (p) {}
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            if (! pool.writePendingData())
+            {
+                isWaiting = true;
+                wait (pool.maxMillisecondsToHoldData);
+                isWaiting = false;
+            }
+        }
+    }
+
+    std::atomic<bool> isWaiting { false };
+
+private:
+    ThreadedWriterPool& pool;
+
+    JUCE_DECLARE_NON_COPYABLE (WriterThread)
+};
+
+AudioFormatWriter::ThreadedWriterPool::ThreadedWriterPool (const String& threadName, int numThreads,
+                                                           int samplesPerWriteToUse, int maxMillisecondsToHold)
+    : samplesPerWrite (jmax (1, samplesPerWriteToUse)),
+      maxMillisecondsToHoldData (jmax (1, maxMillisecondsToHold))
+{
+    jassert (numThreads > 0);
+
+    for (int i = jmax (1, numThreads); --i >= 0;)
+        threads.add (new WriterThread (threadName, *this))->startThread();
+}
+
+AudioFormatWriter::ThreadedWriterPool::~ThreadedWriterPool()
+{
+    // All the ThreadedWriters that use the pool must be deleted before it is!
+    jassert (writers.isEmpty());
+
+    for (auto* t : threads)
+    {
+        t->signalThreadShouldExit();
+        t->notify();
+    }
+
+    for (auto* t : threads)
+        t->stopThread (4000);
+}
+
+int AudioFormatWriter::ThreadedWriterPool::getNumThreads() const noexcept
+{
+    return threads.size();
+}
+
+int AudioFormatWriter::ThreadedWriterPool::getNumWriters() const
+{
+    const ScopedReadLock sl (writersLock);
+    return writers.size();
+}
+
+void AudioFormatWriter::ThreadedWriterPool::addWriter (ThreadedWriter::Buffer* writer)
+{
+    const ScopedWriteLock sl (writersLock);
+    writers.add (writer);
+}
+
+void AudioFormatWriter::ThreadedWriterPool::removeWriter (ThreadedWriter::Buffer* writer)
+{
+    // (this waits for any thread that's in the middle of writing to finish)
+    const ScopedWriteLock sl (writersLock);
+    writers.removeFirstMatchingValue (writer);
+}
+
+void AudioFormatWriter::ThreadedWriterPool::notify() noexcept
+{
+    auto numThreads = (uint32) threads.size();
+    auto first = (uint32) nextThreadToWake++ % numThreads;
+
+    // Wake an idle thread if there is one. If they're all busy, they'll find the data
+    // when they next look, but the next one in turn is also woken in case it's just
+    // about to start waiting.
+    for (uint32 i = 0; i < numThreads; ++i)
+    {
+        auto* t = threads.getUnchecked ((int) ((first + i) % numThreads));
+
+        if (t->isWaiting)
+        {
+            t->notify();
+            return;
+        }
+    }
+
+    threads.getUnchecked ((int) first)->notify();
+}
+
+bool AudioFormatWriter::ThreadedWriterPool::writePendingData()
+{
+    const ScopedReadLock sl (writersLock);
+    auto now = Time::getMillisecondCounter();
+    bool anythingWritten = false;
+
+    for (auto* w : writers)
+        if (w->writeIfReady (now, maxMillisecondsToHoldData))
+            anythingWritten = true;
+
+    return anythingWritten;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct ThreadedWriterPoolTests  : public UnitTest
+{
+    ThreadedWriterPoolTests()
+        : UnitTest ("ThreadedWriterPool", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Writing many files");
+        {
+            const int numWriters = 24, blockSize = 512, numBlocks = 400;
+            AudioFormatWriter::ThreadedWriterPool pool ("Test writers", 3, 8192, 20);
+            OwnedArray<Array<float>> destinations;
+            OwnedArray<AudioFormatWriter::ThreadedWriter> writers;
+
+            for (int i = 0; i < numWriters; ++i)
+                writers.add (new AudioFormatWriter::ThreadedWriter (new RecordingWriter (*destinations.add (new Array<float>())),
+                                                                    pool, 65536));
+
+            expectEquals (pool.getNumWriters(), numWriters);
+
+            HeapBlock<float> block (blockSize);
+            const float* channels[] = { block.get(), nullptr };
+
+            for (int b = 0; b < numBlocks; ++b)
+            {
+                for (int i = 0; i < numWriters; ++i)
+                {
+                    for (int n = 0; n < blockSize; ++n)
+                        block[n] = (float) (i * 100000 + b * blockSize + n);
+
+                    while (! writers.getUnchecked (i)->write (channels, blockSize))
+                        Thread::sleep (1);
+                }
+
+                if (b % 20 == 0)
+                    Thread::sleep (1);
+            }
+
+            int64 numWrites = 0;
+            int maxBuffered = 0;
+
+            for (auto* w : writers)
+            {
+                auto stats = w->getStatistics();
+                numWrites += stats.numWrites;
+                maxBuffered = jmax (maxBuffered, stats.maxNumSamplesBuffered);
+                expectEquals (stats.bufferSize, 65535);
+            }
+
+            logMessage (String (numWriters) + " writers: " + String (numWrites) + " writes before closing, at most "
+                          + String (maxBuffered) + " samples buffered");
+
+            writers.clear();
+            expectEquals (pool.getNumWriters(), 0);
+
+            for (int i = 0; i < numWriters; ++i)
+            {
+                auto& d = *destinations.getUnchecked (i);
+                expectEquals (d.size(), blockSize * numBlocks);
+
+                bool allCorrect = true;
+
+                for (int n = 0; n < d.size(); ++n)
+                    allCorrect = allCorrect && d.getUnchecked (n) == (float) (i * 100000 + n);
+
+                expect (allCorrect);
+            }
+        }
+
+        beginTest ("Statistics");
+        {
+            // with only one thread that's kept busy, the other writer's buffer has to fill up
+            AudioFormatWriter::ThreadedWriterPool pool ("Test writers", 1, 256, 1000);
+            Array<float> blockedData, data;
+            WaitableEvent started, unblock;
+
+            std::unique_ptr<AudioFormatWriter::ThreadedWriter> blocked (new AudioFormatWriter::ThreadedWriter (new RecordingWriter (blockedData, &started, &unblock), pool, 1000));
+            std::unique_ptr<AudioFormatWriter::ThreadedWriter> writer (new AudioFormatWriter::ThreadedWriter (new RecordingWriter (data), pool, 1000));
+
+            HeapBlock<float> block (1000, true);
+            const float* channels[] = { block.get(), nullptr };
+
+            expect (blocked->write (channels, 600));
+            expect (started.wait (5000));
+
+            expect (writer->write (channels, 600));
+            expect (writer->write (channels, 300));
+            expect (! writer->write (channels, 200));
+            expect (! writer->write (channels, 100));
+
+            auto stats = writer->getStatistics();
+            expectEquals (stats.bufferSize, 999);
+            expectEquals (stats.numSamplesBuffered, 900);
+            expectEquals (stats.maxNumSamplesBuffered, 900);
+            expectEquals (stats.numOverruns, (int64) 2);
+            expectEquals (stats.numSamplesDropped, (int64) 300);
+            expectEquals (stats.numSamplesWritten, (int64) 0);
+
+            unblock.signal();
+            writer.reset();
+            blocked.reset();
+            expectEquals (data.size(), 900);
+        }
+    }
+
+private:
+    // A writer that stores its data in an array, and can be made to stall
+    struct RecordingWriter  : public AudioFormatWriter
+    {
+        RecordingWriter (Array<float>& dest, WaitableEvent* eventToSignal = nullptr, WaitableEvent* eventToWaitFor = nullptr)
+            : AudioFormatWriter (nullptr, "Test", 44100.0, 1, 32),
+              destination (dest), startedEvent (eventToSignal), waitEvent (eventToWaitFor)
+        {
+            usesFloatingPointData = true;
+        }
+
+        bool write (const int** data, int numSamples) override
+        {
+            if (startedEvent != nullptr)
+                startedEvent->signal();
+
+            if (waitEvent != nullptr)
+                waitEvent->wait();
+
+            destination.addArray (reinterpret_cast<const float*> (data[0]), numSamples);
+            return true;
+        }
+
+        Array<float>& destination;
+        WaitableEvent* startedEvent;
+        WaitableEvent* waitEvent;
+    };
+
+    JUCE_DECLARE_NON_COPYABLE (ThreadedWriterPoolTests)
+};
+
+static const ThreadedWriterPoolTests threadedWriterPoolTests;
+
+#endif
+
 } // namespace juce
@@ -177,6 +177,8 @@ public:
     bool isFloatingPoint() const noexcept       { return usesFloatingPointData; }
 
     //==============================================================================
+    class ThreadedWriterPool;
+
     /**
         Provides a FIFO for an AudioFormatWriter, allowing you to push incoming
         data into a buffer which will be flushed to disk by a background thread.
@@ -195,6 +197,18 @@ public:
                         TimeSliceThread& backgroundThread,
                         int numSamplesToBuffer);
 
+        /** Creates a ThreadedWriter whose data is written by one of the threads in a
+            ThreadedWriterPool.
+
+            The writer object which is passed in here will be owned and deleted by
+            the ThreadedWriter when it is no longer needed.
+
+            To stop the writer and flush the buffer to disk, simply delete this object.
+        */
+        ThreadedWriter (AudioFormatWriter* writer,
+                        ThreadedWriterPool& pool,
+                        int numSamplesToBuffer);
+
         /** Destructor. */
         ~ThreadedWriter();
 
@@ -212,6 +226,39 @@ public:
         */
         bool write (const float* const* data, int numSamples);
 
+        /** Describes how well the background thread is keeping up with the incoming data.
+            @see getStatistics
+        */
+        struct Statistics
+        {
+            /** The number of samples that the FIFO can hold. */
+            int bufferSize = 0;
+
+            /** The number of samples that are waiting to be written. */
+            int numSamplesBuffered = 0;
+
+            /** The highest number of samples that have been waiting to be written at once. */
+            int maxNumSamplesBuffered = 0;
+
+            /** The number of samples that have been passed to the AudioFormatWriter. */
+            int64 numSamplesWritten = 0;
+
+            /** The number of blocks in which the data has been passed to the AudioFormatWriter. */
+            int64 numWrites = 0;
+
+            /** The number of calls to write() that failed because the FIFO was too full. */
+            int64 numOverruns = 0;
+
+            /** The total number of samples in the calls to write() that failed. */
+            int64 numSamplesDropped = 0;
+        };
+
+        /** Returns the current statistics. This can be called from any thread. */
+        Statistics getStatistics() const noexcept;
+
+        /** Resets the maxNumSamplesBuffered, numOverruns and numSamplesDropped statistics. */
+        void resetStatistics() noexcept;
+
         /** Receiver for incoming data. */
         class JUCE_API  IncomingDataReceiver
         {
@@ -240,9 +287,68 @@ public:
 
     private:
         class Buffer;
+        friend class ThreadedWriterPool;
         std::unique_ptr<Buffer> buffer;
     };
 
+    //==============================================================================
+    /**
+        A set of threads which write the data from any number of ThreadedWriters
+        to disk.
+
+        A TimeSliceThread services its ThreadedWriters one at a time, polling each of
+        them in turn. When a lot of files are being recorded at once (e.g. one for each
+        track of a multitrack recording), a pool can share the writers between several
+        threads instead. The threads sleep until a writer has enough data for a write,
+        and then write all of its data in one go, so each write to a file is a large
+        sequential block.
+
+        A writer is written to when at least samplesPerWrite samples are waiting in its
+        buffer (or half of its buffer, if that's smaller), or when its oldest data has been
+        waiting for longer than maxMillisecondsToHoldData.
+
+        All the ThreadedWriters that use a pool must be deleted before the pool.
+
+        @see ThreadedWriter
+
+        @tags{Audio}
+    */
+    class JUCE_API  ThreadedWriterPool
+    {
+    public:
+        /** Creates a pool and starts its threads. */
+        ThreadedWriterPool (const String& threadName,
+                            int numThreads,
+                            int samplesPerWrite = 32768,
+                            int maxMillisecondsToHoldData = 100);
+
+        /** Destructor. */
+        ~ThreadedWriterPool();
+
+        /** Returns the number of threads in the pool. */
+        int getNumThreads() const noexcept;
+
+        /** Returns the number of ThreadedWriters that are using the pool. */
+        int getNumWriters() const;
+
+    private:
+        class WriterThread;
+        friend class ThreadedWriter;
+
+        OwnedArray<WriterThread> threads;
+        Array<ThreadedWriter::Buffer*> writers;
+        ReadWriteLock writersLock;
+        std::atomic<int> nextThreadToWake { 0 };
+        const int samplesPerWrite, maxMillisecondsToHoldData;
+
+        void addWriter (ThreadedWriter::Buffer*);
+        void removeWriter (ThreadedWriter::Buffer*);
+        void notify() noexcept;
+        bool writePendingData();
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ThreadedWriterPool)
+    };
+
 protected:
     //==============================================================================
     /** The sample rate of the stream. */
@@ -270,9 +376,33 @@ protected:
         using DestType   = AudioData::Pointer <DestSampleType,   DestEndianness,          AudioData::Interleaved,    AudioData::NonConst>;
         using SourceType = AudioData::Pointer <SourceSampleType, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>;
 
+        // Integers being written as integers, and floats as floats, can be done a block at a time
+        enum
+        {
+            destFormat = AudioDataConverters::getDataFormat<DestSampleType, DestEndianness>(),
+            canConvertBlocks = destFormat >= 0
+                                 && (AudioDataConverters::usesVectorInstructions || DestSampleType::bytesPerSample == 4)
+                                 && ((std::is_same<SourceSampleType, AudioData::Int32>::value   && DestSampleType::isFloat == 0)
+                                  || (std::is_same<SourceSampleType, AudioData::Float32>::value && DestSampleType::isFloat != 0))
+        };
+
         static void write (void* destData, int numDestChannels, const int* const* source,
                            int numSamples, const int sourceOffset = 0) noexcept
         {
+            if (canConvertBlocks)
+            {
+                // (the source channels stop at the first null pointer)
+                int numSourceChannels = 0;
+
+                while (numSourceChannels < numDestChannels && source[numSourceChannels] != nullptr)
+                    ++numSourceChannels;
+
+                AudioDataConverters::interleaveFromInt32 (source, sourceOffset, numSourceChannels,
+                                                          (AudioDataConverters::DataFormat) destFormat,
+                                                          destData, numDestChannels, numSamples);
+                return;
+            }
+
             for (int i = 0; i < numDestChannels; ++i)
             {
                 const DestType dest (addBytesToPointer (destData, i * DestType::getBytesPerSample()), numDestChannels);
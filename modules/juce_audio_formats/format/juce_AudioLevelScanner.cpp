@@ -0,0 +1,668 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace LevelScannerHelpers
+{
+    enum
+    {
+        samplesPerBlock = 16384,
+        truePeakMargin = 8    // the number of samples either side of a block that the true-peak filter needs
+    };
+
+    // The 4x oversampling filter from ITU-R BS.1770-4, arranged so that each row holds
+    // one tap of each of the four phases.
+    alignas (16) static const float truePeakCoefficients[12][4] =
+    {
+        {  0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+        {  0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f },
+        { -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+        {  0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f },
+        { -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+        {  0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f },
+        {  0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f },
+        { -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+        {  0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f },
+        { -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+        {  0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f },
+        { -0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f }
+    };
+
+    // Returns the highest absolute value of the oversampled signal around the samples
+    // data[0] to data[num - 1]. The truePeakMargin samples either side of these must
+    // also be readable.
+    static float findTruePeak (const float* data, int num) noexcept
+    {
+        auto& c = truePeakCoefficients;
+
+       #if JUCE_USE_SSE_INTRINSICS
+        auto peak = _mm_setzero_ps();
+        auto signMask = _mm_set1_ps (-0.0f);
+
+        for (int n = 6; n < num + 6; ++n)
+        {
+            auto sum = _mm_mul_ps (_mm_load_ps (c[0]), _mm_set1_ps (data[n]));
+
+            for (int k = 1; k < 12; ++k)
+                sum = _mm_add_ps (sum, _mm_mul_ps (_mm_load_ps (c[k]), _mm_set1_ps (data[n - k])));
+
+            peak = _mm_max_ps (peak, _mm_andnot_ps (signMask, sum));
+        }
+
+        float peaks[4];
+        _mm_storeu_ps (peaks, peak);
+       #elif JUCE_USE_ARM_NEON
+        auto peak = vdupq_n_f32 (0);
+
+        for (int n = 6; n < num + 6; ++n)
+        {
+            auto sum = vmulq_n_f32 (vld1q_f32 (c[0]), data[n]);
+
+            for (int k = 1; k < 12; ++k)
+                sum = vmlaq_n_f32 (sum, vld1q_f32 (c[k]), data[n - k]);
+
+            peak = vmaxq_f32 (peak, vabsq_f32 (sum));
+        }
+
+        float peaks[4];
+        vst1q_f32 (peaks, peak);
+       #else
+        float peaks[4] = {};
+
+        for (int n = 6; n < num + 6; ++n)
+        {
+            for (int phase = 0; phase < 4; ++phase)
+            {
+                float sum = 0;
+
+                for (int k = 0; k < 12; ++k)
+                    sum += c[k][phase] * data[n - k];
+
+                peaks[phase] = jmax (peaks[phase], std::abs (sum));
+            }
+        }
+       #endif
+
+        return jmax (peaks[0], peaks[1], peaks[2], peaks[3]);
+    }
+}
+
+//==============================================================================
+struct AudioLevelScanner::ChunkLevels
+{
+    Range<float> range;
+    double sumOfSquares = 0;
+    float truePeak = 0;
+};
+
+struct AudioLevelScanner::ChunkSearch
+{
+    int64 firstPosition = 0, length = 0;  // the chunk's first position in the direction of the search
+    int64 firstMatch = -1;                // the start of the first complete run of matches in the chunk
+    int64 prefix = 0;                     // the number of matches at the start of the chunk
+    int64 suffix = 0, suffixStart = -1;   // the run of matches at the end of the chunk
+    bool allMatch = false;
+};
+
+//==============================================================================
+AudioLevelScanner::AudioLevelScanner (ReaderFactory createReader, ThreadPool& poolToUse, int maxReaders)
+    : readerFactory (std::move (createReader)), pool (poolToUse),
+      maxNumReaders (maxReaders > 0 ? maxReaders : poolToUse.getNumThreads())
+{
+    if (auto* firstReader = readerFactory())
+        readers.add (firstReader);
+}
+
+AudioLevelScanner::~AudioLevelScanner()
+{
+    const ScopedLock sl (scanLock);
+}
+
+AudioLevelScanner::ReaderFactory AudioLevelScanner::createReaderFactory (AudioFormatManager& formatManager, const File& file)
+{
+    return [&formatManager, file]() -> AudioFormatReader*
+    {
+        if (auto* format = formatManager.findFormatForFileExtension (file.getFileExtension()))
+        {
+            std::unique_ptr<MemoryMappedAudioFormatReader> mapped (format->createMemoryMappedReader (file));
+
+            if (mapped != nullptr && mapped->mapEntireFile())
+                return mapped.release();
+        }
+
+        return formatManager.createReaderFor (file);
+    };
+}
+
+int AudioLevelScanner::getNumChannels() const noexcept
+{
+    if (auto* r = readers.getFirst())
+        return (int) r->numChannels;
+
+    return 0;
+}
+
+int64 AudioLevelScanner::getLengthInSamples() const noexcept
+{
+    if (auto* r = readers.getFirst())
+        return r->lengthInSamples;
+
+    return 0;
+}
+
+void AudioLevelScanner::setSamplesPerChunk (int64 newSamplesPerChunk) noexcept
+{
+    jassert (newSamplesPerChunk > 0);
+
+    const ScopedLock sl (scanLock);
+    samplesPerChunk = jmax ((int64) 1, newSamplesPerChunk);
+}
+
+//==============================================================================
+void AudioLevelScanner::processChunks (int numChunks, ChunkFunction processChunk)
+{
+    auto numJobs = jmin (numChunks, maxNumReaders);
+
+    while (readers.size() < numJobs)
+    {
+        if (auto* r = readerFactory())
+            readers.add (r);
+        else
+            break;
+    }
+
+    numJobs = jmin (numJobs, readers.size());
+
+    if (numJobs <= 0)
+        return;
+
+    nextChunk = 0;
+    numJobsRunning = numJobs;
+    jobsFinished.reset();
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        auto* reader = readers.getUnchecked (i);
+
+        pool.addJob ([this, reader, numChunks, &processChunk]
+        {
+            for (;;)
+            {
+                auto chunkIndex = nextChunk++;
+
+                if (chunkIndex >= numChunks)
+                    break;
+
+                processChunk (*reader, chunkIndex);
+            }
+
+            if (--numJobsRunning == 0)
+                jobsFinished.signal();
+        });
+    }
+
+    jobsFinished.wait();
+}
+
+//==============================================================================
+bool AudioLevelScanner::measureLevels (int64 startSample, int64 numSamples,
+                                       ChannelLevels* results, int numChannelsToRead,
+                                       bool measureTruePeak)
+{
+    jassert (numChannelsToRead > 0 && numChannelsToRead <= getNumChannels());
+
+    for (int i = 0; i < numChannelsToRead; ++i)
+        results[i] = {};
+
+    if (numSamples <= 0 || ! isValid())
+        return isValid();
+
+    const ScopedLock sl (scanLock);
+
+    auto numChunks = (int) ((numSamples + samplesPerChunk - 1) / samplesPerChunk);
+    auto margin = measureTruePeak ? (int) LevelScannerHelpers::truePeakMargin : 0;
+
+    Array<ChunkLevels> chunks;
+    chunks.resize (numChunks * numChannelsToRead);
+    std::atomic<bool> failed { false };
+
+    processChunks (numChunks, [&] (AudioFormatReader& reader, int chunkIndex)
+    {
+        auto start = startSample + chunkIndex * samplesPerChunk;
+        auto end = jmin (start + samplesPerChunk, startSample + numSamples);
+        auto* levels = chunks.getRawDataPointer() + chunkIndex * numChannelsToRead;
+
+        AudioBuffer<float> buffer (numChannelsToRead, (int) LevelScannerHelpers::samplesPerBlock + 2 * margin);
+
+        for (auto pos = start; pos < end;)
+        {
+            auto numThisTime = (int) jmin ((int64) LevelScannerHelpers::samplesPerBlock, end - pos);
+
+            if (! reader.read (buffer.getArrayOfWritePointers(), numChannelsToRead, pos - margin, numThisTime + 2 * margin))
+            {
+                failed = true;
+                return;
+            }
+
+            for (int chan = 0; chan < numChannelsToRead; ++chan)
+            {
+                auto* data = buffer.getReadPointer (chan, margin);
+                auto& l = levels[chan];
+                auto r = FloatVectorOperations::findMinMaxAndSumOfSquares (data, numThisTime, l.sumOfSquares);
+
+                l.range = (pos == start) ? r : l.range.getUnionWith (r);
+
+                if (measureTruePeak)
+                    l.truePeak = jmax (l.truePeak, LevelScannerHelpers::findTruePeak (data, numThisTime));
+            }
+
+            pos += numThisTime;
+        }
+    });
+
+    if (failed)
+        return false;
+
+    for (int chan = 0; chan < numChannelsToRead; ++chan)
+    {
+        double sumOfSquares = 0;
+
+        for (int i = 0; i < numChunks; ++i)
+        {
+            auto& l = chunks.getReference (i * numChannelsToRead + chan);
+
+            results[chan].range = (i == 0) ? l.range : results[chan].range.getUnionWith (l.range);
+            results[chan].truePeak = jmax (results[chan].truePeak, l.truePeak);
+            sumOfSquares += l.sumOfSquares;
+        }
+
+        results[chan].rms = (float) std::sqrt (sumOfSquares / (double) numSamples);
+
+        if (measureTruePeak)
+            results[chan].truePeak = jmax (results[chan].truePeak,
+                                           std::abs (results[chan].range.getStart()),
+                                           std::abs (results[chan].range.getEnd()));
+    }
+
+    return true;
+}
+
+void AudioLevelScanner::readMaxLevels (int64 startSample, int64 numSamples,
+                                       Range<float>* results, int numChannelsToRead)
+{
+    HeapBlock<ChannelLevels> levels ((size_t) numChannelsToRead);
+    measureLevels (startSample, numSamples, levels, numChannelsToRead, false);
+
+    for (int i = 0; i < numChannelsToRead; ++i)
+        results[i] = levels[i].range;
+}
+
+int64 AudioLevelScanner::searchForLevel (int64 startSample,
+                                         int64 numSamplesToSearch,
+                                         double magnitudeRangeMinimum,
+                                         double magnitudeRangeMaximum,
+                                         int minimumConsecutiveSamples)
+{
+    jassert (magnitudeRangeMaximum > magnitudeRangeMinimum);
+
+    if (numSamplesToSearch == 0 || ! isValid())
+        return -1;
+
+    const ScopedLock sl (scanLock);
+
+    auto forwards = numSamplesToSearch > 0;
+    auto range = (forwards ? Range<int64> (startSample, startSample + numSamplesToSearch)
+                           : Range<int64> (startSample + numSamplesToSearch, startSample))
+                    .getIntersectionWith ({ 0, getLengthInSamples() });
+
+    if (range.isEmpty())
+        return -1;
+
+    auto numChunks = (int) ((range.getLength() + samplesPerChunk - 1) / samplesPerChunk);
+    auto numChannelsToCheck = jmin (2, getNumChannels());
+    auto minRun = (int64) jmax (1, minimumConsecutiveSamples);
+
+    Array<ChunkSearch> chunks;
+    chunks.resize (numChunks);
+    std::atomic<int> firstChunkWithMatch { numChunks };
+
+    auto isInRange = [=] (float sample)
+    {
+        auto magnitude = std::abs (sample);
+        return magnitude >= magnitudeRangeMinimum && magnitude <= magnitudeRangeMaximum;
+    };
+
+    processChunks (numChunks, [&] (AudioFormatReader& reader, int chunkIndex)
+    {
+        // once there's a match, the chunks after it don't need to be searched
+        if (chunkIndex > firstChunkWithMatch)
+            return;
+
+        auto chunkRange = (forwards ? Range<int64>::withStartAndLength (range.getStart() + chunkIndex * samplesPerChunk, samplesPerChunk)
+                                    : Range<int64> (range.getEnd() - (chunkIndex + 1) * samplesPerChunk, range.getEnd() - chunkIndex * samplesPerChunk))
+                            .getIntersectionWith (range);
+
+        auto& result = chunks.getReference (chunkIndex);
+        result.firstPosition = forwards ? chunkRange.getStart() : chunkRange.getEnd() - 1;
+        result.length = chunkRange.getLength();
+
+        AudioBuffer<float> buffer (numChannelsToCheck, (int) jmin (chunkRange.getLength(), (int64) LevelScannerHelpers::samplesPerBlock));
+        int64 consecutive = 0, runStart = -1;
+        bool inPrefix = true;
+
+        for (int64 done = 0; done < chunkRange.getLength();)
+        {
+            auto numThisTime = (int) jmin ((int64) buffer.getNumSamples(), chunkRange.getLength() - done);
+            auto blockStart = forwards ? chunkRange.getStart() + done
+                                       : chunkRange.getEnd() - done - numThisTime;
+
+            reader.read (buffer.getArrayOfWritePointers(), numChannelsToCheck, blockStart, numThisTime);
+
+            for (int i = 0; i < numThisTime; ++i)
+            {
+                auto index = forwards ? i : numThisTime - 1 - i;
+
+                if (isInRange (buffer.getSample (0, index))
+                     || (numChannelsToCheck > 1 && isInRange (buffer.getSample (1, index))))
+                {
+                    if (consecutive++ == 0)
+                        runStart = blockStart + index;
+
+                    if (consecutive >= minRun)
+                    {
+                        if (inPrefix)
+                            result.prefix = consecutive;
+
+                        result.firstMatch = runStart;
+
+                        auto firstSoFar = firstChunkWithMatch.load();
+
+                        while (chunkIndex < firstSoFar
+                                && ! firstChunkWithMatch.compare_exchange_weak (firstSoFar, chunkIndex))
+                        {}
+
+                        return;
+                    }
+                }
+                else
+                {
+                    if (inPrefix)
+                    {
+                        result.prefix = consecutive;
+                        inPrefix = false;
+                    }
+
+                    consecutive = 0;
+                }
+            }
+
+            done += numThisTime;
+        }
+
+        if (inPrefix)
+            result.prefix = consecutive;
+
+        result.allMatch = inPrefix;
+        result.suffix = consecutive;
+        result.suffixStart = runStart;
+    });
+
+    // Now join up the chunks in order, to find runs of matches that cross from one chunk
+    // into the next.
+    int64 carry = 0, carryStart = -1;
+
+    for (int i = 0; i <= jmin (numChunks - 1, firstChunkWithMatch.load()); ++i)
+    {
+        auto& chunk = chunks.getReference (i);
+
+        if (carry > 0 && carry + chunk.prefix >= minRun)
+            return carryStart;
+
+        if (chunk.firstMatch >= 0)
+            return chunk.firstMatch;
+
+        if (chunk.allMatch)
+        {
+            if (carry == 0)
+                carryStart = chunk.firstPosition;
+
+            carry += chunk.length;
+        }
+        else
+        {
+            carry = chunk.suffix;
+            carryStart = chunk.suffixStart;
+        }
+    }
+
+    return -1;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioLevelScannerTests  : public UnitTest
+{
+    AudioLevelScannerTests()
+        : UnitTest ("AudioLevelScanner", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        ThreadPool pool (4);
+        auto random = getRandom();
+
+        beginTest ("Levels match AudioFormatReader");
+        {
+            AudioBuffer<float> buffer (3, 300000);
+
+            for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                for (int n = 0; n < buffer.getNumSamples(); ++n)
+                    buffer.setSample (ch, n, (random.nextFloat() * 2.0f - 1.0f) * (float) (ch + 1) / 4.0f
+                                               * (float) std::sin (n * 0.0001));
+
+            auto createReader = createWavReaderFactory (buffer, 24);
+            AudioLevelScanner scanner (createReader, pool);
+            std::unique_ptr<AudioFormatReader> reader (createReader());
+            expect (scanner.isValid() && reader != nullptr);
+            expectEquals (scanner.getNumChannels(), 3);
+            expectEquals (scanner.getLengthInSamples(), (int64) buffer.getNumSamples());
+
+            scanner.setSamplesPerChunk (10000);
+
+            const Range<int64> sections[] = { { 0, 300000 }, { 12345, 98765 }, { 299990, 300010 },
+                                              { -500, 20000 }, { 5, 6 }, { 400000, 400100 }, { 100, 100 } };
+
+            for (auto& section : sections)
+            {
+                Range<float> expected[3], actual[3];
+                reader->readMaxLevels (section.getStart(), section.getLength(), expected, 3);
+                scanner.readMaxLevels (section.getStart(), section.getLength(), actual, 3);
+
+                for (int ch = 0; ch < 3; ++ch)
+                {
+                    expectWithinAbsoluteError (actual[ch].getStart(), expected[ch].getStart(), 1.0e-6f);
+                    expectWithinAbsoluteError (actual[ch].getEnd(), expected[ch].getEnd(), 1.0e-6f);
+                }
+            }
+
+            AudioLevelScanner::ChannelLevels levels[2];
+            expect (scanner.measureLevels (1000, 250000, levels, 2, false));
+
+            for (int ch = 0; ch < 2; ++ch)
+                expectWithinAbsoluteError (levels[ch].rms, buffer.getRMSLevel (ch, 1000, 250000), 1.0e-5f);
+        }
+
+        beginTest ("True peak");
+        {
+            // a quarter-sample-rate sine whose samples all fall halfway between its peaks
+            AudioBuffer<float> buffer (1, 48000);
+
+            for (int n = 0; n < buffer.getNumSamples(); ++n)
+                buffer.setSample (0, n, 0.5f * (float) std::sin (MathConstants<double>::halfPi * n + MathConstants<double>::pi / 4.0));
+
+            AudioLevelScanner scanner (createWavReaderFactory (buffer, 32), pool);
+            scanner.setSamplesPerChunk (5000);
+
+            AudioLevelScanner::ChannelLevels levels;
+            expect (scanner.measureLevels (100, 40000, &levels, 1, true));
+
+            expectWithinAbsoluteError (levels.range.getStart(), -0.3536f, 0.001f);
+            expectWithinAbsoluteError (levels.range.getEnd(), 0.3536f, 0.001f);
+            expectWithinAbsoluteError (levels.rms, 0.3536f, 0.001f);
+            expectWithinAbsoluteError (levels.truePeak, 0.5f, 0.01f);
+        }
+
+        beginTest ("Searching for levels");
+        {
+            AudioBuffer<float> buffer (2, 50000);
+            buffer.clear();
+
+            for (int burst = 0; burst < 40; ++burst)
+            {
+                auto start = random.nextInt (buffer.getNumSamples() - 100);
+                auto length = random.nextInt (100) + 1;
+                auto channel = random.nextInt (2);
+
+                for (int n = start; n < start + length; ++n)
+                    buffer.setSample (channel, n, random.nextBool() ? 0.5f : -0.5f);
+            }
+
+            auto createReader = createWavReaderFactory (buffer, 32);
+            AudioLevelScanner scanner (createReader, pool);
+            std::unique_ptr<AudioFormatReader> reader (createReader());
+            scanner.setSamplesPerChunk (1000);
+
+            for (int i = 0; i < 200; ++i)
+            {
+                auto start = (int64) random.nextInt (buffer.getNumSamples() + 1);
+                auto num = (int64) random.nextInt (30000) * (random.nextBool() ? 1 : -1);
+                const int minConsecutive[] = { 0, 1, 5, 30, 80 };
+                auto minRun = minConsecutive[random.nextInt (numElementsInArray (minConsecutive))];
+
+                expectEquals (scanner.searchForLevel (start, num, 0.25, 1.0, minRun),
+                              reader->searchForLevel (start, num, 0.25, 1.0, minRun));
+            }
+        }
+
+        beginTest ("Reading from a file");
+        {
+            AudioFormatManager formatManager;
+            formatManager.registerBasicFormats();
+
+            AudioBuffer<float> buffer (2, 100000);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < buffer.getNumSamples(); ++n)
+                    buffer.setSample (ch, n, random.nextFloat() - 0.5f);
+
+            TemporaryFile file (".wav");
+            auto wavData = createWavData (buffer, 24);
+            expect (file.getFile().replaceWithData (wavData.getData(), wavData.getSize()));
+
+            // the scanner's readers map the file, so this checks them against a normal reader
+            AudioLevelScanner scanner (AudioLevelScanner::createReaderFactory (formatManager, file.getFile()), pool);
+            std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (file.getFile()));
+            expect (scanner.isValid() && reader != nullptr);
+            scanner.setSamplesPerChunk (7000);
+
+            Range<float> expected[2], actual[2];
+            reader->readMaxLevels (0, buffer.getNumSamples(), expected, 2);
+            scanner.readMaxLevels (0, buffer.getNumSamples(), actual, 2);
+
+            for (int ch = 0; ch < 2; ++ch)
+                expect (actual[ch] == expected[ch]);
+
+            AudioLevelScanner missing (AudioLevelScanner::createReaderFactory (formatManager, file.getFile().getSiblingFile ("missing.wav")), pool);
+            expect (! missing.isValid());
+        }
+
+        beginTest ("Performance");
+        {
+            AudioBuffer<float> buffer (2, 44100 * 60);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int n = 0; n < buffer.getNumSamples(); ++n)
+                    buffer.setSample (ch, n, 0.5f * (float) std::sin (n * (0.01 + 0.01 * ch)));
+
+            auto createReader = createWavReaderFactory (buffer, 16);
+            AudioLevelScanner scanner (createReader, pool);
+            std::unique_ptr<AudioFormatReader> reader (createReader());
+            Range<float> ranges[2];
+            AudioLevelScanner::ChannelLevels levels[2];
+
+            auto time = [] (std::function<void()> f)
+            {
+                auto start = Time::getMillisecondCounterHiRes();
+                f();
+                return Time::getMillisecondCounterHiRes() - start;
+            };
+
+            auto length = scanner.getLengthInSamples();
+            auto readerTime  = time ([&] { reader->readMaxLevels (0, length, ranges, 2); });
+            auto scannerTime = time ([&] { scanner.readMaxLevels (0, length, ranges, 2); });
+            auto levelsTime  = time ([&] { scanner.measureLevels (0, length, levels, 2, true); });
+
+            logMessage ("Scanning 60s of stereo: AudioFormatReader " + String (readerTime, 1) + " ms, AudioLevelScanner "
+                          + String (scannerTime, 1) + " ms, with RMS and true peak " + String (levelsTime, 1) + " ms");
+        }
+    }
+
+private:
+    static MemoryBlock createWavData (const AudioBuffer<float>& buffer, int bitsPerSample)
+    {
+        MemoryBlock data;
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (new MemoryOutputStream (data, false), 44100.0,
+                                                                        (unsigned int) buffer.getNumChannels(),
+                                                                        bitsPerSample, {}, 0));
+        writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+        return data;
+    }
+
+    // The scanner only needs a way of making readers, so most of these tests just give
+    // it readers of an in-memory WAV rather than going via a file
+    static AudioLevelScanner::ReaderFactory createWavReaderFactory (const AudioBuffer<float>& buffer, int bitsPerSample)
+    {
+        auto data = std::make_shared<MemoryBlock> (createWavData (buffer, bitsPerSample));
+
+        return [data]() -> AudioFormatReader*
+        {
+            return WavAudioFormat().createReaderFor (new MemoryInputStream (*data, false), true);
+        };
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (AudioLevelScannerTests)
+};
+
+static const AudioLevelScannerTests audioLevelScannerTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Measures the levels of an audio source, using a pool of threads to scan several
+    sections of it at once.
+
+    This does the same jobs as AudioFormatReader::readMaxLevels() and
+    AudioFormatReader::searchForLevel(), but the range to be scanned is split into
+    chunks, which are read by several readers in parallel. measureLevels() also finds
+    the RMS and (optionally) the true-peak level of each channel in the same pass.
+
+    The readers are created by a function that you supply, and are kept until the
+    scanner is deleted. Each one is only used by one thread at a time, so the function
+    has to be able to create several independent readers for the same source. For
+    files, createReaderFactory() returns a function that uses memory-mapped readers
+    where the format supports them.
+
+    e.g.
+    @code
+    ThreadPool pool;
+    AudioLevelScanner scanner (AudioLevelScanner::createReaderFactory (formatManager, file), pool);
+
+    HeapBlock<AudioLevelScanner::ChannelLevels> levels (scanner.getNumChannels());
+    scanner.measureLevels (0, scanner.getLengthInSamples(), levels, scanner.getNumChannels(), true);
+    @endcode
+
+    The methods block until the scan has finished, so don't call them from one of the
+    pool's own threads.
+
+    @see AudioFormatReader
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioLevelScanner
+{
+public:
+    //==============================================================================
+    /** A function that creates a new reader for the source. */
+    using ReaderFactory = std::function<AudioFormatReader*()>;
+
+    /** Creates a scanner.
+
+        @param createReader     the function that creates readers for the source. The first
+                                reader is created straight away; the others are created
+                                when they're first needed
+        @param pool             the pool whose threads do the scanning. This must not be
+                                deleted before the scanner
+        @param maxNumReaders    the largest number of readers to use at once, or 0 to use
+                                as many as there are threads in the pool
+    */
+    AudioLevelScanner (ReaderFactory createReader, ThreadPool& pool, int maxNumReaders = 0);
+
+    /** Destructor. */
+    ~AudioLevelScanner();
+
+    /** Returns a function which creates readers for a file.
+        If the file's format supports memory-mapped reading, the readers map the whole
+        file; otherwise they're normal readers created by the AudioFormatManager.
+    */
+    static ReaderFactory createReaderFactory (AudioFormatManager& formatManager, const File& file);
+
+    //==============================================================================
+    /** Returns false if the source couldn't be opened. */
+    bool isValid() const noexcept                   { return readers.size() > 0; }
+
+    /** Returns the number of channels in the source. */
+    int getNumChannels() const noexcept;
+
+    /** Returns the length of the source. */
+    int64 getLengthInSamples() const noexcept;
+
+    /** Sets the number of samples that each thread reads before taking the next chunk.
+        Chunks that are too small mean that the threads spend more time waiting for each
+        other, and chunks that are too large mean that a short range is scanned by fewer
+        threads.
+    */
+    void setSamplesPerChunk (int64 newSamplesPerChunk) noexcept;
+
+    //==============================================================================
+    /** The levels of one channel that are found by measureLevels(). */
+    struct ChannelLevels
+    {
+        /** The lowest and highest sample values. */
+        Range<float> range;
+
+        /** The RMS level of the samples. */
+        float rms = 0;
+
+        /** The true-peak level, if it was measured. This is the highest absolute value
+            of the signal after it has been oversampled by four times, as described by
+            ITU-R BS.1770, so it's never lower than the highest absolute sample value.
+        */
+        float truePeak = 0;
+    };
+
+    /** Measures the levels of each channel in a section of the source.
+
+        @param startSample          the first sample to measure. As with AudioFormatReader,
+                                    any part of the section that's beyond the ends of the
+                                    source is treated as silence
+        @param numSamples           the number of samples to measure
+        @param results              an array of numChannelsToRead objects, to receive the levels
+        @param numChannelsToRead    the number of channels to measure
+        @param measureTruePeak      if true, the true-peak level of each channel is also measured,
+                                    which takes a little longer
+        @returns false if the source couldn't be read
+    */
+    bool measureLevels (int64 startSample, int64 numSamples,
+                        ChannelLevels* results, int numChannelsToRead,
+                        bool measureTruePeak);
+
+    /** Finds the highest and lowest sample levels from a section of the source.
+        @see AudioFormatReader::readMaxLevels
+    */
+    void readMaxLevels (int64 startSample, int64 numSamples,
+                        Range<float>* results, int numChannelsToRead);
+
+    /** Scans the source looking for a sample whose magnitude is in a specified range.
+
+        This returns the same results as AudioFormatReader::searchForLevel(), except that
+        only the part of the range that lies within the source is searched. The range is
+        split into chunks that are searched in parallel, and once a match has been found,
+        any chunks after it are skipped.
+
+        @see AudioFormatReader::searchForLevel
+    */
+    int64 searchForLevel (int64 startSample,
+                          int64 numSamplesToSearch,
+                          double magnitudeRangeMinimum,
+                          double magnitudeRangeMaximum,
+                          int minimumConsecutiveSamples);
+
+private:
+    //==============================================================================
+    struct ChunkLevels;
+    struct ChunkSearch;
+    using ChunkFunction = std::function<void (AudioFormatReader&, int chunkIndex)>;
+
+    ReaderFactory readerFactory;
+    ThreadPool& pool;
+    OwnedArray<AudioFormatReader> readers;
+    int maxNumReaders;
+    int64 samplesPerChunk = 1 << 18;
+
+    CriticalSection scanLock;
+    WaitableEvent jobsFinished;
+    std::atomic<int> nextChunk { 0 }, numJobsRunning { 0 };
+
+    void processChunks (int numChunks, ChunkFunction);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioLevelScanner)
+};
+
+} // namespace juce
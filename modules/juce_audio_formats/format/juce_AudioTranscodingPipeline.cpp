@@ -0,0 +1,964 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+struct AudioTranscodingPipeline::Block
+{
+    AudioBuffer<float> buffer;
+    int numSamples = 0;
+    bool isLast = false;
+};
+
+// The blocks passed between two stages. The stage before takes empty blocks and
+// hands them on full, and the stage after hands them back when it's used them.
+// Each queue only has one reader and one writer, so they don't need a lock.
+struct AudioTranscodingPipeline::BlockQueue
+{
+    BlockQueue (int numBlocks, int numChannels, int numSamples)
+        : emptyFifo (numBlocks + 1), fullFifo (numBlocks + 1),
+          emptyBlocks ((size_t) numBlocks + 1), fullBlocks ((size_t) numBlocks + 1)
+    {
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            auto* b = blocks.add (new Block());
+            b->buffer.setSize (numChannels, numSamples);
+            push (emptyFifo, emptyBlocks, b);
+        }
+    }
+
+    Block* getEmptyBlock() noexcept         { return pop (emptyFifo, emptyBlocks); }
+    void addFullBlock (Block* b) noexcept   { push (fullFifo, fullBlocks, b); }
+    Block* getFullBlock() noexcept          { return pop (fullFifo, fullBlocks); }
+    void returnBlock (Block* b) noexcept    { push (emptyFifo, emptyBlocks, b); }
+
+private:
+    OwnedArray<Block> blocks;
+    AbstractFifo emptyFifo, fullFifo;
+    HeapBlock<Block*> emptyBlocks, fullBlocks;
+
+    static void push (AbstractFifo& fifo, Block** items, Block* b) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (1, start1, size1, start2, size2);
+        jassert (size1 == 1); // there should always be room for all the blocks!
+        items[start1] = b;
+        fifo.finishedWrite (1);
+    }
+
+    static Block* pop (AbstractFifo& fifo, Block** items) noexcept
+    {
+        int start1, size1, start2, size2;
+        fifo.prepareToRead (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+            return nullptr;
+
+        auto* b = items[start1];
+        fifo.finishedRead (1);
+        return b;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BlockQueue)
+};
+
+//==============================================================================
+struct AudioTranscodingPipeline::Transcode
+{
+    Transcode (AudioTranscodingPipeline& p, const Task& t)
+        : pipeline (p), task (t), kernel (WindowedSincKernel::forRatio (1.0))
+    {}
+
+    enum class StepResult { progressed, waitingForInput, waitingForOutput, finished };
+
+    ThreadPoolJob::JobStatus runStage (Stage stage, ThreadPoolJob& job)
+    {
+        auto& counters = pipeline.counters[stage];
+        auto startTime = Time::getHighResolutionTicks();
+        auto result = StepResult::progressed;
+        bool madeProgress = false;
+
+        for (;;)
+        {
+            if (job.shouldExit())
+                fail ("Cancelled");
+
+            if (hasFailed)
+            {
+                result = StepResult::finished;
+                break;
+            }
+
+            result = stage == decoding   ? decodeNextBlock()
+                   : stage == converting ? convertNextBlock()
+                                         : encodeNextBlock();
+
+            if (result != StepResult::progressed)
+                break;
+
+            madeProgress = true;
+            wakeUp.signal();
+        }
+
+        auto endTime = Time::getHighResolutionTicks();
+        counters.busyTicks += endTime - startTime;
+
+        if (result == StepResult::finished)
+        {
+            wakeUp.signal();
+            return ThreadPoolJob::jobHasFinished;
+        }
+
+        // Rather than going straight back into the thread pool's queue and spinning, a
+        // stage that couldn't do anything waits briefly for another stage to move a block.
+        if (! madeProgress)
+        {
+            wakeUp.wait (1);
+            (result == StepResult::waitingForInput ? counters.inputWaitTicks
+                                                   : counters.outputWaitTicks) += Time::getHighResolutionTicks() - endTime;
+        }
+
+        return ThreadPoolJob::jobNeedsRunningAgain;
+    }
+
+    // returns true when all the stages have finished
+    bool stageFinished() noexcept
+    {
+        return --numStagesRunning == 0;
+    }
+
+    Result finish()
+    {
+        writer.reset();
+        reader.reset();
+
+        if (hasFailed)
+        {
+            task.destinationFile.deleteFile();
+            return Result::fail (errorMessage);
+        }
+
+        return Result::ok();
+    }
+
+    void fail (const String& message)
+    {
+        const SpinLock::ScopedLockType sl (errorLock);
+
+        if (! hasFailed)
+        {
+            errorMessage = message;
+            hasFailed = true;
+        }
+    }
+
+    AudioTranscodingPipeline& pipeline;
+    Task task;
+
+private:
+    std::unique_ptr<AudioFormatReader> reader;
+    std::unique_ptr<AudioFormatWriter> writer;
+    std::unique_ptr<BlockQueue> decodedBlocks, convertedBlocks;
+    std::atomic<bool> isPrepared { false }, hasFailed { false };
+    std::atomic<int> numStagesRunning { numStages };
+    WaitableEvent wakeUp;
+    SpinLock errorLock;
+    String errorMessage;
+
+    int numSourceChannels = 0, numDestChannels = 0;
+    int64 readPosition = 0, numSourceSamples = 0;
+
+    // resampling state, used by the conversion stage
+    bool needsResampling = false;
+    double ratio = 1.0, position = 0;
+    AudioBuffer<float> resamplerInput;
+    int numResamplerInputSamples = 0;
+    bool inputFinished = false;
+    int64 numOutputSamplesDone = 0, numOutputSamples = 0;
+    WindowedSincKernel kernel;
+    Block* outputBlock = nullptr;
+
+    //==============================================================================
+    bool prepare()
+    {
+        reader.reset (pipeline.formatManager.createReaderFor (task.sourceFile));
+
+        if (reader == nullptr)
+        {
+            fail ("Couldn't open " + task.sourceFile.getFullPathName());
+            return false;
+        }
+
+        auto* format = task.destinationFormat != nullptr
+                          ? task.destinationFormat
+                          : pipeline.formatManager.findFormatForFileExtension (task.destinationFile.getFileExtension());
+
+        if (format == nullptr)
+        {
+            fail ("No format to write " + task.destinationFile.getFullPathName());
+            return false;
+        }
+
+        numSourceChannels = (int) reader->numChannels;
+        numDestChannels = task.numChannels > 0 ? task.numChannels : numSourceChannels;
+        numSourceSamples = jmax ((int64) 0, reader->lengthInSamples);
+
+        auto sampleRate = task.sampleRate > 0 ? task.sampleRate : reader->sampleRate;
+        auto bitsPerSample = task.bitsPerSample;
+
+        if (bitsPerSample <= 0)
+        {
+            auto possibleDepths = format->getPossibleBitDepths();
+            bitsPerSample = possibleDepths.contains ((int) reader->bitsPerSample) ? (int) reader->bitsPerSample
+                                                                                  : possibleDepths.getLast();
+        }
+
+        task.destinationFile.deleteFile();
+        task.destinationFile.getParentDirectory().createDirectory();
+        std::unique_ptr<FileOutputStream> out (task.destinationFile.createOutputStream());
+
+        if (out == nullptr)
+        {
+            fail ("Couldn't create " + task.destinationFile.getFullPathName());
+            return false;
+        }
+
+        writer.reset (format->createWriterFor (out.get(), sampleRate, (unsigned int) numDestChannels,
+                                               bitsPerSample, task.metadataValues, task.qualityOptionIndex));
+
+        if (writer == nullptr)
+        {
+            out.reset();
+            fail ("Can't write " + format->getFormatName() + " at " + String (sampleRate) + " Hz, "
+                    + String (bitsPerSample) + " bits, with " + String (numDestChannels) + " channels");
+            return false;
+        }
+
+        out.release();
+
+        needsResampling = sampleRate != reader->sampleRate;
+        numOutputSamples = numSourceSamples;
+
+        if (needsResampling)
+        {
+            ratio = reader->sampleRate / sampleRate;
+            kernel = WindowedSincKernel::forRatio (ratio);
+            numOutputSamples = (int64) std::llround ((double) numSourceSamples / ratio);
+
+            resamplerInput.setSize (numDestChannels, pipeline.samplesPerBlock
+                                                      + 2 * (WindowedSincKernel::numTaps + (int) std::ceil (ratio)) + 4);
+            resamplerInput.clear();
+            numResamplerInputSamples = WindowedSincKernel::numBefore;
+            position = WindowedSincKernel::numBefore;
+        }
+
+        decodedBlocks.reset (new BlockQueue (pipeline.blocksPerQueue, numSourceChannels, pipeline.samplesPerBlock));
+        convertedBlocks.reset (new BlockQueue (pipeline.blocksPerQueue, numDestChannels, pipeline.samplesPerBlock));
+        isPrepared = true;
+        return true;
+    }
+
+    //==============================================================================
+    StepResult decodeNextBlock()
+    {
+        if (! isPrepared)
+            return prepare() ? StepResult::progressed : StepResult::finished;
+
+        if (readPosition > numSourceSamples)
+            return StepResult::finished;
+
+        auto* block = decodedBlocks->getEmptyBlock();
+
+        if (block == nullptr)
+            return StepResult::waitingForOutput;
+
+        auto numSamples = (int) jmin ((int64) pipeline.samplesPerBlock, numSourceSamples - readPosition);
+
+        if (numSamples > 0)
+            reader->read (&block->buffer, 0, numSamples, readPosition, true, true);
+
+        block->numSamples = numSamples;
+        readPosition += numSamples;
+        block->isLast = readPosition >= numSourceSamples;
+
+        // this moves the read position past the end, so that the next step finishes
+        if (block->isLast)
+            ++readPosition;
+
+        decodedBlocks->addFullBlock (block);
+        pipeline.counters[decoding].numSamples += numSamples;
+        return StepResult::progressed;
+    }
+
+    //==============================================================================
+    StepResult convertNextBlock()
+    {
+        if (! isPrepared)
+            return StepResult::waitingForInput;
+
+        if (outputBlock == nullptr)
+        {
+            if (numOutputSamplesDone > numOutputSamples)
+            {
+                if (inputFinished)
+                    return StepResult::finished;
+
+                // the decoder may still be waiting to hand over the last few blocks
+                auto* in = decodedBlocks->getFullBlock();
+
+                if (in == nullptr)
+                    return StepResult::waitingForInput;
+
+                inputFinished = in->isLast;
+                decodedBlocks->returnBlock (in);
+                return StepResult::progressed;
+            }
+
+            outputBlock = convertedBlocks->getEmptyBlock();
+
+            if (outputBlock == nullptr)
+                return StepResult::waitingForOutput;
+
+            outputBlock->numSamples = 0;
+            outputBlock->isLast = false;
+        }
+
+        if (! needsResampling)
+        {
+            auto* in = decodedBlocks->getFullBlock();
+
+            if (in == nullptr)
+                return StepResult::waitingForInput;
+
+            mapChannels (in->buffer, 0, outputBlock->buffer, 0, in->numSamples);
+            outputBlock->numSamples = in->numSamples;
+            outputBlock->isLast = in->isLast;
+            inputFinished = in->isLast;
+            numOutputSamplesDone += in->numSamples;
+
+            decodedBlocks->returnBlock (in);
+            sendOutputBlock();
+            return StepResult::progressed;
+        }
+
+        resample();
+
+        if (outputBlock->numSamples == pipeline.samplesPerBlock
+             || numOutputSamplesDone >= numOutputSamples)
+        {
+            sendOutputBlock();
+            return StepResult::progressed;
+        }
+
+        if (inputFinished)
+        {
+            // there's no more input to fill the block, so finish with what we've got
+            numOutputSamples = numOutputSamplesDone;
+            sendOutputBlock();
+            return StepResult::progressed;
+        }
+
+        auto* in = decodedBlocks->getFullBlock();
+
+        if (in == nullptr)
+            return StepResult::waitingForInput;
+
+        // discard the input that's no longer needed, before adding the new block
+        auto numToDiscard = jlimit (0, numResamplerInputSamples, (int) position - WindowedSincKernel::numBefore);
+
+        if (numToDiscard > 0)
+        {
+            auto numToKeep = numResamplerInputSamples - numToDiscard;
+
+            for (int i = 0; i < numDestChannels; ++i)
+            {
+                auto* data = resamplerInput.getWritePointer (i);
+                memmove (data, data + numToDiscard, (size_t) numToKeep * sizeof (float));
+            }
+
+            numResamplerInputSamples = numToKeep;
+            position -= numToDiscard;
+        }
+
+        mapChannels (in->buffer, 0, resamplerInput, numResamplerInputSamples, in->numSamples);
+        numResamplerInputSamples += in->numSamples;
+
+        if (in->isLast)
+        {
+            // pad the end with silence, so that the last samples can be interpolated
+            auto numToPad = WindowedSincKernel::numAfter + 2 + (int) std::ceil (ratio);
+            resamplerInput.clear (numResamplerInputSamples, numToPad);
+            numResamplerInputSamples += numToPad;
+            inputFinished = true;
+        }
+
+        decodedBlocks->returnBlock (in);
+        return StepResult::progressed;
+    }
+
+    void resample() noexcept
+    {
+        auto numDone = outputBlock->numSamples;
+
+        while (numDone < pipeline.samplesPerBlock && numOutputSamplesDone < numOutputSamples)
+        {
+            auto index = (int) position;
+
+            if (index + WindowedSincKernel::numAfter >= numResamplerInputSamples)
+                break;
+
+            auto alpha = (float) (position - index);
+
+            for (int i = 0; i < numDestChannels; ++i)
+                outputBlock->buffer.setSample (i, numDone, kernel.interpolate (resamplerInput.getReadPointer (i, index), alpha));
+
+            position += ratio;
+            ++numDone;
+            ++numOutputSamplesDone;
+        }
+
+        outputBlock->numSamples = numDone;
+    }
+
+    void sendOutputBlock() noexcept
+    {
+        if (numOutputSamplesDone >= numOutputSamples)
+        {
+            outputBlock->isLast = true;
+            ++numOutputSamplesDone; // so that the next step finishes
+        }
+
+        pipeline.counters[converting].numSamples += outputBlock->numSamples;
+        convertedBlocks->addFullBlock (outputBlock);
+        outputBlock = nullptr;
+    }
+
+    void mapChannels (const AudioBuffer<float>& source, int sourceStart,
+                      AudioBuffer<float>& dest, int destStart, int numSamples) noexcept
+    {
+        if (numSamples <= 0)
+            return;
+
+        if (numSourceChannels == 1)
+        {
+            for (int i = 0; i < numDestChannels; ++i)
+                dest.copyFrom (i, destStart, source, 0, sourceStart, numSamples);
+        }
+        else if (numDestChannels == 1)
+        {
+            auto gain = 1.0f / (float) numSourceChannels;
+            dest.copyFrom (0, destStart, source.getReadPointer (0, sourceStart), numSamples, gain);
+
+            for (int i = 1; i < numSourceChannels; ++i)
+                dest.addFrom (0, destStart, source, i, sourceStart, numSamples, gain);
+        }
+        else
+        {
+            for (int i = 0; i < numDestChannels; ++i)
+            {
+                if (i < numSourceChannels)
+                    dest.copyFrom (i, destStart, source, i, sourceStart, numSamples);
+                else
+                    dest.clear (i, destStart, numSamples);
+            }
+        }
+    }
+
+    //==============================================================================
+    StepResult encodeNextBlock()
+    {
+        if (! isPrepared)
+            return StepResult::waitingForInput;
+
+        if (writer == nullptr)
+            return StepResult::finished;
+
+        auto* block = convertedBlocks->getFullBlock();
+
+        if (block == nullptr)
+            return StepResult::waitingForInput;
+
+        if (block->numSamples > 0 && ! writer->writeFromAudioSampleBuffer (block->buffer, 0, block->numSamples))
+        {
+            fail ("Couldn't write to " + task.destinationFile.getFullPathName());
+            return StepResult::finished;
+        }
+
+        pipeline.counters[encoding].numSamples += block->numSamples;
+        auto isLast = block->isLast;
+        convertedBlocks->returnBlock (block);
+
+        if (isLast)
+        {
+            writer.reset(); // this flushes the file
+            return StepResult::finished;
+        }
+
+        return StepResult::progressed;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Transcode)
+};
+
+//==============================================================================
+struct AudioTranscodingPipeline::StageJob  : public ThreadPoolJob
+{
+    StageJob (Transcode& t, Stage s)
+        : ThreadPoolJob ("Transcoding " + t.task.sourceFile.getFileName()),
+          transcode (t), pipeline (t.pipeline), stage (s)
+    {}
+
+    JobStatus runJob() override
+    {
+        auto status = transcode.runStage (stage, *this);
+
+        // once this stage has said it's finished, the transcode may be deleted by another stage
+        if (status == jobHasFinished && transcode.stageFinished())
+            pipeline.transcodeFinished (transcode);
+
+        return status;
+    }
+
+    Transcode& transcode;
+    AudioTranscodingPipeline& pipeline;
+    const Stage stage;
+
+    JUCE_DECLARE_NON_COPYABLE (StageJob)
+};
+
+//==============================================================================
+AudioTranscodingPipeline::AudioTranscodingPipeline (AudioFormatManager& fm, int numThreads, int maxFiles,
+                                                    int blockSize, int numBlocks)
+    : formatManager (fm),
+      maxFilesInProgress (maxFiles > 0 ? maxFiles : jmax (1, numThreads)),
+      samplesPerBlock (jmax (64, blockSize)),
+      blocksPerQueue (jmax (1, numBlocks)),
+      pool (jmax (1, numThreads))
+{
+    WindowedSincKernel::prepareTables();
+}
+
+AudioTranscodingPipeline::~AudioTranscodingPipeline()
+{
+    cancel();
+}
+
+void AudioTranscodingPipeline::addTask (const Task& task)
+{
+    {
+        const ScopedLock sl (lock);
+        pendingTasks.add (task);
+    }
+
+    startNextTasks();
+}
+
+void AudioTranscodingPipeline::startNextTasks()
+{
+    const ScopedLock sl (lock);
+
+    while (activeTranscodes.size() < maxFilesInProgress && ! pendingTasks.isEmpty())
+    {
+        auto* t = activeTranscodes.add (new Transcode (*this, pendingTasks.removeAndReturn (0)));
+
+        for (int stage = 0; stage < numStages; ++stage)
+            pool.addJob (new StageJob (*t, (Stage) stage), true);
+    }
+}
+
+void AudioTranscodingPipeline::transcodeFinished (Transcode& t)
+{
+    auto result = t.finish();
+    auto task = t.task;
+
+    {
+        const ScopedLock sl (lock);
+        activeTranscodes.removeObject (&t);
+    }
+
+    ++(result.wasOk() ? numSucceeded : numFailed);
+    startNextTasks();
+
+    if (onTaskFinished != nullptr)
+        onTaskFinished (task, result);
+
+    taskFinishedEvent.signal();
+}
+
+bool AudioTranscodingPipeline::waitForCompletion (int timeoutMilliseconds)
+{
+    auto endTime = Time::getMillisecondCounter() + (uint32) timeoutMilliseconds;
+
+    for (;;)
+    {
+        {
+            const ScopedLock sl (lock);
+
+            if (pendingTasks.isEmpty() && activeTranscodes.isEmpty())
+                return true;
+        }
+
+        auto timeToWait = 100;
+
+        if (timeoutMilliseconds >= 0)
+        {
+            auto now = Time::getMillisecondCounter();
+
+            if (now >= endTime)
+                return false;
+
+            timeToWait = jmin (timeToWait, (int) (endTime - now));
+        }
+
+        taskFinishedEvent.wait (timeToWait);
+    }
+}
+
+void AudioTranscodingPipeline::cancel()
+{
+    {
+        const ScopedLock sl (lock);
+        pendingTasks.clear();
+    }
+
+    pool.removeAllJobs (true, -1);
+
+    // Any transcodes that are left had jobs which were removed before they could finish.
+    OwnedArray<Transcode> abandoned;
+
+    {
+        const ScopedLock sl (lock);
+        abandoned.swapWith (activeTranscodes);
+    }
+
+    for (auto* t : abandoned)
+    {
+        t->fail ("Cancelled");
+        auto result = t->finish();
+        ++numFailed;
+
+        if (onTaskFinished != nullptr)
+            onTaskFinished (t->task, result);
+    }
+
+    taskFinishedEvent.signal();
+}
+
+//==============================================================================
+AudioTranscodingPipeline::Metrics AudioTranscodingPipeline::getMetrics() const
+{
+    Metrics m;
+    auto tickLength = 1.0 / (double) Time::getHighResolutionTicksPerSecond();
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        auto& c = counters[i];
+        auto& s = (i == decoding ? m.decoding : (i == converting ? m.converting : m.encoding));
+
+        s.numSamples = c.numSamples;
+        s.busySeconds = (double) c.busyTicks * tickLength;
+        s.secondsWaitingForInput = (double) c.inputWaitTicks * tickLength;
+        s.secondsWaitingForOutput = (double) c.outputWaitTicks * tickLength;
+    }
+
+    {
+        const ScopedLock sl (lock);
+        m.numTasksPending = pendingTasks.size();
+        m.numTasksInProgress = activeTranscodes.size();
+    }
+
+    m.numTasksSucceeded = numSucceeded;
+    m.numTasksFailed = numFailed;
+    return m;
+}
+
+void AudioTranscodingPipeline::resetMetrics()
+{
+    for (auto& c : counters)
+        c.numSamples = c.busyTicks = c.inputWaitTicks = c.outputWaitTicks = 0;
+
+    numSucceeded = 0;
+    numFailed = 0;
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct AudioTranscodingPipelineTests  : public UnitTest
+{
+    AudioTranscodingPipelineTests()
+        : UnitTest ("AudioTranscodingPipeline", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        AudioFormatManager formatManager;
+        formatManager.registerBasicFormats();
+
+        auto dir = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("TranscodingTests", {}, false);
+        dir.createDirectory();
+
+        beginTest ("Converting a batch of files");
+        {
+            struct Source { double rate; int channels, length; };
+            const Source sources[] = { { 44100.0, 2, 44100 }, { 48000.0, 1, 30000 }, { 22050.0, 3, 20001 },
+                                       { 48000.0, 2, 50000 }, { 96000.0, 2, 70000 }, { 44100.0, 1, 1 },
+                                       { 32000.0, 2, 0 },     { 8000.0, 1, 12345 } };
+
+            AudioTranscodingPipeline pipeline (formatManager, 4, 0, 1024, 2);
+            std::atomic<int> numSucceeded { 0 };
+            pipeline.onTaskFinished = [&] (const Task&, const Result& r) { if (r.wasOk()) ++numSucceeded; };
+
+            for (int i = 0; i < numElementsInArray (sources); ++i)
+            {
+                Task task;
+                task.sourceFile = dir.getChildFile ("source" + String (i) + ".wav");
+                task.destinationFile = dir.getChildFile ("dest" + String (i) + getDestinationExtension (i));
+                task.sampleRate = 48000.0;
+                task.numChannels = 2;
+                task.bitsPerSample = 24;
+
+                writeSineFile (task.sourceFile, sources[i].rate, sources[i].channels, sources[i].length);
+                pipeline.addTask (task);
+            }
+
+            expect (pipeline.waitForCompletion (30000));
+            expectEquals (numSucceeded.load(), numElementsInArray (sources));
+
+            for (int i = 0; i < numElementsInArray (sources); ++i)
+            {
+                std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (dir.getChildFile ("dest" + String (i) + getDestinationExtension (i))));
+                expect (reader != nullptr);
+
+                auto& source = sources[i];
+                expectEquals (reader->sampleRate, 48000.0);
+                expectEquals ((int) reader->numChannels, 2);
+                expectEquals ((int) reader->bitsPerSample, 24);
+                expectEquals (reader->lengthInSamples, (int64) std::llround (source.length * 48000.0 / source.rate));
+
+                AudioBuffer<float> buffer (2, (int) reader->lengthInSamples);
+                reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+
+                // away from the ends, the output should match the same sine waves sampled at 48kHz
+                auto edge = source.rate == 48000.0 ? 0 : 64;
+                float maxError = 0;
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int n = edge; n < buffer.getNumSamples() - edge; ++n)
+                        maxError = jmax (maxError, std::abs (buffer.getSample (ch, n)
+                                                              - getSineSample (source.channels == 1 ? 0 : ch, n / 48000.0)));
+
+                expectLessThan (maxError, source.rate == 48000.0 ? 0.0001f : 0.005f);
+            }
+        }
+
+        beginTest ("Failures");
+        {
+            AudioTranscodingPipeline pipeline (formatManager, 2);
+            CriticalSection resultsLock;
+            StringArray failedFiles;
+
+            pipeline.onTaskFinished = [&] (const Task& t, const Result& r)
+            {
+                const ScopedLock sl (resultsLock);
+
+                if (r.failed())
+                    failedFiles.add (t.sourceFile.getFileName());
+            };
+
+            Task missing;
+            missing.sourceFile = dir.getChildFile ("missing.wav");
+            missing.destinationFile = dir.getChildFile ("missing_out.wav");
+            pipeline.addTask (missing);
+
+            Task badRate;
+            badRate.sourceFile = dir.getChildFile ("source0.wav");
+            badRate.destinationFile = dir.getChildFile ("bad_rate_out.wav");
+            badRate.bitsPerSample = 13;
+            pipeline.addTask (badRate);
+
+            Task good;
+            good.sourceFile = dir.getChildFile ("source1.wav");
+            good.destinationFile = dir.getChildFile ("good_out.wav");
+            pipeline.addTask (good);
+
+            expect (pipeline.waitForCompletion (30000));
+            expectEquals (failedFiles.size(), 2);
+            expect (failedFiles.contains ("missing.wav") && failedFiles.contains ("source0.wav"));
+            expect (! dir.getChildFile ("missing_out.wav").exists());
+            expect (! dir.getChildFile ("bad_rate_out.wav").exists());
+            expect (dir.getChildFile ("good_out.wav").existsAsFile());
+
+            auto metrics = pipeline.getMetrics();
+            expectEquals (metrics.numTasksSucceeded, 1);
+            expectEquals (metrics.numTasksFailed, 2);
+        }
+
+        beginTest ("Back-pressure");
+        {
+            // a single thread and single-block queues mean that the stages have to keep
+            // handing over to each other
+            AudioTranscodingPipeline pipeline (formatManager, 1, 3, 256, 1);
+            int64 totalSamples = 0;
+
+            for (int i = 0; i < 5; ++i)
+            {
+                Task task;
+                task.sourceFile = dir.getChildFile ("source" + String (i) + ".wav");
+                task.destinationFile = dir.getChildFile ("single_thread" + String (i) + ".wav");
+                pipeline.addTask (task);
+
+                std::unique_ptr<AudioFormatReader> reader (formatManager.createReaderFor (task.sourceFile));
+                totalSamples += reader->lengthInSamples;
+            }
+
+            expect (pipeline.waitForCompletion (30000));
+
+            auto metrics = pipeline.getMetrics();
+            expectEquals (metrics.numTasksSucceeded, 5);
+            expectEquals (metrics.decoding.numSamples, totalSamples);
+            expectEquals (metrics.converting.numSamples, totalSamples);
+            expectEquals (metrics.encoding.numSamples, totalSamples);
+        }
+
+        beginTest ("Cancelling");
+        {
+            writeSineFile (dir.getChildFile ("long.wav"), 44100.0, 2, 44100 * 20);
+
+            std::atomic<int> numFinished { 0 };
+            AudioTranscodingPipeline pipeline (formatManager, 2);
+            pipeline.onTaskFinished = [&] (const Task&, const Result&) { ++numFinished; };
+
+            for (int i = 0; i < 8; ++i)
+            {
+                Task task;
+                task.sourceFile = dir.getChildFile ("long.wav");
+                task.destinationFile = dir.getChildFile ("cancelled" + String (i) + ".wav");
+                task.sampleRate = 48000.0;
+                pipeline.addTask (task);
+            }
+
+            Thread::sleep (20);
+            pipeline.cancel();
+
+            auto metrics = pipeline.getMetrics();
+            expectEquals (metrics.numTasksInProgress, 0);
+            expectEquals (metrics.numTasksPending, 0);
+            expectEquals (numFinished.load(), metrics.numTasksSucceeded + metrics.numTasksFailed);
+
+            for (int i = 0; i < 8; ++i)
+                expect (dir.getChildFile ("cancelled" + String (i) + ".wav").existsAsFile() == (i < metrics.numTasksSucceeded));
+        }
+
+        beginTest ("Throughput");
+        {
+            for (int i = 0; i < 16; ++i)
+                writeSineFile (dir.getChildFile ("bench" + String (i) + ".wav"), 44100.0, 2, 44100 * 10);
+
+            auto runBatch = [&] (int numThreads, int maxFiles)
+            {
+                AudioTranscodingPipeline pipeline (formatManager, numThreads, maxFiles);
+                auto start = Time::getMillisecondCounterHiRes();
+
+                for (int i = 0; i < 16; ++i)
+                {
+                    Task task;
+                    task.sourceFile = dir.getChildFile ("bench" + String (i) + ".wav");
+                    task.destinationFile = dir.getChildFile ("bench_out" + String (i) + getDestinationExtension (1));
+                    task.sampleRate = 48000.0;
+                    pipeline.addTask (task);
+                }
+
+                expect (pipeline.waitForCompletion (120000));
+                auto elapsed = Time::getMillisecondCounterHiRes() - start;
+                auto m = pipeline.getMetrics();
+
+                auto describe = [] (const char* stageName, const StageMetrics& s)
+                {
+                    return String (stageName) + " " + String (s.getSamplesPerSecond() / 1.0e6, 1) + "M samples/s (waiting "
+                             + String (s.secondsWaitingForInput, 2) + "s for input, "
+                             + String (s.secondsWaitingForOutput, 2) + "s for output)";
+                };
+
+                logMessage ("16 x 10s files, " + String (numThreads) + " threads: " + String (roundToInt (elapsed)) + " ms; "
+                              + describe ("decode", m.decoding) + ", " + describe ("convert", m.converting)
+                              + ", " + describe ("encode", m.encoding));
+            };
+
+            runBatch (1, 1);
+            runBatch (jmax (2, SystemStats::getNumCpus()), 0);
+        }
+
+        dir.deleteRecursively();
+    }
+
+private:
+    using Task = AudioTranscodingPipeline::Task;
+    using StageMetrics = AudioTranscodingPipeline::StageMetrics;
+
+    static String getDestinationExtension (int index)
+    {
+       #if JUCE_USE_FLAC
+        if (index % 2 != 0)
+            return ".flac";
+       #endif
+
+        ignoreUnused (index);
+        return ".wav";
+    }
+
+    static float getSineSample (int channel, double time) noexcept
+    {
+        return 0.5f * (float) std::sin (MathConstants<double>::twoPi * (440.0 + 110.0 * channel) * time + channel);
+    }
+
+    void writeSineFile (const File& file, double sampleRate, int numChannels, int numSamples)
+    {
+        AudioBuffer<float> buffer (numChannels, jmax (1, numSamples));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            for (int n = 0; n < numSamples; ++n)
+                buffer.setSample (ch, n, getSineSample (ch, n / sampleRate));
+
+        file.deleteFile();
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (file.createOutputStream(), sampleRate,
+                                                                        (unsigned int) numChannels, 16, {}, 0));
+        expect (writer != nullptr);
+        writer->writeFromAudioSampleBuffer (buffer, 0, numSamples);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (AudioTranscodingPipelineTests)
+};
+
+static const AudioTranscodingPipelineTests audioTranscodingPipelineTests;
+
+#endif
+
+} // namespace juce
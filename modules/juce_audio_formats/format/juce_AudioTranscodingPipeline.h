@@ -0,0 +1,231 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Converts batches of audio files from one format to another, using a pool of
+    threads to work on several files at once.
+
+    Each file is passed through three stages: it's decoded by a reader from the
+    AudioFormatManager, then its sample rate and channel layout are converted, and
+    then it's encoded by the destination format's writer. Each stage runs as a
+    separate ThreadPoolJob, so the stages of one file run in parallel with each
+    other as well as with the stages of other files.
+
+    The stages pass the audio to each other in blocks, through short queues. Each
+    file has a fixed set of blocks, so if a stage gets ahead of the one after it,
+    it has to wait until that stage has finished with a block before it can carry
+    on. This means that the memory used doesn't depend on the length of the files,
+    only on the number of files that are being worked on at once, their numbers of
+    channels, and the block size and queue length that are passed to the constructor.
+    Files beyond the maximum number that can be in progress wait in a list until
+    another file has finished.
+
+    e.g.
+    @code
+    AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    AudioTranscodingPipeline pipeline (formatManager);
+
+    for (auto& file : filesToConvert)
+    {
+        AudioTranscodingPipeline::Task task;
+        task.sourceFile = file;
+        task.destinationFile = file.withFileExtension (".flac");
+        task.sampleRate = 48000.0;
+        task.bitsPerSample = 24;
+        pipeline.addTask (task);
+    }
+
+    pipeline.waitForCompletion();
+    @endcode
+
+    The AudioFormatManager is used from the pipeline's threads, so don't change
+    its list of formats while the pipeline is running.
+
+    @see AudioFormatManager, AudioFormatReader, AudioFormatWriter
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioTranscodingPipeline
+{
+public:
+    //==============================================================================
+    /** Describes a file to be converted. */
+    struct Task
+    {
+        /** The file to read. */
+        File sourceFile;
+
+        /** The file to write. If it already exists, it'll be replaced. */
+        File destinationFile;
+
+        /** The format to write. If this is nullptr, the format manager's format
+            for the destination file's extension is used.
+        */
+        AudioFormat* destinationFormat = nullptr;
+
+        /** The sample rate to write, or 0 to use the source file's rate. */
+        double sampleRate = 0;
+
+        /** The number of channels to write, or 0 to use the source file's channels.
+            A mono source is copied to all the channels, and all the channels of a
+            source are mixed together if the destination is mono. Otherwise channels
+            are copied across in order, and any extra ones are left silent.
+        */
+        int numChannels = 0;
+
+        /** The bit depth to write, or 0 to use the source file's bit depth if the
+            destination format supports it, or otherwise its highest bit depth.
+        */
+        int bitsPerSample = 0;
+
+        /** The quality option to pass to the destination format. */
+        int qualityOptionIndex = 0;
+
+        /** Metadata to pass to the destination format. */
+        StringPairArray metadataValues;
+    };
+
+    //==============================================================================
+    /** Creates a pipeline.
+
+        @param formatManager         the formats to use to read and write files. This must
+                                     not be deleted before the pipeline
+        @param numThreads            the number of threads to run the stages on
+        @param maxFilesInProgress    the number of files that can be worked on at once.
+                                     If this is 0, it's the same as the number of threads
+        @param samplesPerBlock       the number of samples in each block that's passed
+                                     between the stages
+        @param blocksPerQueue        the number of blocks in each of the queues between
+                                     the stages
+    */
+    AudioTranscodingPipeline (AudioFormatManager& formatManager,
+                              int numThreads = SystemStats::getNumCpus(),
+                              int maxFilesInProgress = 0,
+                              int samplesPerBlock = 8192,
+                              int blocksPerQueue = 4);
+
+    /** Destructor. Any tasks that haven't finished are cancelled. */
+    ~AudioTranscodingPipeline();
+
+    //==============================================================================
+    /** Adds a file to be converted. It's started straight away if there's room for it. */
+    void addTask (const Task& task);
+
+    /** Waits until all the tasks have finished, or the timeout expires.
+        Returns true if they've all finished.
+    */
+    bool waitForCompletion (int timeoutMilliseconds = -1);
+
+    /** Stops all the tasks, and removes any that haven't started. The files that were
+        being written are deleted.
+    */
+    void cancel();
+
+    /** This is called when each task finishes, with the result of converting its file.
+        It's called on one of the pipeline's threads, or on the thread that calls
+        cancel() for tasks that are cancelled.
+    */
+    std::function<void (const Task&, const Result&)> onTaskFinished;
+
+    //==============================================================================
+    /** Statistics about one of the stages of the pipeline. */
+    struct StageMetrics
+    {
+        /** The number of sample frames that the stage has produced. */
+        int64 numSamples = 0;
+
+        /** The total time that the stage's jobs have spent working, added up across threads. */
+        double busySeconds = 0;
+
+        /** The total time that the stage's jobs have spent waiting for the stage before
+            it to provide some audio.
+        */
+        double secondsWaitingForInput = 0;
+
+        /** The total time that the stage's jobs have spent waiting for the stage after
+            it to make room for more audio. If a stage spends a lot of time doing this,
+            it's the stage after it that's holding up the pipeline.
+        */
+        double secondsWaitingForOutput = 0;
+
+        /** Returns the number of sample frames that the stage processes per second of work. */
+        double getSamplesPerSecond() const noexcept     { return busySeconds > 0 ? (double) numSamples / busySeconds : 0.0; }
+    };
+
+    /** Statistics about the pipeline. */
+    struct Metrics
+    {
+        StageMetrics decoding, converting, encoding;
+        int numTasksPending = 0, numTasksInProgress = 0;
+        int numTasksSucceeded = 0, numTasksFailed = 0;
+    };
+
+    /** Returns statistics about the work that has been done so far. */
+    Metrics getMetrics() const;
+
+    /** Resets the statistics that getMetrics() returns. */
+    void resetMetrics();
+
+private:
+    //==============================================================================
+    enum Stage { decoding, converting, encoding, numStages };
+
+    struct StageCounters
+    {
+        std::atomic<int64> numSamples { 0 }, busyTicks { 0 }, inputWaitTicks { 0 }, outputWaitTicks { 0 };
+    };
+
+    struct Block;
+    struct BlockQueue;
+    struct Transcode;
+    struct StageJob;
+
+    AudioFormatManager& formatManager;
+    const int maxFilesInProgress, samplesPerBlock, blocksPerQueue;
+
+    StageCounters counters[numStages];
+    std::atomic<int> numSucceeded { 0 }, numFailed { 0 };
+
+    CriticalSection lock;
+    Array<Task> pendingTasks;
+    OwnedArray<Transcode> activeTranscodes;
+    WaitableEvent taskFinishedEvent;
+
+    ThreadPool pool;
+
+    void startNextTasks();
+    void transcodeFinished (Transcode&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioTranscodingPipeline)
+};
+
+} // namespace juce
@@ -38,7 +38,8 @@ namespace juce
 
     Note that before reading samples from a MemoryMappedAudioFormatReader, you must first
     call mapEntireFile() or mapSectionOfFile() to ensure that the region you want to
-    read has been mapped.
+    read has been mapped, unless you've turned on automatic mapping with
+    setSlidingWindowSize().
 
     @see AudioFormat::createMemoryMappedReader, AudioFormatReader
 
@@ -82,6 +83,53 @@ public:
     /** Returns the number of bytes currently being mapped */
     size_t getNumBytesUsed() const                          { return map != nullptr ? map->getSize() : 0; }
 
+    //==============================================================================
+    /** Tells the OS how the samples are going to be read, so that it can decide how far
+        to read ahead when a page of the file is loaded.
+
+        For random access to a large file, randomAccess avoids loading lots of data around
+        each position that's read, which is what the default (sequentialAccess) does.
+        This applies to the current mapping and any that are made later.
+    */
+    void setAccessPattern (MemoryMappedFile::AccessPattern pattern);
+
+    /** Returns the access pattern that was set with setAccessPattern(). */
+    MemoryMappedFile::AccessPattern getAccessPattern() const noexcept   { return accessPattern; }
+
+    /** Asks the OS to start loading a range of samples in the background, so that they're
+        already in memory when they're read. Only the part of the range that's currently
+        mapped is affected.
+    */
+    void prefetchSamples (Range<int64> samples) noexcept;
+
+    /** Turns on automatic mapping, which lets you read from files that are too big to map
+        in one go.
+
+        When this is enabled, reading samples that aren't in the mapped section will replace
+        the mapping with one of around maxBytesToMap bytes that contains them, so you don't
+        need to call mapSectionOfFile() yourself. With sequentialAccess the new window starts
+        at the samples being read, and the OS is asked to load it in the background; otherwise
+        it's centred on them. A single read that's bigger than the window is mapped on its own.
+
+        Pass 0 to turn automatic mapping off again.
+    */
+    void setSlidingWindowSize (int64 maxBytesToMap);
+
+    /** Returns the window size set by setSlidingWindowSize(), or 0 if it's not enabled. */
+    int64 getSlidingWindowSize() const noexcept             { return slidingWindowBytes; }
+
+    /** Returns a pointer to the mapped data for a range of samples, if they're 32-bit floats
+        in the CPU's native byte order, so that they can be used without being copied or
+        converted.
+
+        The samples are interleaved, so the sample for channel c at position startSample + i
+        is at index (i * numChannels + c). The pointer is only valid until the mapping changes.
+
+        If the file isn't in that format, or the samples aren't mapped (and can't be mapped
+        automatically), or the data isn't aligned for float access, this returns nullptr.
+    */
+    const float* getInterleavedFloatData (Range<int64> samples);
+
 protected:
     File file;
     Range<int64> mappedSection;
@@ -89,6 +137,15 @@ protected:
     int64 dataChunkStart, dataLength;
     int bytesPerFrame;
 
+    /** Subclasses whose sample data is big-endian should set this to true. */
+    bool dataIsBigEndian = false;
+
+    /** Checks that a range of samples is mapped. If it isn't, and automatic mapping has been
+        turned on with setSlidingWindowSize(), this will map a new window that contains them.
+        Subclasses should call this before reading from the mapped memory.
+    */
+    bool ensureSamplesAreMapped (Range<int64> samples) const;
+
     /** Converts a sample index to a byte position in the file. */
     inline int64 sampleToFilePos (int64 sample) const noexcept       { return dataChunkStart + sample * bytesPerFrame; }
 
@@ -108,6 +165,10 @@ protected:
                 .findMinAndMax ((size_t) numSamples);
     }
 
+private:
+    MemoryMappedFile::AccessPattern accessPattern = MemoryMappedFile::sequentialAccess;
+    int64 slidingWindowBytes = 0;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedAudioFormatReader)
 };
 
@@ -74,6 +74,16 @@
  #define JUCE_USE_OGGVORBIS 1
 #endif
 
+/** Config: JUCE_USE_OPUS
+    Enables the OpusAudioFormat class.
+    The Opus codec isn't included with JUCE, so if you enable this, you'll need to add the
+    libopus headers to your header search paths and link to libopus. It also needs
+    JUCE_USE_OGGVORBIS, which provides the Ogg container code.
+*/
+#ifndef JUCE_USE_OPUS
+ #define JUCE_USE_OPUS 0
+#endif
+
 /** Config: JUCE_USE_MP3AUDIOFORMAT
     Enables the software-based MP3AudioFormat class.
     IMPORTANT DISCLAIMER: By choosing to enable the JUCE_USE_MP3AUDIOFORMAT flag and to compile
@@ -118,12 +128,16 @@
 #include "format/juce_AudioFormatReaderSource.h"
 #include "format/juce_AudioSubsectionReader.h"
 #include "format/juce_BufferingAudioFormatReader.h"
+#include "format/juce_AudioTranscodingPipeline.h"
+#include "format/juce_AudioLevelScanner.h"
 #include "codecs/juce_AiffAudioFormat.h"
 #include "codecs/juce_CoreAudioFormat.h"
 #include "codecs/juce_FlacAudioFormat.h"
 #include "codecs/juce_LAMEEncoderAudioFormat.h"
 #include "codecs/juce_MP3AudioFormat.h"
 #include "codecs/juce_OggVorbisAudioFormat.h"
+#include "codecs/juce_OpusAudioFormat.h"
 #include "codecs/juce_WavAudioFormat.h"
 #include "codecs/juce_WindowsMediaAudioFormat.h"
 #include "sampler/juce_Sampler.h"
+#include "sampler/juce_StreamingSampler.h"
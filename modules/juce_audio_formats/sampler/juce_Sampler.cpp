@@ -67,6 +67,66 @@ bool SamplerSound::appliesToChannel (int /*midiChannel*/)
     return true;
 }
 
+//==============================================================================
+namespace SamplerInterpolators
+{
+    struct Linear
+    {
+        static constexpr int numBefore = 0, numAfter = 1;
+
+        float operator() (const float* in, float alpha) const noexcept
+        {
+            return in[0] * (1.0f - alpha) + in[1] * alpha;
+        }
+    };
+
+    struct Cubic
+    {
+        static constexpr int numBefore = 1, numAfter = 2;
+
+        float operator() (const float* in, float alpha) const noexcept
+        {
+            auto y0 = in[-1], y1 = in[0], y2 = in[1], y3 = in[2];
+
+            auto c1 = 0.5f * (y2 - y0);
+            auto c2 = y0 - 2.5f * y1 + 2.0f * y2 - 0.5f * y3;
+            auto c3 = 0.5f * (y3 - y0) + 1.5f * (y1 - y2);
+
+            return ((c3 * alpha + c2) * alpha + c1) * alpha + y1;
+        }
+    };
+
+    struct Sinc
+    {
+        static constexpr int numBefore = WindowedSincKernel::numBefore, numAfter = WindowedSincKernel::numAfter;
+
+        Sinc (double ratio) noexcept  : kernel (WindowedSincKernel::forRatio (ratio)) {}
+
+        float operator() (const float* in, float alpha) const noexcept
+        {
+            return kernel.interpolate (in, alpha);
+        }
+
+        WindowedSincKernel kernel;
+    };
+
+    // Handles positions near the ends of the sample, where some of the points that
+    // the interpolator needs lie outside the data
+    template <typename Interpolator>
+    static float interpolateAtEdge (const Interpolator& interpolator, const float* in, int size, int pos, float alpha) noexcept
+    {
+        float points[Interpolator::numBefore + Interpolator::numAfter + 1];
+
+        for (int i = 0; i < numElementsInArray (points); ++i)
+        {
+            auto index = pos - Interpolator::numBefore + i;
+            points[i] = isPositiveAndBelow (index, size) ? in[index] : 0.0f;
+        }
+
+        return interpolator (points + Interpolator::numBefore, alpha);
+    }
+}
+
 //==============================================================================
 SamplerVoice::SamplerVoice() {}
 SamplerVoice::~SamplerVoice() {}
@@ -76,13 +136,19 @@ bool SamplerVoice::canPlaySound (SynthesiserSound* sound)
     return dynamic_cast<const SamplerSound*> (sound) != nullptr;
 }
 
-void SamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSound* s, int /*currentPitchWheelPosition*/)
+void SamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSound* s, int currentPitchWheelPosition)
 {
     if (auto* sound = dynamic_cast<const SamplerSound*> (s))
     {
-        pitchRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
+        noteRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
                         * sound->sourceSampleRate / getSampleRate();
 
+        pitchWheelPosition = currentPitchWheelPosition;
+        smoothedPitchRatio.reset (getSampleRate(), glideTime);
+        updatePitchRatio();
+        smoothedPitchRatio.setCurrentAndTargetValue (smoothedPitchRatio.getTargetValue());
+        pitchRatio = smoothedPitchRatio.getTargetValue();
+
         sourceSamplePosition = 0.0;
         lgain = velocity;
         rgain = velocity;
@@ -111,56 +177,720 @@ void SamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
     }
 }
 
-void SamplerVoice::pitchWheelMoved (int /*newValue*/) {}
+void SamplerVoice::pitchWheelMoved (int newValue)
+{
+    pitchWheelPosition = newValue;
+    updatePitchRatio();
+}
+
 void SamplerVoice::controllerMoved (int /*controllerNumber*/, int /*newValue*/) {}
 
+//==============================================================================
+void SamplerVoice::setInterpolation (Interpolation newInterpolation)
+{
+    // builds the tables now, rather than on the audio thread
+    if (newInterpolation == Interpolation::sinc)
+        WindowedSincKernel::prepareTables();
+
+    interpolation = newInterpolation;
+}
+
+void SamplerVoice::setPitchWheelRange (double semitones) noexcept
+{
+    pitchWheelRange = semitones;
+    updatePitchRatio();
+}
+
+void SamplerVoice::setPitchOffset (double semitones) noexcept
+{
+    pitchOffset = semitones;
+    updatePitchRatio();
+}
+
+void SamplerVoice::setGlideTime (double seconds) noexcept
+{
+    glideTime = jmax (0.0, seconds);
+
+    if (getSampleRate() > 0)
+        smoothedPitchRatio.reset (getSampleRate(), glideTime);
+}
+
+void SamplerVoice::glideToNote (int midiNoteNumber) noexcept
+{
+    if (auto* sound = static_cast<const SamplerSound*> (getCurrentlyPlayingSound().get()))
+    {
+        noteRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
+                        * sound->sourceSampleRate / getSampleRate();
+        updatePitchRatio();
+    }
+}
+
+void SamplerVoice::updatePitchRatio() noexcept
+{
+    auto semitones = pitchOffset + pitchWheelRange * (pitchWheelPosition - 8192) / 8192.0;
+
+    smoothedPitchRatio.setTargetValue (semitones != 0 ? noteRatio * std::pow (2.0, semitones / 12.0)
+                                                      : noteRatio);
+}
+
+bool SamplerVoice::canBeRenderedInBatch() const noexcept
+{
+    return interpolation == Interpolation::linear && ! smoothedPitchRatio.isSmoothing();
+}
+
 //==============================================================================
 void SamplerVoice::renderNextBlock (AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
 {
+    renderBlock (outputBuffer, startSample, numSamples);
+}
+
+void SamplerVoice::renderNextBlock (AudioBuffer<double>& outputBuffer, int startSample, int numSamples)
+{
+    renderBlock (outputBuffer, startSample, numSamples);
+}
+
+template <typename FloatType>
+void SamplerVoice::renderBlock (AudioBuffer<FloatType>& outputBuffer, int startSample, int numSamples)
+{
+    // while the pitch is changing, the ratio is updated at this interval
+    constexpr int pitchUpdateInterval = 32;
+
     if (auto* playingSound = static_cast<SamplerSound*> (getCurrentlyPlayingSound().get()))
     {
-        auto& data = *playingSound->data;
-        const float* const inL = data.getReadPointer (0);
-        const float* const inR = data.getNumChannels() > 1 ? data.getReadPointer (1) : nullptr;
-
-        float* outL = outputBuffer.getWritePointer (0, startSample);
-        float* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+        auto* outL = outputBuffer.getWritePointer (0, startSample);
+        auto* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
 
-        while (--numSamples >= 0)
+        while (numSamples > 0)
         {
-            auto pos = (int) sourceSamplePosition;
-            auto alpha = (float) (sourceSamplePosition - pos);
-            auto invAlpha = 1.0f - alpha;
+            auto numThisTime = numSamples;
+            pitchRatio = smoothedPitchRatio.getCurrentValue();
 
-            // just using a very simple linear interpolation here..
-            float l = (inL[pos] * invAlpha + inL[pos + 1] * alpha);
-            float r = (inR != nullptr) ? (inR[pos] * invAlpha + inR[pos + 1] * alpha)
-                                       : l;
+            if (smoothedPitchRatio.isSmoothing())
+            {
+                numThisTime = jmin (numSamples, pitchUpdateInterval);
+                smoothedPitchRatio.skip (numThisTime);
+            }
 
-            auto envelopeValue = adsr.getNextSample();
+            bool finished = false;
 
-            l *= lgain * envelopeValue;
-            r *= rgain * envelopeValue;
+            switch (interpolation)
+            {
+                case Interpolation::cubic:   finished = renderSection (SamplerInterpolators::Cubic(), *playingSound, outL, outR, numThisTime); break;
+                case Interpolation::sinc:    finished = renderSection (SamplerInterpolators::Sinc (pitchRatio), *playingSound, outL, outR, numThisTime); break;
+                case Interpolation::linear:
+                default:                     finished = renderSection (SamplerInterpolators::Linear(), *playingSound, outL, outR, numThisTime); break;
+            }
 
-            if (outR != nullptr)
+            if (finished)
             {
-                *outL++ += l;
-                *outR++ += r;
+                stopNote (0.0f, false);
+                break;
             }
-            else
+
+            outL += numThisTime;
+
+            if (outR != nullptr)
+                outR += numThisTime;
+
+            numSamples -= numThisTime;
+        }
+    }
+}
+
+template <typename FloatType, typename Interpolator>
+bool SamplerVoice::renderSection (const Interpolator& interpolator, const SamplerSound& sound,
+                                  FloatType* outL, FloatType* outR, int numSamples)
+{
+    auto& data = *sound.data;
+    const float* const inL = data.getReadPointer (0);
+    const float* const inR = data.getNumChannels() > 1 ? data.getReadPointer (1) : nullptr;
+    auto dataSize = data.getNumSamples();
+
+    while (--numSamples >= 0)
+    {
+        auto pos = (int) sourceSamplePosition;
+        auto alpha = (float) (sourceSamplePosition - pos);
+        float l, r;
+
+        if (pos >= Interpolator::numBefore && pos + Interpolator::numAfter < dataSize)
+        {
+            l = interpolator (inL + pos, alpha);
+            r = (inR != nullptr) ? interpolator (inR + pos, alpha) : l;
+        }
+        else
+        {
+            l = SamplerInterpolators::interpolateAtEdge (interpolator, inL, dataSize, pos, alpha);
+            r = (inR != nullptr) ? SamplerInterpolators::interpolateAtEdge (interpolator, inR, dataSize, pos, alpha) : l;
+        }
+
+        auto envelopeValue = adsr.getNextSample();
+
+        l *= lgain * envelopeValue;
+        r *= rgain * envelopeValue;
+
+        if (outR != nullptr)
+        {
+            *outL++ += l;
+            *outR++ += r;
+        }
+        else
+        {
+            *outL++ += (l + r) * 0.5f;
+        }
+
+        sourceSamplePosition += pitchRatio;
+
+        if (sourceSamplePosition > sound.length)
+            return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+int SamplerVoice::getMaximumBatchSize() const
+{
+    return batchSize;
+}
+
+void SamplerVoice::renderBatch (SynthesiserVoice* const* voicesToRender, int numVoices,
+                                AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    renderBatchOfVoices (voicesToRender, numVoices, outputBuffer, startSample, numSamples);
+}
+
+void SamplerVoice::renderBatch (SynthesiserVoice* const* voicesToRender, int numVoices,
+                                AudioBuffer<double>& outputBuffer, int startSample, int numSamples)
+{
+    renderBatchOfVoices (voicesToRender, numVoices, outputBuffer, startSample, numSamples);
+}
+
+template <typename FloatType>
+void SamplerVoice::renderBatchOfVoices (SynthesiserVoice* const* voicesToRender, int numVoices,
+                                        AudioBuffer<FloatType>& outputBuffer, int startSample, int numSamples)
+{
+    jassert (numVoices <= batchSize);
+
+    // Each voice in the group is mixed into a small accumulator that stays in
+    // registers/L1, and the accumulator is added to the output once per chunk,
+    // rather than every voice making its own pass over the output buffer.
+    constexpr int chunkSize = 64;
+
+    SamplerVoice* lanes[batchSize];
+    int numLanes = 0;
+
+    for (int i = 0; i < jmin (numVoices, (int) batchSize); ++i)
+    {
+        auto* voice = static_cast<SamplerVoice*> (voicesToRender[i]);
+
+        if (voice->getCurrentlyPlayingSound() == nullptr)
+            continue;
+
+        if (voice->canBeRenderedInBatch())
+        {
+            voice->pitchRatio = voice->smoothedPitchRatio.getCurrentValue();
+            lanes[numLanes++] = voice;
+        }
+        else
+        {
+            voice->renderBlock (outputBuffer, startSample, numSamples);
+        }
+    }
+
+    auto* outL = outputBuffer.getWritePointer (0, startSample);
+    auto* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+
+    float accumL[chunkSize], accumR[chunkSize];
+
+    while (numSamples > 0 && numLanes > 0)
+    {
+        auto numThisTime = jmin (chunkSize, numSamples);
+
+        std::fill (accumL, accumL + numThisTime, 0.0f);
+        std::fill (accumR, accumR + numThisTime, 0.0f);
+
+        for (int lane = numLanes; --lane >= 0;)
+        {
+            auto& voice = *lanes[lane];
+            auto& sound = *static_cast<SamplerSound*> (voice.getCurrentlyPlayingSound().get());
+            auto& data = *sound.data;
+            const float* const inL = data.getReadPointer (0);
+            const float* const inR = data.getReadPointer (data.getNumChannels() > 1 ? 1 : 0);
+
+            auto sourcePos = voice.sourceSamplePosition;
+            auto ratio = voice.pitchRatio;
+            auto length = sound.length;
+            bool finished = false;
+
+            for (int i = 0; i < numThisTime; ++i)
             {
-                *outL++ += (l + r) * 0.5f;
+                auto pos = (int) sourcePos;
+                auto alpha = (float) (sourcePos - pos);
+                auto invAlpha = 1.0f - alpha;
+                auto envelopeValue = voice.adsr.getNextSample();
+
+                accumL[i] += (inL[pos] * invAlpha + inL[pos + 1] * alpha) * (voice.lgain * envelopeValue);
+                accumR[i] += (inR[pos] * invAlpha + inR[pos + 1] * alpha) * (voice.rgain * envelopeValue);
+
+                sourcePos += ratio;
+
+                if (sourcePos > length)
+                {
+                    finished = true;
+                    break;
+                }
             }
 
-            sourceSamplePosition += pitchRatio;
+            voice.sourceSamplePosition = sourcePos;
 
-            if (sourceSamplePosition > playingSound->length)
+            if (finished)
             {
-                stopNote (0.0f, false);
-                break;
+                voice.stopNote (0.0f, false);
+                lanes[lane] = lanes[--numLanes];
             }
         }
+
+        if (outR != nullptr)
+        {
+            FloatVectorOperations::add (outL, accumL, numThisTime);
+            FloatVectorOperations::add (outR, accumR, numThisTime);
+            outR += numThisTime;
+        }
+        else
+        {
+            for (int i = 0; i < numThisTime; ++i)
+                outL[i] += (accumL[i] + accumR[i]) * 0.5f;
+        }
+
+        outL += numThisTime;
+        numSamples -= numThisTime;
     }
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class SamplerVoiceBatchTests  : public UnitTest
+{
+public:
+    SamplerVoiceBatchTests()
+        : UnitTest ("SamplerVoice batch rendering", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        MemoryBlock wavData;
+        createSampleData (wavData, 30000);
+
+        beginTest ("Batched output matches per-voice rendering");
+        {
+            for (auto numOutputChannels : { 1, 2 })
+            {
+                for (auto numVoices : { 1, 3, 8, 13, 64 })
+                {
+                    AudioBuffer<float> batched (numOutputChannels, 20000), unbatched (numOutputChannels, 20000);
+                    render (wavData, numVoices, true,  batched);
+                    render (wavData, numVoices, false, unbatched);
+
+                    expect (batched.getMagnitude (0, batched.getNumSamples()) > 0.1f);
+
+                    for (int ch = 0; ch < numOutputChannels; ++ch)
+                    {
+                        float maxError = 0;
+
+                        for (int i = 0; i < batched.getNumSamples(); ++i)
+                            maxError = jmax (maxError, std::abs (batched.getSample (ch, i) - unbatched.getSample (ch, i)));
+
+                        expect (maxError < 1.0e-4f, "max error " + String (maxError));
+                    }
+                }
+            }
+        }
+
+        beginTest ("Blocks bigger than the prepared size are rendered per-voice");
+        {
+            expect (! Synthesiser().isVoiceBatchingEnabled());
+
+            AudioBuffer<float> batched (2, 20000), unbatched (2, 20000);
+            render (wavData, 8, true,  batched, 256);
+            render (wavData, 8, false, unbatched);
+
+            expect (batched.getMagnitude (0, batched.getNumSamples()) > 0.1f);
+
+            float maxError = 0;
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < batched.getNumSamples(); ++i)
+                    maxError = jmax (maxError, std::abs (batched.getSample (ch, i) - unbatched.getSample (ch, i)));
+
+            expect (maxError < 1.0e-4f, "max error " + String (maxError));
+        }
+
+        beginTest ("Double precision output matches single precision");
+        {
+            for (auto batch : { false, true })
+            {
+                AudioBuffer<float> floatOutput (2, 20000);
+                AudioBuffer<double> doubleOutput (2, 20000);
+                render (wavData, 16, batch, floatOutput);
+                render (wavData, 16, batch, doubleOutput);
+
+                double maxError = 0;
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < floatOutput.getNumSamples(); ++i)
+                        maxError = jmax (maxError, std::abs (doubleOutput.getSample (ch, i) - (double) floatOutput.getSample (ch, i)));
+
+                expect (doubleOutput.getMagnitude (0, doubleOutput.getNumSamples()) > 0.1);
+                expect (maxError < 1.0e-4, "max error " + String (maxError));
+            }
+        }
+
+        beginTest ("Voices that reach the end of their sample are released");
+        {
+            Synthesiser synth;
+            createSynth (synth, wavData, 8);
+
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, 84, 1.0f), 0);
+
+            AudioBuffer<float> buffer (2, 30000);
+            buffer.clear();
+            synth.renderNextBlock (buffer, midi, 0, buffer.getNumSamples());
+
+            for (int i = 0; i < synth.getNumVoices(); ++i)
+                expect (! synth.getVoice (i)->isVoiceActive());
+        }
+
+        beginTest ("Benchmark");
+        {
+            const int numBlocks = 200, blockSize = 512;
+
+            for (auto batch : { false, true })
+            {
+                Synthesiser synth;
+                createSynth (synth, wavData, 128);
+                synth.setVoiceBatchingEnabled (batch);
+                synth.prepareBatchRendering (2, blockSize);
+
+                MidiBuffer midi;
+
+                for (int note = 0; note < 128; ++note)
+                    midi.addEvent (MidiMessage::noteOn (1, note, 0.5f), 0);
+
+                AudioBuffer<float> buffer (2, blockSize);
+                auto start = Time::getMillisecondCounterHiRes();
+
+                for (int i = 0; i < numBlocks; ++i)
+                {
+                    buffer.clear();
+                    synth.renderNextBlock (buffer, midi, 0, blockSize);
+                    midi.clear();
+                }
+
+                logMessage (String (batch ? "Batched" : "Per-voice") + " rendering of 128 voices: "
+                              + String ((Time::getMillisecondCounterHiRes() - start) * 1000.0 / numBlocks, 1) + " us per block");
+            }
+        }
+    }
+
+private:
+    static void createSampleData (MemoryBlock& block, int length)
+    {
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (new MemoryOutputStream (block, false),
+                                                                        44100.0, 2, 24, {}, 0));
+        AudioBuffer<float> buffer (2, length);
+
+        for (int i = 0; i < length; ++i)
+        {
+            buffer.setSample (0, i, 0.5f * std::sin ((float) i * 0.031f));
+            buffer.setSample (1, i, 0.5f * std::sin ((float) i * 0.017f));
+        }
+
+        writer->writeFromAudioSampleBuffer (buffer, 0, length);
+    }
+
+    static void createSynth (Synthesiser& synth, const MemoryBlock& wavData, int numVoices)
+    {
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatReader> reader (wav.createReaderFor (new MemoryInputStream (wavData, false), true));
+
+        BigInteger allNotes;
+        allNotes.setRange (0, 128, true);
+
+        synth.addSound (new SamplerSound ("test", *reader, allNotes, 60, 0.01, 0.1, 10.0));
+
+        for (int i = 0; i < numVoices; ++i)
+            synth.addVoice (new SamplerVoice());
+
+        synth.setCurrentPlaybackSampleRate (44100.0);
+    }
+
+    template <typename FloatType>
+    static void render (const MemoryBlock& wavData, int numVoices, bool batch, AudioBuffer<FloatType>& buffer,
+                        int preparedBlockSize = 480)
+    {
+        Synthesiser synth;
+        createSynth (synth, wavData, numVoices);
+        synth.setVoiceBatchingEnabled (batch);
+        synth.prepareBatchRendering (buffer.getNumChannels(), preparedBlockSize);
+
+        MidiBuffer midi;
+        Random r (1234);
+
+        for (int i = 0; i < 40; ++i)
+        {
+            auto time = r.nextInt (buffer.getNumSamples());
+            auto note = 40 + r.nextInt (40);
+
+            midi.addEvent (MidiMessage::noteOn (1, note, 0.2f + 0.8f * r.nextFloat()), time);
+            midi.addEvent (MidiMessage::noteOff (1, note), jmin (buffer.getNumSamples() - 1, time + r.nextInt (5000)));
+        }
+
+        buffer.clear();
+
+        for (int pos = 0; pos < buffer.getNumSamples(); pos += 480)
+        {
+            auto num = jmin (480, buffer.getNumSamples() - pos);
+            synth.renderNextBlock (buffer, midi, pos, num);
+        }
+    }
+};
+
+static SamplerVoiceBatchTests samplerVoiceBatchTests;
+
+//==============================================================================
+class SamplerVoiceInterpolationTests  : public UnitTest
+{
+public:
+    SamplerVoiceInterpolationTests()
+        : UnitTest ("SamplerVoice interpolation", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        using Interpolation = SamplerVoice::Interpolation;
+        const int length = 100000;
+
+        auto sine = [] (int64 i) { return 0.5f * (float) std::sin ((double) i * 0.02); };
+
+        beginTest ("Interpolators reproduce the sample at its natural pitch");
+        {
+            for (auto interpolation : { Interpolation::linear, Interpolation::cubic, Interpolation::sinc })
+            {
+                Synthesiser synth;
+                auto& voice = createSynth (synth, sine, length);
+                voice.setInterpolation (interpolation);
+
+                AudioBuffer<float> output (1, 4096);
+                render (synth, output, { MidiMessage::noteOn (1, 60, 1.0f) });
+
+                float maxError = 0;
+
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                    maxError = jmax (maxError, std::abs (output.getSample (0, i) - sine (i)));
+
+                expect (maxError < 1.0e-5f, "max error " + String (maxError));
+            }
+        }
+
+        beginTest ("Interpolators follow a transposed signal");
+        {
+            for (auto interpolation : { Interpolation::cubic, Interpolation::sinc })
+            {
+                Synthesiser synth;
+                auto& voice = createSynth (synth, sine, length);
+                voice.setInterpolation (interpolation);
+
+                AudioBuffer<float> output (1, 4096);
+                render (synth, output, { MidiMessage::noteOn (1, 63, 1.0f) });
+
+                auto ratio = std::pow (2.0, 3.0 / 12.0);
+                float maxError = 0;
+
+                for (int i = 64; i < output.getNumSamples(); ++i)
+                    maxError = jmax (maxError, std::abs (output.getSample (0, i) - 0.5f * (float) std::sin (i * ratio * 0.02)));
+
+                expect (maxError < 1.0e-3f, "max error " + String (maxError));
+            }
+        }
+
+        beginTest ("Sinc interpolation suppresses aliasing when transposing upwards");
+        {
+            // a tone at 0.35 of the sample rate, played an octave up, is entirely above the
+            // output's Nyquist frequency, so ideally the output is silent
+            auto highTone = [] (int64 i) { return 0.5f * (float) std::sin ((double) i * MathConstants<double>::twoPi * 0.35); };
+            float levels[3];
+
+            for (auto interpolation : { Interpolation::linear, Interpolation::cubic, Interpolation::sinc })
+            {
+                Synthesiser synth;
+                auto& voice = createSynth (synth, highTone, length);
+                voice.setInterpolation (interpolation);
+
+                AudioBuffer<float> output (1, 8192);
+                render (synth, output, { MidiMessage::noteOn (1, 72, 1.0f) });
+
+                levels[(int) interpolation] = output.getRMSLevel (0, 1024, 4096);
+            }
+
+            logMessage ("Aliasing level - linear: " + String (Decibels::gainToDecibels (levels[0]), 1)
+                          + " dB, cubic: " + String (Decibels::gainToDecibels (levels[1]), 1)
+                          + " dB, sinc: " + String (Decibels::gainToDecibels (levels[2]), 1) + " dB");
+
+            expect (levels[0] > 0.1f);
+            expect (levels[2] < 0.001f);
+        }
+
+        beginTest ("Pitch wheel");
+        {
+            auto ramp = [length] (int64 i) { return (float) i / (float) length; };
+
+            Synthesiser synth;
+            auto& voice = createSynth (synth, ramp, length);
+            voice.setPitchWheelRange (12.0);
+
+            AudioBuffer<float> output (1, 1024);
+            render (synth, output, { MidiMessage::noteOn (1, 60, 1.0f), MidiMessage::pitchWheel (1, 16383) });
+
+            auto expectedSlope = std::pow (2.0, 8191.0 / 8192.0) / length;
+            expectWithinAbsoluteError ((double) (output.getSample (0, 1000) - output.getSample (0, 999)), expectedSlope, 1.0e-7);
+        }
+
+        beginTest ("Glide");
+        {
+            auto ramp = [length] (int64 i) { return (float) i / (float) length; };
+
+            Synthesiser synth;
+            auto& voice = createSynth (synth, ramp, length);
+            voice.setGlideTime (0.01);
+
+            AudioBuffer<float> output (1, 4096);
+            output.clear();
+
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 0);
+            synth.renderNextBlock (output, midi, 0, 1024);
+
+            voice.glideToNote (72);
+            synth.renderNextBlock (output, {}, 1024, 3072);
+
+            auto slopeAt = [&output] (int i) { return (double) (output.getSample (0, i + 1) - output.getSample (0, i)); };
+
+            expectWithinAbsoluteError (slopeAt (1000), 1.0 / length, 1.0e-7);
+            expectWithinAbsoluteError (slopeAt (4000), 2.0 / length, 1.0e-7);
+
+            bool rising = true;
+
+            for (int i = 1024 + 32; i < 2048; i += 32)
+                rising = rising && slopeAt (i) >= slopeAt (i - 32) - 1.0e-8;
+
+            expect (rising);
+            expect (slopeAt (1024 + 200) > 1.1 / length && slopeAt (1024 + 200) < 1.9 / length);
+        }
+
+        beginTest ("Benchmark");
+        {
+            const int numBlocks = 200, blockSize = 512, numVoices = 32;
+
+            for (auto interpolation : { Interpolation::linear, Interpolation::cubic, Interpolation::sinc })
+            {
+                Synthesiser synth;
+                std::unique_ptr<AudioFormatReader> reader (new FunctionReader (sine, length));
+
+                BigInteger allNotes;
+                allNotes.setRange (0, 128, true);
+                synth.addSound (new SamplerSound ("test", *reader, allNotes, 60, 0.0, 0.0, 10.0));
+
+                for (int i = 0; i < numVoices; ++i)
+                {
+                    auto* voice = new SamplerVoice();
+                    voice->setInterpolation (interpolation);
+                    synth.addVoice (voice);
+                }
+
+                synth.setCurrentPlaybackSampleRate (44100.0);
+
+                MidiBuffer midi;
+
+                for (int i = 0; i < numVoices; ++i)
+                    midi.addEvent (MidiMessage::noteOn (1, 50 + i, 0.5f), 0);
+
+                AudioBuffer<float> buffer (2, blockSize);
+                auto start = Time::getMillisecondCounterHiRes();
+
+                for (int i = 0; i < numBlocks; ++i)
+                {
+                    buffer.clear();
+                    synth.renderNextBlock (buffer, midi, 0, blockSize);
+                    midi.clear();
+                }
+
+                logMessage (String (interpolation == Interpolation::linear ? "Linear" : (interpolation == Interpolation::cubic ? "Cubic" : "Sinc"))
+                              + " interpolation of " + String (numVoices) + " voices: "
+                              + String ((Time::getMillisecondCounterHiRes() - start) * 1000.0 / numBlocks, 1) + " us per block");
+            }
+        }
+    }
+
+private:
+    struct FunctionReader  : public AudioFormatReader
+    {
+        FunctionReader (std::function<float (int64)> f, int64 numSamples)
+            : AudioFormatReader (nullptr, "Test"), function (std::move (f))
+        {
+            sampleRate = 44100.0;
+            lengthInSamples = numSamples;
+            numChannels = 1;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            for (int ch = 0; ch < numDestChannels; ++ch)
+                if (auto* dest = reinterpret_cast<float*> (destSamples[ch]))
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[startOffsetInDestBuffer + i] = startSampleInFile + i < lengthInSamples ? function (startSampleInFile + i) : 0.0f;
+
+            return true;
+        }
+
+        std::function<float (int64)> function;
+    };
+
+    static SamplerVoice& createSynth (Synthesiser& synth, std::function<float (int64)> function, int length)
+    {
+        FunctionReader reader (std::move (function), length);
+
+        BigInteger allNotes;
+        allNotes.setRange (0, 128, true);
+
+        synth.addSound (new SamplerSound ("test", reader, allNotes, 60, 0.0, 0.0, 10.0));
+        auto* voice = new SamplerVoice();
+        synth.addVoice (voice);
+        synth.setCurrentPlaybackSampleRate (44100.0);
+
+        return *voice;
+    }
+
+    static void render (Synthesiser& synth, AudioBuffer<float>& output, std::initializer_list<MidiMessage> messages)
+    {
+        MidiBuffer midi;
+
+        for (auto& m : messages)
+            midi.addEvent (m, 0);
+
+        output.clear();
+        synth.renderNextBlock (output, midi, 0, output.getNumSamples());
+    }
+};
+
+static SamplerVoiceInterpolationTests samplerVoiceInterpolationTests;
+
+#endif
+
 } // namespace juce
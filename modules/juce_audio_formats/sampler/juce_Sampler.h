@@ -114,6 +114,14 @@ private:
     To use it, create a Synthesiser, add some SamplerVoice objects to it, then
     give it some SampledSound objects to play.
 
+    By default, the voice uses linear interpolation, which is cheap but aliases
+    audibly when a sample is transposed far from its root note. Cubic or windowed-sinc
+    interpolation can be selected with setInterpolation().
+
+    The pitch can be modulated while a note is playing, with the pitch wheel, a pitch
+    offset, or by gliding to a new note. Pitch changes are applied in small blocks and
+    ramp over the time set by setGlideTime().
+
     @see SamplerSound, Synthesiser, SynthesiserVoice
 
     @tags{Audio}
@@ -138,7 +146,51 @@ public:
     void controllerMoved (int controllerNumber, int newValue) override;
 
     void renderNextBlock (AudioBuffer<float>&, int startSample, int numSamples) override;
-    using SynthesiserVoice::renderNextBlock;
+    void renderNextBlock (AudioBuffer<double>&, int startSample, int numSamples) override;
+
+    //==============================================================================
+    /** The algorithms that a SamplerVoice can use to interpolate between samples. */
+    enum class Interpolation
+    {
+        linear,     /**< Two-point linear interpolation. This is the cheapest option. */
+        cubic,      /**< Four-point cubic Hermite interpolation. */
+        sinc        /**< 32-point windowed-sinc interpolation. The cut-off frequency follows the
+                         playback rate, so samples that are transposed upwards don't alias. */
+    };
+
+    /** Selects the interpolation algorithm. The default is Interpolation::linear. */
+    void setInterpolation (Interpolation newInterpolation);
+
+    /** Returns the interpolation algorithm that is being used. */
+    Interpolation getInterpolation() const noexcept             { return interpolation; }
+
+    //==============================================================================
+    /** Sets the range of the pitch wheel, in semitones.
+        The default is 0, which means that the pitch wheel is ignored.
+    */
+    void setPitchWheelRange (double semitones) noexcept;
+
+    /** Transposes the note that is playing by a number of semitones.
+        This can be called before each block to apply vibrato or other modulation.
+    */
+    void setPitchOffset (double semitones) noexcept;
+
+    /** Sets the time taken to move to a new pitch.
+        This applies to the pitch wheel, setPitchOffset() and glideToNote(). The default
+        is 0, in which case pitch changes happen at the start of the next block.
+    */
+    void setGlideTime (double seconds) noexcept;
+
+    /** Glides the note that is playing to a new pitch, without restarting it. */
+    void glideToNote (int midiNoteNumber) noexcept;
+
+    //==============================================================================
+    /** SamplerVoices can be rendered in groups of this size, one voice per lane. */
+    static constexpr int batchSize = 8;
+
+    int getMaximumBatchSize() const override;
+    void renderBatch (SynthesiserVoice* const*, int numVoices, AudioBuffer<float>&, int startSample, int numSamples) override;
+    void renderBatch (SynthesiserVoice* const*, int numVoices, AudioBuffer<double>&, int startSample, int numSamples) override;
 
 private:
     //==============================================================================
@@ -148,6 +200,23 @@ private:
 
     ADSR adsr;
 
+    Interpolation interpolation = Interpolation::linear;
+    SmoothedValue<double, ValueSmoothingTypes::Multiplicative> smoothedPitchRatio { 1.0 };
+    double noteRatio = 1.0, pitchWheelRange = 0, pitchOffset = 0, glideTime = 0;
+    int pitchWheelPosition = 8192;
+
+    void updatePitchRatio() noexcept;
+    bool canBeRenderedInBatch() const noexcept;
+
+    template <typename FloatType>
+    void renderBlock (AudioBuffer<FloatType>&, int startSample, int numSamples);
+
+    template <typename FloatType, typename Interpolator>
+    bool renderSection (const Interpolator&, const SamplerSound&, FloatType* outL, FloatType* outR, int numSamples);
+
+    template <typename FloatType>
+    static void renderBatchOfVoices (SynthesiserVoice* const*, int numVoices, AudioBuffer<FloatType>&, int startSample, int numSamples);
+
     JUCE_LEAK_DETECTOR (SamplerVoice)
 };
 
@@ -0,0 +1,759 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace StreamingSamplerHelpers
+{
+    // The stream state of a voice: the top 16 bits are a generation count which
+    // changes whenever a note starts or stops, bit 47 is set while the voice needs
+    // streaming, and the low 47 bits hold the end of the valid data in the ring.
+    static constexpr uint64 endMask    = (((uint64) 1) << 47) - 1;
+    static constexpr uint64 activeFlag = ((uint64) 1) << 47;
+    static constexpr int generationShift = 48;
+
+    static uint64 makeState (uint64 generation, bool active, int64 validEnd) noexcept
+    {
+        return (generation << generationShift) | (active ? activeFlag : 0) | ((uint64) validEnd & endMask);
+    }
+
+    static uint64 getGeneration (uint64 state) noexcept   { return state >> generationShift; }
+    static bool isActive (uint64 state) noexcept          { return (state & activeFlag) != 0; }
+    static int64 getValidEnd (uint64 state) noexcept      { return (int64) (state & endMask); }
+
+    static uint64 nextState (uint64 state, bool active, int64 validEnd) noexcept
+    {
+        return makeState ((getGeneration (state) + 1) & 0xffff, active, validEnd);
+    }
+
+    static constexpr int maximumReadSize = 16384;
+    static constexpr int minimumReadSize = 2048;
+    static constexpr int idleWaitMs = 2;
+    static constexpr int soundReleaseIntervalMs = 500;
+}
+
+//==============================================================================
+class StreamingSamplerPool::ReaderThread  : public Thread
+{
+public:
+    ReaderThread (StreamingSamplerPool& p, int index)
+        : Thread ("Sampler streaming " + String (index + 1)), pool (p)
+    {
+    }
+
+    void run() override
+    {
+        using namespace StreamingSamplerHelpers;
+
+        auto lastSoundRelease = Time::getMillisecondCounter();
+
+        while (! threadShouldExit())
+        {
+            if (auto* voice = pool.claimMostUrgentVoice())
+            {
+                voice->fillBuffer (maximumReadSize);
+                voice->beingServiced = false;
+                continue;
+            }
+
+            auto now = Time::getMillisecondCounter();
+
+            if (now > lastSoundRelease + (uint32) soundReleaseIntervalMs)
+            {
+                pool.releaseUnusedSounds();
+                lastSoundRelease = now;
+            }
+
+            pool.workAvailable.wait (idleWaitMs);
+        }
+    }
+
+private:
+    StreamingSamplerPool& pool;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReaderThread)
+};
+
+//==============================================================================
+StreamingSamplerPool::StreamingSamplerPool (int numThreads)
+{
+    jassert (numThreads > 0);
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        auto* t = threads.add (new ReaderThread (*this, i));
+        t->startThread (8);
+    }
+}
+
+StreamingSamplerPool::~StreamingSamplerPool()
+{
+    for (auto* t : threads)
+        t->signalThreadShouldExit();
+
+    workAvailable.signal();
+
+    for (auto* t : threads)
+        t->stopThread (4000);
+
+    // All the voices that use this pool must be deleted before it is!
+    jassert (voices.isEmpty());
+
+    sounds.clear();
+}
+
+void StreamingSamplerPool::addVoice (StreamingSamplerVoice* v)
+{
+    const ScopedLock sl (lock);
+    voices.add (v);
+}
+
+void StreamingSamplerPool::removeVoice (StreamingSamplerVoice* v)
+{
+    const ScopedLock sl (lock);
+    voices.removeFirstMatchingValue (v);
+}
+
+void StreamingSamplerPool::addSound (StreamingSamplerSound* s)
+{
+    const ScopedLock sl (lock);
+    sounds.add (s);
+}
+
+StreamingSamplerVoice* StreamingSamplerPool::claimMostUrgentVoice()
+{
+    const ScopedLock sl (lock);
+
+    StreamingSamplerVoice* mostUrgent = nullptr;
+    double shortestTime = 0;
+
+    for (auto* v : voices)
+    {
+        if (v->beingServiced.load() || ! v->needsData (StreamingSamplerHelpers::minimumReadSize))
+            continue;
+
+        auto timeLeft = v->getSecondsUntilUnderrun();
+
+        if (mostUrgent == nullptr || timeLeft < shortestTime)
+        {
+            mostUrgent = v;
+            shortestTime = timeLeft;
+        }
+    }
+
+    if (mostUrgent != nullptr)
+    {
+        // the state has to be read before the sound - see StreamingSamplerVoice::startNote()
+        mostUrgent->beingServiced = true;
+        mostUrgent->servicedState = mostUrgent->streamState.load();
+        mostUrgent->servicedSound = mostUrgent->streamingSound.load();
+    }
+
+    return mostUrgent;
+}
+
+void StreamingSamplerPool::releaseUnusedSounds()
+{
+    const ScopedLock sl (lock);
+
+    for (int i = sounds.size(); --i >= 0;)
+    {
+        auto* s = sounds.getObjectPointerUnchecked (i);
+
+        if (s->getReferenceCount() > 1)
+            continue;
+
+        bool inUse = false;
+
+        for (auto* v : voices)
+            if ((v->beingServiced.load() && v->servicedSound == s)
+                 || (StreamingSamplerHelpers::isActive (v->streamState.load()) && v->streamingSound.load() == s))
+                inUse = true;
+
+        if (! inUse)
+            sounds.remove (i);
+    }
+}
+
+StreamingSamplerPool::Statistics StreamingSamplerPool::getStatistics() const
+{
+    using namespace StreamingSamplerHelpers;
+
+    const ScopedLock sl (lock);
+
+    Statistics stats;
+    stats.numVoices = voices.size();
+    stats.numSounds = sounds.size();
+    bool anyBuffering = false;
+
+    for (auto* v : voices)
+    {
+        stats.samplesStreamed += v->getNumSamplesStreamed();
+        stats.underrunSamples += v->getNumUnderrunSamples();
+
+        if (isActive (v->streamState.load()))
+        {
+            ++stats.numStreamingVoices;
+
+            auto buffered = v->getNumBufferedSamples();
+
+            if (! anyBuffering || buffered < stats.minimumBufferedSamples)
+                stats.minimumBufferedSamples = buffered;
+
+            anyBuffering = true;
+        }
+    }
+
+    return stats;
+}
+
+//==============================================================================
+StreamingSamplerSound::StreamingSamplerSound (StreamingSamplerPool& pool,
+                                              const String& soundName,
+                                              AudioFormatReader* source,
+                                              const BigInteger& notes,
+                                              int midiNoteForNormalPitch,
+                                              double attackTimeSecs,
+                                              double releaseTimeSecs,
+                                              int numSamplesToPreload)
+    : name (soundName),
+      reader (source),
+      sourceSampleRate (source != nullptr ? source->sampleRate : 0.0),
+      midiNotes (notes),
+      midiRootNote (midiNoteForNormalPitch)
+{
+    jassert (source != nullptr);
+
+    if (reader != nullptr && sourceSampleRate > 0 && reader->lengthInSamples > 0)
+    {
+        if (auto* mapped = dynamic_cast<MemoryMappedAudioFormatReader*> (reader.get()))
+            readerIsThreadSafe = mapped->mapEntireFile();
+
+        length = reader->lengthInSamples;
+        numChannels = jmin (2, (int) reader->numChannels);
+        preloadLength = (int) jmin (length, (int64) jmax (0, numSamplesToPreload));
+
+        preload.setSize (numChannels, preloadLength);
+        reader->read (&preload, 0, preloadLength, 0, true, numChannels > 1);
+
+        params.attack  = static_cast<float> (attackTimeSecs);
+        params.release = static_cast<float> (releaseTimeSecs);
+    }
+
+    pool.addSound (this);
+}
+
+StreamingSamplerSound::~StreamingSamplerSound()
+{
+}
+
+bool StreamingSamplerSound::appliesToNote (int midiNoteNumber)
+{
+    return midiNotes[midiNoteNumber];
+}
+
+bool StreamingSamplerSound::appliesToChannel (int /*midiChannel*/)
+{
+    return true;
+}
+
+void StreamingSamplerSound::read (float* const* dest, int64 startSample, int numSamples)
+{
+    numSamples = (int) jmin ((int64) numSamples, length - startSample);
+
+    if (numSamples <= 0)
+        return;
+
+    if (readerIsThreadSafe)
+    {
+        reader->read (dest, numChannels, startSample, numSamples);
+    }
+    else
+    {
+        const ScopedLock sl (readerLock);
+        reader->read (dest, numChannels, startSample, numSamples);
+    }
+}
+
+//==============================================================================
+StreamingSamplerVoice::StreamingSamplerVoice (StreamingSamplerPool& p, int lookAheadSamples)
+    : pool (p),
+      ringSize (nextPowerOfTwo (jmax (2 * StreamingSamplerHelpers::minimumReadSize, lookAheadSamples))),
+      ringMask (ringSize - 1)
+{
+    ring.setSize (2, ringSize);
+    pool.addVoice (this);
+}
+
+StreamingSamplerVoice::~StreamingSamplerVoice()
+{
+    pool.removeVoice (this);
+
+    // once removed, no more threads can claim this voice, but one may still be filling it
+    while (beingServiced.load())
+        Thread::yield();
+}
+
+int StreamingSamplerVoice::getNumBufferedSamples() const noexcept
+{
+    auto state = streamState.load();
+
+    if (! StreamingSamplerHelpers::isActive (state))
+        return 0;
+
+    return (int) jmax ((int64) 0, StreamingSamplerHelpers::getValidEnd (state) - playPosition.load());
+}
+
+void StreamingSamplerVoice::resetStatistics() noexcept
+{
+    underrunSamples = 0;
+    samplesStreamed = 0;
+}
+
+bool StreamingSamplerVoice::canPlaySound (SynthesiserSound* sound)
+{
+    return dynamic_cast<const StreamingSamplerSound*> (sound) != nullptr;
+}
+
+void StreamingSamplerVoice::startNote (int midiNoteNumber, float velocity, SynthesiserSound* s, int /*currentPitchWheelPosition*/)
+{
+    using namespace StreamingSamplerHelpers;
+
+    if (auto* sound = dynamic_cast<StreamingSamplerSound*> (s))
+    {
+        pitchRatio = std::pow (2.0, (midiNoteNumber - sound->midiRootNote) / 12.0)
+                        * sound->sourceSampleRate / getSampleRate();
+
+        sourceSamplePosition = 0.0;
+        lgain = velocity;
+        rgain = velocity;
+
+        adsr.setSampleRate (sound->sourceSampleRate);
+        adsr.setParameters (sound->params);
+
+        adsr.noteOn();
+
+        // the sound has to be published before the new state, so that a reader thread
+        // which sees the new generation is guaranteed to read from the right sound
+        streamingSound = sound;
+        playPosition = 0;
+        consumptionRate = (float) (pitchRatio * getSampleRate());
+        streamState = nextState (streamState.load(), sound->length > sound->preloadLength, sound->preloadLength);
+
+        pool.workAvailable.signal();
+    }
+    else
+    {
+        jassertfalse; // this object can only play StreamingSamplerSounds!
+    }
+}
+
+void StreamingSamplerVoice::stopNote (float /*velocity*/, bool allowTailOff)
+{
+    if (allowTailOff)
+    {
+        adsr.noteOff();
+    }
+    else
+    {
+        clearCurrentNote();
+        adsr.reset();
+        stopStreaming();
+    }
+}
+
+void StreamingSamplerVoice::stopStreaming() noexcept
+{
+    auto state = streamState.load();
+    streamState = StreamingSamplerHelpers::nextState (state, false, StreamingSamplerHelpers::getValidEnd (state));
+}
+
+void StreamingSamplerVoice::pitchWheelMoved (int /*newValue*/) {}
+void StreamingSamplerVoice::controllerMoved (int /*controllerNumber*/, int /*newValue*/) {}
+
+//==============================================================================
+bool StreamingSamplerVoice::needsData (int minimumSize) const noexcept
+{
+    using namespace StreamingSamplerHelpers;
+
+    auto state = streamState.load();
+
+    if (! isActive (state))
+        return false;
+
+    if (auto* sound = streamingSound.load())
+    {
+        auto validEnd = jmax (getValidEnd (state), playPosition.load());
+        auto limit = jmin (sound->length, playPosition.load() + ringSize);
+
+        // small reads are only worth doing if they reach the end of the sample
+        return validEnd < limit && (limit - validEnd >= minimumSize || limit == sound->length);
+    }
+
+    return false;
+}
+
+double StreamingSamplerVoice::getSecondsUntilUnderrun() const noexcept
+{
+    return getNumBufferedSamples() / jmax (1.0f, consumptionRate.load());
+}
+
+void StreamingSamplerVoice::fillBuffer (int maximumSize)
+{
+    using namespace StreamingSamplerHelpers;
+
+    auto state = servicedState;
+    auto* sound = servicedSound;
+
+    if (! isActive (state) || sound == nullptr)
+        return;
+
+    auto position = playPosition.load();
+    auto start = jmax (getValidEnd (state), position);
+    auto end = jmin (sound->length, position + ringSize, start + maximumSize);
+
+    if (end <= start)
+        return;
+
+    for (auto blockStart = start; blockStart < end;)
+    {
+        auto ringIndex = (int) (blockStart & ringMask);
+        auto numThisTime = (int) jmin (end - blockStart, (int64) (ringSize - ringIndex));
+
+        float* dest[] = { ring.getWritePointer (0, ringIndex), ring.getWritePointer (1, ringIndex) };
+        sound->read (dest, blockStart, numThisTime);
+
+        blockStart += numThisTime;
+    }
+
+    // If the note has changed while we were reading, this fails and the data is discarded
+    auto newState = makeState (getGeneration (state), true, end);
+
+    if (streamState.compare_exchange_strong (state, newState))
+        samplesStreamed += (end - start);
+}
+
+//==============================================================================
+void StreamingSamplerVoice::renderNextBlock (AudioBuffer<float>& outputBuffer, int startSample, int numSamples)
+{
+    renderBlock (outputBuffer, startSample, numSamples);
+}
+
+void StreamingSamplerVoice::renderNextBlock (AudioBuffer<double>& outputBuffer, int startSample, int numSamples)
+{
+    renderBlock (outputBuffer, startSample, numSamples);
+}
+
+template <typename FloatType>
+void StreamingSamplerVoice::renderBlock (AudioBuffer<FloatType>& outputBuffer, int startSample, int numSamples)
+{
+    if (auto* playingSound = static_cast<StreamingSamplerSound*> (getCurrentlyPlayingSound().get()))
+    {
+        auto state = streamState.load();
+        auto validEnd = StreamingSamplerHelpers::getValidEnd (state);
+        auto preloadLength = (int64) playingSound->preloadLength;
+        auto length = playingSound->length;
+        int64 numUnderruns = 0;
+
+        auto stereo = playingSound->numChannels > 1;
+        const float* const preL = playingSound->preload.getReadPointer (0);
+        const float* const preR = stereo ? playingSound->preload.getReadPointer (1) : nullptr;
+        const float* const ringL = ring.getReadPointer (0);
+        const float* const ringR = ring.getReadPointer (1);
+
+        auto sampleAt = [=] (const float* pre, const float* streamed, int64 index) noexcept
+        {
+            if (index < preloadLength)  return pre[index];
+            if (index < validEnd)       return streamed[index & ringMask];
+            return 0.0f;
+        };
+
+        auto* outL = outputBuffer.getWritePointer (0, startSample);
+        auto* outR = outputBuffer.getNumChannels() > 1 ? outputBuffer.getWritePointer (1, startSample) : nullptr;
+
+        while (--numSamples >= 0)
+        {
+            auto pos = (int64) sourceSamplePosition;
+            auto alpha = (float) (sourceSamplePosition - (double) pos);
+            auto invAlpha = 1.0f - alpha;
+            auto envelopeValue = adsr.getNextSample();
+
+            if (pos + 1 >= validEnd && pos + 1 < length)
+            {
+                // the data hasn't arrived yet, so all we can do is keep time
+                ++numUnderruns;
+
+                if (outR != nullptr)
+                    ++outR;
+
+                ++outL;
+            }
+            else
+            {
+                float l = (sampleAt (preL, ringL, pos) * invAlpha + sampleAt (preL, ringL, pos + 1) * alpha);
+                float r = (preR != nullptr) ? (sampleAt (preR, ringR, pos) * invAlpha + sampleAt (preR, ringR, pos + 1) * alpha)
+                                            : l;
+
+                l *= lgain * envelopeValue;
+                r *= rgain * envelopeValue;
+
+                if (outR != nullptr)
+                {
+                    *outL++ += l;
+                    *outR++ += r;
+                }
+                else
+                {
+                    *outL++ += (l + r) * 0.5f;
+                }
+            }
+
+            sourceSamplePosition += pitchRatio;
+
+            if (sourceSamplePosition > length || ! adsr.isActive())
+            {
+                stopNote (0.0f, false);
+                break;
+            }
+        }
+
+        if (numUnderruns > 0)
+            underrunSamples += numUnderruns;
+
+        playPosition = (int64) sourceSamplePosition;
+    }
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class StreamingSamplerTests  : public UnitTest
+{
+public:
+    StreamingSamplerTests()  : UnitTest ("Streaming sampler", UnitTestCategories::audio) {}
+
+    void runTest() override
+    {
+        const double sampleRate = 44100.0;
+        const int numSamples = 200000, blockSize = 512;
+
+        TemporaryFile tempFile (".wav");
+        writeTestFile (tempFile.getFile(), sampleRate, numSamples);
+
+        WavAudioFormat wavFormat;
+
+        beginTest ("Streamed output matches a fully loaded sample");
+        {
+            for (auto useMemoryMapping : { true, false })
+            {
+                for (auto note : { 60, 67, 53 })
+                {
+                    StreamingSamplerPool pool;
+                    auto reference = renderReference (wavFormat, tempFile.getFile(), note, sampleRate, blockSize);
+
+                    Synthesiser synth;
+                    auto* voice = new StreamingSamplerVoice (pool, 16384);
+                    synth.addVoice (voice);
+                    synth.setCurrentPlaybackSampleRate (sampleRate);
+                    synth.addSound (new StreamingSamplerSound (pool, "test", createReader (wavFormat, tempFile.getFile(), useMemoryMapping),
+                                                               allNotes(), 60, 0.0, 0.0, 4096));
+
+                    AudioBuffer<float> output (2, reference.getNumSamples());
+                    output.clear();
+
+                    for (int pos = 0; pos < output.getNumSamples(); pos += blockSize)
+                    {
+                        // make sure the reader threads have had a chance to stream the next chunk
+                        for (int i = 0; i < 50 && voice->getNumBufferedSamples() < 4 * blockSize; ++i)
+                            Thread::sleep (1);
+
+                        MidiBuffer midi;
+
+                        if (pos == 0)
+                            midi.addEvent (MidiMessage::noteOn (1, note, 1.0f), 0);
+
+                        auto num = jmin (blockSize, output.getNumSamples() - pos);
+                        synth.renderNextBlock (output, midi, pos, num);
+                    }
+
+                    expectEquals (voice->getNumUnderrunSamples(), (int64) 0);
+                    expect (voice->getNumSamplesStreamed() > 0);
+                    expect (! voice->isVoiceActive());
+
+                    for (int ch = 0; ch < 2; ++ch)
+                        for (int i = 0; i < output.getNumSamples(); ++i)
+                            if (std::abs (output.getSample (ch, i) - reference.getSample (ch, i)) > 1.0e-6f)
+                                expectEquals (output.getSample (ch, i), reference.getSample (ch, i));
+                }
+            }
+        }
+
+        beginTest ("Underruns are silenced and counted");
+        {
+            StreamingSamplerPool pool (1);
+
+            Synthesiser synth;
+            auto* voice = new StreamingSamplerVoice (pool, 16384);
+            synth.addVoice (voice);
+            synth.setCurrentPlaybackSampleRate (sampleRate);
+            synth.addSound (new StreamingSamplerSound (pool, "slow", new SlowReader (sampleRate, numSamples),
+                                                       allNotes(), 60, 0.0, 0.0, 1000));
+
+            AudioBuffer<float> output (2, 4096);
+            output.clear();
+
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 0);
+            synth.renderNextBlock (output, midi, 0, output.getNumSamples());
+
+            expect (voice->getNumUnderrunSamples() > 0);
+            expect (voice->getNumUnderrunSamples() <= output.getNumSamples() - 999);
+            expect (voice->isVoiceActive());
+            expectEquals (output.getSample (0, 500), 500.0f / (float) numSamples);
+            expectEquals (output.getSample (0, output.getNumSamples() - 1), 0.0f);
+
+            auto stats = pool.getStatistics();
+            expectEquals (stats.numVoices, 1);
+            expectEquals (stats.numStreamingVoices, 1);
+            expectEquals (stats.underrunSamples, voice->getNumUnderrunSamples());
+
+            voice->resetStatistics();
+            expectEquals (voice->getNumUnderrunSamples(), (int64) 0);
+
+            synth.allNotesOff (0, false);
+            expectEquals (pool.getStatistics().numStreamingVoices, 0);
+        }
+
+        beginTest ("Unused sounds are released");
+        {
+            StreamingSamplerPool pool (1);
+
+            {
+                StreamingSamplerSound::Ptr sound (new StreamingSamplerSound (pool, "test", createReader (wavFormat, tempFile.getFile(), true),
+                                                                             allNotes(), 60, 0.0, 0.0, 4096));
+                pool.releaseUnusedSounds();
+                expectEquals (pool.getStatistics().numSounds, 1);
+            }
+
+            pool.releaseUnusedSounds();
+            expectEquals (pool.getStatistics().numSounds, 0);
+        }
+    }
+
+private:
+    //==============================================================================
+    struct SlowReader  : public AudioFormatReader
+    {
+        SlowReader (double rate, int64 numSamples)  : AudioFormatReader (nullptr, "Slow")
+        {
+            sampleRate = rate;
+            lengthInSamples = numSamples;
+            numChannels = 1;
+            bitsPerSample = 32;
+            usesFloatingPointData = true;
+        }
+
+        bool readSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                          int64 startSampleInFile, int numSamples) override
+        {
+            if (startSampleInFile > 0)
+                Thread::sleep (100);
+
+            for (int ch = 0; ch < numDestChannels; ++ch)
+                if (auto* dest = reinterpret_cast<float*> (destSamples[ch]))
+                    for (int i = 0; i < numSamples; ++i)
+                        dest[startOffsetInDestBuffer + i] = (float) (startSampleInFile + i) / (float) lengthInSamples;
+
+            return true;
+        }
+    };
+
+    static BigInteger allNotes()
+    {
+        BigInteger notes;
+        notes.setRange (0, 128, true);
+        return notes;
+    }
+
+    static void writeTestFile (const File& file, double sampleRate, int numSamples)
+    {
+        AudioBuffer<float> data (2, numSamples);
+        Random random (1234);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            data.setSample (0, i, std::sin ((float) i * 0.01f) * 0.5f + (random.nextFloat() - 0.5f) * 0.1f);
+            data.setSample (1, i, std::cos ((float) i * 0.003f) * 0.5f);
+        }
+
+        std::unique_ptr<AudioFormatWriter> writer (WavAudioFormat().createWriterFor (new FileOutputStream (file),
+                                                                                    sampleRate, 2, 16, {}, 0));
+        writer->writeFromAudioSampleBuffer (data, 0, numSamples);
+    }
+
+    static AudioFormatReader* createReader (WavAudioFormat& format, const File& file, bool useMemoryMapping)
+    {
+        if (useMemoryMapping)
+            return format.createMemoryMappedReader (file);
+
+        return format.createReaderFor (new FileInputStream (file), true);
+    }
+
+    static AudioBuffer<float> renderReference (WavAudioFormat& format, const File& file, int note,
+                                               double sampleRate, int blockSize)
+    {
+        std::unique_ptr<AudioFormatReader> reader (createReader (format, file, false));
+
+        Synthesiser synth;
+        synth.addVoice (new SamplerVoice());
+        synth.setCurrentPlaybackSampleRate (sampleRate);
+        synth.addSound (new SamplerSound ("test", *reader, allNotes(), 60, 0.0, 0.0, 10.0));
+
+        auto length = (int) (reader->lengthInSamples / std::pow (2.0, (note - 60) / 12.0)) + blockSize;
+        AudioBuffer<float> output (2, length);
+        output.clear();
+
+        for (int pos = 0; pos < length; pos += blockSize)
+        {
+            MidiBuffer midi;
+
+            if (pos == 0)
+                midi.addEvent (MidiMessage::noteOn (1, note, 1.0f), 0);
+
+            synth.renderNextBlock (output, midi, pos, jmin (blockSize, length - pos));
+        }
+
+        return output;
+    }
+};
+
+static StreamingSamplerTests streamingSamplerTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,285 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+class StreamingSamplerSound;
+class StreamingSamplerVoice;
+
+//==============================================================================
+/**
+    A set of background threads which stream sample data from disk for
+    StreamingSamplerVoices.
+
+    Each voice has its own look-ahead buffer, and whenever a thread becomes free it
+    services the playing voice that is closest to running out of data, taking into
+    account how quickly the voice is consuming its sample. This means that a voice
+    playing a high note, or one that has just been triggered, gets priority over
+    voices which still have plenty of data buffered.
+
+    The pool also keeps a reference to every StreamingSamplerSound that is created
+    with it, so that a sound can't be deleted while one of the threads is reading from
+    it. Sounds which are no longer used by anything else are released periodically.
+
+    The pool must outlive all the voices and sounds that use it.
+
+    @see StreamingSamplerSound, StreamingSamplerVoice
+
+    @tags{Audio}
+*/
+class JUCE_API  StreamingSamplerPool
+{
+public:
+    //==============================================================================
+    /** Creates a pool with the given number of reader threads. */
+    StreamingSamplerPool (int numThreads = 2);
+
+    /** Destructor. */
+    ~StreamingSamplerPool();
+
+    //==============================================================================
+    /** A summary of the pool's streaming activity. */
+    struct Statistics
+    {
+        int numVoices = 0;                  /**< The number of voices using this pool. */
+        int numStreamingVoices = 0;         /**< The number of voices currently streaming. */
+        int numSounds = 0;                  /**< The number of sounds held by the pool. */
+        int64 samplesStreamed = 0;          /**< The total number of samples read from disk. */
+        int64 underrunSamples = 0;          /**< The number of output samples that were silenced because data wasn't ready in time. */
+        int minimumBufferedSamples = 0;     /**< The smallest amount of data that any streaming voice had buffered. */
+    };
+
+    /** Returns the current statistics. */
+    Statistics getStatistics() const;
+
+    /** Releases any sounds which are no longer referenced by anything other than this pool.
+        This is also done periodically by the pool's threads.
+    */
+    void releaseUnusedSounds();
+
+private:
+    //==============================================================================
+    friend class StreamingSamplerSound;
+    friend class StreamingSamplerVoice;
+    class ReaderThread;
+
+    CriticalSection lock;
+    Array<StreamingSamplerVoice*> voices;
+    ReferenceCountedArray<StreamingSamplerSound> sounds;
+    OwnedArray<ReaderThread> threads;
+    WaitableEvent workAvailable;
+
+    void addVoice (StreamingSamplerVoice*);
+    void removeVoice (StreamingSamplerVoice*);
+    void addSound (StreamingSamplerSound*);
+    StreamingSamplerVoice* claimMostUrgentVoice();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StreamingSamplerPool)
+};
+
+//==============================================================================
+/**
+    A SynthesiserSound that plays a sample which is streamed from disk.
+
+    Only the first part of the sample is loaded into memory. This must be long enough
+    to cover the time it takes the pool's threads to start streaming the rest, once a
+    note has been triggered.
+
+    If the reader is a MemoryMappedAudioFormatReader, the sample data is read directly
+    from the mapped file, and several voices can stream from it at once. Other types of
+    reader are shared between the voices using a lock, which is only ever taken on the
+    pool's threads.
+
+    @see StreamingSamplerVoice, StreamingSamplerPool, SamplerSound
+
+    @tags{Audio}
+*/
+class JUCE_API  StreamingSamplerSound    : public SynthesiserSound
+{
+public:
+    //==============================================================================
+    /** Creates a sound.
+
+        @param pool                     the pool that will stream this sound's data
+        @param name                     a name for the sample
+        @param source                   the reader to stream the sample from. The sound
+                                        takes ownership of this object.
+        @param midiNotes                the set of midi keys that this sound should be played on
+        @param midiNoteForNormalPitch   the midi note at which the sample should be played
+                                        with its natural rate
+        @param attackTimeSecs           the attack (fade-in) time, in seconds
+        @param releaseTimeSecs          the decay (fade-out) time, in seconds
+        @param numSamplesToPreload      the number of samples from the start of the file
+                                        to keep in memory
+    */
+    StreamingSamplerSound (StreamingSamplerPool& pool,
+                           const String& name,
+                           AudioFormatReader* source,
+                           const BigInteger& midiNotes,
+                           int midiNoteForNormalPitch,
+                           double attackTimeSecs,
+                           double releaseTimeSecs,
+                           int numSamplesToPreload = 32768);
+
+    /** Destructor. */
+    ~StreamingSamplerSound() override;
+
+    //==============================================================================
+    /** Returns the sample's name */
+    const String& getName() const noexcept                  { return name; }
+
+    /** Returns the total length of the sample, in samples. */
+    int64 getLengthInSamples() const noexcept               { return length; }
+
+    /** Returns the number of samples that are held in memory. */
+    int getNumPreloadedSamples() const noexcept             { return preloadLength; }
+
+    /** Changes the parameters of the ADSR envelope which will be applied to the sample. */
+    void setEnvelopeParameters (ADSR::Parameters parametersToUse)    { params = parametersToUse; }
+
+    //==============================================================================
+    bool appliesToNote (int midiNoteNumber) override;
+    bool appliesToChannel (int midiChannel) override;
+
+private:
+    //==============================================================================
+    friend class StreamingSamplerVoice;
+
+    String name;
+    std::unique_ptr<AudioFormatReader> reader;
+    CriticalSection readerLock;
+    bool readerIsThreadSafe = false;
+    AudioBuffer<float> preload;
+    double sourceSampleRate;
+    BigInteger midiNotes;
+    int64 length = 0;
+    int preloadLength = 0, midiRootNote = 0, numChannels = 0;
+
+    ADSR::Parameters params;
+
+    void read (float* const* dest, int64 startSample, int numSamples);
+
+    JUCE_LEAK_DETECTOR (StreamingSamplerSound)
+};
+
+//==============================================================================
+/**
+    A SynthesiserVoice that plays a StreamingSamplerSound.
+
+    Each voice has a look-ahead buffer which is filled by the StreamingSamplerPool's
+    threads while the voice plays. The audio thread never blocks: if the data for a
+    sample isn't ready in time, the voice outputs silence for it and counts it as an
+    underrun.
+
+    @see StreamingSamplerSound, StreamingSamplerPool, SamplerVoice
+
+    @tags{Audio}
+*/
+class JUCE_API  StreamingSamplerVoice    : public SynthesiserVoice
+{
+public:
+    //==============================================================================
+    /** Creates a voice.
+
+        The look-ahead size is the number of samples that can be buffered ahead of the
+        play position, and is rounded up to a power of two.
+    */
+    StreamingSamplerVoice (StreamingSamplerPool& pool, int lookAheadSamples = 65536);
+
+    /** Destructor. */
+    ~StreamingSamplerVoice() override;
+
+    //==============================================================================
+    /** Returns the size of this voice's look-ahead buffer. */
+    int getLookAheadSize() const noexcept                   { return ringSize; }
+
+    /** Returns the number of samples that are currently buffered ahead of the play position. */
+    int getNumBufferedSamples() const noexcept;
+
+    /** Returns the number of output samples that this voice has had to silence because
+        the data wasn't streamed in time.
+    */
+    int64 getNumUnderrunSamples() const noexcept            { return underrunSamples.load(); }
+
+    /** Returns the number of samples that have been streamed from disk for this voice. */
+    int64 getNumSamplesStreamed() const noexcept            { return samplesStreamed.load(); }
+
+    /** Resets the underrun and streaming counters. */
+    void resetStatistics() noexcept;
+
+    //==============================================================================
+    bool canPlaySound (SynthesiserSound*) override;
+
+    void startNote (int midiNoteNumber, float velocity, SynthesiserSound*, int pitchWheel) override;
+    void stopNote (float velocity, bool allowTailOff) override;
+
+    void pitchWheelMoved (int newValue) override;
+    void controllerMoved (int controllerNumber, int newValue) override;
+
+    void renderNextBlock (AudioBuffer<float>&, int startSample, int numSamples) override;
+    void renderNextBlock (AudioBuffer<double>&, int startSample, int numSamples) override;
+
+private:
+    //==============================================================================
+    friend class StreamingSamplerPool;
+
+    StreamingSamplerPool& pool;
+    AudioBuffer<float> ring;
+    int ringSize, ringMask;
+
+    // The streaming state packs a generation count, an "active" flag and the end of
+    // the valid data in the ring into one word, so that a reader thread can publish
+    // new data with a single compare-and-swap that fails if the note has changed.
+    std::atomic<uint64> streamState { 0 };
+    std::atomic<StreamingSamplerSound*> streamingSound { nullptr };
+    std::atomic<int64> playPosition { 0 };
+    std::atomic<float> consumptionRate { 1.0f };
+    std::atomic<bool> beingServiced { false };
+    std::atomic<int64> underrunSamples { 0 }, samplesStreamed { 0 };
+
+    // These are only used by the reader thread which has claimed the voice
+    StreamingSamplerSound* servicedSound = nullptr;
+    uint64 servicedState = 0;
+
+    double pitchRatio = 0;
+    double sourceSamplePosition = 0;
+    float lgain = 0, rgain = 0;
+
+    ADSR adsr;
+
+    void stopStreaming() noexcept;
+    bool needsData (int minimumReadSize) const noexcept;
+    double getSecondsUntilUnderrun() const noexcept;
+    void fillBuffer (int maximumReadSize);
+
+    template <typename FloatType>
+    void renderBlock (AudioBuffer<FloatType>&, int startSample, int numSamples);
+
+    JUCE_LEAK_DETECTOR (StreamingSamplerVoice)
+};
+
+} // namespace juce
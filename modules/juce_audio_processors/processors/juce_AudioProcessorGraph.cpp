@@ -27,6 +27,157 @@
 namespace juce
 {
 
+//==============================================================================
+/*  These move MIDI between the graph's buffers on the audio thread.
+
+    MidiBuffer::operator= always reallocates, and MidiBuffer::addEvents() searches
+    from the start of the buffer for every event it inserts, so instead these work
+    directly on the buffers' sorted raw data.
+
+    The graph's own buffers are all given the same fixed capacity when it's prepared,
+    and as cleared buffers keep their storage, writing into them never allocates. If
+    there's more MIDI in a block than will fit, the events that don't fit are dropped.
+*/
+struct GraphMidiBufferOps
+{
+    static int getEventTime (const uint8* d) noexcept       { return readUnaligned<int32> (d); }
+
+    static int getEventTotalSize (const uint8* d) noexcept
+    {
+        return (int) (readUnaligned<uint16> (d + sizeof (int32)) + sizeof (int32) + sizeof (uint16));
+    }
+
+    // Room for 32 three-byte messages on every sample, which is far more than a real MIDI
+    // stream will ever contain, but leaves space for the events of many sources to be merged.
+    static int getBufferCapacity (int blockSize) noexcept
+    {
+        return jmax (512, blockSize * 32 * (int) (sizeof (int32) + sizeof (uint16) + 3));
+    }
+
+    // Returns the end of the events from start that will fit in numBytesFree.
+    static const uint8* findEndOfEventsThatFit (const uint8* start, const uint8* end, int numBytesFree) noexcept
+    {
+        if (end - start <= numBytesFree)
+            return end;
+
+        auto* fitEnd = start;
+
+        while (fitEnd < end && (fitEnd - start) + getEventTotalSize (fitEnd) <= numBytesFree)
+            fitEnd += getEventTotalSize (fitEnd);
+
+        // There's more MIDI in this block than the graph's buffers were prepared for, so
+        // rather than allocating more space on the audio thread, some of it is dropped.
+        jassertfalse;
+        return fitEnd;
+    }
+
+    // Copies source into dest, which has space for capacity bytes
+    static void copy (const MidiBuffer& source, MidiBuffer& dest, int capacity)
+    {
+        auto* start = source.data.begin();
+
+        dest.data.clearQuick();
+        dest.data.addArray (start, (int) (findEndOfEventsThatFit (start, source.data.end(), capacity) - start));
+    }
+
+    // Finds the range of events with timestamps between 0 and numSamples - 1
+    static void findEventsInBlock (const MidiBuffer& buffer, int numSamples, const uint8*& start, const uint8*& blockEnd) noexcept
+    {
+        start = buffer.data.begin();
+        auto* end = buffer.data.end();
+
+        while (start < end && getEventTime (start) < 0)
+            start += getEventTotalSize (start);
+
+        blockEnd = start;
+
+        while (blockEnd < end && getEventTime (blockEnd) < numSamples)
+            blockEnd += getEventTotalSize (blockEnd);
+    }
+
+    // Copies only the events with timestamps between 0 and numSamples - 1
+    static void copyBlock (const MidiBuffer& source, MidiBuffer& dest, int numSamples)
+    {
+        const uint8* start;
+        const uint8* end;
+        findEventsInBlock (source, numSamples, start, end);
+
+        dest.data.clearQuick();
+        dest.data.addArray (start, (int) (end - start));
+    }
+
+    /*  Merges the events from source with timestamps between 0 and numSamples - 1 into
+        dest, using scratch as working space. This matches MidiBuffer::addEvents (source,
+        0, numSamples, 0), so events already in dest come before any source events with
+        the same timestamp.
+
+        Both dest and scratch must have space for capacity bytes, and any source events
+        that won't fit alongside the ones already in dest are dropped.
+    */
+    static void merge (const MidiBuffer& source, MidiBuffer& dest, MidiBuffer& scratch, int numSamples, int capacity)
+    {
+        const uint8* b;
+        const uint8* bEnd;
+        findEventsInBlock (source, numSamples, b, bEnd);
+        bEnd = findEndOfEventsThatFit (b, bEnd, jmax (0, capacity - dest.data.size()));
+
+        if (b == bEnd)
+            return;
+
+        if (dest.isEmpty())
+        {
+            dest.data.clearQuick();
+            dest.data.addArray (b, (int) (bEnd - b));
+            return;
+        }
+
+        const uint8* a = dest.data.begin();
+        const uint8* aEnd = dest.data.end();
+
+        scratch.data.clearQuick();
+        scratch.data.resize (dest.data.size() + (int) (bEnd - b));
+        auto* out = scratch.data.begin();
+
+        auto copyRun = [&out] (const uint8*& start, const uint8* end)
+        {
+            auto numBytes = (size_t) (end - start);
+            memcpy (out, start, numBytes);
+            out += numBytes;
+            start = end;
+        };
+
+        while (a < aEnd && b < bEnd)
+        {
+            // copy the longest possible runs from each buffer rather than single events
+            auto* runEnd = a;
+            auto bTime = getEventTime (b);
+
+            while (runEnd < aEnd && getEventTime (runEnd) <= bTime)
+                runEnd += getEventTotalSize (runEnd);
+
+            copyRun (a, runEnd);
+
+            if (a == aEnd)
+                break;
+
+            auto aTime = getEventTime (a);
+            runEnd = b;
+
+            while (runEnd < bEnd && getEventTime (runEnd) < aTime)
+                runEnd += getEventTotalSize (runEnd);
+
+            copyRun (b, runEnd);
+        }
+
+        copyRun (a, aEnd);
+        copyRun (b, bEnd);
+
+        jassert (out == scratch.data.end());
+        dest.swapWith (scratch);
+    }
+};
+
+//==============================================================================
 template <typename FloatType>
 struct GraphRenderSequence
 {
@@ -36,6 +187,8 @@ struct GraphRenderSequence
     {
         FloatType** audioBuffers;
         MidiBuffer* midiBuffers;
+        MidiBuffer* midiScratchBuffer;
+        int midiBufferCapacity;
         AudioPlayHead* audioPlayHead;
         int numSamples;
     };
@@ -72,7 +225,8 @@ struct GraphRenderSequence
         currentMidiOutputBuffer.clear();
 
         {
-            const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(), audioPlayHead, numSamples };
+            const Context context { renderingBuffer.getArrayOfWritePointers(), midiBuffers.begin(),
+                                    &midiScratchBuffer, midiBufferCapacity, audioPlayHead, numSamples };
 
             for (auto* op : renderOps)
                 op->perform (context);
@@ -81,8 +235,7 @@ struct GraphRenderSequence
         for (int i = 0; i < buffer.getNumChannels(); ++i)
             buffer.copyFrom (i, 0, currentAudioOutputBuffer, i, 0, numSamples);
 
-        midiMessages.clear();
-        midiMessages.addEvents (currentMidiOutputBuffer, 0, buffer.getNumSamples(), 0);
+        GraphMidiBufferOps::copyBlock (currentMidiOutputBuffer, midiMessages, numSamples);
         currentAudioInputBuffer = nullptr;
     }
 
@@ -112,13 +265,18 @@ struct GraphRenderSequence
 
     void addCopyMidiBufferOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex] = c.midiBuffers[srcIndex]; });
+        createOp ([=] (const Context& c)    { GraphMidiBufferOps::copy (c.midiBuffers[srcIndex],
+                                                                        c.midiBuffers[dstIndex],
+                                                                        c.midiBufferCapacity); });
     }
 
     void addAddMidiBufferOp (int srcIndex, int dstIndex)
     {
-        createOp ([=] (const Context& c)    { c.midiBuffers[dstIndex].addEvents (c.midiBuffers[srcIndex],
-                                                                                 0, c.numSamples, 0); });
+        createOp ([=] (const Context& c)    { GraphMidiBufferOps::merge (c.midiBuffers[srcIndex],
+                                                                         c.midiBuffers[dstIndex],
+                                                                         *c.midiScratchBuffer,
+                                                                         c.numSamples,
+                                                                         c.midiBufferCapacity); });
     }
 
     void addDelayChannelOp (int chan, int delaySize)
@@ -146,12 +304,16 @@ struct GraphRenderSequence
         midiBuffers.clearQuick();
         midiBuffers.resize (numMidiBuffersNeeded);
 
-        const int defaultMIDIBufferSize = 512;
+        // Buffers get swapped with the scratch buffer when they're merged, so all of them need
+        // the same amount of space to avoid having to allocate on the audio thread
+        midiBufferCapacity = GraphMidiBufferOps::getBufferCapacity (blockSize);
 
-        midiChunk.ensureSize (defaultMIDIBufferSize);
+        midiChunk.ensureSize ((size_t) midiBufferCapacity);
+        midiScratchBuffer.ensureSize ((size_t) midiBufferCapacity);
+        currentMidiOutputBuffer.ensureSize ((size_t) midiBufferCapacity);
 
         for (auto&& m : midiBuffers)
-            m.ensureSize (defaultMIDIBufferSize);
+            m.ensureSize ((size_t) midiBufferCapacity);
     }
 
     void releaseBuffers()
@@ -164,7 +326,7 @@ struct GraphRenderSequence
         midiBuffers.clear();
     }
 
-    int numBuffersNeeded = 0, numMidiBuffersNeeded = 0;
+    int numBuffersNeeded = 0, numMidiBuffersNeeded = 0, midiBufferCapacity = 0;
 
     AudioBuffer<FloatType> renderingBuffer, currentAudioOutputBuffer;
     AudioBuffer<FloatType>* currentAudioInputBuffer = nullptr;
@@ -173,7 +335,7 @@ struct GraphRenderSequence
     MidiBuffer currentMidiOutputBuffer;
 
     Array<MidiBuffer> midiBuffers;
-    MidiBuffer midiChunk;
+    MidiBuffer midiChunk, midiScratchBuffer;
 
 private:
     //==============================================================================
@@ -578,7 +740,8 @@ struct RenderSequenceBuilder
 
             if (midiBufferToUse >= 0)
             {
-                if (isBufferNeededLater (ourRenderingIndex, AudioProcessorGraph::midiChannelIndex, src))
+                if (isBufferNeededLater (ourRenderingIndex, AudioProcessorGraph::midiChannelIndex, src)
+                     && ! onlyReadsMidi (node))
                 {
                     // can't mess up this channel because it's needed later by another node, so we
                     // need to use a copy of it..
@@ -689,6 +852,16 @@ struct RenderSequenceBuilder
         sequence.addProcessOp (node, audioChannelsToUse, totalChans, midiBufferToUse);
     }
 
+    // Nodes which never modify the MIDI buffer they're given can share a read-only view
+    // of their source's buffer, rather than needing their own copy of it
+    static bool onlyReadsMidi (AudioProcessorGraph::Node& node)
+    {
+        if (auto* ioProc = dynamic_cast<AudioProcessorGraph::AudioGraphIOProcessor*> (node.getProcessor()))
+            return ioProc->getType() == AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode;
+
+        return false;
+    }
+
     //==============================================================================
     Array<AudioProcessorGraph::NodeAndChannel> getSourcesForChannel (AudioProcessorGraph::Node& node, int inputChannelIndex)
     {
@@ -1435,11 +1608,13 @@ static void processIOBlock (AudioProcessorGraph::AudioGraphIOProcessor& io, Sequ
         }
 
         case AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode:
-            sequence.currentMidiOutputBuffer.addEvents (midiMessages, 0, buffer.getNumSamples(), 0);
+            GraphMidiBufferOps::merge (midiMessages, sequence.currentMidiOutputBuffer, sequence.midiScratchBuffer,
+                                       buffer.getNumSamples(), sequence.midiBufferCapacity);
             break;
 
         case AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode:
-            midiMessages.addEvents (*sequence.currentMidiInputBuffer, 0, buffer.getNumSamples(), 0);
+            GraphMidiBufferOps::merge (*sequence.currentMidiInputBuffer, midiMessages, sequence.midiScratchBuffer,
+                                       buffer.getNumSamples(), sequence.midiBufferCapacity);
             break;
 
         default:
@@ -1505,4 +1680,192 @@ void AudioProcessorGraph::AudioGraphIOProcessor::setParentGraph (AudioProcessorG
     }
 }
 
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorGraphMidiTests  : public UnitTest
+{
+public:
+    AudioProcessorGraphMidiTests()
+        : UnitTest ("AudioProcessorGraph MIDI routing", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Fan-out and merging");
+        {
+            AudioProcessorGraph graph;
+            auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode));
+            auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode));
+            auto a = graph.addNode (std::make_unique<MidiMarkerProcessor> (1));
+            auto b = graph.addNode (std::make_unique<MidiMarkerProcessor> (2));
+
+            for (auto& c : { Connection ({ input->nodeID,  midiChannel }, { a->nodeID,      midiChannel }),
+                             Connection ({ input->nodeID,  midiChannel }, { b->nodeID,      midiChannel }),
+                             Connection ({ input->nodeID,  midiChannel }, { output->nodeID, midiChannel }),
+                             Connection ({ a->nodeID,      midiChannel }, { output->nodeID, midiChannel }),
+                             Connection ({ b->nodeID,      midiChannel }, { output->nodeID, midiChannel }) })
+                expect (graph.addConnection (c));
+
+            graph.setPlayConfigDetails (0, 0, 44100.0, blockSize);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            for (int block = 0; block < 4; ++block)
+            {
+                auto midi = createInput (100);
+                AudioBuffer<float> audio (1, blockSize);
+
+                graph.processBlock (audio, midi);
+
+                // each input event arrives through all three paths, plus one marker from each processor
+                expectEquals (midi.getNumEvents(), 3 * 100 + 2);
+                expect (isSorted (midi));
+                expectEquals (countNotes (midi, 1), 1);
+                expectEquals (countNotes (midi, 2), 1);
+            }
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Events outside the block are ignored");
+        {
+            AudioProcessorGraph graph;
+            auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode));
+            auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode));
+            auto marker = std::make_unique<MidiMarkerProcessor> (1);
+            auto* markerProcessor = marker.get();
+            auto a = graph.addNode (std::move (marker));
+
+            for (auto& c : { Connection ({ input->nodeID,  midiChannel }, { a->nodeID,      midiChannel }),
+                             Connection ({ input->nodeID,  midiChannel }, { output->nodeID, midiChannel }),
+                             Connection ({ a->nodeID,      midiChannel }, { output->nodeID, midiChannel }) })
+                expect (graph.addConnection (c));
+
+            graph.setPlayConfigDetails (0, 0, 44100.0, blockSize);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            MidiBuffer midi;
+
+            for (int time : { -10, 0, (int) blockSize - 1, (int) blockSize, (int) blockSize + 50 })
+                midi.addEvent (MidiMessage::controllerEvent (1, 1, 0), time);
+
+            AudioBuffer<float> audio (1, blockSize);
+            graph.processBlock (audio, midi);
+
+            expectEquals (markerProcessor->numEventsReceived, 2);
+            expectEquals (midi.getNumEvents(), 2 * 2 + 1);
+            expect (isSorted (midi));
+
+            graph.releaseResources();
+        }
+
+        beginTest ("Heavy MIDI traffic benchmark");
+        {
+            const int numProcessors = 16, numEventsPerBlock = 1000, numBlocks = 50;
+
+            AudioProcessorGraph graph;
+            auto input  = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::midiInputNode));
+            auto output = graph.addNode (std::make_unique<AudioProcessorGraph::AudioGraphIOProcessor> (AudioProcessorGraph::AudioGraphIOProcessor::midiOutputNode));
+
+            for (int i = 0; i < numProcessors; ++i)
+            {
+                auto node = graph.addNode (std::make_unique<MidiMarkerProcessor> (i + 1));
+                graph.addConnection ({ { input->nodeID, midiChannel }, { node->nodeID,   midiChannel } });
+                graph.addConnection ({ { node->nodeID,  midiChannel }, { output->nodeID, midiChannel } });
+            }
+
+            graph.setPlayConfigDetails (0, 0, 44100.0, blockSize);
+            graph.prepareToPlay (44100.0, blockSize);
+
+            AudioBuffer<float> audio (1, blockSize);
+            auto inputEvents = createInput (numEventsPerBlock);
+            MidiBuffer midi;
+            midi.ensureSize ((size_t) inputEvents.data.size() * (numProcessors + 2));
+
+            double totalSeconds = 0;
+
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                midi.clear();
+                midi.addEvents (inputEvents, 0, -1, 0);
+
+                auto startTime = Time::getHighResolutionTicks();
+                graph.processBlock (audio, midi);
+                totalSeconds += Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - startTime);
+
+                expectEquals (midi.getNumEvents(), numProcessors * (numEventsPerBlock + 1));
+                expect (isSorted (midi));
+            }
+
+            logMessage ("MIDI graph with " + String (numProcessors) + " nodes and " + String (numEventsPerBlock)
+                         + " events per block: " + String (totalSeconds * 1.0e6 / numBlocks, 1) + " microseconds per block");
+
+            graph.releaseResources();
+        }
+    }
+
+private:
+    using Connection = AudioProcessorGraph::Connection;
+    enum { midiChannel = AudioProcessorGraph::midiChannelIndex, blockSize = 512 };
+
+    // Passes its MIDI through, adding a note-on with its own note number half-way through the block
+    struct MidiMarkerProcessor  : public TestAudioProcessor
+    {
+        MidiMarkerProcessor (int note)  : TestAudioProcessor ("MIDI Marker", BusesProperties()), noteNumber (note) {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midiMessages) override
+        {
+            numEventsReceived = midiMessages.getNumEvents();
+            midiMessages.addEvent (MidiMessage::noteOn (16, noteNumber, 1.0f), buffer.getNumSamples() / 2);
+        }
+
+        const int noteNumber;
+        int numEventsReceived = 0;
+    };
+
+    static MidiBuffer createInput (int numEvents)
+    {
+        MidiBuffer buffer;
+
+        for (int i = 0; i < numEvents; ++i)
+            buffer.addEvent (MidiMessage::controllerEvent (1, 1, i % 128), (i * blockSize) / numEvents);
+
+        return buffer;
+    }
+
+    static bool isSorted (const MidiBuffer& buffer)
+    {
+        MidiBuffer::Iterator iter (buffer);
+        MidiMessage message;
+        int position, lastPosition = -1;
+
+        while (iter.getNextEvent (message, position))
+        {
+            if (position < lastPosition || position >= blockSize)
+                return false;
+
+            lastPosition = position;
+        }
+
+        return true;
+    }
+
+    static int countNotes (const MidiBuffer& buffer, int noteNumber)
+    {
+        MidiBuffer::Iterator iter (buffer);
+        MidiMessage message;
+        int position, count = 0;
+
+        while (iter.getNextEvent (message, position))
+            if (message.isNoteOn() && message.getNoteNumber() == noteNumber)
+                ++count;
+
+        return count;
+    }
+};
+
+static AudioProcessorGraphMidiTests audioProcessorGraphMidiTests;
+
+#endif
+
 } // namespace juce
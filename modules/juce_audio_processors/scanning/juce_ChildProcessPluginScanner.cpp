@@ -0,0 +1,336 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace PluginScannerMessages
+{
+    static MemoryBlock toMemoryBlock (const XmlElement& xml)
+    {
+        MemoryOutputStream mo;
+        xml.writeTo (mo, XmlElement::TextFormat().withoutHeader().singleLine());
+        return mo.getMemoryBlock();
+    }
+
+    static std::unique_ptr<XmlElement> fromMemoryBlock (const MemoryBlock& mb)
+    {
+        return parseXML (mb.toString());
+    }
+}
+
+//==============================================================================
+struct ChildProcessPluginScanner::Worker  : public ChildProcessMaster
+{
+    Worker (ChildProcessPluginScanner& s)  : owner (s) {}
+
+    ~Worker() override
+    {
+        killSlaveProcess();
+    }
+
+    // (Re)launches the child if it isn't running, including when it has died since
+    // it was last used.
+    bool ensureRunning()
+    {
+        if (! isRunning || connectionLost)
+        {
+            connectionLost = false;
+            isRunning = launchSlaveProcess (owner.executable, owner.uniqueID, 0, 0);
+        }
+
+        return isRunning;
+    }
+
+    // Sends a request to the child, restarting it once if the message can't be sent,
+    // as the child may have died while it was idle without that being noticed yet.
+    bool sendRequest (const XmlElement& request)
+    {
+        auto message = PluginScannerMessages::toMemoryBlock (request);
+
+        for (int attempt = 0; attempt < 2; ++attempt)
+        {
+            if (ensureRunning() && sendMessageToSlave (message))
+                return true;
+
+            stop();
+        }
+
+        return false;
+    }
+
+    void stop()
+    {
+        killSlaveProcess();
+        isRunning = false;
+    }
+
+    void handleMessageFromSlave (const MemoryBlock& mb) override
+    {
+        if (auto xml = PluginScannerMessages::fromMemoryBlock (mb))
+        {
+            if (xml->hasTagName ("RESULT") && xml->getIntAttribute ("id") == requestID.get())
+            {
+                {
+                    const ScopedLock sl (replyLock);
+                    reply = std::move (xml);
+                }
+
+                replyReceived.signal();
+            }
+        }
+    }
+
+    void handleConnectionLost() override
+    {
+        connectionLost = true;
+        replyReceived.signal();
+    }
+
+    std::unique_ptr<XmlElement> takeReply()
+    {
+        const ScopedLock sl (replyLock);
+        return std::move (reply);
+    }
+
+    ChildProcessPluginScanner& owner;
+    Atomic<int> requestID;
+    std::atomic<bool> connectionLost { false };
+    bool isRunning = false, isBusy = false;
+
+    CriticalSection replyLock;
+    std::unique_ptr<XmlElement> reply;
+    WaitableEvent replyReceived;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+};
+
+//==============================================================================
+ChildProcessPluginScanner::ChildProcessPluginScanner (const File& exe, const String& commandLineUniqueID,
+                                                      int numProcesses, int timeoutMsPerPlugin)
+    : executable (exe), uniqueID (commandLineUniqueID), timeoutMs (timeoutMsPerPlugin)
+{
+    jassert (numProcesses > 0);
+
+    for (int i = jmax (1, numProcesses); --i >= 0;)
+        workers.add (new Worker (*this));
+}
+
+ChildProcessPluginScanner::~ChildProcessPluginScanner()
+{
+    // Make sure no scans are still in progress when this gets deleted!
+    jassert ([this] { for (auto* w : workers) if (w->isBusy) return false; return true; }());
+
+    workers.clear();
+}
+
+ChildProcessPluginScanner::Worker* ChildProcessPluginScanner::acquireWorker()
+{
+    for (;;)
+    {
+        {
+            const ScopedLock sl (workerLock);
+
+            for (auto* w : workers)
+            {
+                if (! w->isBusy)
+                {
+                    w->isBusy = true;
+                    return w;
+                }
+            }
+        }
+
+        if (shouldExit())
+            return nullptr;
+
+        workerFreed.wait (100);
+    }
+}
+
+void ChildProcessPluginScanner::releaseWorker (Worker* w)
+{
+    {
+        const ScopedLock sl (workerLock);
+        w->isBusy = false;
+    }
+
+    workerFreed.signal();
+}
+
+bool ChildProcessPluginScanner::findPluginTypesFor (AudioPluginFormat& format,
+                                                    OwnedArray<PluginDescription>& result,
+                                                    const String& fileOrIdentifier)
+{
+    auto* worker = acquireWorker();
+
+    if (worker == nullptr)
+        return true;
+
+    struct WorkerReleaser
+    {
+        ~WorkerReleaser()  { scanner.releaseWorker (worker); }
+        ChildProcessPluginScanner& scanner;
+        Worker* worker;
+    };
+
+    const WorkerReleaser releaser { *this, worker };
+
+    XmlElement request ("SCAN");
+    request.setAttribute ("id", ++(worker->requestID));
+    request.setAttribute ("format", format.getName());
+    request.setAttribute ("identifier", fileOrIdentifier);
+
+    worker->replyReceived.reset();
+    worker->takeReply();
+
+    if (! worker->sendRequest (request))
+    {
+        // Couldn't launch a child process that would take the request - check that the
+        // executable calls ChildProcessPluginScannerSlave::initialiseFromCommandLine() with
+        // a matching ID! The file can't be loaded in this process instead, as that's what
+        // the child is there to prevent, so it's reported as having failed.
+        jassertfalse;
+        return false;
+    }
+
+    auto startTime = Time::getMillisecondCounter();
+
+    for (;;)
+    {
+        if (worker->replyReceived.wait (50))
+        {
+            if (auto reply = worker->takeReply())
+            {
+                forEachXmlChildElement (*reply, e)
+                {
+                    PluginDescription desc;
+
+                    if (desc.loadFromXml (*e))
+                        result.add (new PluginDescription (desc));
+                }
+
+                return true;
+            }
+
+            if (worker->connectionLost)
+            {
+                // The child process crashed while loading this plugin..
+                worker->stop();
+                return false;
+            }
+        }
+
+        if (shouldExit())
+        {
+            worker->stop();
+            return true;
+        }
+
+        if (Time::getMillisecondCounter() - startTime > (uint32) timeoutMs)
+        {
+            // The plugin has hung, so treat it as if it had crashed..
+            worker->stop();
+            return false;
+        }
+    }
+}
+
+void ChildProcessPluginScanner::scanFinished()
+{
+    const ScopedLock sl (workerLock);
+
+    for (auto* w : workers)
+        if (! w->isBusy)
+            w->stop();
+}
+
+//==============================================================================
+ChildProcessPluginScannerSlave::ChildProcessPluginScannerSlave()
+{
+    formatManager.addDefaultFormats();
+}
+
+ChildProcessPluginScannerSlave::~ChildProcessPluginScannerSlave() {}
+
+void ChildProcessPluginScannerSlave::handleMessageFromMaster (const MemoryBlock& mb)
+{
+    if (auto xml = PluginScannerMessages::fromMemoryBlock (mb))
+    {
+        if (xml->hasTagName ("SCAN"))
+        {
+            // Plug-ins generally expect to be created on the message thread..
+            std::shared_ptr<XmlElement> request (xml.release());
+            WeakReference<ChildProcessPluginScannerSlave> weakThis (this);
+
+            MessageManager::callAsync ([weakThis, request]
+            {
+                if (weakThis != nullptr)
+                    weakThis->scan (*request);
+            });
+        }
+    }
+}
+
+void ChildProcessPluginScannerSlave::handleConnectionLost()
+{
+    // There's nothing to tidy up in a scanner process, and its message thread may
+    // be stuck inside a plugin that has hung, so just get out as quickly as possible.
+    Process::terminate();
+}
+
+void ChildProcessPluginScannerSlave::scan (const XmlElement& request)
+{
+    XmlElement result ("RESULT");
+    result.setAttribute ("id", request.getIntAttribute ("id"));
+
+    auto formatName = request.getStringAttribute ("format");
+    auto fileOrIdentifier = request.getStringAttribute ("identifier");
+
+    OwnedArray<PluginDescription> found;
+    bool formatFound = false;
+
+    for (auto* format : formatManager.getFormats())
+    {
+        if (format->getName() == formatName)
+        {
+            format->findAllTypesForFile (found, fileOrIdentifier);
+            formatFound = true;
+            break;
+        }
+    }
+
+    // The master asked for a format that this process doesn't know about!
+    jassert (formatFound);
+    ignoreUnused (formatFound);
+
+    for (auto* desc : found)
+        result.addChildElement (desc->createXml().release());
+
+    sendMessageToMaster (PluginScannerMessages::toMemoryBlock (result));
+}
+
+} // namespace juce
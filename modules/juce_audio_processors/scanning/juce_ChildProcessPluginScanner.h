@@ -0,0 +1,147 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    A KnownPluginList::CustomScanner which loads each plug-in inside a pool of
+    child processes, so that a plug-in which crashes or hangs while it's being
+    scanned can't take down the host.
+
+    Each call to findPluginTypesFor() takes an idle child process from the pool
+    (launching it if needed), asks it to scan the file, and waits for its answer.
+    If the child crashes, or doesn't reply within the per-plugin timeout, it's
+    killed and replaced, and the file is reported as having crashed so that the
+    KnownPluginList will blacklist it. A child that dies while it's idle is just
+    relaunched, so that the next file isn't blamed for it. If a child can't be
+    launched at all, the file is reported as having crashed too, rather than being
+    loaded inside the host.
+
+    Because the calls are independent, a PluginDirectoryScanner whose list uses one
+    of these can have scanNextFile() called from as many threads as there are child
+    processes (e.g. via PluginListComponent::setNumberOfThreadsForScanning()), and
+    the results are merged into the KnownPluginList as each file completes.
+
+    The executable that gets launched must create a ChildProcessPluginScannerSlave
+    in its startup code - see that class for details. It can be the same executable
+    as the host itself.
+
+    @see ChildProcessPluginScannerSlave, PluginDirectoryScanner, KnownPluginList::setCustomScanner
+
+    @tags{Audio}
+*/
+class JUCE_API  ChildProcessPluginScanner  : public KnownPluginList::CustomScanner
+{
+public:
+    //==============================================================================
+    /** Creates a scanner.
+
+        @param executableToLaunch       the exe that will be launched to do the scanning
+        @param commandLineUniqueID      a short alphanumeric ID which must match the one
+                                        passed to ChildProcessPluginScannerSlave::initialiseFromCommandLine()
+        @param numProcesses             the maximum number of child processes to run at once
+        @param timeoutMsPerPlugin       how long a child is allowed to spend on a single file
+                                        before it's considered to have hung
+    */
+    ChildProcessPluginScanner (const File& executableToLaunch,
+                               const String& commandLineUniqueID,
+                               int numProcesses = SystemStats::getNumCpus(),
+                               int timeoutMsPerPlugin = 30000);
+
+    /** Destructor. This will kill any child processes that are still running. */
+    ~ChildProcessPluginScanner() override;
+
+    //==============================================================================
+    /** @internal */
+    bool findPluginTypesFor (AudioPluginFormat&, OwnedArray<PluginDescription>&, const String&) override;
+    /** @internal */
+    void scanFinished() override;
+
+private:
+    //==============================================================================
+    struct Worker;
+    friend struct Worker;
+
+    Worker* acquireWorker();
+    void releaseWorker (Worker*);
+
+    const File executable;
+    const String uniqueID;
+    const int timeoutMs;
+    OwnedArray<Worker> workers;
+    CriticalSection workerLock;
+    WaitableEvent workerFreed;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChildProcessPluginScanner)
+};
+
+//==============================================================================
+/**
+    The child-process end of a ChildProcessPluginScanner.
+
+    In the executable that the ChildProcessPluginScanner launches, create one of
+    these in your main() or JUCEApplication::initialise() and call its
+    initialiseFromCommandLine() method. If that returns true, then the process has
+    been launched as a scanner and should do nothing else: the object will scan the
+    files it's asked for on the message thread, and will quit the app when the
+    master goes away.
+
+    @see ChildProcessPluginScanner
+
+    @tags{Audio}
+*/
+class JUCE_API  ChildProcessPluginScannerSlave  : public ChildProcessSlave
+{
+public:
+    /** Creates a slave which can scan all the default plug-in formats. */
+    ChildProcessPluginScannerSlave();
+
+    /** Destructor. */
+    ~ChildProcessPluginScannerSlave() override;
+
+    /** Returns the format manager used to look up the formats that are requested.
+        If you've got any custom formats, you can add them to this before connecting.
+    */
+    AudioPluginFormatManager& getFormatManager() noexcept       { return formatManager; }
+
+    /** @internal */
+    void handleMessageFromMaster (const MemoryBlock&) override;
+    /** @internal */
+    void handleConnectionLost() override;
+
+private:
+    //==============================================================================
+    AudioPluginFormatManager formatManager;
+
+    void scan (const XmlElement& request);
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (ChildProcessPluginScannerSlave)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChildProcessPluginScannerSlave)
+};
+
+} // namespace juce
@@ -389,6 +389,33 @@ void KnownPluginList::recreateFromXml (const XmlElement& xml)
     }
 }
 
+bool KnownPluginList::writeToBinaryCache (OutputStream& output) const
+{
+    return KnownPluginListCache::write (output, getTypes(), blacklist);
+}
+
+bool KnownPluginList::recreateFromBinaryCache (const KnownPluginListCache& cache)
+{
+    if (! cache.isValid())
+        return false;
+
+    auto newTypes = cache.getTypes();
+
+    {
+        ScopedLock lock (typesArrayLock);
+        types.swapWith (newTypes);
+    }
+
+    blacklist = cache.getBlacklistedFiles();
+    sendChangeMessage();
+    return true;
+}
+
+bool KnownPluginList::recreateFromBinaryCache (const void* data, size_t dataSize)
+{
+    return recreateFromBinaryCache (KnownPluginListCache (data, dataSize));
+}
+
 //==============================================================================
 struct PluginTreeUtils
 {
@@ -165,6 +165,22 @@ public:
     /** Recreates the state of this list from its stored XML format. */
     void recreateFromXml (const XmlElement& xml);
 
+    /** Writes the list and blacklist in a compact binary format, which is much
+        faster to reload than the XML created by createXml().
+        @see recreateFromBinaryCache, KnownPluginListCache
+    */
+    bool writeToBinaryCache (OutputStream& output) const;
+
+    /** Recreates the state of this list from a KnownPluginListCache.
+        Returns false (leaving the list unchanged) if the cache isn't valid.
+    */
+    bool recreateFromBinaryCache (const KnownPluginListCache& cache);
+
+    /** Recreates the state of this list from some data that was written by writeToBinaryCache().
+        Returns false (leaving the list unchanged) if the data isn't valid.
+    */
+    bool recreateFromBinaryCache (const void* data, size_t dataSize);
+
     //==============================================================================
     /** A structure that recursively holds a tree of plugins.
         @see KnownPluginList::createTree()
@@ -0,0 +1,507 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+namespace KnownPluginListCacheFormat
+{
+    enum : uint32
+    {
+        magicNumber = 0x4c504b4a, // "JKPL"
+        formatVersion = 1,
+        headerSize = 36,
+        fileIndexEntrySize = 12,
+        identifierIndexEntrySize = 12
+    };
+
+    enum Flags : uint8
+    {
+        isInstrumentFlag = 1,
+        hasSharedContainerFlag = 2
+    };
+
+    static uint64 getFileHash (const String& fileOrIdentifier)    { return (uint64) fileOrIdentifier.hashCode64(); }
+
+    // This must match the hash used in PluginDescription::createIdentifierString()
+    static uint32 getIdentifierFileHash (const String& fileOrIdentifier)  { return (uint32) fileOrIdentifier.hashCode(); }
+
+    static void writeString (OutputStream& out, const String& s)
+    {
+        auto numBytes = s.getNumBytesAsUTF8();
+        out.writeInt ((int) numBytes);
+        out.write (s.toRawUTF8(), numBytes);
+    }
+
+    static void writeRecord (OutputStream& out, const PluginDescription& d)
+    {
+        writeString (out, d.name);
+        writeString (out, d.descriptiveName);
+        writeString (out, d.pluginFormatName);
+        writeString (out, d.category);
+        writeString (out, d.manufacturerName);
+        writeString (out, d.version);
+        writeString (out, d.fileOrIdentifier);
+
+        out.writeInt (d.uid);
+        out.writeByte ((char) ((d.isInstrument       ? isInstrumentFlag : 0)
+                             | (d.hasSharedContainer ? hasSharedContainerFlag : 0)));
+        out.writeInt (d.numInputChannels);
+        out.writeInt (d.numOutputChannels);
+        out.writeInt64 (d.lastFileModTime.toMilliseconds());
+        out.writeInt64 (d.lastInfoUpdateTime.toMilliseconds());
+    }
+}
+
+//==============================================================================
+KnownPluginListCache::KnownPluginListCache (const File& cacheFile)
+    : mappedFile (new MemoryMappedFile (cacheFile, MemoryMappedFile::readOnly))
+{
+    data = static_cast<const uint8*> (mappedFile->getData());
+    dataSize = mappedFile->getSize();
+    parseHeader();
+}
+
+KnownPluginListCache::KnownPluginListCache (const void* sourceData, size_t sourceDataSize)
+    : ownedData (sourceData, sourceDataSize)
+{
+    data = static_cast<const uint8*> (ownedData.getData());
+    dataSize = ownedData.getSize();
+    parseHeader();
+}
+
+KnownPluginListCache::~KnownPluginListCache() {}
+
+uint32 KnownPluginListCache::readUint32 (size_t offset) const noexcept
+{
+    jassert (offset + 4 <= dataSize);
+    return ByteOrder::littleEndianInt (data + offset);
+}
+
+void KnownPluginListCache::parseHeader()
+{
+    using namespace KnownPluginListCacheFormat;
+
+    numTypes = -1;
+
+    if (data == nullptr || dataSize < headerSize
+         || readUint32 (0) != magicNumber
+         || readUint32 (4) != formatVersion
+         || readUint32 (32) != dataSize)
+        return;
+
+    auto num            = readUint32 (8);
+    numBlacklisted      = (int) readUint32 (12);
+    recordOffsetsStart  = readUint32 (16);
+    fileIndexStart      = readUint32 (20);
+    idIndexStart        = readUint32 (24);
+    blacklistStart      = readUint32 (28);
+
+    if ((uint64) recordOffsetsStart + 4 * (uint64) num                          <= fileIndexStart
+         && (uint64) fileIndexStart + fileIndexEntrySize * (uint64) num          <= idIndexStart
+         && (uint64) idIndexStart   + identifierIndexEntrySize * (uint64) num    <= blacklistStart
+         && blacklistStart <= dataSize)
+        numTypes = (int) num;
+}
+
+String KnownPluginListCache::readString (size_t& offset) const
+{
+    if (offset + 4 > dataSize)
+        return {};
+
+    auto numBytes = (size_t) readUint32 (offset);
+    offset += 4;
+
+    if (offset + numBytes > dataSize)
+    {
+        jassertfalse; // corrupt data!
+        offset = dataSize;
+        return {};
+    }
+
+    auto s = String::fromUTF8 (reinterpret_cast<const char*> (data + offset), (int) numBytes);
+    offset += numBytes;
+    return s;
+}
+
+PluginDescription KnownPluginListCache::getType (int index) const
+{
+    using namespace KnownPluginListCacheFormat;
+
+    PluginDescription d;
+
+    if (! isPositiveAndBelow (index, numTypes))
+    {
+        jassertfalse;
+        return d;
+    }
+
+    size_t offset = readUint32 (recordOffsetsStart + 4 * (size_t) index);
+
+    d.name              = readString (offset);
+    d.descriptiveName   = readString (offset);
+    d.pluginFormatName  = readString (offset);
+    d.category          = readString (offset);
+    d.manufacturerName  = readString (offset);
+    d.version           = readString (offset);
+    d.fileOrIdentifier  = readString (offset);
+
+    if (offset + 29 <= dataSize)
+    {
+        auto flags = data[offset + 4];
+
+        d.uid                   = (int) readUint32 (offset);
+        d.isInstrument          = (flags & isInstrumentFlag) != 0;
+        d.hasSharedContainer    = (flags & hasSharedContainerFlag) != 0;
+        d.numInputChannels      = (int) readUint32 (offset + 5);
+        d.numOutputChannels     = (int) readUint32 (offset + 9);
+        d.lastFileModTime       = Time ((int64) ByteOrder::littleEndianInt64 (data + offset + 13));
+        d.lastInfoUpdateTime    = Time ((int64) ByteOrder::littleEndianInt64 (data + offset + 21));
+    }
+    else
+    {
+        jassertfalse; // corrupt data!
+    }
+
+    return d;
+}
+
+Array<PluginDescription> KnownPluginListCache::getTypes() const
+{
+    Array<PluginDescription> result;
+    result.ensureStorageAllocated (getNumTypes());
+
+    for (int i = 0; i < numTypes; ++i)
+        result.add (getType (i));
+
+    return result;
+}
+
+int KnownPluginListCache::findFirstInFileIndex (uint64 fileHash) const noexcept
+{
+    using namespace KnownPluginListCacheFormat;
+
+    int start = 0, end = numTypes;
+
+    while (start < end)
+    {
+        auto mid = start + (end - start) / 2;
+
+        if (ByteOrder::littleEndianInt64 (data + fileIndexStart + fileIndexEntrySize * (size_t) mid) < fileHash)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
+}
+
+int KnownPluginListCache::findFirstInIdentifierIndex (uint32 fileHash, uint32 uid) const noexcept
+{
+    using namespace KnownPluginListCacheFormat;
+
+    auto key = ((uint64) fileHash << 32) | uid;
+    int start = 0, end = numTypes;
+
+    while (start < end)
+    {
+        auto mid = start + (end - start) / 2;
+        auto entry = idIndexStart + identifierIndexEntrySize * (size_t) mid;
+
+        if ((((uint64) readUint32 (entry) << 32) | readUint32 (entry + 4)) < key)
+            start = mid + 1;
+        else
+            end = mid;
+    }
+
+    return start;
+}
+
+std::unique_ptr<PluginDescription> KnownPluginListCache::getTypeForFile (const String& fileOrIdentifier) const
+{
+    using namespace KnownPluginListCacheFormat;
+
+    auto hash = getFileHash (fileOrIdentifier);
+
+    for (int i = findFirstInFileIndex (hash); i < numTypes; ++i)
+    {
+        auto entry = fileIndexStart + fileIndexEntrySize * (size_t) i;
+
+        if (ByteOrder::littleEndianInt64 (data + entry) != hash)
+            break;
+
+        auto d = getType ((int) readUint32 (entry + 8));
+
+        if (d.fileOrIdentifier == fileOrIdentifier)
+            return std::make_unique<PluginDescription> (d);
+    }
+
+    return {};
+}
+
+std::unique_ptr<PluginDescription> KnownPluginListCache::getTypeForIdentifierString (const String& identifierString) const
+{
+    using namespace KnownPluginListCacheFormat;
+
+    // The identifier ends with "-<file hash>-<uid>", both in hex
+    auto uid      = (uint32) identifierString.fromLastOccurrenceOf ("-", false, false).getHexValue32();
+    auto fileHash = (uint32) identifierString.upToLastOccurrenceOf ("-", false, false)
+                                             .fromLastOccurrenceOf ("-", false, false).getHexValue32();
+
+    for (int i = findFirstInIdentifierIndex (fileHash, uid); i < numTypes; ++i)
+    {
+        auto entry = idIndexStart + identifierIndexEntrySize * (size_t) i;
+
+        if (readUint32 (entry) != fileHash || readUint32 (entry + 4) != uid)
+            break;
+
+        auto d = getType ((int) readUint32 (entry + 8));
+
+        if (d.matchesIdentifierString (identifierString))
+            return std::make_unique<PluginDescription> (d);
+    }
+
+    return {};
+}
+
+StringArray KnownPluginListCache::getBlacklistedFiles() const
+{
+    StringArray result;
+
+    if (isValid())
+    {
+        size_t offset = blacklistStart;
+
+        for (int i = 0; i < numBlacklisted && offset < dataSize; ++i)
+            result.add (readString (offset));
+    }
+
+    return result;
+}
+
+//==============================================================================
+bool KnownPluginListCache::write (OutputStream& output,
+                                  const Array<PluginDescription>& types,
+                                  const StringArray& blacklistedFiles)
+{
+    using namespace KnownPluginListCacheFormat;
+
+    MemoryOutputStream records;
+    Array<uint32> recordOffsets;
+    recordOffsets.ensureStorageAllocated (types.size());
+
+    for (auto& d : types)
+    {
+        recordOffsets.add ((uint32) (headerSize + records.getDataSize()));
+        writeRecord (records, d);
+    }
+
+    struct FileIndexEntry        { uint64 hash; uint32 index; };
+    struct IdentifierIndexEntry  { uint64 key;  uint32 index; };
+
+    std::vector<FileIndexEntry> fileIndex;
+    std::vector<IdentifierIndexEntry> idIndex;
+    fileIndex.reserve ((size_t) types.size());
+    idIndex.reserve ((size_t) types.size());
+
+    for (int i = 0; i < types.size(); ++i)
+    {
+        auto& d = types.getReference (i);
+        fileIndex.push_back ({ getFileHash (d.fileOrIdentifier), (uint32) i });
+        idIndex.push_back ({ ((uint64) getIdentifierFileHash (d.fileOrIdentifier) << 32) | (uint32) d.uid, (uint32) i });
+    }
+
+    std::stable_sort (fileIndex.begin(), fileIndex.end(), [] (const FileIndexEntry& a, const FileIndexEntry& b) { return a.hash < b.hash; });
+    std::stable_sort (idIndex.begin(),   idIndex.end(),   [] (const IdentifierIndexEntry& a, const IdentifierIndexEntry& b) { return a.key < b.key; });
+
+    MemoryOutputStream blacklist;
+
+    for (auto& b : blacklistedFiles)
+        writeString (blacklist, b);
+
+    auto recordOffsetsStart = (uint32) (headerSize + records.getDataSize());
+    auto fileIndexStart     = recordOffsetsStart + 4 * (uint32) types.size();
+    auto idIndexStart       = fileIndexStart + fileIndexEntrySize * (uint32) types.size();
+    auto blacklistStart     = idIndexStart + identifierIndexEntrySize * (uint32) types.size();
+    auto totalSize          = (uint64) blacklistStart + blacklist.getDataSize();
+
+    if (totalSize > std::numeric_limits<uint32>::max())
+    {
+        jassertfalse;
+        return false;
+    }
+
+    output.writeInt ((int) magicNumber);
+    output.writeInt ((int) formatVersion);
+    output.writeInt (types.size());
+    output.writeInt (blacklistedFiles.size());
+    output.writeInt ((int) recordOffsetsStart);
+    output.writeInt ((int) fileIndexStart);
+    output.writeInt ((int) idIndexStart);
+    output.writeInt ((int) blacklistStart);
+    output.writeInt ((int) totalSize);
+
+    output << records;
+
+    for (auto offset : recordOffsets)
+        output.writeInt ((int) offset);
+
+    for (auto& e : fileIndex)
+    {
+        output.writeInt64 ((int64) e.hash);
+        output.writeInt ((int) e.index);
+    }
+
+    for (auto& e : idIndex)
+    {
+        output.writeInt ((int) (e.key >> 32));
+        output.writeInt ((int) (uint32) e.key);
+        output.writeInt ((int) e.index);
+    }
+
+    output << blacklist;
+    output.flush();
+    return true;
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct KnownPluginListCacheTests  : public UnitTest
+{
+    KnownPluginListCacheTests()
+        : UnitTest ("KnownPluginListCache", UnitTestCategories::audio)
+    {}
+
+    static PluginDescription createDescription (int index)
+    {
+        PluginDescription d;
+        d.name               = "Plugin " + String (index);
+        d.descriptiveName    = d.name + " (descriptive)";
+        d.pluginFormatName   = index % 2 == 0 ? "VST" : "VST3";
+        d.category           = "Effect";
+        d.manufacturerName   = "Manufacturer " + String (index % 7);
+        d.version            = "1.0." + String (index);
+        d.fileOrIdentifier   = "/plugins/shell" + String (index / 4) + ".vst";
+        d.uid                = index * 7919;
+        d.isInstrument       = (index % 3) == 0;
+        d.numInputChannels   = index % 4;
+        d.numOutputChannels  = 2;
+        d.hasSharedContainer = true;
+        d.lastFileModTime    = Time (1500000000000 + index);
+        d.lastInfoUpdateTime = Time (1600000000000 + index);
+        return d;
+    }
+
+    static bool isIdentical (const PluginDescription& a, const PluginDescription& b)
+    {
+        return a.createXml()->isEquivalentTo (b.createXml().get(), false);
+    }
+
+    void runTest() override
+    {
+        Array<PluginDescription> types;
+
+        for (int i = 0; i < 500; ++i)
+            types.add (createDescription (i));
+
+        StringArray blacklist { "/plugins/crashy.vst", String (CharPointer_UTF8 ("/plugins/\xc3\xbcnicode.vst")) };
+
+        MemoryOutputStream mo;
+        expect (KnownPluginListCache::write (mo, types, blacklist));
+
+        beginTest ("Round trip");
+        {
+            KnownPluginListCache cache (mo.getData(), mo.getDataSize());
+
+            expect (cache.isValid());
+            expectEquals (cache.getNumTypes(), types.size());
+
+            for (int i = 0; i < types.size(); ++i)
+                expect (isIdentical (cache.getType (i), types.getReference (i)));
+
+            expect (cache.getBlacklistedFiles() == blacklist);
+        }
+
+        beginTest ("Lookups");
+        {
+            KnownPluginListCache cache (mo.getData(), mo.getDataSize());
+
+            for (auto& d : types)
+            {
+                auto byId = cache.getTypeForIdentifierString (d.createIdentifierString());
+                expect (byId != nullptr && isIdentical (*byId, d));
+
+                auto byFile = cache.getTypeForFile (d.fileOrIdentifier);
+                expect (byFile != nullptr && byFile->fileOrIdentifier == d.fileOrIdentifier);
+            }
+
+            expect (cache.getTypeForFile ("/plugins/missing.vst") == nullptr);
+            expect (cache.getTypeForIdentifierString ("VST-Missing-1234-5678") == nullptr);
+        }
+
+        beginTest ("Invalid data");
+        {
+            KnownPluginListCache truncated (mo.getData(), mo.getDataSize() - 1);
+            expect (! truncated.isValid());
+            expectEquals (truncated.getNumTypes(), 0);
+
+            MemoryBlock wrongVersion (mo.getData(), mo.getDataSize());
+            static_cast<uint8*> (wrongVersion.getData())[4] = 0xff;
+            expect (! KnownPluginListCache (wrongVersion.getData(), wrongVersion.getSize()).isValid());
+        }
+
+        beginTest ("KnownPluginList");
+        {
+            KnownPluginList list;
+
+            for (auto& d : types)
+                list.addType (d);
+
+            list.addToBlacklist (blacklist[0]);
+
+            MemoryOutputStream listData;
+            expect (list.writeToBinaryCache (listData));
+
+            KnownPluginList reloaded;
+            expect (reloaded.recreateFromBinaryCache (listData.getData(), listData.getDataSize()));
+            expectEquals (reloaded.getNumTypes(), list.getNumTypes());
+            expect (reloaded.getBlacklistedFiles() == list.getBlacklistedFiles());
+
+            auto originalTypes = list.getTypes();
+            auto reloadedTypes = reloaded.getTypes();
+
+            for (int i = 0; i < originalTypes.size(); ++i)
+                expect (isIdentical (originalTypes.getReference (i), reloadedTypes.getReference (i)));
+        }
+    }
+};
+
+static KnownPluginListCacheTests knownPluginListCacheTests;
+
+#endif
+
+} // namespace juce
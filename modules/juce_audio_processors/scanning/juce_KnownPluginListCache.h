@@ -0,0 +1,118 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Reads a KnownPluginList which has been saved in a compact binary format.
+
+    The XML produced by KnownPluginList::createXml() has to be completely parsed
+    before any of it can be used, which can be slow when there are thousands of
+    plug-ins. The binary format written by KnownPluginList::writeToBinaryCache()
+    stores each description as a separate record, along with sorted indexes by
+    file and by identifier string, so a cache can be opened (or memory-mapped)
+    almost instantly, and individual descriptions can be looked up without having
+    to create all the others.
+
+    The data contains a version number, and isValid() will return false for any
+    data that was written by an incompatible version, in which case you should
+    rescan or fall back to a saved XML list.
+
+    @see KnownPluginList::writeToBinaryCache, KnownPluginList::recreateFromBinaryCache
+
+    @tags{Audio}
+*/
+class JUCE_API  KnownPluginListCache
+{
+public:
+    //==============================================================================
+    /** Opens a cache file by memory-mapping it. */
+    explicit KnownPluginListCache (const File& cacheFile);
+
+    /** Uses a block of data which was written by KnownPluginList::writeToBinaryCache().
+        The data is copied, so the caller needn't keep it.
+    */
+    KnownPluginListCache (const void* data, size_t dataSize);
+
+    /** Destructor. */
+    ~KnownPluginListCache();
+
+    //==============================================================================
+    /** Returns true if the data was a complete cache written by a compatible version. */
+    bool isValid() const noexcept                               { return numTypes >= 0; }
+
+    /** Returns the number of plug-in descriptions in the cache. */
+    int getNumTypes() const noexcept                            { return jmax (0, numTypes); }
+
+    /** Decodes one of the descriptions in the cache. */
+    PluginDescription getType (int index) const;
+
+    /** Decodes all of the descriptions in the cache. */
+    Array<PluginDescription> getTypes() const;
+
+    /** Looks for a type which comes from this file.
+        This uses a binary search, and only decodes the matching description.
+    */
+    std::unique_ptr<PluginDescription> getTypeForFile (const String& fileOrIdentifier) const;
+
+    /** Looks for a type which matches a string that was created by
+        PluginDescription::createIdentifierString().
+        This uses a binary search, and only decodes the matching description.
+    */
+    std::unique_ptr<PluginDescription> getTypeForIdentifierString (const String& identifierString) const;
+
+    /** Returns the list of blacklisted files that were stored in the cache. */
+    StringArray getBlacklistedFiles() const;
+
+    //==============================================================================
+    /** Writes a set of descriptions and blacklisted files in the binary cache format.
+        You'd normally call KnownPluginList::writeToBinaryCache() rather than this.
+    */
+    static bool write (OutputStream& output,
+                       const Array<PluginDescription>& types,
+                       const StringArray& blacklistedFiles);
+
+private:
+    //==============================================================================
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    MemoryBlock ownedData;
+    const uint8* data = nullptr;
+    size_t dataSize = 0;
+    int numTypes = -1, numBlacklisted = 0;
+    uint32 recordOffsetsStart = 0, fileIndexStart = 0, idIndexStart = 0, blacklistStart = 0;
+
+    void parseHeader();
+    uint32 readUint32 (size_t offset) const noexcept;
+    String readString (size_t& offset) const;
+    int findFirstInFileIndex (uint64 fileHash) const noexcept;
+    int findFirstInIdentifierIndex (uint32 fileHash, uint32 uid) const noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (KnownPluginListCache)
+};
+
+} // namespace juce
@@ -76,6 +76,12 @@ String PluginDirectoryScanner::getNextPluginFileThatWillBeScanned() const
     return format.getNameOfPluginFromIdentifier (filesOrIdentifiersToScan [nextIndex.get() - 1]);
 }
 
+StringArray PluginDirectoryScanner::getFailedFiles() const
+{
+    const ScopedLock sl (failedFilesLock);
+    return failedFiles;
+}
+
 void PluginDirectoryScanner::updateProgress()
 {
     progress = (1.0f - nextIndex.get() / (float) filesOrIdentifiersToScan.size());
@@ -90,26 +96,29 @@ bool PluginDirectoryScanner::scanNextFile (bool dontRescanIfAlreadyInList,
     {
         auto file = filesOrIdentifiersToScan [index];
 
-        if (file.isNotEmpty() && ! (dontRescanIfAlreadyInList && list.isListingUpToDate (file, format)))
+        if (file.isNotEmpty()
+             && ! (dontRescanIfAlreadyInList && (isUnchangedSinceLastScan (file)
+                                                  || list.isListingUpToDate (file, format))))
         {
             nameOfPluginBeingScanned = format.getNameOfPluginFromIdentifier (file);
 
             OwnedArray<PluginDescription> typesFound;
 
             // Add this plugin to the end of the dead-man's pedal list in case it crashes...
-            auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
-            crashedPlugins.removeString (file);
-            crashedPlugins.add (file);
-            setDeadMansPedalFile (crashedPlugins);
+            addToDeadMansPedal (file);
 
             list.scanAndAddFile (file, dontRescanIfAlreadyInList, typesFound, format);
 
             // Managed to load without crashing, so remove it from the dead-man's-pedal..
-            crashedPlugins.removeString (file);
-            setDeadMansPedalFile (crashedPlugins);
+            removeFromDeadMansPedal (file);
 
             if (typesFound.size() == 0 && ! list.getBlacklistedFiles().contains (file))
+            {
+                const ScopedLock sl (failedFilesLock);
                 failedFiles.add (file);
+            }
+
+            updateScannedFileCache (file, typesFound.size());
         }
     }
 
@@ -129,6 +138,156 @@ void PluginDirectoryScanner::setDeadMansPedalFile (const StringArray& newContent
         deadMansPedalFile.replaceWithText (newContents.joinIntoString ("\n"), true, true);
 }
 
+void PluginDirectoryScanner::addToDeadMansPedal (const String& fileOrIdentifier)
+{
+    const ScopedLock sl (deadMansPedalLock);
+
+    auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
+    crashedPlugins.removeString (fileOrIdentifier);
+    crashedPlugins.add (fileOrIdentifier);
+    setDeadMansPedalFile (crashedPlugins);
+}
+
+void PluginDirectoryScanner::removeFromDeadMansPedal (const String& fileOrIdentifier)
+{
+    const ScopedLock sl (deadMansPedalLock);
+
+    auto crashedPlugins = readDeadMansPedalFile (deadMansPedalFile);
+    crashedPlugins.removeString (fileOrIdentifier);
+    setDeadMansPedalFile (crashedPlugins);
+}
+
+//==============================================================================
+void PluginDirectoryScanner::setScannedFileCache (const File& cacheFile)
+{
+    const ScopedLock sl (scannedFileCacheLock);
+
+    scannedFileCacheFile = cacheFile;
+    scannedFileCache.clear();
+
+    StringArray lines;
+    cacheFile.readLines (lines);
+
+    for (auto& line : lines)
+    {
+        auto tokens = StringArray::fromTokens (line, "\t", {});
+
+        // The first two columns are the format name and file, which together make the key.
+        // Entries for other formats are kept, so that they're preserved when the file is saved.
+        if (tokens.size() == 5)
+        {
+            ScannedFileState state;
+            state.modificationTime = tokens[2].getLargeIntValue();
+            state.size             = tokens[3].getLargeIntValue();
+            state.numTypesFound    = tokens[4].getIntValue();
+
+            scannedFileCache.set (tokens[0] + "\t" + tokens[1], state);
+        }
+    }
+}
+
+static bool getFileStateForScanning (const String& fileOrIdentifier, int64& modificationTime, int64& size)
+{
+    // Some formats use identifiers which aren't file paths, so these can't be checked
+    if (! File::isAbsolutePath (fileOrIdentifier))
+        return false;
+
+    File f (fileOrIdentifier);
+
+    if (! f.exists())
+        return false;
+
+    modificationTime = f.getLastModificationTime().toMilliseconds();
+    size = f.getSize();
+    return true;
+}
+
+String PluginDirectoryScanner::getScannedFileCacheKey (const String& fileOrIdentifier) const
+{
+    return format.getName() + "\t" + fileOrIdentifier;
+}
+
+bool PluginDirectoryScanner::isUnchangedSinceLastScan (const String& fileOrIdentifier)
+{
+    ScannedFileState state;
+    auto key = getScannedFileCacheKey (fileOrIdentifier);
+
+    {
+        const ScopedLock sl (scannedFileCacheLock);
+
+        if (scannedFileCacheFile == File() || ! scannedFileCache.contains (key))
+            return false;
+
+        state = scannedFileCache[key];
+    }
+
+    int64 modificationTime, size;
+
+    if (! getFileStateForScanning (fileOrIdentifier, modificationTime, size)
+         || state.modificationTime != modificationTime || state.size != size)
+        return false;
+
+    if (state.numTypesFound == 0)
+    {
+        const ScopedLock sl (failedFilesLock);
+        failedFiles.add (fileOrIdentifier);
+        return true;
+    }
+
+    // If the file contained some plugins, we still need to check that they're in the list
+    return list.getTypeForFile (fileOrIdentifier) != nullptr;
+}
+
+void PluginDirectoryScanner::updateScannedFileCache (const String& fileOrIdentifier, int numTypesFound)
+{
+    {
+        const ScopedLock sl (scannedFileCacheLock);
+
+        if (scannedFileCacheFile == File())
+            return;
+    }
+
+    ScannedFileState state;
+    auto key = getScannedFileCacheKey (fileOrIdentifier);
+
+    // Anything that was blacklisted needs to be tried again next time..
+    if (list.getBlacklistedFiles().contains (fileOrIdentifier)
+         || ! getFileStateForScanning (fileOrIdentifier, state.modificationTime, state.size))
+    {
+        const ScopedLock sl (scannedFileCacheLock);
+        scannedFileCache.remove (key);
+        saveScannedFileCache();
+        return;
+    }
+
+    state.numTypesFound = numTypesFound;
+
+    const ScopedLock sl (scannedFileCacheLock);
+    scannedFileCache.set (key, state);
+    saveScannedFileCache();
+}
+
+void PluginDirectoryScanner::saveScannedFileCache()
+{
+    const ScopedLock sl (scannedFileCacheLock);
+
+    if (scannedFileCacheFile == File())
+        return;
+
+    StringArray lines;
+
+    for (HashMap<String, ScannedFileState>::Iterator i (scannedFileCache); i.next();)
+    {
+        auto state = i.getValue();
+
+        lines.add (i.getKey() + "\t" + String (state.modificationTime)
+                              + "\t" + String (state.size)
+                              + "\t" + String (state.numTypesFound));
+    }
+
+    scannedFileCacheFile.replaceWithText (lines.joinIntoString ("\n"), true, true);
+}
+
 void PluginDirectoryScanner::applyBlacklistingsFromDeadMansPedal (KnownPluginList& list, const File& file)
 {
     // If any plugins have crashed recently when being loaded, move them to the
@@ -137,4 +296,290 @@ void PluginDirectoryScanner::applyBlacklistingsFromDeadMansPedal (KnownPluginLis
         list.addToBlacklist (crashedPlugin);
 }
 
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class PluginDirectoryScannerTests  : public UnitTest
+{
+public:
+    PluginDirectoryScannerTests()
+        : UnitTest ("PluginDirectoryScanner", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Scanned files are written to the cache straight away");
+
+        auto folder = File::getSpecialLocation (File::tempDirectory).getNonexistentChildFile ("PluginScannerTest", {});
+        expect (folder.createDirectory());
+
+        auto pluginFile = folder.getChildFile ("a.testplugin");
+        auto brokenFile = folder.getChildFile ("b.testplugin");
+        auto cacheFile  = folder.getChildFile ("cache.txt");
+
+        expect (pluginFile.replaceWithText ("plugin"));
+        expect (brokenFile.replaceWithText ("broken"));
+
+        TestFormat format ("Test"), otherFormat ("OtherTest");
+        KnownPluginList list;
+
+        {
+            PluginDirectoryScanner scanner (list, format, folder.getFullPathName(), false, {});
+            scanner.setScannedFileCache (cacheFile);
+
+            expectEquals (scan (scanner), 2);
+            expectEquals (format.numFilesLoaded, 2);
+            expect (scanner.getFailedFiles() == StringArray (brokenFile.getFullPathName()));
+            expectEquals (scanner.getProgress(), 1.0f);
+
+            // the scanner hasn't been deleted yet, so this checks that the cache didn't wait for that
+            StringArray lines;
+            cacheFile.readLines (lines);
+            lines.removeEmptyStrings();
+            expectEquals (lines.size(), 2);
+        }
+
+        beginTest ("Unchanged files are skipped");
+        {
+            format.numFilesLoaded = 0;
+            PluginDirectoryScanner scanner (list, format, folder.getFullPathName(), false, {});
+            scanner.setScannedFileCache (cacheFile);
+
+            scan (scanner);
+            expectEquals (format.numFilesLoaded, 0);
+            expect (scanner.getFailedFiles() == StringArray (brokenFile.getFullPathName()));
+            expectEquals (list.getNumTypes(), 1);
+        }
+
+        beginTest ("Cache entries belong to a format");
+        {
+            KnownPluginList otherList;
+            PluginDirectoryScanner scanner (otherList, otherFormat, folder.getFullPathName(), false, {});
+            scanner.setScannedFileCache (cacheFile);
+
+            scan (scanner);
+            expectEquals (otherFormat.numFilesLoaded, 2);
+
+            // The other format's entries must have survived being re-saved. The file with a plugin
+            // in it is loaded again because this list doesn't contain it, but the broken one isn't.
+            format.numFilesLoaded = 0;
+            KnownPluginList newList;
+            PluginDirectoryScanner scanner2 (newList, format, folder.getFullPathName(), false, {});
+            scanner2.setScannedFileCache (cacheFile);
+
+            scan (scanner2);
+            expectEquals (format.numFilesLoaded, 1);
+        }
+
+        beginTest ("Modified files are rescanned");
+        {
+            expect (brokenFile.appendText ("!"));
+
+            format.numFilesLoaded = 0;
+            PluginDirectoryScanner scanner (list, format, folder.getFullPathName(), false, {});
+            scanner.setScannedFileCache (cacheFile);
+
+            scan (scanner);
+            expectEquals (format.numFilesLoaded, 1);
+        }
+
+       #if (JUCE_MAC || JUCE_LINUX) && JUCE_MODAL_LOOPS_PERMITTED
+        {
+            // The scanner launches this script, which passes its command line back through a
+            // file and then waits to be killed. The test then connects a slave to the scanner
+            // from inside this process, so the slave's behaviour can be controlled.
+            auto childScript = folder.getChildFile ("scanner.sh");
+            auto commandLineFile = folder.getChildFile ("commandline.txt");
+            auto tempFile = commandLineFile.getSiblingFile ("commandline.tmp");
+
+            expect (childScript.replaceWithText ("#!/bin/sh\n"
+                                                 "echo \"$@\" > \"" + tempFile.getFullPathName() + "\"\n"
+                                                 "mv \"" + tempFile.getFullPathName() + "\" \"" + commandLineFile.getFullPathName() + "\"\n"
+                                                 "exec sleep 5\n", false, false, "\n"));
+            expect (childScript.setExecutePermission (true));
+
+            beginTest ("Child processes that don't answer get blacklisted");
+            {
+                KnownPluginList childList;
+                childList.setCustomScanner (std::make_unique<ChildProcessPluginScanner> (childScript, "pluginscannertest", 1, 200));
+
+                format.numFilesLoaded = 0;
+                PluginDirectoryScanner scanner (childList, format, folder.getFullPathName(), false, {});
+                scanner.setScannedFileCache (cacheFile);
+                scanner.setFilesOrIdentifiersToScan (StringArray (pluginFile.getFullPathName()));
+
+                OwnedArray<ChildProcessSlave> slaves;
+                auto startTime = Time::getMillisecondCounter();
+                runWithSlaves<SilentSlave> ([&] { scan (scanner); }, commandLineFile, slaves);
+
+                expect (Time::getMillisecondCounter() - startTime < 5000);
+                expectEquals (slaves.size(), 1);
+                expectEquals (format.numFilesLoaded, 0);
+                expect (childList.getBlacklistedFiles().contains (pluginFile.getFullPathName()));
+                expectEquals (childList.getNumTypes(), 0);
+
+                // blacklisted files aren't reported as failures, and aren't remembered in the cache
+                expect (scanner.getFailedFiles().isEmpty());
+                expect (! ("\n" + cacheFile.loadFileAsString()).contains ("\n" + format.getName() + "\t" + pluginFile.getFullPathName() + "\t"));
+            }
+
+            beginTest ("Child processes that die while idle are relaunched");
+            {
+                KnownPluginList childList;
+                childList.setCustomScanner (std::make_unique<ChildProcessPluginScanner> (childScript, "pluginscannertest", 1, 5000));
+
+                // A PluginDirectoryScanner stops its idle children when it's deleted, so the
+                // files are given to the list directly, as the scanner would do.
+                auto scanFile = [&] (const File& file)
+                {
+                    OwnedArray<PluginDescription> found;
+                    childList.scanAndAddFile (file.getFullPathName(), false, found, format);
+                };
+
+                format.numFilesLoaded = 0;
+                OwnedArray<ChildProcessSlave> slaves;
+
+                runWithSlaves<ScanningSlave> ([&] { scanFile (pluginFile); }, commandLineFile, slaves);
+                expectEquals (slaves.size(), 1);
+                expectEquals (childList.getNumTypes(), 1);
+
+                // this is what a child that has crashed between two files looks like to the scanner
+                slaves.clear();
+
+                runWithSlaves<ScanningSlave> ([&] { scanFile (brokenFile); }, commandLineFile, slaves);
+                expectEquals (slaves.size(), 1);
+                expect (childList.getBlacklistedFiles().isEmpty());
+                expectEquals (childList.getNumTypes(), 1);
+
+                // the files were only ever loaded by the children
+                expectEquals (format.numFilesLoaded, 0);
+            }
+        }
+       #endif
+
+        folder.deleteRecursively();
+    }
+
+private:
+    struct TestFormat  : public AudioPluginFormat
+    {
+        TestFormat (const String& formatName)  : name (formatName) {}
+
+        String getName() const override                                         { return name; }
+
+        void findAllTypesForFile (OwnedArray<PluginDescription>& results, const String& fileOrIdentifier) override
+        {
+            ++numFilesLoaded;
+            File file (fileOrIdentifier);
+
+            if (file.loadFileAsString() == "plugin")
+            {
+                auto* desc = results.add (new PluginDescription());
+                desc->name = file.getFileNameWithoutExtension();
+                desc->pluginFormatName = name;
+                desc->fileOrIdentifier = fileOrIdentifier;
+                desc->lastFileModTime = file.getLastModificationTime();
+            }
+        }
+
+        bool fileMightContainThisPluginType (const String& f) override          { return f.endsWith (".testplugin"); }
+        String getNameOfPluginFromIdentifier (const String& f) override         { return File (f).getFileNameWithoutExtension(); }
+        bool pluginNeedsRescanning (const PluginDescription&) override          { return false; }
+        bool doesPluginStillExist (const PluginDescription& d) override         { return File (d.fileOrIdentifier).exists(); }
+        bool canScanForPlugins() const override                                 { return true; }
+        bool isTrivialToScan() const override                                   { return false; }
+        FileSearchPath getDefaultLocationsToSearch() override                   { return {}; }
+
+        StringArray searchPathsForPlugins (const FileSearchPath& path, bool, bool) override
+        {
+            StringArray results;
+
+            for (auto& f : path[0].findChildFiles (File::findFiles, false, "*.testplugin"))
+                results.add (f.getFullPathName());
+
+            results.sort (false);
+            return results;
+        }
+
+        void createPluginInstance (const PluginDescription&, double, int, PluginCreationCallback callback) override
+        {
+            callback (nullptr, "Not supported");
+        }
+
+        bool requiresUnblockedMessageThreadDuringCreation (const PluginDescription&) const override
+        {
+            return false;
+        }
+
+        String name;
+        int numFilesLoaded = 0;
+    };
+
+    static int scan (PluginDirectoryScanner& scanner)
+    {
+        String name;
+        int numFiles = 0;
+
+        for (;;)
+        {
+            ++numFiles;
+
+            if (! scanner.scanNextFile (true, name))
+                return numFiles;
+        }
+    }
+
+   #if (JUCE_MAC || JUCE_LINUX) && JUCE_MODAL_LOOPS_PERMITTED
+    // A slave which takes requests but never answers them, like a scanner process
+    // that's stuck inside a plugin.
+    struct SilentSlave  : public ChildProcessSlave
+    {
+        void handleMessageFromMaster (const MemoryBlock&) override {}
+    };
+
+    // A real scanner slave, which can load the test format.
+    struct ScanningSlave  : public ChildProcessPluginScannerSlave
+    {
+        ScanningSlave()                             { getFormatManager().addFormat (new TestFormat ("Test")); }
+
+        // the real one quits the process, as it's normally running in its own
+        void handleConnectionLost() override        {}
+    };
+
+    // Scans on another thread, while this one runs the message loop that the slaves use,
+    // and connects a new slave each time the scanner launches a child process.
+    template <typename SlaveType>
+    void runWithSlaves (std::function<void()> scanFunction, const File& commandLineFile, OwnedArray<ChildProcessSlave>& slaves)
+    {
+        struct ScanThread  : public Thread
+        {
+            ScanThread (std::function<void()> f)  : Thread ("Plugin scan"), function (std::move (f)) {}
+            void run() override     { function(); }
+
+            std::function<void()> function;
+        };
+
+        ScanThread thread (std::move (scanFunction));
+        thread.startThread();
+
+        while (thread.isThreadRunning())
+        {
+            MessageManager::getInstance()->runDispatchLoopUntil (5);
+
+            if (commandLineFile.existsAsFile())
+            {
+                auto* slave = slaves.add (new SlaveType());
+                expect (slave->initialiseFromCommandLine (commandLineFile.loadFileAsString(), "pluginscannertest"));
+                commandLineFile.deleteFile();
+            }
+        }
+    }
+   #endif
+};
+
+static PluginDirectoryScannerTests pluginDirectoryScannerTests;
+
+#endif
+
 } // namespace juce
@@ -34,6 +34,11 @@ namespace juce
     To use one of these, create it and call scanNextFile() repeatedly, until
     it returns false.
 
+    scanNextFile() may be called from several threads at once to scan more than
+    one file at a time. This is most useful when the KnownPluginList has been given a
+    ChildProcessPluginScanner, so that each file gets loaded in its own child process
+    rather than all of them being loaded into the host at the same time.
+
     @tags{Audio}
 */
 class JUCE_API  PluginDirectoryScanner
@@ -112,8 +117,26 @@ public:
 
     /** This returns a list of all the filenames of things that looked like being
         a plugin file, but which failed to open for some reason.
+
+        This returns a copy, because other threads may still be adding to the list
+        while they're scanning.
+    */
+    StringArray getFailedFiles() const;
+
+    /** Sets a file in which the size and modification time of each scanned file is recorded.
+
+        When this has been set and scanNextFile() is called with dontRescanIfAlreadyInList
+        set to true, any file whose size and modification time match those recorded for
+        it will be skipped without being loaded. Unlike KnownPluginList::isListingUpToDate(),
+        this also applies to files which previously failed to produce any plugins, which
+        would otherwise be re-loaded during every scan.
+
+        The entries are keyed by the format's name as well as the file, so scanners for
+        different formats can share one cache file. The file is loaded when this is called,
+        and is re-written each time a file is scanned, so the results survive even if the
+        host crashes part-way through a scan.
     */
-    const StringArray& getFailedFiles() const noexcept              { return failedFiles; }
+    void setScannedFileCache (const File& cacheFile);
 
     /** Reads the given dead-mans-pedal file and applies its contents to the list. */
     static void applyBlacklistingsFromDeadMansPedal (KnownPluginList& listToApplyTo,
@@ -127,11 +150,28 @@ private:
     File deadMansPedalFile;
     StringArray failedFiles;
     Atomic<int> nextIndex;
-    float progress = 0;
+    std::atomic<float> progress { 0.0f };
     const bool allowAsync;
+    CriticalSection deadMansPedalLock, failedFilesLock;
+
+    struct ScannedFileState
+    {
+        int64 modificationTime = 0, size = 0;
+        int numTypesFound = 0;
+    };
+
+    File scannedFileCacheFile;
+    HashMap<String, ScannedFileState> scannedFileCache;
+    CriticalSection scannedFileCacheLock;
 
     void updateProgress();
     void setDeadMansPedalFile (const StringArray& newContents);
+    void addToDeadMansPedal (const String& fileOrIdentifier);
+    void removeFromDeadMansPedal (const String& fileOrIdentifier);
+    String getScannedFileCacheKey (const String& fileOrIdentifier) const;
+    bool isUnchangedSinceLastScan (const String& fileOrIdentifier);
+    void updateScannedFileCache (const String& fileOrIdentifier, int numTypesFound);
+    void saveScannedFileCache();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginDirectoryScanner)
 };
@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+#if JUCE_UNIT_TESTS
+
+//==============================================================================
+/*  This is only used by the unit tests of this module and juce_audio_utils, and isn't
+    part of the public API. It's a base for the simple processors that the tests put
+    into graphs and renderers, stubbing out everything they don't need, so that they
+    only have to implement processBlock().
+*/
+struct TestAudioProcessor  : public AudioProcessor
+{
+    TestAudioProcessor (const String& processorName, const BusesProperties& ioLayouts)
+        : AudioProcessor (ioLayouts), name (processorName)
+    {}
+
+    const String getName() const override                           { return name; }
+    void prepareToPlay (double, int) override                       {}
+    void releaseResources() override                                {}
+    double getTailLengthSeconds() const override                    { return 0; }
+    bool acceptsMidi() const override                               { return true; }
+    bool producesMidi() const override                              { return true; }
+    AudioProcessorEditor* createEditor() override                   { return nullptr; }
+    bool hasEditor() const override                                 { return false; }
+    int getNumPrograms() override                                   { return 1; }
+    int getCurrentProgram() override                                { return 0; }
+    void setCurrentProgram (int) override                           {}
+    const String getProgramName (int) override                      { return {}; }
+    void changeProgramName (int, const String&) override            {}
+    void getStateInformation (juce::MemoryBlock&) override          {}
+    void setStateInformation (const void*, int) override            {}
+
+    using AudioProcessor::processBlock;
+
+private:
+    const String name;
+
+    JUCE_DECLARE_NON_COPYABLE (TestAudioProcessor)
+};
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,431 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+AudioProcessor::BusesProperties AudioProcessorBlockAdapter::getBusesPropertiesFor (const AudioProcessor& p)
+{
+    BusesProperties props;
+
+    for (int i = 0; i < p.getBusCount (true); ++i)
+        if (auto* bus = p.getBus (true, i))
+            props = props.withInput (bus->getName(), bus->getDefaultLayout(), bus->isEnabledByDefault());
+
+    for (int i = 0; i < p.getBusCount (false); ++i)
+        if (auto* bus = p.getBus (false, i))
+            props = props.withOutput (bus->getName(), bus->getDefaultLayout(), bus->isEnabledByDefault());
+
+    return props;
+}
+
+AudioProcessorBlockAdapter::AudioProcessorBlockAdapter (std::unique_ptr<AudioProcessor> processorToWrap,
+                                                        Mode m, int blockSizeToUse)
+    : AudioProcessor (getBusesPropertiesFor (*processorToWrap)),
+      processor (std::move (processorToWrap)),
+      mode (m),
+      internalBlockSize (jmax (1, blockSizeToUse))
+{
+    setBusesLayout (processor->getBusesLayout());
+    splitPoints.ensureStorageAllocated (maxSplitPoints);
+}
+
+AudioProcessorBlockAdapter::~AudioProcessorBlockAdapter() {}
+
+//==============================================================================
+void AudioProcessorBlockAdapter::addSplitPoint (int samplePosition) noexcept
+{
+    jassert (mode == Mode::splitAtEvents);
+
+    if (splitPoints.size() >= maxSplitPoints)
+    {
+        jassertfalse; // too many split points - you might need to call setMaximumSplitPointsPerBlock()
+        return;
+    }
+
+    // keep the points sorted, so that they can be consumed in order
+    int i = splitPoints.size();
+
+    while (i > 0 && splitPoints.getUnchecked (i - 1) > samplePosition)
+        --i;
+
+    splitPoints.insert (i, samplePosition);
+}
+
+void AudioProcessorBlockAdapter::setMaximumSplitPointsPerBlock (int newMax)
+{
+    maxSplitPoints = jmax (1, newMax);
+    splitPoints.ensureStorageAllocated (maxSplitPoints);
+}
+
+//==============================================================================
+const String AudioProcessorBlockAdapter::getName() const                       { return processor->getName(); }
+
+void AudioProcessorBlockAdapter::prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock)
+{
+    auto innerBlockSize = mode == Mode::fixedBlockSize ? internalBlockSize
+                                                       : jmax (1, maximumExpectedSamplesPerBlock);
+    maxSubBlockSize = innerBlockSize;
+
+    if (processor->supportsDoublePrecisionProcessing())
+        processor->setProcessingPrecision (getProcessingPrecision());
+
+    processor->setRateAndBufferSizeDetails (sampleRate, innerBlockSize);
+    processor->prepareToPlay (sampleRate, innerBlockSize);
+
+    auto numChannels = jmax (getTotalNumInputChannels(), getTotalNumOutputChannels(), 1);
+    const int midiBytesPerSample = 4;
+    auto midiBufferSize = (size_t) (jmax (innerBlockSize, maximumExpectedSamplesPerBlock) * midiBytesPerSample);
+
+    midiInputFifo.ensureSize (midiBufferSize);
+    midiOutputFifo.ensureSize (midiBufferSize);
+    subBlockMidi.ensureSize (midiBufferSize);
+    midiOutput.ensureSize (midiBufferSize);
+
+    if (mode == Mode::fixedBlockSize)
+    {
+        if (isUsingDoublePrecision())
+        {
+            doubleFifo.input .setSize (numChannels, internalBlockSize);
+            doubleFifo.output.setSize (numChannels, internalBlockSize);
+        }
+        else
+        {
+            floatFifo.input .setSize (numChannels, internalBlockSize);
+            floatFifo.output.setSize (numChannels, internalBlockSize);
+        }
+
+        setLatencySamples (processor->getLatencySamples() + internalBlockSize);
+    }
+    else
+    {
+        setLatencySamples (processor->getLatencySamples());
+    }
+
+    reset();
+}
+
+void AudioProcessorBlockAdapter::releaseResources()
+{
+    processor->releaseResources();
+
+    floatFifo = {};
+    doubleFifo = {};
+}
+
+void AudioProcessorBlockAdapter::reset()
+{
+    processor->reset();
+
+    floatFifo.input.clear();
+    floatFifo.output.clear();
+    doubleFifo.input.clear();
+    doubleFifo.output.clear();
+    midiInputFifo.clear();
+    midiOutputFifo.clear();
+    splitPoints.clearQuick();
+    fifoPosition = 0;
+}
+
+void AudioProcessorBlockAdapter::processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
+{
+    if (mode == Mode::fixedBlockSize)
+        processFixedBlockSize (buffer, midi, floatFifo);
+    else
+        processSplitAtEvents (buffer, midi);
+}
+
+void AudioProcessorBlockAdapter::processBlock (AudioBuffer<double>& buffer, MidiBuffer& midi)
+{
+    if (mode == Mode::fixedBlockSize)
+        processFixedBlockSize (buffer, midi, doubleFifo);
+    else
+        processSplitAtEvents (buffer, midi);
+}
+
+template <typename FloatType>
+void AudioProcessorBlockAdapter::processWrapped (AudioBuffer<FloatType>& buffer, MidiBuffer& midi)
+{
+    processor->setPlayHead (getPlayHead());
+
+    if (processor->isSuspended())
+        buffer.clear();
+    else
+        processor->processBlock (buffer, midi);
+}
+
+template <typename FloatType>
+void AudioProcessorBlockAdapter::processFixedBlockSize (AudioBuffer<FloatType>& buffer, MidiBuffer& midi,
+                                                        Fifo<FloatType>& fifo)
+{
+    auto numSamples = buffer.getNumSamples();
+    auto numChannels = jmin (buffer.getNumChannels(), fifo.input.getNumChannels());
+    int position = 0;
+
+    midiOutput.clear();
+
+    while (position < numSamples)
+    {
+        auto numThisTime = jmin (numSamples - position, internalBlockSize - fifoPosition);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            fifo.input.copyFrom (ch, fifoPosition, buffer, ch, position, numThisTime);
+            buffer.copyFrom (ch, position, fifo.output, ch, fifoPosition, numThisTime);
+        }
+
+        midiInputFifo.addEvents (midi, position, numThisTime, fifoPosition - position);
+        midiOutput.addEvents (midiOutputFifo, fifoPosition, numThisTime, position - fifoPosition);
+
+        position += numThisTime;
+        fifoPosition += numThisTime;
+
+        if (fifoPosition == internalBlockSize)
+        {
+            // The input block is complete, so process it in place, and it becomes
+            // the next block to be played out of the FIFO
+            processWrapped (fifo.input, midiInputFifo);
+
+            std::swap (fifo.input, fifo.output);
+            midiOutputFifo.swapWith (midiInputFifo);
+            midiInputFifo.clear();
+            fifoPosition = 0;
+        }
+    }
+
+    midi.swapWith (midiOutput);
+}
+
+template <typename FloatType>
+void AudioProcessorBlockAdapter::processSplitAtEvents (AudioBuffer<FloatType>& buffer, MidiBuffer& midi)
+{
+    auto numSamples = buffer.getNumSamples();
+
+    MidiBuffer::Iterator midiIterator (midi);
+    const uint8* midiData;
+    int midiDataSize, nextMidiPosition = 0;
+    auto hasMoreMidi = midiIterator.getNextEvent (midiData, midiDataSize, nextMidiPosition);
+    int splitPointIndex = 0;
+    int start = 0;
+
+    midiOutput.clear();
+
+    while (start < numSamples)
+    {
+        // skip past all the events at the start of this sub-block..
+        while (hasMoreMidi && nextMidiPosition <= start)
+            hasMoreMidi = midiIterator.getNextEvent (midiData, midiDataSize, nextMidiPosition);
+
+        while (splitPointIndex < splitPoints.size() && splitPoints.getUnchecked (splitPointIndex) <= start)
+            ++splitPointIndex;
+
+        auto end = jmin (numSamples, start + maxSubBlockSize);
+
+        if (hasMoreMidi)
+            end = jmin (end, nextMidiPosition);
+
+        if (splitPointIndex < splitPoints.size())
+            end = jmin (end, splitPoints.getUnchecked (splitPointIndex));
+
+        AudioBuffer<FloatType> subBlock (buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                         start, end - start);
+
+        subBlockMidi.clear();
+        subBlockMidi.addEvents (midi, start, end - start, -start);
+
+        processWrapped (subBlock, subBlockMidi);
+
+        midiOutput.addEvents (subBlockMidi, 0, end - start, start);
+        start = end;
+    }
+
+    splitPoints.clearQuick();
+    midi.swapWith (midiOutput);
+}
+
+//==============================================================================
+bool AudioProcessorBlockAdapter::supportsDoublePrecisionProcessing() const     { return processor->supportsDoublePrecisionProcessing(); }
+
+void AudioProcessorBlockAdapter::setNonRealtime (bool isNonRealtime) noexcept
+{
+    AudioProcessor::setNonRealtime (isNonRealtime);
+    processor->setNonRealtime (isNonRealtime);
+}
+
+double AudioProcessorBlockAdapter::getTailLengthSeconds() const                { return processor->getTailLengthSeconds(); }
+bool AudioProcessorBlockAdapter::acceptsMidi() const                           { return processor->acceptsMidi(); }
+bool AudioProcessorBlockAdapter::producesMidi() const                          { return processor->producesMidi(); }
+bool AudioProcessorBlockAdapter::isMidiEffect() const                          { return processor->isMidiEffect(); }
+
+int AudioProcessorBlockAdapter::getNumPrograms()                               { return processor->getNumPrograms(); }
+int AudioProcessorBlockAdapter::getCurrentProgram()                            { return processor->getCurrentProgram(); }
+void AudioProcessorBlockAdapter::setCurrentProgram (int index)                 { processor->setCurrentProgram (index); }
+const String AudioProcessorBlockAdapter::getProgramName (int index)            { return processor->getProgramName (index); }
+void AudioProcessorBlockAdapter::changeProgramName (int index, const String& name) { processor->changeProgramName (index, name); }
+
+void AudioProcessorBlockAdapter::getStateInformation (juce::MemoryBlock& data)          { processor->getStateInformation (data); }
+void AudioProcessorBlockAdapter::setStateInformation (const void* data, int sizeInBytes) { processor->setStateInformation (data, sizeInBytes); }
+
+bool AudioProcessorBlockAdapter::isBusesLayoutSupported (const BusesLayout& layouts) const
+{
+    return processor->checkBusesLayoutSupported (layouts);
+}
+
+void AudioProcessorBlockAdapter::processorLayoutsChanged()
+{
+    processor->setBusesLayout (getBusesLayout());
+}
+
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorBlockAdapterTests  : public UnitTest
+{
+public:
+    AudioProcessorBlockAdapterTests()
+        : UnitTest ("AudioProcessorBlockAdapter", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Fixed block size");
+        {
+            auto* recorder = new BlockRecorder();
+            AudioProcessorBlockAdapter adapter (std::unique_ptr<AudioProcessor> (recorder),
+                                                AudioProcessorBlockAdapter::Mode::fixedBlockSize, 64);
+
+            adapter.prepareToPlay (44100.0, 100);
+            expectEquals (adapter.getLatencySamples(), 64);
+
+            AudioBuffer<float> buffer (1, 100);
+            int sampleCounter = 0;
+            bool outputIsDelayedInput = true;
+
+            for (auto blockSize : { 100, 17, 64, 1, 99, 33 })
+            {
+                AudioBuffer<float> block (buffer.getArrayOfWritePointers(), 1, blockSize);
+                MidiBuffer midi;
+
+                for (int i = 0; i < blockSize; ++i)
+                    block.setSample (0, i, (float) (sampleCounter + i));
+
+                adapter.processBlock (block, midi);
+
+                for (int i = 0; i < blockSize; ++i)
+                {
+                    auto expected = jmax (0, sampleCounter + i - 64);
+
+                    if (block.getSample (0, i) != (float) expected)
+                        outputIsDelayedInput = false;
+                }
+
+                sampleCounter += blockSize;
+            }
+
+            expect (outputIsDelayedInput);
+
+            for (auto size : recorder->blockSizes)
+                expectEquals (size, 64);
+        }
+
+        beginTest ("Fixed block size MIDI");
+        {
+            auto* recorder = new BlockRecorder();
+            AudioProcessorBlockAdapter adapter (std::unique_ptr<AudioProcessor> (recorder),
+                                                AudioProcessorBlockAdapter::Mode::fixedBlockSize, 64);
+            adapter.prepareToPlay (44100.0, 48);
+
+            AudioBuffer<float> buffer (1, 48);
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 10);
+
+            adapter.processBlock (buffer, midi);
+            expect (midi.isEmpty());
+
+            int positionOfNote = -1;
+
+            for (int block = 1; block < 4 && positionOfNote < 0; ++block)
+            {
+                adapter.processBlock (buffer, midi);
+
+                if (! midi.isEmpty())
+                    positionOfNote = block * 48 + midi.getFirstEventTime();
+            }
+
+            expectEquals (positionOfNote, 10 + 64);
+        }
+
+        beginTest ("Split at events");
+        {
+            auto* recorder = new BlockRecorder();
+            AudioProcessorBlockAdapter adapter (std::unique_ptr<AudioProcessor> (recorder),
+                                                AudioProcessorBlockAdapter::Mode::splitAtEvents);
+            adapter.prepareToPlay (44100.0, 512);
+            expectEquals (adapter.getLatencySamples(), 0);
+
+            AudioBuffer<float> buffer (1, 512);
+            MidiBuffer midi;
+            midi.addEvent (MidiMessage::noteOn (1, 60, 1.0f), 0);
+            midi.addEvent (MidiMessage::noteOn (1, 61, 1.0f), 100);
+            midi.addEvent (MidiMessage::noteOff (1, 61), 100);
+            midi.addEvent (MidiMessage::noteOn (1, 62, 1.0f), 300);
+
+            adapter.addSplitPoint (200);
+            adapter.processBlock (buffer, midi);
+
+            expect (recorder->blockSizes == Array<int> { 100, 100, 100, 212 });
+            expect (recorder->numEventsPerBlock == Array<int> { 1, 2, 0, 1 });
+            expect (recorder->allEventsAtStartOfBlock);
+            expectEquals (midi.getNumEvents(), 4);
+            expectEquals (midi.getLastEventTime(), 300);
+        }
+    }
+
+private:
+    struct BlockRecorder  : public TestAudioProcessor
+    {
+        BlockRecorder()  : TestAudioProcessor ("Block Recorder", BusesProperties().withInput  ("Input",  AudioChannelSet::mono())
+                                                                                 .withOutput ("Output", AudioChannelSet::mono())) {}
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi) override
+        {
+            blockSizes.add (buffer.getNumSamples());
+            numEventsPerBlock.add (midi.getNumEvents());
+
+            if (! midi.isEmpty() && midi.getLastEventTime() != 0)
+                allEventsAtStartOfBlock = false;
+        }
+
+        Array<int> blockSizes, numEventsPerBlock;
+        bool allEventsAtStartOfBlock = true;
+    };
+};
+
+static AudioProcessorBlockAdapterTests audioProcessorBlockAdapterTests;
+
+#endif
+
+} // namespace juce
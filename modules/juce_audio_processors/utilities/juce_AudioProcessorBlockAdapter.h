@@ -0,0 +1,188 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An AudioProcessor which wraps another one, and changes the way that the host's
+    audio blocks get divided up before being passed to it.
+
+    In fixedBlockSize mode, the wrapped processor is always called with blocks of
+    exactly the same size, whatever the host does. This is useful for processors
+    such as FFT-based effects which work on a fixed frame size. The audio and MIDI
+    pass through a preallocated FIFO, which adds a block's worth of latency, and this
+    is included in the value reported by getLatencySamples().
+
+    In splitAtEvents mode, each block from the host is cut into sub-blocks at the
+    positions of its MIDI events, and at any positions passed to addSplitPoint(),
+    so that the wrapped processor can treat everything in a block as happening at
+    its first sample. This adds no latency.
+
+    Neither mode allocates any memory on the audio thread, as long as there are no more
+    than the preallocated number of split points or MIDI bytes in a block.
+
+    The wrapper doesn't expose the wrapped processor's parameters or editor, so you
+    should use getWrappedProcessor() to access those.
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioProcessorBlockAdapter  : public AudioProcessor
+{
+public:
+    //==============================================================================
+    enum class Mode
+    {
+        fixedBlockSize,     /**< Calls the wrapped processor with blocks of a fixed size, adding latency. */
+        splitAtEvents       /**< Splits the host's blocks at MIDI events and split points. */
+    };
+
+    /** Creates an adapter.
+
+        @param processorToWrap          the processor to use - the adapter takes ownership of it
+        @param mode                     the way in which to divide up the host's blocks
+        @param internalBlockSize        in fixedBlockSize mode, the size of block that the wrapped
+                                        processor will always be given. In splitAtEvents mode, this
+                                        is ignored.
+    */
+    AudioProcessorBlockAdapter (std::unique_ptr<AudioProcessor> processorToWrap,
+                                Mode mode,
+                                int internalBlockSize = 512);
+
+    /** Destructor. */
+    ~AudioProcessorBlockAdapter() override;
+
+    //==============================================================================
+    /** Returns the processor that this adapter is wrapping. */
+    AudioProcessor& getWrappedProcessor() const noexcept           { return *processor; }
+
+    /** Returns the mode that was passed to the constructor. */
+    Mode getMode() const noexcept                                   { return mode; }
+
+    /** In fixedBlockSize mode, returns the number of samples the wrapped processor will be given. */
+    int getInternalBlockSize() const noexcept                       { return internalBlockSize; }
+
+    /** In splitAtEvents mode, this adds a position in the next block at which it should be
+        split, e.g. because a parameter changes at that sample. Positions are relative to the
+        start of the next block passed to processBlock(), and are cleared after it has been
+        processed.
+
+        This should be called on the audio thread. Any points added beyond the capacity set
+        by setMaximumSplitPointsPerBlock() will be ignored.
+    */
+    void addSplitPoint (int samplePosition) noexcept;
+
+    /** Sets the number of split points that will be preallocated. This must not be called
+        while the processor is playing.
+    */
+    void setMaximumSplitPointsPerBlock (int maxSplitPoints);
+
+    //==============================================================================
+    /** @internal */
+    const String getName() const override;
+    /** @internal */
+    void prepareToPlay (double sampleRate, int maximumExpectedSamplesPerBlock) override;
+    /** @internal */
+    void releaseResources() override;
+    /** @internal */
+    void reset() override;
+    /** @internal */
+    void processBlock (AudioBuffer<float>&, MidiBuffer&) override;
+    /** @internal */
+    void processBlock (AudioBuffer<double>&, MidiBuffer&) override;
+    /** @internal */
+    bool supportsDoublePrecisionProcessing() const override;
+    /** @internal */
+    void setNonRealtime (bool isNonRealtime) noexcept override;
+    /** @internal */
+    double getTailLengthSeconds() const override;
+    /** @internal */
+    bool acceptsMidi() const override;
+    /** @internal */
+    bool producesMidi() const override;
+    /** @internal */
+    bool isMidiEffect() const override;
+    /** @internal */
+    AudioProcessorEditor* createEditor() override                   { return nullptr; }
+    /** @internal */
+    bool hasEditor() const override                                 { return false; }
+    /** @internal */
+    int getNumPrograms() override;
+    /** @internal */
+    int getCurrentProgram() override;
+    /** @internal */
+    void setCurrentProgram (int) override;
+    /** @internal */
+    const String getProgramName (int) override;
+    /** @internal */
+    void changeProgramName (int, const String&) override;
+    /** @internal */
+    void getStateInformation (juce::MemoryBlock&) override;
+    /** @internal */
+    void setStateInformation (const void*, int) override;
+
+protected:
+    /** @internal */
+    bool isBusesLayoutSupported (const BusesLayout&) const override;
+    /** @internal */
+    void processorLayoutsChanged() override;
+
+private:
+    //==============================================================================
+    template <typename FloatType>
+    struct Fifo
+    {
+        AudioBuffer<FloatType> input, output;
+    };
+
+    std::unique_ptr<AudioProcessor> processor;
+    const Mode mode;
+    const int internalBlockSize;
+
+    Fifo<float> floatFifo;
+    Fifo<double> doubleFifo;
+    MidiBuffer midiInputFifo, midiOutputFifo, subBlockMidi, midiOutput;
+    int fifoPosition = 0, maxSubBlockSize = 1;
+
+    Array<int> splitPoints;
+    int maxSplitPoints = 128;
+
+    static BusesProperties getBusesPropertiesFor (const AudioProcessor&);
+
+    template <typename FloatType>
+    void processFixedBlockSize (AudioBuffer<FloatType>&, MidiBuffer&, Fifo<FloatType>&);
+
+    template <typename FloatType>
+    void processSplitAtEvents (AudioBuffer<FloatType>&, MidiBuffer&);
+
+    template <typename FloatType>
+    void processWrapped (AudioBuffer<FloatType>&, MidiBuffer&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorBlockAdapter)
+};
+
+} // namespace juce
@@ -0,0 +1,1051 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+struct AudioPeakPyramid::PeakValue
+{
+    int16 minValue, maxValue;
+    uint16 rms;
+};
+
+//==============================================================================
+struct AudioPeakPyramid::Accumulator
+{
+    void add (Range<float> levels, double squares, int64 num) noexcept
+    {
+        if (numSamples == 0)
+        {
+            minValue = levels.getStart();
+            maxValue = levels.getEnd();
+        }
+        else
+        {
+            minValue = jmin (minValue, levels.getStart());
+            maxValue = jmax (maxValue, levels.getEnd());
+        }
+
+        sumOfSquares += squares;
+        numSamples += num;
+    }
+
+    void add (const Accumulator& other) noexcept
+    {
+        if (other.numSamples > 0)
+            add ({ other.minValue, other.maxValue }, other.sumOfSquares, other.numSamples);
+    }
+
+    void add (const PeakValue& peak, int64 num) noexcept
+    {
+        auto rms = peak.rms / 65535.0;
+        add ({ peak.minValue / 32767.0f, peak.maxValue / 32767.0f }, rms * rms * (double) num, num);
+    }
+
+    PeakValue toPeakValue() const noexcept
+    {
+        auto rms = numSamples > 0 ? std::sqrt (sumOfSquares / (double) numSamples) : 0.0;
+
+        return { toInt16 (minValue), toInt16 (maxValue),
+                 (uint16) jlimit (0, 65535, roundToInt (rms * 65535.0)) };
+    }
+
+    static int16 toInt16 (float value) noexcept
+    {
+        return (int16) jlimit (-32767, 32767, roundToInt (value * 32767.0f));
+    }
+
+    float minValue = 0, maxValue = 0;
+    double sumOfSquares = 0;
+    int64 numSamples = 0;
+};
+
+//==============================================================================
+struct AudioPeakPyramid::Level
+{
+    void setSize (int newNumPeaks, int numChannels)
+    {
+        storage.resize (newNumPeaks * numChannels);
+        data = storage.getRawDataPointer();
+        numPeaks = newNumPeaks;
+    }
+
+    void clear()
+    {
+        storage.clear();
+        data = nullptr;
+        numPeaks = 0;
+    }
+
+    Array<PeakValue> storage;
+    const PeakValue* data = nullptr; // points to either the storage array or a mapped file
+    int numPeaks = 0;
+};
+
+//==============================================================================
+class AudioPeakPyramid::GeneratorJob  : public ThreadPoolJob
+{
+public:
+    GeneratorJob (AudioPeakPyramid& p)  : ThreadPoolJob ("Peak pyramid generator"), owner (p) {}
+
+    JobStatus runJob() override
+    {
+        std::unique_ptr<AudioFormatReader> reader (owner.readerFactory());
+
+        if (reader != nullptr)
+        {
+            AudioBuffer<float> buffer (owner.numChannels, 16384);
+
+            while (! shouldExit() && owner.generateNextChunk (*reader, buffer, *this))
+            {}
+        }
+
+        return jobHasFinished;
+    }
+
+private:
+    AudioPeakPyramid& owner;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GeneratorJob)
+};
+
+//==============================================================================
+namespace PeakPyramidHelpers
+{
+    struct FileHeader
+    {
+        static constexpr int currentVersion = 1;
+
+        bool read (InputStream& input)
+        {
+            char magic[4];
+
+            if (input.read (magic, 4) != 4 || memcmp (magic, "jpkp", 4) != 0
+                 || input.readInt() != currentVersion)
+                return false;
+
+            numChannels        = input.readInt();
+            samplesPerPeak     = input.readInt();
+            numLevels          = input.readInt();
+            input.readInt();   // (reserved)
+            sampleRate         = input.readDouble();
+            totalSamples       = input.readInt64();
+            numSamplesFinished = input.readInt64();
+            hashCode           = input.readInt64();
+
+            if (! (numChannels > 0 && numChannels <= 256
+                    && samplesPerPeak > 0 && samplesPerPeak <= (1 << 20) && isPowerOfTwo (samplesPerPeak)
+                    && numLevels > 0 && numLevels <= 16
+                    && sampleRate > 0
+                    && totalSamples >= 0
+                    && isPositiveAndNotGreaterThan (numSamplesFinished, totalSamples)))
+                return false;
+
+            numPeaks.clearQuick();
+
+            for (int level = 0; level < numLevels; ++level)
+            {
+                auto samplesInPeak = ((int64) samplesPerPeak) << (2 * level);
+                auto num = input.readInt();
+
+                if (num < 0 || num > (totalSamples + samplesInPeak - 1) / samplesInPeak)
+                    return false;
+
+                numPeaks.add (num);
+            }
+
+            return ! input.isExhausted() || getNumValues() == 0;
+        }
+
+        int64 getNumValues() const noexcept
+        {
+            int64 total = 0;
+
+            for (auto num : numPeaks)
+                total += num;
+
+            return total * numChannels;
+        }
+
+        int numChannels = 0, samplesPerPeak = 0, numLevels = 0;
+        double sampleRate = 0;
+        int64 totalSamples = 0, numSamplesFinished = 0, hashCode = 0;
+        Array<int> numPeaks;
+    };
+}
+
+//==============================================================================
+AudioPeakPyramid::AudioPeakPyramid (int numChans, double rate, int samplesPer, int levelsToUse)
+    : sampleRate (rate)
+{
+    static_assert (sizeof (PeakValue) == 6, "The peak data is memory-mapped, so it mustn't contain any padding");
+
+    jassert (numChans > 0 && levelsToUse > 0);
+    jassert (samplesPer > 0 && isPowerOfTwo (samplesPer));
+
+    setLayout (numChans, samplesPer, levelsToUse);
+}
+
+AudioPeakPyramid::~AudioPeakPyramid()
+{
+    stopGenerating();
+}
+
+void AudioPeakPyramid::setLayout (int newNumChannels, int newSamplesPerPeak, int newNumLevels)
+{
+    numChannels = newNumChannels;
+    samplesPerPeak = newSamplesPerPeak;
+    numLevels = newNumLevels;
+
+    levels.clear();
+
+    for (int i = 0; i < numLevels; ++i)
+        levels.add (new Level());
+
+    accumulators.allocate ((size_t) (numChannels * numLevels), true);
+    accumulatorsAreValid = true;
+}
+
+int AudioPeakPyramid::getNumPeaks (int level) const
+{
+    const ScopedLock sl (lock);
+
+    if (auto* l = levels[level])
+        return l->numPeaks;
+
+    return 0;
+}
+
+bool AudioPeakPyramid::isMemoryMapped() const noexcept
+{
+    const ScopedLock sl (lock);
+    return mappedFile != nullptr;
+}
+
+//==============================================================================
+AudioPeakPyramid::Peak AudioPeakPyramid::getPeakUnlocked (int channel, int64 start, int64 end) const noexcept
+{
+    int level = 0;
+
+    while (level + 1 < numLevels && getSamplesPerPeak (level + 1) <= end - start)
+        ++level;
+
+    start = jmax ((int64) 0, start);
+    end = jmin (end, totalSamples.load());
+
+    if (start >= end || ! isPositiveAndBelow (channel, numChannels))
+        return {};
+
+    auto& l = *levels.getUnchecked (level);
+    auto samplesInPeak = getSamplesPerPeak (level);
+    auto first = (int) (start / samplesInPeak);
+    auto last  = jmin (l.numPeaks, (int) ((end - 1) / samplesInPeak) + 1);
+
+    if (first >= last)
+        return {};
+
+    auto* peak = l.data + first * numChannels + channel;
+    int lowest = peak->minValue, highest = peak->maxValue;
+    double squares = 0;
+
+    for (int i = first; i < last; ++i)
+    {
+        lowest  = jmin (lowest,  (int) peak->minValue);
+        highest = jmax (highest, (int) peak->maxValue);
+        squares += (double) peak->rms * peak->rms;
+        peak += numChannels;
+    }
+
+    Peak result;
+    result.minValue = lowest  / 32767.0f;
+    result.maxValue = highest / 32767.0f;
+    result.rms = (float) (std::sqrt (squares / (last - first)) / 65535.0);
+    return result;
+}
+
+AudioPeakPyramid::Peak AudioPeakPyramid::getPeak (int channel, Range<int64> sampleRange) const
+{
+    const ScopedLock sl (lock);
+    return getPeakUnlocked (channel, sampleRange.getStart(), sampleRange.getEnd());
+}
+
+void AudioPeakPyramid::getPeaks (int channel, int64 startSample, double samplesPerResult,
+                                 Peak* results, int numResults) const
+{
+    const ScopedLock sl (lock);
+
+    for (int i = 0; i < numResults; ++i)
+    {
+        auto start = startSample + (int64) (i * samplesPerResult);
+        auto end   = startSample + (int64) ((i + 1) * samplesPerResult);
+
+        results[i] = getPeakUnlocked (channel, start, jmax (start + 1, end));
+    }
+}
+
+float AudioPeakPyramid::getHighestLevel() const
+{
+    const ScopedLock sl (lock);
+
+    auto& top = *levels.getLast();
+    int highest = 0;
+
+    for (int i = top.numPeaks * numChannels; --i >= 0;)
+        highest = jmax (highest, std::abs ((int) top.data[i].minValue), std::abs ((int) top.data[i].maxValue));
+
+    return highest / 32767.0f;
+}
+
+//==============================================================================
+void AudioPeakPyramid::clear()
+{
+    stopGenerating();
+
+    const ScopedLock sl (lock);
+    clearLevels();
+}
+
+void AudioPeakPyramid::clearLevels()
+{
+    for (auto* l : levels)
+        l->clear();
+
+    mappedFile.reset();
+    accumulators.clear ((size_t) (numChannels * numLevels));
+    accumulatorsAreValid = true;
+    totalSamples = 0;
+    numSamplesFinished = 0;
+}
+
+void AudioPeakPyramid::makeWritable()
+{
+    if (mappedFile != nullptr)
+    {
+        for (auto* l : levels)
+        {
+            l->storage = Array<PeakValue> (l->data, l->numPeaks * numChannels);
+            l->data = l->storage.getRawDataPointer();
+        }
+
+        mappedFile.reset();
+    }
+
+    if (! accumulatorsAreValid)
+        restoreAccumulators();
+}
+
+// When the levels have been loaded or generated, the running totals for the last
+// (incomplete) peak of each level have to be rebuilt from the peaks below it before
+// more samples can be added.
+void AudioPeakPyramid::restoreAccumulators()
+{
+    auto numAdded = numSamplesFinished.load();
+    accumulators.clear ((size_t) (numChannels * numLevels));
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        auto* acc = accumulators + level * numChannels;
+
+        if (level == 0)
+        {
+            auto& l = *levels.getUnchecked (0);
+            auto index = (int) (numAdded / samplesPerPeak);
+            auto numInPeak = numAdded % samplesPerPeak;
+
+            if (numInPeak > 0 && index < l.numPeaks)
+                for (int chan = 0; chan < numChannels; ++chan)
+                    acc[chan].add (l.data[index * numChannels + chan], numInPeak);
+        }
+        else
+        {
+            auto& below = *levels.getUnchecked (level - 1);
+            auto samplesBelow = getSamplesPerPeak (level - 1);
+            auto first = (int) (numAdded / getSamplesPerPeak (level)) * 4;
+            auto end = jmin (below.numPeaks, (int) (numAdded / samplesBelow));
+
+            for (int i = first; i < end; ++i)
+                for (int chan = 0; chan < numChannels; ++chan)
+                    acc[chan].add (below.data[i * numChannels + chan], samplesBelow);
+        }
+    }
+
+    accumulatorsAreValid = true;
+}
+
+void AudioPeakPyramid::addSamples (const AudioBuffer<float>& buffer, int startSample, int numSamples)
+{
+    jassert (startSample >= 0 && startSample + numSamples <= buffer.getNumSamples());
+    jassert (! isGenerating()); // samples can only be added once the levels have been generated
+
+    const ScopedLock sl (lock);
+    makeWritable();
+
+    auto numChansToUse = jmin (numChannels, buffer.getNumChannels());
+    auto numAdded = numSamplesFinished.load();
+
+    while (numSamples > 0)
+    {
+        auto numThisTime = (int) jmin ((int64) numSamples, samplesPerPeak - numAdded % samplesPerPeak);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            if (chan < numChansToUse)
+            {
+                double squares = 0;
+                auto range = FloatVectorOperations::findMinMaxAndSumOfSquares (buffer.getReadPointer (chan, startSample),
+                                                                               numThisTime, squares);
+
+                accumulators[chan].add (range, squares, numThisTime);
+            }
+            else
+            {
+                accumulators[chan].add ({}, 0, numThisTime);
+            }
+        }
+
+        numAdded += numThisTime;
+        startSample += numThisTime;
+        numSamples -= numThisTime;
+
+        if (numAdded % samplesPerPeak == 0)
+            completePeaks (numAdded);
+    }
+
+    updatePartialPeaks (numAdded);
+    numSamplesFinished = numAdded;
+    totalSamples = jmax (totalSamples.load(), numAdded);
+}
+
+void AudioPeakPyramid::completePeaks (int64 numAdded)
+{
+    for (int level = 0; level < numLevels; ++level)
+    {
+        auto* acc = accumulators + level * numChannels;
+        auto index = (int) ((numAdded - 1) / getSamplesPerPeak (level));
+        auto isTopLevel = (level == numLevels - 1);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            setPeak (level, index, chan, acc[chan]);
+
+            if (! isTopLevel)
+                acc[chan + numChannels].add (acc[chan]);
+
+            acc[chan] = {};
+        }
+
+        if (isTopLevel || numAdded % getSamplesPerPeak (level + 1) != 0)
+            break;
+    }
+}
+
+void AudioPeakPyramid::updatePartialPeaks (int64 numAdded)
+{
+    for (int chan = 0; chan < numChannels; ++chan)
+    {
+        Accumulator partial;
+
+        for (int level = 0; level < numLevels; ++level)
+        {
+            auto samplesInPeak = getSamplesPerPeak (level);
+            partial.add (accumulators[level * numChannels + chan]);
+
+            if (numAdded % samplesInPeak != 0)
+                setPeak (level, (int) (numAdded / samplesInPeak), chan, partial);
+        }
+    }
+}
+
+void AudioPeakPyramid::setPeak (int level, int index, int channel, const Accumulator& acc)
+{
+    auto& l = *levels.getUnchecked (level);
+
+    if (index >= l.numPeaks)
+        l.setSize (index + 1, numChannels);
+
+    l.storage.getReference (index * numChannels + channel) = acc.toPeakValue();
+}
+
+//==============================================================================
+int64 AudioPeakPyramid::getSamplesPerChunk() const noexcept
+{
+    auto samplesInTopPeak = getSamplesPerPeak (numLevels - 1);
+    return samplesInTopPeak * jmax ((int64) 1, (int64) 262144 / samplesInTopPeak);
+}
+
+void AudioPeakPyramid::startGenerating (ReaderFactory createReader, int64 numSamples,
+                                        ThreadPool& pool, int maxNumJobs)
+{
+    stopGenerating();
+
+    {
+        const ScopedLock sl (lock);
+        clearLevels();
+
+        readerFactory = std::move (createReader);
+        totalSamples = numSamples;
+        accumulatorsAreValid = false;
+
+        for (int level = 0; level < numLevels; ++level)
+        {
+            auto samplesInPeak = getSamplesPerPeak (level);
+            levels.getUnchecked (level)->setSize ((int) ((numSamples + samplesInPeak - 1) / samplesInPeak), numChannels);
+        }
+
+        auto samplesPerChunk = getSamplesPerChunk();
+        numChunks = (int) ((numSamples + samplesPerChunk - 1) / samplesPerChunk);
+        nextChunk = 0;
+        numChunksFinished = 0;
+    }
+
+    if (numChunks == 0)
+    {
+        if (onGenerationFinished != nullptr)
+            onGenerationFinished();
+
+        return;
+    }
+
+    jobPool = &pool;
+    auto numJobs = jmin (numChunks, maxNumJobs > 0 ? maxNumJobs : pool.getNumThreads());
+
+    for (int i = 0; i < numJobs; ++i)
+        pool.addJob (jobs.add (new GeneratorJob (*this)), false);
+}
+
+void AudioPeakPyramid::stopGenerating()
+{
+    for (auto* job : jobs)
+        jobPool->removeJob (job, true, -1);
+
+    jobs.clear();
+}
+
+bool AudioPeakPyramid::isGenerating() const
+{
+    for (auto* job : jobs)
+        if (jobPool->contains (job))
+            return true;
+
+    return false;
+}
+
+bool AudioPeakPyramid::generateNextChunk (AudioFormatReader& reader, AudioBuffer<float>& buffer,
+                                          const ThreadPoolJob& job)
+{
+    auto chunkIndex = nextChunk++;
+
+    if (chunkIndex >= numChunks)
+        return false;
+
+    auto samplesPerChunk = getSamplesPerChunk();
+    auto start = chunkIndex * samplesPerChunk;
+    auto end = jmin (start + samplesPerChunk, totalSamples.load());
+
+    AudioPeakPyramid chunk (numChannels, sampleRate, samplesPerPeak, numLevels);
+
+    for (auto pos = start; pos < end;)
+    {
+        if (job.shouldExit())
+            return false;
+
+        auto numThisTime = (int) jmin ((int64) buffer.getNumSamples(), end - pos);
+        reader.read (&buffer, 0, numThisTime, pos, true, true);
+        chunk.addSamples (buffer, 0, numThisTime);
+        pos += numThisTime;
+    }
+
+    addChunk (chunk, start);
+
+    auto isLastChunk = (++numChunksFinished == numChunks);
+
+    if (onChunkFinished != nullptr)
+        onChunkFinished();
+
+    if (isLastChunk && onGenerationFinished != nullptr)
+        onGenerationFinished();
+
+    return true;
+}
+
+void AudioPeakPyramid::addChunk (const AudioPeakPyramid& chunk, int64 startSample)
+{
+    const ScopedLock sl (lock);
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        auto& source = *chunk.levels.getUnchecked (level);
+        auto& dest = *levels.getUnchecked (level);
+        auto firstPeak = (int) (startSample / getSamplesPerPeak (level));
+        auto num = jmin (source.numPeaks, dest.numPeaks - firstPeak);
+
+        if (num > 0)
+            memcpy (dest.storage.getRawDataPointer() + firstPeak * numChannels, source.data,
+                    (size_t) (num * numChannels) * sizeof (PeakValue));
+    }
+
+    numSamplesFinished += chunk.numSamplesFinished;
+}
+
+//==============================================================================
+void AudioPeakPyramid::saveTo (OutputStream& output) const
+{
+    const ScopedLock sl (lock);
+
+    output.write ("jpkp", 4);
+    output.writeInt (PeakPyramidHelpers::FileHeader::currentVersion);
+    output.writeInt (numChannels);
+    output.writeInt (samplesPerPeak);
+    output.writeInt (numLevels);
+    output.writeInt (0);
+    output.writeDouble (sampleRate);
+    output.writeInt64 (totalSamples);
+    output.writeInt64 (numSamplesFinished);
+    output.writeInt64 (sourceHashCode);
+
+    for (auto* l : levels)
+        output.writeInt (l->numPeaks);
+
+    for (auto* l : levels)
+    {
+       #if JUCE_LITTLE_ENDIAN
+        output.write (l->data, (size_t) (l->numPeaks * numChannels) * sizeof (PeakValue));
+       #else
+        for (int i = 0; i < l->numPeaks * numChannels; ++i)
+        {
+            output.writeShort (l->data[i].minValue);
+            output.writeShort (l->data[i].maxValue);
+            output.writeShort ((short) l->data[i].rms);
+        }
+       #endif
+    }
+}
+
+bool AudioPeakPyramid::saveTo (const File& file) const
+{
+    TemporaryFile temp (file);
+
+    {
+        FileOutputStream out (temp.getFile());
+
+        if (out.failedToOpen())
+            return false;
+
+        saveTo (out);
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+bool AudioPeakPyramid::loadFrom (InputStream& input)
+{
+    stopGenerating();
+
+    PeakPyramidHelpers::FileHeader header;
+
+    if (! header.read (input))
+        return false;
+
+    auto dataSize = (size_t) header.getNumValues() * sizeof (PeakValue);
+    MemoryBlock data;
+
+    if (input.readIntoMemoryBlock (data, (ssize_t) dataSize) != dataSize)
+        return false;
+
+    const ScopedLock sl (lock);
+    clearLevels();
+    setLayout (header.numChannels, header.samplesPerPeak, header.numLevels);
+
+    sampleRate = header.sampleRate;
+    sourceHashCode = header.hashCode;
+    totalSamples = header.totalSamples;
+    numSamplesFinished = header.numSamplesFinished;
+    accumulatorsAreValid = false;
+
+    auto* source = static_cast<const char*> (data.getData());
+
+    for (int level = 0; level < numLevels; ++level)
+    {
+        auto& l = *levels.getUnchecked (level);
+        l.setSize (header.numPeaks[level], numChannels);
+
+        for (auto& peak : l.storage)
+        {
+            peak.minValue = (int16)  ByteOrder::littleEndianShort (source);
+            peak.maxValue = (int16)  ByteOrder::littleEndianShort (source + 2);
+            peak.rms      = (uint16) ByteOrder::littleEndianShort (source + 4);
+            source += sizeof (PeakValue);
+        }
+    }
+
+    return true;
+}
+
+bool AudioPeakPyramid::loadFrom (const File& file)
+{
+   #if JUCE_LITTLE_ENDIAN
+    stopGenerating();
+
+    PeakPyramidHelpers::FileHeader header;
+
+    {
+        FileInputStream in (file);
+
+        if (in.failedToOpen() || ! header.read (in))
+            return false;
+
+        auto fileRange = Range<int64> (0, in.getPosition() + header.getNumValues() * (int64) sizeof (PeakValue));
+
+        if (fileRange.getEnd() > in.getTotalLength())
+            return false;
+
+        std::unique_ptr<MemoryMappedFile> mapped (new MemoryMappedFile (file, fileRange, MemoryMappedFile::readOnly));
+
+        if (mapped->getData() == nullptr)
+            return false;
+
+        const ScopedLock sl (lock);
+        clearLevels();
+        setLayout (header.numChannels, header.samplesPerPeak, header.numLevels);
+
+        sampleRate = header.sampleRate;
+        sourceHashCode = header.hashCode;
+        totalSamples = header.totalSamples;
+        numSamplesFinished = header.numSamplesFinished;
+        accumulatorsAreValid = false;
+
+        auto* peaks = addBytesToPointer (static_cast<const PeakValue*> (mapped->getData()), in.getPosition());
+
+        for (int level = 0; level < numLevels; ++level)
+        {
+            auto& l = *levels.getUnchecked (level);
+            l.data = peaks;
+            l.numPeaks = header.numPeaks[level];
+            peaks += l.numPeaks * numChannels;
+        }
+
+        mappedFile = std::move (mapped);
+    }
+
+    return true;
+   #else
+    FileInputStream in (file);
+    return in.openedOk() && loadFrom (static_cast<InputStream&> (in));
+   #endif
+}
+
+File AudioPeakPyramid::getSidecarFileFor (const File& audioFile)
+{
+    return audioFile.getSiblingFile (audioFile.getFileName() + ".peaks");
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioPeakPyramidTests  : public UnitTest
+{
+public:
+    AudioPeakPyramidTests()  : UnitTest ("AudioPeakPyramid", UnitTestCategories::audio) {}
+
+    void runTest() override
+    {
+        auto random = getRandom();
+
+        beginTest ("Levels match the audio");
+        {
+            auto audio = createTestSignal (random, 2, 100003);
+            AudioPeakPyramid pyramid (2, 44100.0, 16, 5);
+            addInRandomBlocks (pyramid, audio, 0, audio.getNumSamples(), random);
+
+            expectEquals (pyramid.getNumSamplesFinished(), (int64) audio.getNumSamples());
+            expect (pyramid.isFullyLoaded());
+
+            for (int level = 0; level < pyramid.getNumLevels(); ++level)
+            {
+                auto samplesInPeak = pyramid.getSamplesPerPeak (level);
+                auto numPeaks = pyramid.getNumPeaks (level);
+                expectEquals ((int64) numPeaks, (audio.getNumSamples() + samplesInPeak - 1) / samplesInPeak);
+
+                for (int i = 0; i < 20; ++i)
+                {
+                    // (the last peak of each level only covers part of a block)
+                    auto start = (i == 0 ? numPeaks - 1 : random.nextInt (numPeaks)) * samplesInPeak;
+                    Range<int64> range (start, start + samplesInPeak);
+
+                    for (int chan = 0; chan < 2; ++chan)
+                        expectPeakMatches (pyramid.getPeak (chan, range), audio, chan, range);
+                }
+            }
+
+            for (int i = 0; i < 100; ++i)
+            {
+                auto start = (int64) random.nextInt (audio.getNumSamples());
+                Range<int64> range (start, jmin (start + 1 + random.nextInt (30000), (int64) audio.getNumSamples()));
+
+                auto expected = getPeak (audio, 1, range);
+                auto peak = pyramid.getPeak (1, range);
+
+                expect (peak.minValue <= expected.minValue + 1.0e-4f);
+                expect (peak.maxValue >= expected.maxValue - 1.0e-4f);
+            }
+        }
+
+        beginTest ("Generating in parallel");
+        {
+            WavAudioFormat wav;
+            auto audio = createTestSignal (random, 2, 600000);
+            auto wavData = writeWav (wav, audio, 24);
+            auto decoded = readWav (wav, wavData);
+
+            AudioPeakPyramid incremental (2, 44100.0, 64, 6);
+            incremental.addSamples (decoded, 0, decoded.getNumSamples());
+
+            ThreadPool pool (4);
+            AudioPeakPyramid parallel (2, 44100.0, 64, 6);
+            std::atomic<int> numChunksFinished { 0 };
+            WaitableEvent finished;
+
+            parallel.onChunkFinished = [&] { ++numChunksFinished; };
+            parallel.onGenerationFinished = [&] { finished.signal(); };
+            parallel.startGenerating ([&] { return wav.createReaderFor (new MemoryInputStream (wavData, false), true); },
+                                      decoded.getNumSamples(), pool);
+
+            expect (finished.wait (30000));
+            parallel.stopGenerating();
+
+            expectEquals ((int64) numChunksFinished.load(),
+                          (decoded.getNumSamples() + parallel.getSamplesPerChunk() - 1) / parallel.getSamplesPerChunk());
+            expect (parallel.isFullyLoaded());
+            expectPyramidsMatch (parallel, incremental, 0.0f);
+
+            // Adding more samples after generating has to carry on from the partial peaks
+            auto more = createTestSignal (random, 2, 70000);
+            parallel.addSamples (more, 0, more.getNumSamples());
+            incremental.addSamples (more, 0, more.getNumSamples());
+            expectPyramidsMatch (parallel, incremental, 4.0f / 65535.0f);
+        }
+
+        beginTest ("Saving and memory-mapping");
+        {
+            auto audio = createTestSignal (random, 2, 50001);
+            AudioPeakPyramid original (2, 48000.0, 16, 5);
+            original.addSamples (audio, 0, 30001);
+            original.setSourceHashCode (1234);
+
+            TemporaryFile temp (".peaks");
+            expect (original.saveTo (temp.getFile()));
+
+            AudioPeakPyramid mapped (1, 44100.0);
+            expect (mapped.loadFrom (temp.getFile()));
+            expect (mapped.isMemoryMapped());
+            expectEquals (mapped.getNumChannels(), 2);
+            expectEquals (mapped.getSampleRate(), 48000.0);
+            expectEquals (mapped.getSourceHashCode(), (int64) 1234);
+            expectPyramidsMatch (mapped, original, 0.0f);
+
+            MemoryOutputStream out;
+            original.saveTo (out);
+
+            AudioPeakPyramid streamed (1, 44100.0);
+            MemoryInputStream in (out.getData(), out.getDataSize(), false);
+            expect (streamed.loadFrom (in));
+            expect (! streamed.isMemoryMapped());
+            expectPyramidsMatch (streamed, original, 0.0f);
+
+            addInRandomBlocks (original, audio, 30001, 20000, random);
+            addInRandomBlocks (mapped, audio, 30001, 20000, random);
+            expect (! mapped.isMemoryMapped());
+            expectPyramidsMatch (mapped, original, 4.0f / 65535.0f);
+
+            MemoryInputStream truncated (out.getData(), out.getDataSize() - 10, false);
+            expect (! streamed.loadFrom (truncated));
+
+            MemoryInputStream notPeakData ("RIFF0000WAVEfmt ", 16, false);
+            expect (! streamed.loadFrom (notPeakData));
+        }
+
+        beginTest ("Generation performance");
+        {
+            WavAudioFormat wav;
+            auto audio = createTestSignal (random, 2, 2000000);
+            auto wavData = writeWav (wav, audio, 16);
+            auto createReader = [&] { return wav.createReaderFor (new MemoryInputStream (wavData, false), true); };
+
+            ThreadPool pool (SystemStats::getNumCpus());
+            double bestTimes[2] = { 1.0e10, 1.0e10 };
+
+            for (int run = 0; run < 3; ++run)
+            {
+                for (int i = 0; i < 2; ++i)
+                {
+                    AudioPeakPyramid pyramid (2, 44100.0);
+                    WaitableEvent finished;
+                    pyramid.onGenerationFinished = [&] { finished.signal(); };
+
+                    auto start = Time::getMillisecondCounterHiRes();
+                    pyramid.startGenerating (createReader, audio.getNumSamples(), pool, i == 0 ? 1 : 0);
+                    expect (finished.wait (60000));
+                    bestTimes[i] = jmin (bestTimes[i], Time::getMillisecondCounterHiRes() - start);
+                }
+            }
+
+            AudioPeakPyramid pyramid (2, 44100.0);
+            pyramid.addSamples (audio, 0, audio.getNumSamples());
+            HeapBlock<AudioPeakPyramid::Peak> peaks (2000);
+
+            auto start = Time::getMillisecondCounterHiRes();
+
+            for (int i = 0; i < 100; ++i)
+                pyramid.getPeaks (0, 0, audio.getNumSamples() / 2000.0, peaks, 2000);
+
+            auto drawTime = (Time::getMillisecondCounterHiRes() - start) / 100.0;
+
+            logMessage ("Generating the levels of " + String (audio.getNumSamples()) + " samples: "
+                          + String (bestTimes[0], 1) + "ms with one job, " + String (bestTimes[1], 1) + "ms with "
+                          + String (pool.getNumThreads()) + " threads. Reading 2000 peaks across the whole file: "
+                          + String (drawTime, 3) + "ms");
+        }
+    }
+
+private:
+    static AudioBuffer<float> createTestSignal (Random& random, int numChannels, int numSamples)
+    {
+        AudioBuffer<float> buffer (numChannels, numSamples);
+
+        for (int chan = 0; chan < numChannels; ++chan)
+        {
+            auto* data = buffer.getWritePointer (chan);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto envelope = 0.5f + 0.5f * std::sin ((float) i * 0.0003f * (float) (chan + 1));
+                data[i] = envelope * (random.nextFloat() * 2.0f - 1.0f);
+            }
+        }
+
+        return buffer;
+    }
+
+    static void addInRandomBlocks (AudioPeakPyramid& pyramid, const AudioBuffer<float>& audio,
+                                   int start, int numSamples, Random& random)
+    {
+        for (int pos = start; pos < start + numSamples;)
+        {
+            auto numThisTime = jmin (start + numSamples - pos, 1 + random.nextInt (1000));
+            pyramid.addSamples (audio, pos, numThisTime);
+            pos += numThisTime;
+        }
+    }
+
+    static MemoryBlock writeWav (WavAudioFormat& wav, const AudioBuffer<float>& audio, int bitsPerSample)
+    {
+        MemoryBlock data;
+
+        {
+            std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (new MemoryOutputStream (data, false), 44100.0,
+                                                                            (unsigned int) audio.getNumChannels(),
+                                                                            bitsPerSample, {}, 0));
+            writer->writeFromAudioSampleBuffer (audio, 0, audio.getNumSamples());
+        }
+
+        return data;
+    }
+
+    static AudioBuffer<float> readWav (WavAudioFormat& wav, const MemoryBlock& data)
+    {
+        std::unique_ptr<AudioFormatReader> reader (wav.createReaderFor (new MemoryInputStream (data, false), true));
+        AudioBuffer<float> buffer ((int) reader->numChannels, (int) reader->lengthInSamples);
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+        return buffer;
+    }
+
+    static AudioPeakPyramid::Peak getPeak (const AudioBuffer<float>& audio, int channel, Range<int64> range)
+    {
+        range = range.getIntersectionWith ({ 0, (int64) audio.getNumSamples() });
+        auto* data = audio.getReadPointer (channel, (int) range.getStart());
+        auto levels = FloatVectorOperations::findMinAndMax (data, (int) range.getLength());
+        double squares = 0;
+
+        for (int i = 0; i < (int) range.getLength(); ++i)
+            squares += (double) data[i] * data[i];
+
+        AudioPeakPyramid::Peak peak;
+        peak.minValue = levels.getStart();
+        peak.maxValue = levels.getEnd();
+        peak.rms = (float) std::sqrt (squares / (double) range.getLength());
+        return peak;
+    }
+
+    void expectPeakMatches (AudioPeakPyramid::Peak peak, const AudioBuffer<float>& audio, int channel, Range<int64> range)
+    {
+        auto expected = getPeak (audio, channel, range);
+
+        expectWithinAbsoluteError (peak.minValue, expected.minValue, 1.0f / 32767.0f);
+        expectWithinAbsoluteError (peak.maxValue, expected.maxValue, 1.0f / 32767.0f);
+        expectWithinAbsoluteError (peak.rms, expected.rms, 1.0f / 65535.0f);
+    }
+
+    void expectPyramidsMatch (const AudioPeakPyramid& a, const AudioPeakPyramid& b, float rmsTolerance)
+    {
+        expectEquals (a.getNumSamplesFinished(), b.getNumSamplesFinished());
+        expectEquals (a.getNumLevels(), b.getNumLevels());
+
+        for (int level = 0; level < a.getNumLevels(); ++level)
+        {
+            expectEquals (a.getNumPeaks (level), b.getNumPeaks (level));
+
+            auto samplesInPeak = a.getSamplesPerPeak (level);
+            bool allMatch = true;
+
+            for (int i = 0; i < a.getNumPeaks (level); ++i)
+            {
+                for (int chan = 0; chan < a.getNumChannels(); ++chan)
+                {
+                    Range<int64> range (i * samplesInPeak, (i + 1) * samplesInPeak);
+                    auto peakA = a.getPeak (chan, range);
+                    auto peakB = b.getPeak (chan, range);
+
+                    allMatch = allMatch && peakA.minValue == peakB.minValue
+                                        && peakA.maxValue == peakB.maxValue
+                                        && std::abs (peakA.rms - peakB.rms) <= rmsTolerance + 1.0e-7f;
+                }
+            }
+
+            expect (allMatch, "Level " + String (level) + " differs");
+        }
+    }
+};
+
+static AudioPeakPyramidTests audioPeakPyramidTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Holds the levels of an audio stream at several zoom levels, so that a waveform
+    can be drawn at any scale without scanning more than a few values per pixel.
+
+    Level 0 holds the minimum, maximum and RMS level of each channel for every block of
+    getSamplesPerPeak (0) samples. Each level above that covers four times as many
+    samples per peak, so a view of a very long recording can be drawn from one of the
+    coarser levels without touching the finer ones.
+
+    There are three ways of filling a pyramid:
+    - startGenerating() reads a source in chunks, using a ThreadPool to analyse several
+      chunks at once.
+    - addSamples() appends blocks of audio as they arrive, e.g. while recording. The
+      last peak of each level is kept up to date, so the pyramid can be drawn at any time.
+    - loadFrom() reloads data that was written by saveTo(). When loading from a file,
+      the file is memory-mapped rather than read, so opening a pyramid for a very long
+      file is almost instant.
+
+    The file that the data is kept in is normally a "sidecar" file next to the audio
+    file - see getSidecarFileFor().
+
+    All the methods are thread-safe.
+
+    @see AudioPeakThumbnail
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioPeakPyramid
+{
+public:
+    //==============================================================================
+    /** Creates an empty pyramid.
+
+        @param numChannels      the number of channels of audio
+        @param sampleRate       the sample rate of the audio
+        @param samplesPerPeak   the number of samples covered by each peak in the finest
+                                level (this must be a power of two)
+        @param numLevels        the number of levels, each of which covers four times as
+                                many samples per peak as the one below it
+    */
+    AudioPeakPyramid (int numChannels, double sampleRate,
+                      int samplesPerPeak = 256, int numLevels = 7);
+
+    /** Destructor.
+        If the pyramid is still being generated, this will stop the jobs that are
+        filling it, and wait for them to finish.
+    */
+    ~AudioPeakPyramid();
+
+    //==============================================================================
+    /** The level of a section of one channel. */
+    struct Peak
+    {
+        float minValue = 0, maxValue = 0;
+        float rms = 0;
+    };
+
+    //==============================================================================
+    /** Returns the number of channels. */
+    int getNumChannels() const noexcept                 { return numChannels; }
+
+    /** Returns the sample rate of the audio. */
+    double getSampleRate() const noexcept               { return sampleRate; }
+
+    /** Returns the number of zoom levels. */
+    int getNumLevels() const noexcept                   { return numLevels; }
+
+    /** Returns the number of samples covered by each peak of one of the levels. */
+    int64 getSamplesPerPeak (int level) const noexcept  { return ((int64) samplesPerPeak) << (2 * level); }
+
+    /** Returns the number of peaks in each channel of one of the levels. */
+    int getNumPeaks (int level) const;
+
+    /** Returns the total number of samples in the source. */
+    int64 getTotalSamples() const noexcept              { return totalSamples; }
+
+    /** Returns the number of samples whose levels have been added so far. */
+    int64 getNumSamplesFinished() const noexcept        { return numSamplesFinished; }
+
+    /** Returns true if the levels of all the samples in the source have been added. */
+    bool isFullyLoaded() const noexcept                 { return numSamplesFinished >= totalSamples; }
+
+    /** Returns true if the data is being read directly from a memory-mapped file. */
+    bool isMemoryMapped() const noexcept;
+
+    /** Sets a value that identifies the source of the data, such as the hash code
+        of an InputSource. This is stored along with the levels by saveTo(), so that
+        a reloaded pyramid can be checked against its source.
+    */
+    void setSourceHashCode (int64 newHashCode) noexcept { sourceHashCode = newHashCode; }
+
+    /** Returns the value that was set by setSourceHashCode(). */
+    int64 getSourceHashCode() const noexcept            { return sourceHashCode; }
+
+    //==============================================================================
+    /** Returns the level of a range of samples in one channel.
+
+        This uses the coarsest level whose peaks are no longer than the range, so it only
+        has to look at a handful of peaks, however long the range is.
+    */
+    Peak getPeak (int channel, Range<int64> sampleRange) const;
+
+    /** Fills an array with the levels of consecutive sections of one channel, each of
+        which is samplesPerResult long, starting from startSample. This is the quickest
+        way to get the levels needed to draw a waveform, with one result per pixel.
+    */
+    void getPeaks (int channel, int64 startSample, double samplesPerResult,
+                   Peak* results, int numResults) const;
+
+    /** Returns the highest absolute level in any of the channels. */
+    float getHighestLevel() const;
+
+    //==============================================================================
+    /** Removes all the levels, and sets the number of samples to zero. */
+    void clear();
+
+    /** Appends a block of audio to the end of the data, updating all the levels.
+
+        The block is treated as following on from the last one that was added. Any
+        channels that the buffer doesn't have are treated as silent.
+    */
+    void addSamples (const AudioBuffer<float>& buffer, int startSample, int numSamples);
+
+    //==============================================================================
+    /** A function that creates a reader for the source that is being analysed. */
+    using ReaderFactory = std::function<AudioFormatReader*()>;
+
+    /** Clears the pyramid and starts filling it with the levels of a source, using
+        jobs on a ThreadPool.
+
+        The source is split into chunks, which the jobs take in turn. Each job calls
+        createReader once to get its own reader, so the factory must be able to create
+        several readers that can be used at the same time. If the source can only be read
+        by one reader, set maxNumJobs to 1 and the chunks will be read one after another.
+
+        This returns immediately. The onChunkFinished callback is called by a job each
+        time a chunk has been added to the pyramid, and onGenerationFinished is called once
+        all of it has been added.
+
+        @param createReader     the function that is used to create readers for the source
+        @param numSamples       the length of the source
+        @param pool             the pool to run the jobs on. This must not be deleted while
+                                the jobs are running
+        @param maxNumJobs       the largest number of jobs to use, or 0 to use one job per
+                                thread in the pool
+    */
+    void startGenerating (ReaderFactory createReader, int64 numSamples,
+                          ThreadPool& pool, int maxNumJobs = 0);
+
+    /** Stops any jobs that were started by startGenerating(), and waits for them to finish. */
+    void stopGenerating();
+
+    /** Returns true if there are jobs filling the pyramid. */
+    bool isGenerating() const;
+
+    /** Returns the number of samples that each job reads at once. This is always a
+        multiple of the number of samples covered by a peak of the coarsest level.
+    */
+    int64 getSamplesPerChunk() const noexcept;
+
+    /** Called by the generating jobs each time a chunk has been added. */
+    std::function<void()> onChunkFinished;
+
+    /** Called by the generating jobs once all the chunks have been added. */
+    std::function<void()> onGenerationFinished;
+
+    //==============================================================================
+    /** Writes the levels to a stream. @see loadFrom */
+    void saveTo (OutputStream& output) const;
+
+    /** Writes the levels to a file, replacing its previous contents.
+        Returns false if the file couldn't be written.
+    */
+    bool saveTo (const File& file) const;
+
+    /** Reloads data that was written by saveTo().
+
+        This replaces the channel layout, sample rate and level sizes of this pyramid with
+        the ones in the stream. Returns false if the stream doesn't contain valid data.
+    */
+    bool loadFrom (InputStream& input);
+
+    /** Reloads data from a file that was written by saveTo().
+
+        The file is memory-mapped, and the levels are read directly from the mapped
+        file rather than being copied into memory. If you add more samples to the
+        pyramid after loading it, its data is copied into memory first.
+        Returns false if the file doesn't contain valid data.
+    */
+    bool loadFrom (const File& file);
+
+    /** Returns the file that is normally used to store the levels of an audio file.
+        This is a file in the same directory, with ".peaks" added to its name.
+    */
+    static File getSidecarFileFor (const File& audioFile);
+
+private:
+    //==============================================================================
+    struct PeakValue;
+    struct Accumulator;
+    struct Level;
+    class GeneratorJob;
+
+    int numChannels, samplesPerPeak, numLevels;
+    double sampleRate;
+    int64 sourceHashCode = 0;
+    std::atomic<int64> totalSamples { 0 }, numSamplesFinished { 0 };
+
+    OwnedArray<Level> levels;
+    HeapBlock<Accumulator> accumulators;
+    bool accumulatorsAreValid = true;
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+
+    ReaderFactory readerFactory;
+    OwnedArray<GeneratorJob> jobs;
+    ThreadPool* jobPool = nullptr;
+    std::atomic<int> nextChunk { 0 }, numChunksFinished { 0 };
+    int numChunks = 0;
+
+    CriticalSection lock;
+
+    void setLayout (int numChannels, int samplesPerPeak, int numLevels);
+    void clearLevels();
+    void makeWritable();
+    void restoreAccumulators();
+    void completePeaks (int64 numSamplesAdded);
+    void updatePartialPeaks (int64 numSamplesAdded);
+    void setPeak (int level, int index, int channel, const Accumulator&);
+    Peak getPeakUnlocked (int channel, int64 start, int64 end) const noexcept;
+    void addChunk (const AudioPeakPyramid& chunk, int64 startSample);
+    bool generateNextChunk (AudioFormatReader&, AudioBuffer<float>&, const ThreadPoolJob&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPeakPyramid)
+};
+
+} // namespace juce
@@ -0,0 +1,323 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+AudioPeakThumbnail::AudioPeakThumbnail (AudioFormatManager& formats, ThreadPool& poolToUse, int samplesPer)
+    : formatManager (formats), pool (poolToUse), samplesPerPeak (samplesPer)
+{
+}
+
+AudioPeakThumbnail::~AudioPeakThumbnail()
+{
+    clear();
+}
+
+void AudioPeakThumbnail::clear()
+{
+    pyramid.reset();
+    reader.reset();
+    source.reset();
+    peakFile = File();
+    hashCode = 0;
+}
+
+//==============================================================================
+bool AudioPeakThumbnail::setSource (InputSource* newSource)
+{
+    return setSource (newSource, {});
+}
+
+bool AudioPeakThumbnail::setSource (InputSource* newSource, const File& fileForPeaks)
+{
+    clear();
+
+    if (newSource == nullptr)
+        return false;
+
+    source.reset (newSource);
+    hashCode = source->hashCode();
+    peakFile = fileForPeaks;
+
+    auto createReader = [this]() -> AudioFormatReader*
+    {
+        if (auto* stream = source->createInputStream())
+            return formatManager.createReaderFor (stream);
+
+        return nullptr;
+    };
+
+    std::unique_ptr<AudioFormatReader> firstReader (createReader());
+
+    return firstReader != nullptr
+            && initialise (*firstReader, createReader, 0);
+}
+
+void AudioPeakThumbnail::setReader (AudioFormatReader* newReader, int64 hash)
+{
+    clear();
+
+    if (newReader != nullptr)
+    {
+        reader.reset (newReader);
+        hashCode = hash;
+
+        initialise (*newReader, [newReader]
+        {
+            return new AudioSubsectionReader (newReader, 0, newReader->lengthInSamples, false);
+        }, 1);
+    }
+}
+
+bool AudioPeakThumbnail::initialise (const AudioFormatReader& firstReader,
+                                     AudioPeakPyramid::ReaderFactory createReader, int maxNumJobs)
+{
+    if (firstReader.numChannels == 0 || firstReader.sampleRate <= 0)
+        return false;
+
+    auto numChannels = (int) firstReader.numChannels;
+    auto length = firstReader.lengthInSamples;
+
+    if (peakFile != File())
+    {
+        std::unique_ptr<AudioPeakPyramid> loaded (new AudioPeakPyramid (numChannels, firstReader.sampleRate, samplesPerPeak));
+
+        if (loaded->loadFrom (peakFile)
+             && loaded->getSourceHashCode() == hashCode
+             && loaded->getNumChannels() == numChannels
+             && loaded->getTotalSamples() == length
+             && loaded->isFullyLoaded())
+        {
+            pyramid = std::move (loaded);
+            sendChangeMessage();
+            return length > 0;
+        }
+    }
+
+    pyramid.reset (new AudioPeakPyramid (numChannels, firstReader.sampleRate, samplesPerPeak));
+    pyramid->setSourceHashCode (hashCode);
+    pyramid->onChunkFinished = [this] { sendChangeMessage(); };
+
+    pyramid->onGenerationFinished = [this]
+    {
+        if (peakFile != File())
+            pyramid->saveTo (peakFile);
+    };
+
+    pyramid->startGenerating (createReader, length, pool, maxNumJobs);
+    return length > 0;
+}
+
+void AudioPeakThumbnail::reset (int numChannels, double sampleRate, int64)
+{
+    clear();
+    pyramid.reset (new AudioPeakPyramid (jmax (1, numChannels), sampleRate, samplesPerPeak));
+}
+
+void AudioPeakThumbnail::addBlock (int64 startSample, const AudioBuffer<float>& incoming,
+                                   int startOffsetInBuffer, int numSamples)
+{
+    jassert (startSample >= 0
+              && startOffsetInBuffer >= 0
+              && startOffsetInBuffer + numSamples <= incoming.getNumSamples());
+
+    if (pyramid == nullptr)
+        return;
+
+    auto numAdded = pyramid->getNumSamplesFinished();
+
+    // The blocks have to arrive in order!
+    jassert (startSample >= numAdded);
+
+    if (startSample > numAdded)
+    {
+        AudioBuffer<float> silence (pyramid->getNumChannels(), (int) jmin ((int64) 4096, startSample - numAdded));
+        silence.clear();
+
+        while (numAdded < startSample)
+        {
+            auto numThisTime = (int) jmin ((int64) silence.getNumSamples(), startSample - numAdded);
+            pyramid->addSamples (silence, 0, numThisTime);
+            numAdded += numThisTime;
+        }
+    }
+
+    if (startSample == numAdded)
+    {
+        pyramid->addSamples (incoming, startOffsetInBuffer, numSamples);
+        sendChangeMessage();
+    }
+}
+
+bool AudioPeakThumbnail::savePeakFile (const File& file) const
+{
+    return pyramid != nullptr && pyramid->saveTo (file);
+}
+
+//==============================================================================
+bool AudioPeakThumbnail::loadFrom (InputStream& input)
+{
+    std::unique_ptr<AudioPeakPyramid> loaded (new AudioPeakPyramid (1, 44100.0, samplesPerPeak));
+
+    if (! loaded->loadFrom (input))
+        return false;
+
+    pyramid = std::move (loaded);
+    hashCode = pyramid->getSourceHashCode();
+    sendChangeMessage();
+    return true;
+}
+
+void AudioPeakThumbnail::saveTo (OutputStream& output) const
+{
+    if (pyramid != nullptr)
+        pyramid->saveTo (output);
+}
+
+//==============================================================================
+int AudioPeakThumbnail::getNumChannels() const noexcept
+{
+    return pyramid != nullptr ? pyramid->getNumChannels() : 0;
+}
+
+double AudioPeakThumbnail::getTotalLength() const noexcept
+{
+    return pyramid != nullptr ? (pyramid->getTotalSamples() / pyramid->getSampleRate()) : 0;
+}
+
+bool AudioPeakThumbnail::isFullyLoaded() const noexcept
+{
+    return pyramid == nullptr || pyramid->isFullyLoaded();
+}
+
+int64 AudioPeakThumbnail::getNumSamplesFinished() const noexcept
+{
+    return pyramid != nullptr ? pyramid->getNumSamplesFinished() : 0;
+}
+
+float AudioPeakThumbnail::getApproximatePeak() const
+{
+    return pyramid != nullptr ? pyramid->getHighestLevel() : 0.0f;
+}
+
+void AudioPeakThumbnail::getApproximateMinMax (double startTime, double endTime, int channelIndex,
+                                               float& minValue, float& maxValue) const noexcept
+{
+    AudioPeakPyramid::Peak peak;
+
+    if (pyramid != nullptr)
+    {
+        auto rate = pyramid->getSampleRate();
+        peak = pyramid->getPeak (channelIndex, { (int64) (startTime * rate), (int64) (endTime * rate) });
+    }
+
+    minValue = peak.minValue;
+    maxValue = peak.maxValue;
+}
+
+int64 AudioPeakThumbnail::getHashCode() const
+{
+    return hashCode;
+}
+
+//==============================================================================
+void AudioPeakThumbnail::drawLevels (Graphics& g, const Rectangle<int>& area, double startTime, double endTime,
+                                     int channelNum, float verticalZoomFactor, bool drawRMS)
+{
+    if (pyramid == nullptr || endTime <= startTime || area.getWidth() <= 0)
+        return;
+
+    auto clip = g.getClipBounds().getIntersection (area);
+
+    if (clip.isEmpty())
+        return;
+
+    auto rate = pyramid->getSampleRate();
+    auto samplesPerPixel = (endTime - startTime) * rate / area.getWidth();
+    auto startSample = (int64) std::floor (startTime * rate + (clip.getX() - area.getX()) * samplesPerPixel);
+
+    HeapBlock<AudioPeakPyramid::Peak> peaks ((size_t) clip.getWidth());
+    pyramid->getPeaks (channelNum, startSample, samplesPerPixel, peaks, clip.getWidth());
+
+    auto topY = (float) area.getY();
+    auto bottomY = (float) area.getBottom();
+    auto midY = (topY + bottomY) * 0.5f;
+    auto vscale = verticalZoomFactor * (bottomY - topY) * 0.5f;
+
+    RectangleList<float> waveform;
+    waveform.ensureStorageAllocated (clip.getWidth());
+
+    auto x = (float) clip.getX();
+
+    for (int i = 0; i < clip.getWidth(); ++i)
+    {
+        auto& peak = peaks[i];
+        auto high = drawRMS ? peak.rms  : peak.maxValue;
+        auto low  = drawRMS ? -peak.rms : peak.minValue;
+
+        if (high > low)
+        {
+            auto top    = jmax (midY - high * vscale - 0.3f, topY);
+            auto bottom = jmin (midY - low  * vscale + 0.3f, bottomY);
+
+            waveform.addWithoutMerging (Rectangle<float> (x, top, 1.0f, bottom - top));
+        }
+
+        x += 1.0f;
+    }
+
+    g.fillRectList (waveform);
+}
+
+void AudioPeakThumbnail::drawChannel (Graphics& g, const Rectangle<int>& area, double startTime,
+                                      double endTime, int channelNum, float verticalZoomFactor)
+{
+    drawLevels (g, area, startTime, endTime, channelNum, verticalZoomFactor, false);
+}
+
+void AudioPeakThumbnail::drawChannelRMS (Graphics& g, const Rectangle<int>& area, double startTime,
+                                         double endTime, int channelNum, float verticalZoomFactor)
+{
+    drawLevels (g, area, startTime, endTime, channelNum, verticalZoomFactor, true);
+}
+
+void AudioPeakThumbnail::drawChannels (Graphics& g, const Rectangle<int>& area, double startTimeSeconds,
+                                       double endTimeSeconds, float verticalZoomFactor)
+{
+    auto numChannels = getNumChannels();
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        auto y1 = roundToInt ((i * area.getHeight()) / numChannels);
+        auto y2 = roundToInt (((i + 1) * area.getHeight()) / numChannels);
+
+        drawChannel (g, { area.getX(), area.getY() + y1, area.getWidth(), y2 - y1 },
+                     startTimeSeconds, endTimeSeconds, i, verticalZoomFactor);
+    }
+}
+
+} // namespace juce
@@ -0,0 +1,207 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    An AudioThumbnailBase that draws its waveforms from an AudioPeakPyramid, so that
+    very long files can be drawn at any zoom level without a slow scan.
+
+    This works like AudioThumbnail, but rather than keeping a single low-res copy of
+    the levels, it keeps the minimum, maximum and RMS levels at several resolutions, and
+    draws each pixel from whichever level is nearest to the current zoom.
+
+    When a source is set, its levels are generated in chunks by jobs on a ThreadPool,
+    and the thumbnail broadcasts a change message as each chunk is finished. If you
+    also give it a peak file, the levels are written to that file once they have been
+    generated, and the next time the same source is opened, the file is memory-mapped
+    and the thumbnail can be drawn straight away:
+
+    @code
+    thumbnail.setSource (new FileInputSource (file, true),
+                         AudioPeakPyramid::getSidecarFileFor (file));
+    @endcode
+
+    While recording, call reset() and addBlock() as you would with an AudioThumbnail
+    (or use the thumbnail as the IncomingDataReceiver of an AudioFormatWriter::ThreadedWriter),
+    and then call savePeakFile() when the recording has finished.
+
+    @see AudioPeakPyramid, AudioThumbnail
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioPeakThumbnail    : public AudioThumbnailBase
+{
+public:
+    //==============================================================================
+    /** Creates a thumbnail.
+
+        @param formatManagerToUse   the audio format manager that is used to open the source
+        @param poolToUseForGenerating   the pool that runs the jobs which generate the levels.
+                                        This can be shared between several thumbnails, and
+                                        mustn't be deleted before them
+        @param samplesPerPeak       the number of samples covered by each peak of the finest
+                                    level (this must be a power of two)
+    */
+    AudioPeakThumbnail (AudioFormatManager& formatManagerToUse,
+                        ThreadPool& poolToUseForGenerating,
+                        int samplesPerPeak = 256);
+
+    /** Destructor. */
+    ~AudioPeakThumbnail() override;
+
+    //==============================================================================
+    /** Clears and resets the thumbnail. */
+    void clear() override;
+
+    /** Specifies the file or stream that contains the audio, and starts generating its levels.
+
+        The source that is passed in will be deleted by this object when it is no longer needed.
+        @returns true if the source could be opened as a valid audio file
+    */
+    bool setSource (InputSource* newSource) override;
+
+    /** Specifies the source of the audio, and a file in which its levels are kept.
+
+        If the file already holds the levels of a source with the same hash code and length,
+        it's memory-mapped and used straight away. Otherwise the levels are generated, and
+        written to the file once they're finished.
+
+        @returns true if the source could be opened as a valid audio file
+        @see AudioPeakPyramid::getSidecarFileFor
+    */
+    bool setSource (InputSource* newSource, const File& peakFile);
+
+    /** Gives the thumbnail an AudioFormatReader to use directly.
+        The reader will be deleted by the thumbnail when it is no longer needed. As the
+        levels can only be read by one job at a time, this is slower than using setSource().
+    */
+    void setReader (AudioFormatReader* newReader, int64 hashCode) override;
+
+    /** Resets the thumbnail, ready for adding data with the specified format.
+        If you're going to generate a thumbnail yourself, call this before using addBlock()
+        to add the data.
+    */
+    void reset (int numChannels, double sampleRate, int64 totalSamplesInSource = 0) override;
+
+    /** Adds a block of level data to the thumbnail.
+        Call reset() before using this. The blocks must be added in order; if there's a
+        gap before a block, the gap is treated as silence.
+    */
+    void addBlock (int64 sampleNumberInSource, const AudioBuffer<float>& newData,
+                   int startOffsetInBuffer, int numSamples) override;
+
+    /** Writes the levels to a peak file, e.g. once a recording has finished.
+        Returns false if the file couldn't be written.
+    */
+    bool savePeakFile (const File& peakFile) const;
+
+    //==============================================================================
+    /** Reloads the levels from a stream that was written by saveTo(). */
+    bool loadFrom (InputStream& input) override;
+
+    /** Saves the levels to a stream.
+        This is the same data that is kept in a peak file.
+    */
+    void saveTo (OutputStream& output) const override;
+
+    //==============================================================================
+    /** Returns the number of channels in the file. */
+    int getNumChannels() const noexcept override;
+
+    /** Returns the length of the audio file, in seconds. */
+    double getTotalLength() const noexcept override;
+
+    /** Draws the waveform for a channel, using the minimum and maximum levels.
+        @see AudioThumbnail::drawChannel
+    */
+    void drawChannel (Graphics& g,
+                      const Rectangle<int>& area,
+                      double startTimeSeconds,
+                      double endTimeSeconds,
+                      int channelNum,
+                      float verticalZoomFactor) override;
+
+    /** Draws the waveforms for all channels in the thumbnail, stacked above each other
+        within the specified area.
+    */
+    void drawChannels (Graphics& g,
+                       const Rectangle<int>& area,
+                       double startTimeSeconds,
+                       double endTimeSeconds,
+                       float verticalZoomFactor) override;
+
+    /** Draws the RMS level of a channel, as a band around the centre of the area.
+        This is usually drawn on top of drawChannel(), in a different colour.
+    */
+    void drawChannelRMS (Graphics& g,
+                         const Rectangle<int>& area,
+                         double startTimeSeconds,
+                         double endTimeSeconds,
+                         int channelNum,
+                         float verticalZoomFactor);
+
+    /** Returns true if the levels of the whole source have been generated. */
+    bool isFullyLoaded() const noexcept override;
+
+    /** Returns the number of samples whose levels have been generated. */
+    int64 getNumSamplesFinished() const noexcept override;
+
+    /** Returns the highest level in the thumbnail. */
+    float getApproximatePeak() const override;
+
+    /** Reads the approximate min and max levels from a section of the thumbnail. */
+    void getApproximateMinMax (double startTime, double endTime, int channelIndex,
+                               float& minValue, float& maxValue) const noexcept override;
+
+    /** Returns the hash code that was set by setSource() or setReader(). */
+    int64 getHashCode() const override;
+
+    /** Returns the pyramid that holds the levels, or nullptr if there's no source. */
+    const AudioPeakPyramid* getPeakPyramid() const noexcept     { return pyramid.get(); }
+
+private:
+    //==============================================================================
+    AudioFormatManager& formatManager;
+    ThreadPool& pool;
+    const int samplesPerPeak;
+
+    std::unique_ptr<InputSource> source;
+    std::unique_ptr<AudioFormatReader> reader;
+    std::unique_ptr<AudioPeakPyramid> pyramid;
+    File peakFile;
+    int64 hashCode = 0;
+
+    bool initialise (const AudioFormatReader&, AudioPeakPyramid::ReaderFactory, int maxNumJobs);
+    void drawLevels (Graphics&, const Rectangle<int>&, double startTime, double endTime,
+                     int channelNum, float verticalZoomFactor, bool drawRMS);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioPeakThumbnail)
+};
+
+} // namespace juce
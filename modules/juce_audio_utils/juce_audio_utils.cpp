@@ -55,14 +55,21 @@
  #endif
 #endif
 
+#if JUCE_UNIT_TESTS
+ #include "../juce_audio_processors/unit_tests/juce_TestAudioProcessor.h"
+#endif
+
 #include "gui/juce_AudioDeviceSelectorComponent.cpp"
 #include "gui/juce_AudioThumbnail.cpp"
 #include "gui/juce_AudioThumbnailCache.cpp"
+#include "gui/juce_AudioPeakPyramid.cpp"
+#include "gui/juce_AudioPeakThumbnail.cpp"
 #include "gui/juce_AudioVisualiserComponent.cpp"
 #include "gui/juce_MidiKeyboardComponent.cpp"
 #include "gui/juce_AudioAppComponent.cpp"
 #include "players/juce_SoundPlayer.cpp"
 #include "players/juce_AudioProcessorPlayer.cpp"
+#include "players/juce_AudioProcessorOfflineRenderer.cpp"
 #include "audio_cd/juce_AudioCDReader.cpp"
 
 #if JUCE_MAC
@@ -0,0 +1,689 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+AudioProcessorOfflineRenderer::Job::Job (std::unique_ptr<AudioProcessor> processorToRender,
+                                         std::unique_ptr<AudioFormatReader> sourceReader,
+                                         std::unique_ptr<AudioFormatWriter> destinationWriter,
+                                         const String& jobName)
+    : processor (std::move (processorToRender)),
+      reader (std::move (sourceReader)),
+      writer (std::move (destinationWriter)),
+      name (jobName)
+{
+    jassert (processor != nullptr); // you need to give the job something to render!
+
+    if (reader != nullptr)
+        lengthInSamples = reader->lengthInSamples;
+}
+
+AudioProcessorOfflineRenderer::Job::~Job() {}
+
+void AudioProcessorOfflineRenderer::Job::setLengthInSamples (int64 numSamples) noexcept
+{
+    jassert (getStatus() == Status::pending && reader == nullptr);
+    lengthInSamples = jmax ((int64) 0, numSamples);
+}
+
+void AudioProcessorOfflineRenderer::Job::setTailLength (int64 numSamples) noexcept
+{
+    jassert (getStatus() == Status::pending);
+    tailLength = jmax ((int64) 0, numSamples);
+}
+
+void AudioProcessorOfflineRenderer::Job::setMidiInput (const MidiMessageSequence& sequence)
+{
+    jassert (getStatus() == Status::pending);
+    midiInput = sequence;
+    midiInput.sort();
+}
+
+void AudioProcessorOfflineRenderer::Job::setLatencyCompensation (bool shouldCompensate) noexcept
+{
+    jassert (getStatus() == Status::pending);
+    compensateForLatency = shouldCompensate;
+}
+
+bool AudioProcessorOfflineRenderer::Job::isDone() const noexcept
+{
+    auto s = getStatus();
+    return s == Status::finished || s == Status::failed || s == Status::cancelled;
+}
+
+String AudioProcessorOfflineRenderer::Job::getErrorMessage() const
+{
+    const ScopedLock sl (errorLock);
+    return errorMessage;
+}
+
+int64 AudioProcessorOfflineRenderer::Job::getTotalLength() const noexcept
+{
+    return lengthInSamples + tailLength;
+}
+
+double AudioProcessorOfflineRenderer::Job::getProgress() const noexcept
+{
+    auto total = getTotalLength();
+    return total > 0 ? getNumSamplesRendered() / (double) total : (isDone() ? 1.0 : 0.0);
+}
+
+double AudioProcessorOfflineRenderer::Job::getElapsedSeconds() const noexcept
+{
+    auto start = startTime.load();
+
+    if (start == 0)
+        return 0;
+
+    auto end = endTime.load();
+    return ((end != 0 ? end : Time::getMillisecondCounterHiRes()) - start) * 0.001;
+}
+
+double AudioProcessorOfflineRenderer::Job::getRealtimeFactor() const noexcept
+{
+    auto elapsed = getElapsedSeconds();
+
+    if (elapsed <= 0 || sampleRate <= 0)
+        return 0;
+
+    return getNumSamplesRendered() / (sampleRate * elapsed);
+}
+
+void AudioProcessorOfflineRenderer::Job::fail (const String& message)
+{
+    {
+        const ScopedLock sl (errorLock);
+        errorMessage = message;
+    }
+
+    status = (int) Status::failed;
+}
+
+bool AudioProcessorOfflineRenderer::Job::prepare (int blockSize)
+{
+    if (writer == nullptr)
+    {
+        fail ("No destination to write to");
+        return false;
+    }
+
+    sampleRate = reader != nullptr ? reader->sampleRate : writer->getSampleRate();
+
+    if (sampleRate <= 0)
+    {
+        fail ("Unknown sample rate");
+        return false;
+    }
+
+    processor->setNonRealtime (true);
+    processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor->prepareToPlay (sampleRate, blockSize);
+
+    latency = compensateForLatency ? jmax (0, processor->getLatencySamples()) : 0;
+    return true;
+}
+
+void AudioProcessorOfflineRenderer::Job::render (int blockSize, ThreadPoolJob& task, AudioProcessorOfflineRenderer& owner)
+{
+    status = (int) Status::running;
+    startTime = Time::getMillisecondCounterHiRes();
+
+    auto numInputs  = processor->getTotalNumInputChannels();
+    auto numOutputs = processor->getTotalNumOutputChannels();
+    auto numReaderChannels = reader != nullptr ? jmin ((int) reader->numChannels, numInputs) : 0;
+    auto numWriterChannels = writer->getNumChannels();
+    auto numChannels = jmax (1, numInputs, numOutputs, numWriterChannels);
+
+    AudioBuffer<float> buffer (numChannels, blockSize);
+    MidiBuffer midi;
+    midi.ensureSize (2048);
+    HeapBlock<const float*> outputChannels ((size_t) numWriterChannels + 1, true);
+
+    auto outputLength = getTotalLength();
+    auto inputLength = outputLength + latency;
+    int nextMidiEvent = 0;
+    bool cancelled = false;
+
+    for (int64 position = 0; position < inputLength;)
+    {
+        if (task.shouldExit())
+        {
+            cancelled = true;
+            break;
+        }
+
+        auto numThisTime = (int) jmin ((int64) blockSize, inputLength - position);
+
+        // referencing the preallocated channels avoids any reallocation for the last, shorter block
+        AudioBuffer<float> block (buffer.getArrayOfWritePointers(), numChannels, numThisTime);
+        block.clear();
+
+        if (numReaderChannels > 0 && position < lengthInSamples)
+        {
+            auto numToRead = (int) jmin ((int64) numThisTime, lengthInSamples - position);
+
+            if (! reader->read (block.getArrayOfWritePointers(), numReaderChannels, position, numToRead))
+            {
+                fail ("Failed to read from the source");
+                break;
+            }
+        }
+
+        midi.clear();
+
+        while (nextMidiEvent < midiInput.getNumEvents())
+        {
+            auto& m = midiInput.getEventPointer (nextMidiEvent)->message;
+            auto samplePos = (int64) (m.getTimeStamp() * sampleRate + 0.5) - position;
+
+            if (samplePos >= numThisTime)
+                break;
+
+            midi.addEvent (m, (int) jmax ((int64) 0, samplePos));
+            ++nextMidiEvent;
+        }
+
+        processor->processBlock (block, midi);
+
+        for (int i = numOutputs; i < numChannels; ++i)
+            block.clear (i, 0, numThisTime);
+
+        auto numToSkip = (int) jlimit ((int64) 0, (int64) numThisTime, latency - position);
+        auto numToWrite = numThisTime - numToSkip;
+
+        if (numToWrite > 0)
+        {
+            for (int i = 0; i < numWriterChannels; ++i)
+                outputChannels[i] = block.getReadPointer (i, numToSkip);
+
+            if (! writer->writeFromFloatArrays (outputChannels, numWriterChannels, numToWrite))
+            {
+                fail ("Failed to write to the destination");
+                break;
+            }
+
+            samplesRendered += numToWrite;
+        }
+
+        position += numThisTime;
+        owner.callProgressListeners (*this);
+    }
+
+    processor->releaseResources();
+
+    // deleting the writer is what finalises the file's headers
+    writer.reset();
+    reader.reset();
+
+    endTime = Time::getMillisecondCounterHiRes();
+
+    if (cancelled)
+        status = (int) Status::cancelled;
+    else if (getStatus() == Status::running)
+        status = (int) Status::finished;
+}
+
+//==============================================================================
+class AudioProcessorOfflineRenderer::RenderTask  : public ThreadPoolJob
+{
+public:
+    RenderTask (AudioProcessorOfflineRenderer& r, Job& j)
+        : ThreadPoolJob ("Offline render: " + j.getName()), owner (r), job (j)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        job.render (owner.blockSize, *this, owner);
+        owner.callFinishedListeners (job);
+        return jobHasFinished;
+    }
+
+private:
+    AudioProcessorOfflineRenderer& owner;
+    Job& job;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderTask)
+};
+
+//==============================================================================
+AudioProcessorOfflineRenderer::AudioProcessorOfflineRenderer (int numThreads, int samplesPerBlock)
+    : blockSize (jmax (1, samplesPerBlock)),
+      pool (jmax (1, numThreads))
+{
+}
+
+AudioProcessorOfflineRenderer::~AudioProcessorOfflineRenderer()
+{
+    cancelAllJobs();
+}
+
+AudioProcessorOfflineRenderer::Job* AudioProcessorOfflineRenderer::addJob (std::unique_ptr<Job> job)
+{
+    jassert (job != nullptr && job->getStatus() == Job::Status::pending);
+
+    auto* j = job.get();
+
+    {
+        const ScopedLock sl (jobLock);
+        jobs.add (job.release());
+    }
+
+    if (j->prepare (blockSize))
+        pool.addJob (new RenderTask (*this, *j), true);
+    else
+        callFinishedListeners (*j);
+
+    return j;
+}
+
+int AudioProcessorOfflineRenderer::getNumJobs() const
+{
+    const ScopedLock sl (jobLock);
+    return jobs.size();
+}
+
+AudioProcessorOfflineRenderer::Job* AudioProcessorOfflineRenderer::getJob (int index) const
+{
+    const ScopedLock sl (jobLock);
+    return jobs[index];
+}
+
+void AudioProcessorOfflineRenderer::cancelAllJobs()
+{
+    pool.removeAllJobs (true, -1);
+
+    const ScopedLock sl (jobLock);
+
+    // jobs that were still queued never started, so they need tidying up here
+    for (auto* j : jobs)
+    {
+        if (j->getStatus() == Job::Status::pending)
+        {
+            j->processor->releaseResources();
+            j->writer.reset();
+            j->reader.reset();
+            j->status = (int) Job::Status::cancelled;
+            callFinishedListeners (*j);
+        }
+    }
+}
+
+bool AudioProcessorOfflineRenderer::waitUntilFinished (int timeoutMilliseconds) const
+{
+    auto endTime = Time::getMillisecondCounter() + (uint32) timeoutMilliseconds;
+
+    for (;;)
+    {
+        bool allDone = true;
+
+        {
+            const ScopedLock sl (jobLock);
+
+            for (auto* j : jobs)
+                allDone = allDone && j->isDone();
+        }
+
+        if (allDone)
+        {
+            // the event only wakes one waiter at a time, so pass it on to any other threads that are waiting
+            jobFinished.signal();
+            return true;
+        }
+
+        auto timeToWait = -1;
+
+        if (timeoutMilliseconds >= 0)
+        {
+            auto now = Time::getMillisecondCounter();
+
+            if (now >= endTime)
+                return false;
+
+            timeToWait = (int) (endTime - now);
+        }
+
+        jobFinished.wait (timeToWait);
+    }
+}
+
+//==============================================================================
+double AudioProcessorOfflineRenderer::Statistics::getProgress() const noexcept
+{
+    return totalSamples > 0 ? samplesRendered / (double) totalSamples : 0.0;
+}
+
+double AudioProcessorOfflineRenderer::Statistics::getRealtimeFactor() const noexcept
+{
+    return elapsedSeconds > 0 ? secondsOfAudioRendered / elapsedSeconds : 0.0;
+}
+
+AudioProcessorOfflineRenderer::Statistics AudioProcessorOfflineRenderer::getStatistics() const
+{
+    Statistics s;
+    double firstStart = 0, lastEnd = 0;
+    bool anyRunning = false;
+
+    const ScopedLock sl (jobLock);
+
+    for (auto* j : jobs)
+    {
+        ++s.numJobs;
+
+        switch (j->getStatus())
+        {
+            case Job::Status::finished:   ++s.numFinished; break;
+            case Job::Status::failed:     ++s.numFailed; break;
+            case Job::Status::cancelled:  ++s.numCancelled; break;
+            case Job::Status::running:    anyRunning = true; break;
+            case Job::Status::pending:
+            default:                      break;
+        }
+
+        auto rendered = j->getNumSamplesRendered();
+        s.totalSamples += j->getTotalLength();
+        s.samplesRendered += rendered;
+
+        if (j->sampleRate > 0)
+            s.secondsOfAudioRendered += rendered / j->sampleRate;
+
+        auto start = j->startTime.load();
+
+        if (start != 0)
+            firstStart = firstStart == 0 ? start : jmin (firstStart, start);
+
+        lastEnd = jmax (lastEnd, j->endTime.load());
+    }
+
+    if (firstStart != 0)
+        s.elapsedSeconds = ((anyRunning ? Time::getMillisecondCounterHiRes() : lastEnd) - firstStart) * 0.001;
+
+    return s;
+}
+
+//==============================================================================
+void AudioProcessorOfflineRenderer::addListener (Listener* l)
+{
+    const ScopedLock sl (listenerLock);
+    listeners.add (l);
+}
+
+void AudioProcessorOfflineRenderer::removeListener (Listener* l)
+{
+    const ScopedLock sl (listenerLock);
+    listeners.remove (l);
+}
+
+void AudioProcessorOfflineRenderer::callProgressListeners (Job& job)
+{
+    const ScopedLock sl (listenerLock);
+    listeners.call ([&] (Listener& l) { l.renderJobProgressChanged (job); });
+}
+
+void AudioProcessorOfflineRenderer::callFinishedListeners (Job& job)
+{
+    const ScopedLock sl (listenerLock);
+    listeners.call ([&] (Listener& l) { l.renderJobFinished (job); });
+    jobFinished.signal();
+}
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+class AudioProcessorOfflineRendererTests  : public UnitTest
+{
+public:
+    AudioProcessorOfflineRendererTests()
+        : UnitTest ("AudioProcessorOfflineRenderer", UnitTestCategories::audio)
+    {}
+
+    void runTest() override
+    {
+        beginTest ("Graph bounce");
+        {
+            MemoryBlock source, dest;
+            writeRamp (source, 20000);
+
+            AudioProcessorOfflineRenderer renderer (2, 4096);
+            auto* job = renderer.addJob (createJob (createGraph (0), source, dest));
+
+            expect (renderer.waitUntilFinished (10000));
+            expect (job->getStatus() == Job::Status::finished);
+            expectEquals (job->getNumSamplesRendered(), (int64) 20000);
+            expectEquals (job->getProgress(), 1.0);
+            expectMatchesRamp (dest, 20000, 0);
+        }
+
+        beginTest ("Tail and latency compensation");
+        {
+            MemoryBlock source, dest;
+            writeRamp (source, 10000);
+
+            AudioProcessorOfflineRenderer renderer (1, 1000);
+            auto job = createJob (createGraph (123), source, dest);
+            job->setTailLength (500);
+            auto* j = renderer.addJob (std::move (job));
+
+            expect (renderer.waitUntilFinished (10000));
+            expect (j->getStatus() == Job::Status::finished);
+            expectMatchesRamp (dest, 10000, 500);
+        }
+
+        beginTest ("Parallel jobs");
+        {
+            const int numJobs = 8;
+            const int length = 48000 * 20;
+            OwnedArray<MemoryBlock> sources, dests;
+
+            AudioProcessorOfflineRenderer renderer (4, 8192);
+            FinishCounter counter;
+            renderer.addListener (&counter);
+
+            for (int i = 0; i < numJobs; ++i)
+            {
+                writeRamp (*sources.add (new MemoryBlock()), length);
+                renderer.addJob (createJob (createGraph (64), *sources.getLast(), *dests.add (new MemoryBlock())));
+            }
+
+            expect (renderer.waitUntilFinished (60000));
+            renderer.removeListener (&counter);
+
+            auto stats = renderer.getStatistics();
+            expectEquals (stats.numJobs, numJobs);
+            expectEquals (stats.numFinished, numJobs);
+            expectEquals (stats.samplesRendered, (int64) numJobs * length);
+            expectEquals (counter.count.get(), numJobs);
+
+            for (auto* d : dests)
+                expectMatchesRamp (*d, length, 0);
+
+            logMessage ("Rendered " + String (stats.secondsOfAudioRendered, 1) + "s of audio in "
+                          + String (stats.elapsedSeconds, 3) + "s (" + String (stats.getRealtimeFactor(), 1)
+                          + "x realtime)");
+        }
+
+        beginTest ("Cancellation");
+        {
+            MemoryBlock dests[3];
+            AudioProcessorOfflineRenderer renderer (1, 256);
+
+            Array<Job*> added;
+
+            for (auto& dest : dests)
+            {
+                auto job = createJob (createGraph (0), {}, dest);
+                job->setLengthInSamples (48000 * 60 * 60);
+                added.add (renderer.addJob (std::move (job)));
+            }
+
+            renderer.cancelAllJobs();
+
+            for (auto* j : added)
+                expect (j->getStatus() == Job::Status::cancelled);
+        }
+    }
+
+private:
+    using Job = AudioProcessorOfflineRenderer::Job;
+
+    struct FinishCounter  : public AudioProcessorOfflineRenderer::Listener
+    {
+        void renderJobFinished (Job&) override    { ++count; }
+        Atomic<int> count;
+    };
+
+    // A stereo pass-through which delays its output by a fixed number of samples
+    struct DelayProcessor  : public TestAudioProcessor
+    {
+        DelayProcessor (int delay)
+            : TestAudioProcessor ("Delay", BusesProperties().withInput  ("in",  AudioChannelSet::stereo())
+                                                            .withOutput ("out", AudioChannelSet::stereo())),
+              delaySamples (delay)
+        {
+            setLatencySamples (delay);
+        }
+
+        void prepareToPlay (double, int) override
+        {
+            history.setSize (2, delaySamples + 1);
+            history.clear();
+            writePos = 0;
+        }
+
+        void processBlock (AudioBuffer<float>& buffer, MidiBuffer&) override
+        {
+            if (delaySamples == 0)
+                return;
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                {
+                    auto in = buffer.getSample (ch, i);
+                    buffer.setSample (ch, i, history.getSample (ch, writePos));
+                    history.setSample (ch, writePos, in);
+                }
+
+                writePos = (writePos + 1) % delaySamples;
+            }
+        }
+
+        bool acceptsMidi() const override     { return false; }
+        bool producesMidi() const override    { return false; }
+
+        AudioBuffer<float> history;
+        const int delaySamples;
+        int writePos = 0;
+    };
+
+    static std::unique_ptr<AudioProcessor> createGraph (int delay)
+    {
+        using IOProcessor = AudioProcessorGraph::AudioGraphIOProcessor;
+
+        auto graph = std::make_unique<AudioProcessorGraph>();
+        graph->setPlayConfigDetails (2, 2, 48000.0, 512);
+
+        auto in        = graph->addNode (std::make_unique<IOProcessor> (IOProcessor::audioInputNode));
+        auto out       = graph->addNode (std::make_unique<IOProcessor> (IOProcessor::audioOutputNode));
+        auto delayNode = graph->addNode (std::make_unique<DelayProcessor> (delay));
+
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            graph->addConnection ({ { in->nodeID, ch }, { delayNode->nodeID, ch } });
+            graph->addConnection ({ { delayNode->nodeID, ch }, { out->nodeID, ch } });
+        }
+
+        return graph;
+    }
+
+    static float rampValue (int64 i) noexcept      { return (float) (i % 1000) / 2000.0f; }
+
+    static void writeRamp (MemoryBlock& block, int length)
+    {
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (new MemoryOutputStream (block, false),
+                                                                        48000.0, 2, 32, {}, 0));
+        AudioBuffer<float> buffer (2, length);
+
+        for (int i = 0; i < length; ++i)
+        {
+            buffer.setSample (0, i, rampValue (i));
+            buffer.setSample (1, i, -rampValue (i));
+        }
+
+        writer->writeFromAudioSampleBuffer (buffer, 0, length);
+    }
+
+    static std::unique_ptr<Job> createJob (std::unique_ptr<AudioProcessor> processor,
+                                           const MemoryBlock& source, MemoryBlock& dest)
+    {
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatReader> reader;
+
+        if (source.getSize() > 0)
+            reader.reset (wav.createReaderFor (new MemoryInputStream (source, false), true));
+
+        std::unique_ptr<AudioFormatWriter> writer (wav.createWriterFor (new MemoryOutputStream (dest, false),
+                                                                        48000.0, 2, 32, {}, 0));
+
+        return std::unique_ptr<Job> (new Job (std::move (processor), std::move (reader), std::move (writer)));
+    }
+
+    void expectMatchesRamp (const MemoryBlock& block, int rampLength, int silenceAfter)
+    {
+        WavAudioFormat wav;
+        std::unique_ptr<AudioFormatReader> reader (wav.createReaderFor (new MemoryInputStream (block, false), true));
+
+        expect (reader != nullptr);
+
+        if (reader == nullptr)
+            return;
+
+        expectEquals (reader->lengthInSamples, (int64) (rampLength + silenceAfter));
+
+        AudioBuffer<float> buffer (2, (int) reader->lengthInSamples);
+        reader->read (&buffer, 0, buffer.getNumSamples(), 0, true, true);
+
+        bool ok = true;
+
+        for (int i = 0; i < buffer.getNumSamples() && ok; ++i)
+        {
+            auto expected = i < rampLength ? rampValue (i) : 0.0f;
+            ok = std::abs (buffer.getSample (0, i) - expected) < 1.0e-6f
+                  && std::abs (buffer.getSample (1, i) + expected) < 1.0e-6f;
+        }
+
+        expect (ok);
+    }
+};
+
+static AudioProcessorOfflineRendererTests audioProcessorOfflineRendererTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   By using JUCE, you agree to the terms of both the JUCE 5 End-User License
+   Agreement and JUCE 5 Privacy Policy (both updated and effective as of the
+   27th April 2017).
+
+   End User License Agreement: www.juce.com/juce-5-licence
+   Privacy Policy: www.juce.com/juce-5-privacy-policy
+
+   Or: You may also use this code under the terms of the GPL v3 (see
+   www.gnu.org/licenses).
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Renders AudioProcessors (typically AudioProcessorGraphs) from AudioFormatReader
+    sources into AudioFormatWriter destinations as fast as the machine allows.
+
+    Each Job owns a processor, an optional source reader and a destination writer.
+    Jobs are independent of each other, so the renderer runs them in parallel on a
+    pool of worker threads - with N cores, N bounces can proceed at the same time.
+
+    Processors are put into non-realtime mode and are run with a large block size,
+    which amortises the per-block overhead of a graph's render sequence. Any latency
+    that the processor reports is compensated for, so the output lines up with the
+    source material.
+
+    @code
+    AudioProcessorOfflineRenderer renderer;
+
+    auto job = std::make_unique<AudioProcessorOfflineRenderer::Job> (std::move (graph),
+                                                                     std::move (reader),
+                                                                     std::move (writer));
+    job->setTailLength (44100);
+    renderer.addJob (std::move (job));
+
+    renderer.waitUntilFinished();
+    @endcode
+
+    @see AudioProcessorPlayer, AudioProcessorGraph
+
+    @tags{Audio}
+*/
+class JUCE_API  AudioProcessorOfflineRenderer
+{
+public:
+    //==============================================================================
+    /** A single render of a processor from a source into a destination. */
+    class JUCE_API  Job
+    {
+    public:
+        /** Creates a job.
+
+            The source reader may be null, in which case the processor is fed silence
+            (plus any MIDI given to setMidiInput()), and the length of the render must
+            be set with setLengthInSamples().
+
+            The processor's sample rate is taken from the source if there is one, or
+            from the destination writer otherwise.
+        */
+        Job (std::unique_ptr<AudioProcessor> processorToRender,
+             std::unique_ptr<AudioFormatReader> sourceReader,
+             std::unique_ptr<AudioFormatWriter> destinationWriter,
+             const String& jobName = {});
+
+        /** Destructor. */
+        ~Job();
+
+        //==============================================================================
+        /** Sets the number of samples to render when there's no source reader.
+            When there is a source, its length is used instead.
+        */
+        void setLengthInSamples (int64 numSamples) noexcept;
+
+        /** Sets a number of extra samples to render after the end of the source, so that
+            reverb tails and the like aren't cut off.
+        */
+        void setTailLength (int64 numSamples) noexcept;
+
+        /** Provides a MIDI sequence that will be fed to the processor. The timestamps
+            must be in seconds, as produced by MidiFile::convertTimestampTicksToSeconds().
+        */
+        void setMidiInput (const MidiMessageSequence& sequence);
+
+        /** If enabled (the default), the first getLatencySamples() samples that the
+            processor produces are dropped and the render is extended to match.
+        */
+        void setLatencyCompensation (bool shouldCompensate) noexcept;
+
+        //==============================================================================
+        enum class Status
+        {
+            pending,
+            running,
+            finished,
+            failed,
+            cancelled
+        };
+
+        /** Returns the job's current state. */
+        Status getStatus() const noexcept                       { return (Status) status.load(); }
+
+        /** Returns true once the job has finished, failed or been cancelled. */
+        bool isDone() const noexcept;
+
+        /** If the job has failed, this returns a description of the problem. */
+        String getErrorMessage() const;
+
+        /** Returns the name that was passed to the constructor. */
+        const String& getName() const noexcept                  { return name; }
+
+        /** Returns the processor that this job renders. */
+        AudioProcessor& getProcessor() const noexcept           { return *processor; }
+
+        //==============================================================================
+        /** Returns the number of output samples that will be written. */
+        int64 getTotalLength() const noexcept;
+
+        /** Returns the number of output samples that have been written so far. */
+        int64 getNumSamplesRendered() const noexcept            { return samplesRendered.load(); }
+
+        /** Returns the progress of the job, from 0 to 1. */
+        double getProgress() const noexcept;
+
+        /** Returns the number of seconds of wall-clock time that this job has spent rendering. */
+        double getElapsedSeconds() const noexcept;
+
+        /** Returns how many times faster than realtime this job is being rendered. */
+        double getRealtimeFactor() const noexcept;
+
+    private:
+        //==============================================================================
+        friend class AudioProcessorOfflineRenderer;
+
+        std::unique_ptr<AudioProcessor> processor;
+        std::unique_ptr<AudioFormatReader> reader;
+        std::unique_ptr<AudioFormatWriter> writer;
+        String name, errorMessage;
+        MidiMessageSequence midiInput;
+        CriticalSection errorLock;
+
+        double sampleRate = 0;
+        int64 lengthInSamples = 0, tailLength = 0;
+        int latency = 0;
+        bool compensateForLatency = true;
+
+        std::atomic<int> status { (int) Status::pending };
+        std::atomic<int64> samplesRendered { 0 };
+        std::atomic<double> startTime { 0 }, endTime { 0 };
+
+        bool prepare (int blockSize);
+        void render (int blockSize, ThreadPoolJob&, AudioProcessorOfflineRenderer&);
+        void fail (const String&);
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Job)
+    };
+
+    //==============================================================================
+    /** Creates a renderer.
+
+        @param numThreads   the number of jobs that can be rendered simultaneously
+        @param blockSize    the number of samples passed to each processBlock() call
+    */
+    AudioProcessorOfflineRenderer (int numThreads = SystemStats::getNumCpus(),
+                                   int blockSize = 8192);
+
+    /** Destructor. Any jobs that are still running are cancelled. */
+    ~AudioProcessorOfflineRenderer();
+
+    //==============================================================================
+    /** Adds a job and starts rendering it as soon as a thread is free.
+
+        The job's processor is prepared on the calling thread. If the processor is an
+        AudioProcessorGraph, call this on the message thread so that the graph can build
+        its rendering sequence synchronously, rather than waiting for an async update.
+
+        Returns a pointer to the job, which remains owned by the renderer.
+    */
+    Job* addJob (std::unique_ptr<Job> job);
+
+    /** Returns the number of jobs that have been added. */
+    int getNumJobs() const;
+
+    /** Returns one of the jobs that have been added. */
+    Job* getJob (int index) const;
+
+    /** Cancels any jobs that haven't yet finished, and waits for them to stop. */
+    void cancelAllJobs();
+
+    /** Blocks until all the jobs have finished, or the timeout expires.
+        Returns true if all jobs are done.
+    */
+    bool waitUntilFinished (int timeoutMilliseconds = -1) const;
+
+    //==============================================================================
+    /** A summary of the renderer's progress across all its jobs. */
+    struct Statistics
+    {
+        int numJobs = 0, numFinished = 0, numFailed = 0, numCancelled = 0;
+        int64 totalSamples = 0, samplesRendered = 0;
+        double secondsOfAudioRendered = 0, elapsedSeconds = 0;
+
+        /** Returns the overall progress, from 0 to 1. */
+        double getProgress() const noexcept;
+
+        /** Returns how many seconds of audio have been rendered per second of wall-clock time. */
+        double getRealtimeFactor() const noexcept;
+    };
+
+    /** Returns the current progress and throughput of all the jobs. */
+    Statistics getStatistics() const;
+
+    //==============================================================================
+    /** Receives callbacks as jobs progress.
+        Note that these are called on the renderer's worker threads.
+    */
+    class JUCE_API  Listener
+    {
+    public:
+        /** Destructor. */
+        virtual ~Listener() = default;
+
+        /** Called after each block that a job renders. */
+        virtual void renderJobProgressChanged (Job&) {}
+
+        /** Called when a job finishes, fails or is cancelled. */
+        virtual void renderJobFinished (Job&) = 0;
+    };
+
+    /** Registers a listener. */
+    void addListener (Listener*);
+
+    /** Deregisters a listener. */
+    void removeListener (Listener*);
+
+private:
+    //==============================================================================
+    class RenderTask;
+
+    const int blockSize;
+    ThreadPool pool;
+    OwnedArray<Job> jobs;
+    ListenerList<Listener> listeners;
+    CriticalSection jobLock, listenerLock;
+    WaitableEvent jobFinished;
+
+    void callProgressListeners (Job&);
+    void callFinishedListeners (Job&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorOfflineRenderer)
+};
+
+} // namespace juce
@@ -1154,6 +1154,11 @@ public:
             expect (mmf.getSize() == 10);
             expect (mmf.getData() != nullptr);
             expect (memcmp (mmf.getData(), "0123456789", 10) == 0);
+
+            mmf.setAccessPattern (MemoryMappedFile::randomAccess);
+            mmf.prefetch ({ 2, 8 });
+            mmf.prefetch ({ 5, 1000 });
+            expect (memcmp (mmf.getData(), "0123456789", 10) == 0);
         }
 
         {
@@ -96,6 +96,32 @@ public:
     /** Returns the section of the file at which the mapped memory represents. */
     Range<int64> getRange() const noexcept      { return range; }
 
+    //==============================================================================
+    /** Describes the way that the mapped memory is going to be read. */
+    enum AccessPattern
+    {
+        normalAccess,       /**< No particular pattern, so the OS uses its default amount of read-ahead. */
+        sequentialAccess,   /**< The memory will be read in order, so the OS can read well ahead of the
+                                 current position. This is what a newly-mapped file uses. */
+        randomAccess        /**< The memory will be read in no particular order, so the OS should only
+                                 load the pages that are actually touched. */
+    };
+
+    /** Tells the OS how the mapped memory is going to be read, so that it can choose how
+        much data to read ahead when a page is touched.
+        This is only a hint, and it has no effect on platforms that don't support it.
+    */
+    void setAccessPattern (AccessPattern pattern) noexcept;
+
+    /** Asks the OS to start loading a section of the file into memory in the background,
+        so that it's ready by the time it's read.
+
+        The range is given in bytes from the start of the file (like getRange()), and any
+        part of it that's outside the mapped range is ignored. This is only a hint, and it
+        has no effect on platforms that don't support it.
+    */
+    void prefetch (Range<int64> fileRange) noexcept;
+
 private:
     //==============================================================================
     void* address = nullptr;
@@ -285,6 +285,7 @@ namespace juce
 #include "streams/juce_MemoryInputStream.h"
 #include "streams/juce_MemoryOutputStream.h"
 #include "streams/juce_SubregionStream.h"
+#include "streams/juce_RewindableInputStream.h"
 #include "streams/juce_InputSource.h"
 #include "files/juce_File.h"
 #include "files/juce_DirectoryIterator.h"
@@ -663,6 +663,29 @@ MemoryMappedFile::~MemoryMappedFile()
         close (fileHandle);
 }
 
+void MemoryMappedFile::setAccessPattern (AccessPattern pattern) noexcept
+{
+    if (address != nullptr)
+        madvise (address, (size_t) range.getLength(), pattern == sequentialAccess ? MADV_SEQUENTIAL
+                                                    : (pattern == randomAccess    ? MADV_RANDOM
+                                                                                  : MADV_NORMAL));
+}
+
+void MemoryMappedFile::prefetch (Range<int64> fileRange) noexcept
+{
+    fileRange = fileRange.getIntersectionWith (range);
+
+    if (address != nullptr && ! fileRange.isEmpty())
+    {
+        // madvise needs a page-aligned address, and the start of the mapping is always page-aligned
+        auto pageSize = (int64) sysconf (_SC_PAGE_SIZE);
+        auto start = fileRange.getStart() - range.getStart();
+        start -= start % pageSize;
+
+        madvise (addBytesToPointer (address, start), (size_t) (fileRange.getEnd() - range.getStart() - start), MADV_WILLNEED);
+    }
+}
+
 //==============================================================================
 File juce_getExecutableFile();
 File juce_getExecutableFile()
@@ -431,6 +431,34 @@ MemoryMappedFile::~MemoryMappedFile()
         CloseHandle ((HANDLE) fileHandle);
 }
 
+void MemoryMappedFile::setAccessPattern (AccessPattern) noexcept
+{
+    // Windows has no equivalent of madvise() for mapped views
+}
+
+void MemoryMappedFile::prefetch (Range<int64> fileRange) noexcept
+{
+    fileRange = fileRange.getIntersectionWith (range);
+
+    if (address == nullptr || fileRange.isEmpty())
+        return;
+
+    // PrefetchVirtualMemory is only available on Windows 8 and later, so has to be loaded dynamically
+    struct MemoryRangeEntry  { void* virtualAddress; SIZE_T numberOfBytes; };
+    using PrefetchVirtualMemoryFn = BOOL (WINAPI*) (HANDLE, ULONG_PTR, MemoryRangeEntry*, ULONG);
+
+    static auto prefetchVirtualMemory = (PrefetchVirtualMemoryFn) GetProcAddress (GetModuleHandleA ("kernel32.dll"),
+                                                                                  "PrefetchVirtualMemory");
+
+    if (prefetchVirtualMemory != nullptr)
+    {
+        MemoryRangeEntry entry { addBytesToPointer (address, fileRange.getStart() - range.getStart()),
+                                 (SIZE_T) fileRange.getLength() };
+
+        prefetchVirtualMemory (GetCurrentProcess(), 1, &entry, 0);
+    }
+}
+
 //==============================================================================
 int64 File::getSize() const
 {
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce
+{
+
+RewindableInputStream::RewindableInputStream (InputStream* sourceStream, int rewindBufferSize, bool takeOwnership)
+   : source (sourceStream, takeOwnership),
+     bufferSize (jmax (256, rewindBufferSize)),
+     position (jmax ((int64) 0, sourceStream->getPosition())),
+     sourcePosition (position)
+{
+    // The buffer has room for a whole block to be read in behind the bytes that
+    // are being kept, so that they only need to be moved up occasionally.
+    buffer.malloc (2 * (size_t) bufferSize);
+}
+
+RewindableInputStream::~RewindableInputStream()
+{
+}
+
+//==============================================================================
+int64 RewindableInputStream::getTotalLength()
+{
+    return source->getTotalLength();
+}
+
+int64 RewindableInputStream::getPosition()
+{
+    return position;
+}
+
+bool RewindableInputStream::setPosition (int64 newPosition)
+{
+    if (newPosition < getEarliestAvailablePosition())
+        return false;
+
+    // a position beyond the data read so far is reached by the next call to read()
+    position = newPosition;
+    return true;
+}
+
+bool RewindableInputStream::isExhausted()
+{
+    return position >= sourcePosition && source->isExhausted();
+}
+
+int RewindableInputStream::readFromSource (int maxBytes)
+{
+    jassert (maxBytes > 0 && maxBytes <= bufferSize);
+
+    if (bufferStart + numBuffered + maxBytes > 2 * bufferSize)
+    {
+        memmove (buffer, buffer + bufferStart, (size_t) numBuffered);
+        bufferStart = 0;
+    }
+
+    auto bytesRead = source->read (buffer + bufferStart + numBuffered, maxBytes);
+
+    if (bytesRead <= 0)
+        return 0;
+
+    sourcePosition += bytesRead;
+    numBuffered += bytesRead;
+
+    if (numBuffered > bufferSize)
+    {
+        bufferStart += numBuffered - bufferSize;
+        numBuffered = bufferSize;
+    }
+
+    return bytesRead;
+}
+
+int RewindableInputStream::read (void* destBuffer, int maxBytesToRead)
+{
+    jassert (destBuffer != nullptr && maxBytesToRead >= 0);
+
+    int bytesRead = 0;
+
+    while (maxBytesToRead > 0)
+    {
+        if (position >= sourcePosition)
+        {
+            // only ask the source for the bytes that are needed, so that a slow stream
+            // isn't kept waiting for data that hasn't arrived yet
+            auto numNeeded = jmin ((int64) bufferSize, position + maxBytesToRead - sourcePosition);
+
+            if (readFromSource ((int) numNeeded) == 0)
+                break;
+
+            continue;
+        }
+
+        auto offset = (int) (position - getEarliestAvailablePosition());
+        auto numToCopy = jmin (maxBytesToRead, numBuffered - offset);
+
+        memcpy (destBuffer, buffer + bufferStart + offset, (size_t) numToCopy);
+        destBuffer = static_cast<char*> (destBuffer) + numToCopy;
+        maxBytesToRead -= numToCopy;
+        bytesRead += numToCopy;
+        position += numToCopy;
+    }
+
+    return bytesRead;
+}
+
+
+//==============================================================================
+//==============================================================================
+#if JUCE_UNIT_TESTS
+
+struct RewindableInputStreamTests   : public UnitTest
+{
+    RewindableInputStreamTests()
+        : UnitTest ("RewindableInputStream", UnitTestCategories::streams)
+    {}
+
+    // A stream that can only be read forwards, like a pipe or a socket
+    struct ForwardOnlyStream  : public InputStream
+    {
+        ForwardOnlyStream (const MemoryBlock& d)  : data (d, false) {}
+
+        int64 getTotalLength() override             { return -1; }
+        int64 getPosition() override                { return data.getPosition(); }
+        bool setPosition (int64 pos) override       { return pos == data.getPosition(); }
+        bool isExhausted() override                 { return data.isExhausted(); }
+
+        // return fewer bytes than were asked for, as a network stream might
+        int read (void* dest, int num) override     { return data.read (dest, jmin (num, 1000)); }
+
+        MemoryInputStream data;
+    };
+
+    void runTest() override
+    {
+        MemoryBlock data (100000);
+        auto r = getRandom();
+
+        for (size_t i = 0; i < data.getSize(); ++i)
+            data[i] = (char) r.nextInt (256);
+
+        beginTest ("Read");
+        {
+            ForwardOnlyStream source (data);
+            RewindableInputStream stream (&source, 3000, false);
+
+            expectEquals (stream.getPosition(), (int64) 0);
+            expect (! stream.isExhausted());
+
+            MemoryBlock result;
+            stream.readIntoMemoryBlock (result);
+
+            expect (result == data);
+            expect (stream.isExhausted());
+            expectEquals (stream.getPosition(), (int64) data.getSize());
+        }
+
+        beginTest ("Rewind and skip");
+        {
+            ForwardOnlyStream source (data);
+            RewindableInputStream stream (&source, 3000, false);
+
+            for (int i = 0; i < 1000; ++i)
+            {
+                auto pos = stream.getPosition();
+                auto newPos = jlimit ((int64) 0, (int64) data.getSize(), pos + r.nextInt ({ -4000, 4000 }));
+                auto canMove = newPos >= stream.getEarliestAvailablePosition();
+
+                expect (canMove == (newPos >= jmax ((int64) 0, (int64) source.getPosition() - 3000)));
+                expect (stream.setPosition (newPos) == canMove);
+                expectEquals (stream.getPosition(), canMove ? newPos : pos);
+
+                char bytes[100];
+                auto num = stream.read (bytes, r.nextInt ({ 1, 100 }));
+                auto start = (size_t) stream.getPosition() - (size_t) num;
+
+                expect (memcmp (bytes, data.begin() + start, (size_t) num) == 0);
+            }
+        }
+    }
+};
+
+static RewindableInputStreamTests rewindableInputStreamTests;
+
+#endif
+
+} // namespace juce
@@ -0,0 +1,90 @@
+/*
+  ==============================================================================
+
+   This file is part of the JUCE library.
+   Copyright (c) 2017 - ROLI Ltd.
+
+   JUCE is an open source library subject to commercial or open-source
+   licensing.
+
+   The code included in this file is provided under the terms of the ISC license
+   http://www.isc.org/downloads/software-support-policy/isc-license. Permission
+   To use, copy, modify, and/or distribute this software for any purpose with or
+   without fee is hereby granted provided that the above copyright notice and
+   this permission notice appear in all copies.
+
+   JUCE IS PROVIDED "AS IS" WITHOUT ANY WARRANTY, AND ALL WARRANTIES, WHETHER
+   EXPRESSED OR IMPLIED, INCLUDING MERCHANTABILITY AND FITNESS FOR PURPOSE, ARE
+   DISCLAIMED.
+
+  ==============================================================================
+*/
+
+
+namespace juce
+{
+
+//==============================================================================
+/**
+    Wraps a stream that can only be read forwards, so that it can be moved back
+    by a limited distance.
+
+    Network and pipe streams can't be repositioned, but a lot of code that parses
+    a stream needs to look ahead a little and then go back. This class keeps a copy
+    of the most recent bytes that were read from the source, so that setPosition()
+    can move back to any position within that many bytes of the furthest position
+    read so far. Moving forwards just reads and discards the bytes in between.
+
+    If a position is requested that has already been discarded from the buffer,
+    setPosition() returns false and leaves the position unchanged.
+
+    @see BufferedInputStream
+
+    @tags{Core}
+*/
+class JUCE_API  RewindableInputStream  : public InputStream
+{
+public:
+    //==============================================================================
+    /** Creates a RewindableInputStream from a source stream.
+
+        @param sourceStream                 the source stream to read from
+        @param rewindBufferSize             the number of bytes behind the furthest read
+                                            position that the stream can move back to
+        @param deleteSourceWhenDestroyed    whether the sourceStream that is passed in should be
+                                            deleted by this object when it is itself deleted.
+    */
+    RewindableInputStream (InputStream* sourceStream,
+                           int rewindBufferSize,
+                           bool deleteSourceWhenDestroyed);
+
+    /** Destructor.
+
+        This may also delete the source stream, if that option was chosen when the
+        stream was created.
+    */
+    ~RewindableInputStream() override;
+
+    //==============================================================================
+    /** Returns the earliest position that the stream can currently move back to. */
+    int64 getEarliestAvailablePosition() const noexcept     { return sourcePosition - numBuffered; }
+
+    int64 getTotalLength() override;
+    int64 getPosition() override;
+    bool setPosition (int64 newPosition) override;
+    int read (void* destBuffer, int maxBytesToRead) override;
+    bool isExhausted() override;
+
+private:
+    //==============================================================================
+    OptionalScopedPointer<InputStream> source;
+    HeapBlock<char> buffer;
+    int bufferSize, bufferStart = 0, numBuffered = 0;
+    int64 position, sourcePosition;
+
+    int readFromSource (int maxBytes);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RewindableInputStream)
+};
+
+} // namespace juce
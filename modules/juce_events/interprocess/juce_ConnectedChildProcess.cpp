@@ -54,6 +54,11 @@ struct ChildProcessPingThread  : public Thread,
     void pingReceived() noexcept            { countdown = timeoutMs / 1000 + 1; }
     void triggerConnectionLostMessage()     { triggerAsyncUpdate(); }
 
+    // The pings are sent through the owner's connection pointer, so this mustn't be
+    // started until that pointer has been set, and must be stopped before it's cleared.
+    void startPinging()                     { startThread (4); }
+    void stopPinging()                      { stopThread (10000); }
+
     virtual bool sendPingMessage (const MemoryBlock&) = 0;
     virtual void pingFailed() = 0;
 
@@ -90,15 +95,17 @@ struct ChildProcessMaster::Connection  : public InterprocessConnection,
           ChildProcessPingThread (timeout),
           owner (m)
     {
-        if (createPipe (pipeName, timeoutMs))
-            startThread (4);
+        createPipe (pipeName, timeoutMs);
     }
 
     ~Connection() override
     {
-        stopThread (10000);
+        stopPinging();
     }
 
+    using ChildProcessPingThread::startPinging;
+    using ChildProcessPingThread::stopPinging;
+
 private:
     void connectionMade() override  {}
     void connectionLost() override  { owner.handleConnectionLost(); }
@@ -157,6 +164,7 @@ bool ChildProcessMaster::launchSlaveProcess (const File& executable, const Strin
 
         if (connection->isConnected())
         {
+            connection->startPinging();
             sendMessageToSlave ({ startMessage, specialMessageSize });
             return true;
         }
@@ -171,6 +179,7 @@ void ChildProcessMaster::killSlaveProcess()
 {
     if (connection != nullptr)
     {
+        connection->stopPinging();
         sendMessageToSlave ({ killMessage, specialMessageSize });
         connection->disconnect();
         connection.reset();
@@ -189,14 +198,15 @@ struct ChildProcessSlave::Connection  : public InterprocessConnection,
           owner (p)
     {
         connectToPipe (pipeName, timeoutMs);
-        startThread (4);
     }
 
     ~Connection() override
     {
-        stopThread (10000);
+        stopPinging();
     }
 
+    using ChildProcessPingThread::startPinging;
+
 private:
     ChildProcessSlave& owner;
 
@@ -256,7 +266,9 @@ bool ChildProcessSlave::initialiseFromCommandLine (const String& commandLine,
         {
             connection.reset (new Connection (*this, pipeName, timeoutMs <= 0 ? defaultTimeoutMs : timeoutMs));
 
-            if (! connection->isConnected())
+            if (connection->isConnected())
+                connection->startPinging();
+            else
                 connection.reset();
         }
     }